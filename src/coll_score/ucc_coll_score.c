@@ -7,6 +7,8 @@
 #include "utils/ucc_string.h"
 #include "utils/ucc_log.h"
 #include "utils/ucc_coll_utils.h"
+#include "core/ucc_team.h"
+#include "components/topo/ucc_topo.h"
 
 ucc_status_t ucc_coll_score_alloc(ucc_coll_score_t **score)
 {
@@ -584,36 +586,28 @@ err:
     goto out;
 }
 
-static ucc_status_t str_to_tsizes(const char *str, ucc_rank_t **tsizes,
-                                  unsigned *n_tsizes)
+/* Parses ',' separated list of rank ranges start-end or single values
+   (exact match). Special value "inf" of range end means UCC_RANK_MAX. */
+static ucc_status_t str_to_rank_ranges(const char *str, ucc_rank_t **ranges,
+                                       unsigned *n_ranges)
 {
-    ucc_status_t status = UCC_OK;
+    ucc_status_t status  = UCC_OK;
+    char **      tokens2 = NULL;
     char **      tokens;
-    char **      tokens2;
     unsigned     i, n_tokens, n_tokens2;
 
-    /* team_size qualifer should be enclosed in "[]".
-       It it a coma-separated list of ranges start-end or
-       single values (exact team size) */
-    if ('[' != str[0] || ']' != str[strlen(str) - 1]) {
-        return UCC_ERR_NOT_FOUND;
-    }
-    tokens = ucc_str_split(str + 1, ",");
+    tokens = ucc_str_split(str, ",");
     if (!tokens) {
-        status = UCC_ERR_INVALID_PARAM;
-        goto out;
+        return UCC_ERR_INVALID_PARAM;
     }
     n_tokens = ucc_str_split_count(tokens);
-    *tsizes = ucc_malloc(2 * n_tokens * sizeof(ucc_rank_t), "ucc_tsize_ranges");
-    if (!(*tsizes)) {
-        ucc_error("failed to allocate %zd bytes for ucc_tsize_ranges",
+    *ranges = ucc_malloc(2 * n_tokens * sizeof(ucc_rank_t), "ucc_rank_ranges");
+    if (!(*ranges)) {
+        ucc_error("failed to allocate %zd bytes for ucc_rank_ranges",
                   sizeof(ucc_rank_t) * 2 * n_tokens);
         status = UCC_ERR_NO_MEMORY;
         goto out;
     }
-    ucc_assert(']' == tokens[n_tokens - 1][strlen(tokens[n_tokens - 1]) - 1]);
-    /* remove last "]" from the parsed string, we have already checked it was present */
-    tokens[n_tokens - 1][strlen(tokens[n_tokens - 1]) - 1] = '\0';
     for (i = 0; i < n_tokens; i++) {
         tokens2 = ucc_str_split(tokens[i], "-");
         if (!tokens2) {
@@ -622,50 +616,119 @@ static ucc_status_t str_to_tsizes(const char *str, ucc_rank_t **tsizes,
         }
         n_tokens2 = ucc_str_split_count(tokens2);
         if (n_tokens2 == 1) {
-            /* exact team size - single value */
+            /* exact value */
             if (UCC_OK != ucc_str_is_number(tokens2[0])) {
                 status = UCC_ERR_INVALID_PARAM;
                 goto err;
             }
-            (*tsizes)[2 * i]     = (ucc_rank_t)atoi(tokens2[0]);
-            (*tsizes)[2 * i + 1] = (ucc_rank_t)atoi(tokens2[0]);
+            (*ranges)[2 * i]     = (ucc_rank_t)atoi(tokens2[0]);
+            (*ranges)[2 * i + 1] = (ucc_rank_t)atoi(tokens2[0]);
         } else {
             if (n_tokens2 != 2) {
                 status  = UCC_ERR_INVALID_PARAM;
                 goto err;
             }
             if (UCC_OK == ucc_str_is_number(tokens2[0])) {
-                (*tsizes)[2 * i] = (ucc_rank_t)atoi(tokens2[0]);
+                (*ranges)[2 * i] = (ucc_rank_t)atoi(tokens2[0]);
             } else {
                 status  = UCC_ERR_INVALID_PARAM;
                 goto err;
             }
             if (0 == strcasecmp("inf", tokens2[1])) {
-                (*tsizes)[2 * i + 1] = UCC_RANK_MAX;
+                (*ranges)[2 * i + 1] = UCC_RANK_MAX;
             } else if (UCC_OK == ucc_str_is_number(tokens2[1])) {
-                (*tsizes)[2 * i + 1] = (ucc_rank_t)atoi(tokens2[1]);
+                (*ranges)[2 * i + 1] = (ucc_rank_t)atoi(tokens2[1]);
             } else {
                 status  = UCC_ERR_INVALID_PARAM;
                 goto err;
             }
-            if ((*tsizes)[2 * i + 1] < (*tsizes)[2 * i]) {
+            if ((*ranges)[2 * i + 1] < (*ranges)[2 * i]) {
                 status  = UCC_ERR_INVALID_PARAM;
                 goto err;
             }
         }
         ucc_str_split_free(tokens2);
     }
-    *n_tsizes = i;
+    *n_ranges = i;
 out:
     ucc_str_split_free(tokens);
     return status;
 err:
     ucc_str_split_free(tokens2);
-    ucc_free(*tsizes);
-    *tsizes = NULL;
+    ucc_free(*ranges);
+    *ranges = NULL;
     goto out;
 }
 
+static ucc_status_t str_to_tsizes(const char *str, ucc_rank_t **tsizes,
+                                  unsigned *n_tsizes)
+{
+    ucc_status_t status;
+    char        *list;
+    size_t       len;
+
+    /* team_size qualifer should be either enclosed in "[]" or
+       prefixed with "team_size=".
+       It it a coma-separated list of ranges start-end or
+       single values (exact team size) */
+    len = strlen(str);
+    if ('[' == str[0] && ']' == str[len - 1]) {
+        list = strdup(str + 1);
+        if (!list) {
+            return UCC_ERR_NO_MEMORY;
+        }
+        list[len - 2] = '\0';
+        status        = str_to_rank_ranges(list, tsizes, n_tsizes);
+        free(list);
+        return status;
+    }
+    if (0 == strncasecmp(str, "team_size=", strlen("team_size="))) {
+        return str_to_rank_ranges(str + strlen("team_size="), tsizes, n_tsizes);
+    }
+    return UCC_ERR_NOT_FOUND;
+}
+
+/* Generic "name=r1,r2,...,rn" qualifier, used for ppn and nnodes */
+static ucc_status_t str_to_named_ranges(const char *str, const char *name,
+                                        ucc_rank_t **ranges, unsigned *n_ranges)
+{
+    size_t len = strlen(name);
+
+    if (0 != strncasecmp(str, name, len) || '=' != str[len]) {
+        return UCC_ERR_NOT_FOUND;
+    }
+    return str_to_rank_ranges(str + len + 1, ranges, n_ranges);
+}
+
+static inline int rank_ranges_contain(const ucc_rank_t *ranges,
+                                      unsigned n_ranges, ucc_rank_t value)
+{
+    unsigned i;
+
+    for (i = 0; i < n_ranges; i++) {
+        if (value >= ranges[2 * i] && value <= ranges[2 * i + 1]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Team shape used to filter ppn/nnodes qualifiers. It is only known
+   when the component team spans the whole core team that has topo
+   initialized, otherwise 0 is returned. */
+static void coll_score_team_shape(ucc_base_team_t *team, ucc_rank_t team_size,
+                                  ucc_rank_t *ppn, ucc_rank_t *nnodes)
+{
+    ucc_team_t *core_team = team ? team->params.team : NULL;
+
+    *ppn    = 0;
+    *nnodes = 0;
+    if (core_team && core_team->topo && core_team->size == team_size) {
+        *ppn    = ucc_topo_max_ppn(core_team->topo);
+        *nnodes = ucc_topo_nnodes(core_team->topo);
+    }
+}
+
 static ucc_status_t ucc_coll_score_parse_str(const char *str,
                                              ucc_coll_score_t *score,
                                              ucc_rank_t team_size, //NOLINT
@@ -678,14 +741,18 @@ static ucc_status_t ucc_coll_score_parse_str(const char *str,
     ucc_memory_type_t      *mt       = NULL;
     size_t                 *msg      = NULL;
     ucc_rank_t             *tsizes   = NULL;
+    ucc_rank_t             *ppns     = NULL;
+    ucc_rank_t             *nnodes   = NULL;
     ucc_base_coll_init_fn_t alg_init = NULL;
     const char*             alg_id   = NULL;
     ucc_score_t             score_v  = UCC_SCORE_INVALID;
     int                     ts_skip  = 0;
+    ucc_rank_t              team_ppn, team_nnodes;
     char                  **tokens;
-    unsigned i, n_tokens, ct_n, mt_n, c, m, n_ranges, r, n_tsizes;
+    unsigned i, n_tokens, ct_n, mt_n, c, m, n_ranges, r, n_tsizes, n_ppns,
+        n_nnodes;
 
-    mt_n = ct_n = n_ranges = n_tsizes = 0;
+    mt_n = ct_n = n_ranges = n_tsizes = n_ppns = n_nnodes = 0;
     tokens = ucc_str_split(str, ":");
     if (!tokens) {
         status = UCC_ERR_INVALID_PARAM;
@@ -709,6 +776,14 @@ static ucc_status_t ucc_coll_score_parse_str(const char *str,
         if (!tsizes && UCC_OK == str_to_tsizes(tokens[i], &tsizes, &n_tsizes)) {
             continue;
         }
+        if (!ppns && UCC_OK == str_to_named_ranges(tokens[i], "ppn", &ppns,
+                                                   &n_ppns)) {
+            continue;
+        }
+        if (!nnodes && UCC_OK == str_to_named_ranges(tokens[i], "nnodes",
+                                                     &nnodes, &n_nnodes)) {
+            continue;
+        }
         if (!alg_id && UCC_OK == str_to_alg_id(tokens[i], &alg_id)) {
             continue;
         }
@@ -721,12 +796,17 @@ static ucc_status_t ucc_coll_score_parse_str(const char *str,
     if (tsizes) {
         /* Team size qualifier was provided: check if we should apply this
            str setting to the  current team */
-        ts_skip = 1;
-        for (i = 0; i < n_tsizes; i++) {
-            if (team_size >= tsizes[2 * i] && team_size <= tsizes[2 * i + 1]) {
-                ts_skip = 0;
-                break;
-            }
+        ts_skip = !rank_ranges_contain(tsizes, n_tsizes, team_size);
+    }
+    if (!ts_skip && (ppns || nnodes)) {
+        /* Team shape qualifiers: the token is skipped if the shape of the
+           team is unknown */
+        coll_score_team_shape(team, team_size, &team_ppn, &team_nnodes);
+        if (ppns && !rank_ranges_contain(ppns, n_ppns, team_ppn)) {
+            ts_skip = 1;
+        }
+        if (nnodes && !rank_ranges_contain(nnodes, n_nnodes, team_nnodes)) {
+            ts_skip = 1;
         }
     }
     if (!ts_skip && (UCC_SCORE_INVALID != score_v || NULL != alg_id)) {
@@ -801,6 +881,8 @@ out:
     ucc_free(mt);
     ucc_free(msg);
     ucc_free(tsizes);
+    ucc_free(ppns);
+    ucc_free(nnodes);
     ucc_str_split_free(tokens);
     return status;
 }
@@ -15,9 +15,9 @@ ucc_config_field_t ucc_base_lib_config_table[] = {
 ucc_config_field_t ucc_base_ctx_config_table[] = {
     {"TUNE", "", "Collective tuning modifier for a CL/TL component\n"
      "format: token1#token2#...#tokenn - '#' separated list of tokens where\n"
-     "    token=coll_type:msg_range:mem_type:team_size:score:alg - ':' separated\n"
-     "    list of qualifiers. Each qualifier is optional. The only requirement\n"
-     "    is that either \"score\" or \"alg\" is provided.\n"
+     "    token=coll_type:msg_range:mem_type:team_size:ppn:nnodes:score:alg -\n"
+     "    ':' separated list of qualifiers. Each qualifier is optional.\n"
+     "    The only requirement is that either \"score\" or \"alg\" is provided.\n"
      "qualifiers:\n"
      "    coll_type=coll_type_1,coll_type_2,...,coll_type_n - ',' separated\n"
      "              list of coll_types\n"
@@ -28,6 +28,14 @@ ucc_config_field_t ucc_base_ctx_config_table[] = {
      "    mem_type=m1,m2,..,mn - ',' separated list of memory types\n"
      "    team_size=[t_start_1-t_end_1,t_start_2-t_end_2,...,t_start_n-t_end_n] -\n"
      "              ',' separated list of team size ranges enclosed with [].\n"
+     "              Alternative form: team_size=t_start_1-t_end_1,...\n"
+     "    ppn=p_start_1-p_end_1,...,p_start_n-p_end_n - ',' separated list of\n"
+     "              ranges of max number of processes per node of the team.\n"
+     "    nnodes=n_start_1-n_end_1,...,n_start_n-n_end_n - ',' separated list\n"
+     "              of ranges of number of nodes spanned by the team.\n"
+     "              ppn and nnodes qualifiers are only applied to the teams\n"
+     "              with known topology.\n"
+     "              Any range end can be \"inf\", single value means exact match.\n"
      "    score=value - int value from 0 to \"inf\"\n"
      "          0 - disables the CL/TL in the given range for a given coll\n"
      "          inf - forces the CL/TL in the given range for a given coll\n"
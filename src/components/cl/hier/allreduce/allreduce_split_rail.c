@@ -228,19 +228,25 @@ static ucc_status_t ucc_cl_hier_allreduce_split_rail_frag_init(
     }
 
     task_rs->n_deps = 1;
-    ucc_schedule_add_task(schedule, task_rs);
-    ucc_event_manager_subscribe(&schedule->super.em, UCC_EVENT_SCHEDULE_STARTED,
-                                task_rs, ucc_dependency_handler);
+    UCC_CHECK_GOTO(ucc_schedule_add_task(schedule, task_rs), err_deps, status);
+    UCC_CHECK_GOTO(ucc_event_manager_subscribe(&schedule->super.em,
+                                               UCC_EVENT_SCHEDULE_STARTED,
+                                               task_rs, ucc_dependency_handler),
+                   err_deps, status);
 
     task_ar->n_deps = 1;
-    ucc_schedule_add_task(schedule, task_ar);
-    ucc_event_manager_subscribe(&task_rs->em, UCC_EVENT_COMPLETED, task_ar,
-                                ucc_dependency_handler);
+    UCC_CHECK_GOTO(ucc_schedule_add_task(schedule, task_ar), err_deps, status);
+    UCC_CHECK_GOTO(ucc_event_manager_subscribe(&task_rs->em,
+                                               UCC_EVENT_COMPLETED, task_ar,
+                                               ucc_dependency_handler),
+                   err_deps, status);
 
     task_ag->n_deps = 1;
-    ucc_schedule_add_task(schedule, task_ag);
-    ucc_event_manager_subscribe(&task_ar->em, UCC_EVENT_COMPLETED, task_ag,
-                                ucc_dependency_handler);
+    UCC_CHECK_GOTO(ucc_schedule_add_task(schedule, task_ag), err_deps, status);
+    UCC_CHECK_GOTO(ucc_event_manager_subscribe(&task_ar->em,
+                                               UCC_EVENT_COMPLETED, task_ag,
+                                               ucc_dependency_handler),
+                   err_deps, status);
 
     schedule->super.post     = ucc_schedule_start;
     schedule->super.progress = NULL;
@@ -249,6 +255,8 @@ static ucc_status_t ucc_cl_hier_allreduce_split_rail_frag_init(
     *frag_p = schedule;
     return status;
 
+err_deps:
+    ucc_collective_finalize(&task_ag->super);
 err_ag:
     if (task_ar) {
         ucc_collective_finalize(&task_ar->super);
@@ -238,12 +238,16 @@ UCC_CL_HIER_PROFILE_FUNC(ucc_status_t, ucc_cl_hier_alltoallv_init,
         cl_error(team->context->lib, "failed to init full a2av task");
         goto err_init_2;
     }
-    ucc_schedule_add_task(schedule, task_node);
-    ucc_schedule_add_task(schedule, task_full);
-    ucc_task_subscribe_dep(&schedule->super, task_node,
-                           UCC_EVENT_SCHEDULE_STARTED);
-    ucc_task_subscribe_dep(&schedule->super, task_full,
-                           UCC_EVENT_SCHEDULE_STARTED);
+    UCC_CHECK_GOTO(ucc_schedule_add_task(schedule, task_node), err_deps,
+                   status);
+    UCC_CHECK_GOTO(ucc_schedule_add_task(schedule, task_full), err_deps,
+                   status);
+    UCC_CHECK_GOTO(ucc_task_subscribe_dep(&schedule->super, task_node,
+                                          UCC_EVENT_SCHEDULE_STARTED),
+                   err_deps, status);
+    UCC_CHECK_GOTO(ucc_task_subscribe_dep(&schedule->super, task_full,
+                                          UCC_EVENT_SCHEDULE_STARTED),
+                   err_deps, status);
 
     schedule->super.post           = ucc_cl_hier_alltoallv_start;
     schedule->super.progress       = NULL;
@@ -254,6 +258,8 @@ UCC_CL_HIER_PROFILE_FUNC(ucc_status_t, ucc_cl_hier_alltoallv_init,
     *task = &schedule->super;
     return UCC_OK;
 
+err_deps:
+    ucc_collective_finalize(&task_node->super);
 err_init_2:
     ucc_collective_finalize(&task_full->super);
 err_init_1:
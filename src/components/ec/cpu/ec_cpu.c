@@ -156,6 +156,14 @@ ucc_status_t ucc_cpu_executor_task_post(ucc_ee_executor_t *executor,
         memcpy(task_args->copy.dst, task_args->copy.src, task_args->copy.len);
         break;
     case UCC_EE_EXECUTOR_TASK_COPY_MULTI:
+    {
+        const ucc_eee_task_copy_multi_t *tcm = &task_args->copy_multi;
+        int                              i;
+
+        for (i = 0; i < tcm->num_vectors; i++) {
+            memcpy(tcm->dst[i], tcm->src[i], tcm->counts[i]);
+        }
+    } break;
     default:
         status = UCC_ERR_NOT_SUPPORTED;
         goto free_task;
@@ -7,33 +7,111 @@
 #include "mc_cpu.h"
 #include "utils/ucc_malloc.h"
 #include "utils/ucc_math.h"
+#include "utils/ucc_proc_info.h"
+#include "utils/ucc_atomic.h"
 #include "utils/arch/cpu.h"
+#include <ucs/sys/sys.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+
+/* buffers of smaller classes come from ucc_malloc */
+#define UCC_MC_CPU_MMAP_THRESH (64 * 1024)
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
 
 static ucc_config_field_t ucc_mc_cpu_config_table[] = {
     {"", "", NULL, ucc_offsetof(ucc_mc_cpu_config_t, super),
      UCC_CONFIG_TYPE_TABLE(ucc_mc_config_table)},
 
-    {"MPOOL_ELEM_SIZE", "1Mb", "The size of each element in mc cpu mpool",
+    {"MPOOL_ELEM_SIZE", "8Mb",
+     "Max size of a buffer served from mc cpu size class pool, larger "
+     "buffers are allocated and released on every call. Increase it if "
+     "large scratch buffers of collectives (e.g. allreduce of big messages) "
+     "show allocation overhead, together with MPOOL_MAX_RETAINED",
      ucc_offsetof(ucc_mc_cpu_config_t, mpool_elem_size),
      UCC_CONFIG_TYPE_MEMUNITS},
 
-    {"MPOOL_MAX_ELEMS", "8", "The max amount of elements in mc cpu mpool",
+    {"MPOOL_MAX_ELEMS", "8",
+     "Max amount of free buffers retained in each size class of mc cpu "
+     "pool, 0 - disable the pool",
      ucc_offsetof(ucc_mc_cpu_config_t, mpool_max_elems), UCC_CONFIG_TYPE_UINT},
 
+    {"MPOOL_MAX_RETAINED", "32Mb",
+     "Max total size of free buffers retained by mc cpu pool. This memory "
+     "stays allocated in every process until ucc is finalized, buffers "
+     "released above the limit are returned to the system",
+     ucc_offsetof(ucc_mc_cpu_config_t, mpool_max_retained),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"MPOOL_HUGETLB", "y",
+     "Back pool buffers of huge page size and larger with huge pages, "
+     "hugetlbfs pages are used if available, transparent huge pages otherwise",
+     ucc_offsetof(ucc_mc_cpu_config_t, mpool_hugetlb), UCC_CONFIG_TYPE_BOOL},
+
+    {"MPOOL_NUMA_LOCAL", "y",
+     "Place pool buffers on the NUMA node the process is bound to",
+     ucc_offsetof(ucc_mc_cpu_config_t, mpool_numa_local),
+     UCC_CONFIG_TYPE_BOOL},
+
     {NULL}
 
 };
 
+static ucc_status_t ucc_mc_cpu_mem_alloc(ucc_mc_buffer_header_t **h_ptr,
+                                         size_t                   size);
+static ucc_status_t ucc_mc_cpu_mem_free(ucc_mc_buffer_header_t *h_ptr);
+
+static inline unsigned ucc_mc_cpu_size_class(size_t size)
+{
+    if (size <= UCC_BIT(UCC_MC_CPU_MIN_CLASS_SHIFT)) {
+        return 0;
+    }
+    return ucc_ilog2(size - 1) + 1 - UCC_MC_CPU_MIN_CLASS_SHIFT;
+}
+
+static inline void ucc_mc_cpu_pool_lock(void)
+{
+    if (ucc_mc_cpu.thread_mode != UCC_THREAD_SINGLE) {
+        ucc_spin_lock(&ucc_mc_cpu.pool_lock);
+    }
+}
+
+static inline void ucc_mc_cpu_pool_unlock(void)
+{
+    if (ucc_mc_cpu.thread_mode != UCC_THREAD_SINGLE) {
+        ucc_spin_unlock(&ucc_mc_cpu.pool_lock);
+    }
+}
+
 static ucc_status_t ucc_mc_cpu_init(const ucc_mc_params_t *mc_params)
 {
+    ucc_mc_cpu_config_t *cfg;
+    ssize_t              huge_page_size;
+
     ucc_strncpy_safe(ucc_mc_cpu.super.config->log_component.name,
                      ucc_mc_cpu.super.super.name,
                      sizeof(ucc_mc_cpu.super.config->log_component.name));
+    cfg                    = MC_CPU_CONFIG;
     ucc_mc_cpu.thread_mode = mc_params->thread_mode;
-    // lock assures single mpool initiation when multiple threads concurrently execute
-    // different collective operations thus concurrently entering init function.
-    ucc_spinlock_init(&ucc_mc_cpu.mpool_init_spinlock, 0);
+    ucc_spinlock_init(&ucc_mc_cpu.pool_lock, 0);
+    memset(ucc_mc_cpu.classes, 0, sizeof(ucc_mc_cpu.classes));
+    ucc_mc_cpu.retained      = 0;
+    ucc_mc_cpu.n_outstanding = 0;
+    ucc_mc_cpu.n_classes = ucc_min(ucc_mc_cpu_size_class(cfg->mpool_elem_size)
+                                       + 1, UCC_MC_CPU_MAX_CLASSES);
+
+    huge_page_size            = ucs_get_huge_page_size();
+    ucc_mc_cpu.huge_page_size = (huge_page_size > 0) ? huge_page_size : 0;
+
+    if (cfg->mpool_max_elems == 0 || cfg->mpool_max_retained == 0) {
+        ucc_mc_cpu.super.ops.mem_alloc = ucc_mc_cpu_mem_alloc;
+        ucc_mc_cpu.super.ops.mem_free  = ucc_mc_cpu_mem_free;
+    }
     return UCC_OK;
 }
 
@@ -60,101 +138,172 @@ static ucc_status_t ucc_mc_cpu_mem_alloc(ucc_mc_buffer_header_t **h_ptr,
     h->addr      = PTR_OFFSET(h, sizeof(ucc_mc_buffer_header_t));
     h->mt        = UCC_MEMORY_TYPE_HOST;
     *h_ptr       = h;
+    ucc_atomic_add64(&ucc_mc_cpu.n_outstanding, 1);
     mc_trace(&ucc_mc_cpu.super, "allocated %ld bytes with ucc_malloc", size);
     return UCC_OK;
 }
 
-static ucc_status_t ucc_mc_cpu_mem_pool_alloc(ucc_mc_buffer_header_t **h_ptr,
-                                              size_t                   size)
+static void ucc_mc_cpu_numa_bind(void *ptr, size_t length)
 {
-    ucc_mc_buffer_header_t *h = NULL;
-    if (size <= MC_CPU_CONFIG->mpool_elem_size) {
-        h = (ucc_mc_buffer_header_t *)ucc_mpool_get(&ucc_mc_cpu.mpool);
+#ifdef SYS_mbind
+    unsigned long nodemask[(UCC_MAX_NUMA_ID + 1) / (8 * sizeof(long)) + 1];
+    ucc_numa_id_t numa_id = ucc_local_proc.numa_id;
+
+    if (numa_id == UCC_NUMA_ID_INVALID) {
+        /* process is not bound to a single numa, first touch decides */
+        return;
     }
-    if (!h) {
-        // Slow path
-        return ucc_mc_cpu_mem_alloc(h_ptr, size);
+    memset(nodemask, 0, sizeof(nodemask));
+    nodemask[numa_id / (8 * sizeof(long))] |=
+        1UL << (numa_id % (8 * sizeof(long)));
+    if (0 != syscall(SYS_mbind, ptr, length, MPOL_PREFERRED, nodemask,
+                     8 * sizeof(nodemask) + 1, 0)) {
+        mc_debug(&ucc_mc_cpu.super, "failed to bind %zd bytes to numa %d, "
+                 "errno %d", length, (int)numa_id, errno);
     }
-    mc_trace(&ucc_mc_cpu.super, "allocated %ld bytes from cpu mpool", size);
-    *h_ptr = h;
-    return UCC_OK;
+#endif
 }
 
-static ucc_status_t ucc_mc_cpu_chunk_alloc(ucc_mpool_t *mp, //NOLINT
-                                           size_t *size_p,
-                                           void **chunk_p)
+static ucc_status_t ucc_mc_cpu_buffer_alloc(unsigned              size_class,
+                                            ucc_mc_cpu_buffer_t **buf_p)
 {
-    *chunk_p = ucc_malloc(*size_p, "mc cpu");
-    if (!*chunk_p) {
-        mc_error(&ucc_mc_cpu.super, "failed to allocate %zd bytes", *size_p);
-        return UCC_ERR_NO_MEMORY;
+    ucc_mc_cpu_config_t *cfg     = MC_CPU_CONFIG;
+    size_t               length  = UCC_BIT(size_class +
+                                           UCC_MC_CPU_MIN_CLASS_SHIFT);
+    size_t               hp_size = ucc_mc_cpu.huge_page_size;
+    uint8_t              backing = UCC_MC_CPU_BUF_MALLOC;
+    ucc_mc_cpu_buffer_t *buf;
+    void                *ptr;
+
+    if (length < UCC_MC_CPU_MMAP_THRESH) {
+        buf = ucc_malloc(UCC_MC_CPU_BUF_HDR_SIZE + length, "mc cpu");
+        if (ucc_unlikely(!buf)) {
+            goto err_nomem;
+        }
+        ptr = PTR_OFFSET(buf, UCC_MC_CPU_BUF_HDR_SIZE);
+    } else {
+        buf = ucc_malloc(sizeof(*buf), "mc cpu buffer header");
+        if (ucc_unlikely(!buf)) {
+            goto err_nomem;
+        }
+        ptr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (cfg->mpool_hugetlb && hp_size && length % hp_size == 0) {
+            ptr     = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            backing = UCC_MC_CPU_BUF_HUGETLB;
+        }
+#endif
+        if (ptr == MAP_FAILED) {
+            ptr     = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            backing = UCC_MC_CPU_BUF_MMAP;
+            if (ucc_unlikely(ptr == MAP_FAILED)) {
+                ucc_free(buf);
+                goto err_nomem;
+            }
+#ifdef MADV_HUGEPAGE
+            if (cfg->mpool_hugetlb && hp_size && length >= hp_size) {
+                madvise(ptr, length, MADV_HUGEPAGE);
+            }
+#endif
+        }
+        if (cfg->mpool_numa_local) {
+            ucc_mc_cpu_numa_bind(ptr, length);
+        }
     }
+    buf->super.from_pool = 1;
+    buf->super.addr      = ptr;
+    buf->super.mt        = UCC_MEMORY_TYPE_HOST;
+    buf->next            = NULL;
+    buf->length          = length;
+    buf->size_class      = size_class;
+    buf->backing         = backing;
+    *buf_p               = buf;
+    mc_trace(&ucc_mc_cpu.super, "allocated %zd bytes pool buffer, backing %d",
+             length, (int)backing);
     return UCC_OK;
+
+err_nomem:
+    mc_error(&ucc_mc_cpu.super, "failed to allocate %zd bytes", length);
+    return UCC_ERR_NO_MEMORY;
 }
 
-static void ucc_mc_cpu_chunk_init(ucc_mpool_t *mp, //NOLINT
-                                  void *obj, void *chunk) //NOLINT
+static void ucc_mc_cpu_buffer_release(ucc_mc_cpu_buffer_t *buf)
 {
-    ucc_mc_buffer_header_t *h = (ucc_mc_buffer_header_t *)obj;
-    h->from_pool              = 1;
-    h->addr                   = PTR_OFFSET(h, sizeof(ucc_mc_buffer_header_t));
-    h->mt                     = UCC_MEMORY_TYPE_HOST;
+    if (buf->backing != UCC_MC_CPU_BUF_MALLOC) {
+        munmap(buf->super.addr, buf->length);
+    }
+    ucc_free(buf);
 }
 
-static void ucc_mc_cpu_chunk_release(ucc_mpool_t *mp, void *chunk) //NOLINT
+static ucc_status_t ucc_mc_cpu_mem_pool_alloc(ucc_mc_buffer_header_t **h_ptr,
+                                              size_t                   size)
 {
-    ucc_free(chunk);
-}
+    unsigned                 size_class = ucc_mc_cpu_size_class(size);
+    ucc_mc_cpu_size_class_t *sc;
+    ucc_mc_cpu_buffer_t     *buf;
+    ucc_status_t             status;
 
-static ucc_mpool_ops_t ucc_mc_ops = {.chunk_alloc   = ucc_mc_cpu_chunk_alloc,
-                                     .chunk_release = ucc_mc_cpu_chunk_release,
-                                     .obj_init      = ucc_mc_cpu_chunk_init,
-                                     .obj_cleanup   = NULL};
+    if (size_class >= ucc_mc_cpu.n_classes) {
+        // Slow path
+        return ucc_mc_cpu_mem_alloc(h_ptr, size);
+    }
+    sc = &ucc_mc_cpu.classes[size_class];
+    ucc_mc_cpu_pool_lock();
+    buf = sc->free_list;
+    if (buf) {
+        sc->free_list = buf->next;
+        sc->n_free--;
+        ucc_mc_cpu.retained -= buf->length;
+    }
+    ucc_mc_cpu_pool_unlock();
+    if (!buf) {
+        status = ucc_mc_cpu_buffer_alloc(size_class, &buf);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+    ucc_atomic_add64(&ucc_mc_cpu.n_outstanding, 1);
+    mc_trace(&ucc_mc_cpu.super, "allocated %ld bytes from cpu mpool", size);
+    *h_ptr = &buf->super;
+    return UCC_OK;
+}
 
 static ucc_status_t ucc_mc_cpu_mem_free(ucc_mc_buffer_header_t *h_ptr)
 {
+    ucc_atomic_sub64(&ucc_mc_cpu.n_outstanding, 1);
     ucc_free(h_ptr);
     return UCC_OK;
 }
 
 static ucc_status_t ucc_mc_cpu_mem_pool_free(ucc_mc_buffer_header_t *h_ptr)
 {
+    ucc_mc_cpu_config_t     *cfg = MC_CPU_CONFIG;
+    ucc_mc_cpu_buffer_t     *buf;
+    ucc_mc_cpu_size_class_t *sc;
+
     if (!h_ptr->from_pool) {
         return ucc_mc_cpu_mem_free(h_ptr);
     }
-    ucc_mpool_put(h_ptr);
-    return UCC_OK;
-}
-
-static ucc_status_t
-ucc_mc_cpu_mem_pool_alloc_with_init(ucc_mc_buffer_header_t **h_ptr, size_t size)
-{
-    // lock assures single mpool initiation when multiple threads concurrently
-    // execute different collective operations each entering init function.
-    ucc_spin_lock(&ucc_mc_cpu.mpool_init_spinlock);
-
-    if (MC_CPU_CONFIG->mpool_max_elems == 0) {
-        ucc_mc_cpu.super.ops.mem_alloc = ucc_mc_cpu_mem_alloc;
-        ucc_mc_cpu.super.ops.mem_free  = ucc_mc_cpu_mem_free;
-        ucc_spin_unlock(&ucc_mc_cpu.mpool_init_spinlock);
-        return ucc_mc_cpu_mem_alloc(h_ptr, size);
+    ucc_atomic_sub64(&ucc_mc_cpu.n_outstanding, 1);
+    buf = ucc_derived_of(h_ptr, ucc_mc_cpu_buffer_t);
+    sc  = &ucc_mc_cpu.classes[buf->size_class];
+    ucc_mc_cpu_pool_lock();
+    if (sc->n_free < (unsigned)cfg->mpool_max_elems &&
+        ucc_mc_cpu.retained + buf->length <= cfg->mpool_max_retained) {
+        buf->next            = sc->free_list;
+        sc->free_list        = buf;
+        sc->n_free++;
+        ucc_mc_cpu.retained += buf->length;
+        buf                  = NULL;
     }
-
-    if (!ucc_mc_cpu.mpool_init_flag) {
-        ucc_status_t status = ucc_mpool_init(
-            &ucc_mc_cpu.mpool, 0,
-            sizeof(ucc_mc_buffer_header_t) + MC_CPU_CONFIG->mpool_elem_size, 0,
-            UCC_CACHE_LINE_SIZE, 1, MC_CPU_CONFIG->mpool_max_elems, &ucc_mc_ops,
-            ucc_mc_cpu.thread_mode, "mc cpu mpool buffers");
-        if (ucc_unlikely(status != UCC_OK)) {
-            ucc_spin_unlock(&ucc_mc_cpu.mpool_init_spinlock);
-            return status;
-        }
-        ucc_mc_cpu.super.ops.mem_alloc = ucc_mc_cpu_mem_pool_alloc;
-        ucc_mc_cpu.mpool_init_flag     = 1;
+    ucc_mc_cpu_pool_unlock();
+    if (buf) {
+        /* over the retained memory limit */
+        ucc_mc_cpu_buffer_release(buf);
     }
-    ucc_spin_unlock(&ucc_mc_cpu.mpool_init_spinlock);
-    return ucc_mc_cpu_mem_pool_alloc(h_ptr, size);
+    return UCC_OK;
 }
 
 static ucc_status_t ucc_mc_cpu_memcpy(void *dst, const void *src, size_t len,
@@ -178,12 +327,24 @@ static ucc_status_t ucc_mc_cpu_mem_query(const void *ptr, //NOLINT
 
 static ucc_status_t ucc_mc_cpu_finalize()
 {
-    if (ucc_mc_cpu.mpool_init_flag) {
-        ucc_mpool_cleanup(&ucc_mc_cpu.mpool, 1);
-        ucc_mc_cpu.mpool_init_flag     = 0;
-        ucc_mc_cpu.super.ops.mem_alloc = ucc_mc_cpu_mem_pool_alloc_with_init;
+    ucc_mc_cpu_buffer_t *buf;
+    unsigned             i;
+
+    if (ucc_mc_cpu.n_outstanding) {
+        mc_warn(&ucc_mc_cpu.super, "%lu host buffers were not freed",
+                (unsigned long)ucc_mc_cpu.n_outstanding);
+    }
+    for (i = 0; i < ucc_mc_cpu.n_classes; i++) {
+        while ((buf = ucc_mc_cpu.classes[i].free_list)) {
+            ucc_mc_cpu.classes[i].free_list = buf->next;
+            ucc_mc_cpu_buffer_release(buf);
+        }
+        ucc_mc_cpu.classes[i].n_free = 0;
     }
-    ucc_spinlock_destroy(&ucc_mc_cpu.mpool_init_spinlock);
+    ucc_mc_cpu.retained            = 0;
+    ucc_mc_cpu.super.ops.mem_alloc = ucc_mc_cpu_mem_pool_alloc;
+    ucc_mc_cpu.super.ops.mem_free  = ucc_mc_cpu_mem_pool_free;
+    ucc_spinlock_destroy(&ucc_mc_cpu.pool_lock);
     return UCC_OK;
 }
 
@@ -196,7 +357,7 @@ ucc_mc_cpu_t ucc_mc_cpu = {
     .super.get_attr               = ucc_mc_cpu_get_attr,
     .super.finalize               = ucc_mc_cpu_finalize,
     .super.ops.mem_query          = ucc_mc_cpu_mem_query,
-    .super.ops.mem_alloc          = ucc_mc_cpu_mem_pool_alloc_with_init,
+    .super.ops.mem_alloc          = ucc_mc_cpu_mem_pool_alloc,
     .super.ops.mem_free           = ucc_mc_cpu_mem_pool_free,
     .super.ops.memcpy             = ucc_mc_cpu_memcpy,
     .super.ops.flush              = NULL,
@@ -207,7 +368,7 @@ ucc_mc_cpu_t ucc_mc_cpu = {
             .table  = ucc_mc_cpu_config_table,
             .size   = sizeof(ucc_mc_cpu_config_t),
         },
-    .mpool_init_flag               = 0,
+    .n_classes                     = 0,
 };
 
 UCC_CONFIG_REGISTER_TABLE_ENTRY(&ucc_mc_cpu.super.config_table,
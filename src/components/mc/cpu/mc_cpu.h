@@ -1,5 +1,5 @@
 /**
- * Copyright (c) 2020-2021, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * Copyright (c) 2020-2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
  *
  * See file LICENSE for terms.
  */
@@ -10,18 +10,54 @@
 #include "components/mc/base/ucc_mc_base.h"
 #include "components/mc/ucc_mc_log.h"
 
+/* Host scratch buffers are served from power of 2 size classes. Freed
+   buffers are kept in per class free lists up to the retained memory limit
+   and reused without page faults. Class 2^k holds exactly 2^k bytes of data:
+   small buffers keep the header in front of the data in the same malloc,
+   mmap backed buffers keep it out of band, so their data is page aligned
+   and spans whole (huge) pages. */
+#define UCC_MC_CPU_MIN_CLASS_SHIFT 8 /* 256 bytes */
+#define UCC_MC_CPU_MAX_CLASSES     40
+#define UCC_MC_CPU_BUF_HDR_SIZE    64
+
+enum {
+    UCC_MC_CPU_BUF_MALLOC  = 0, /* ucc_malloc */
+    UCC_MC_CPU_BUF_MMAP    = 1, /* anonymous mmap, transparent hugepages */
+    UCC_MC_CPU_BUF_HUGETLB = 2  /* mmap from hugetlbfs pool */
+};
+
+typedef struct ucc_mc_cpu_buffer {
+    ucc_mc_buffer_header_t    super;
+    struct ucc_mc_cpu_buffer *next;
+    size_t                    length; /* data size, the class size */
+    uint8_t                   size_class;
+    uint8_t                   backing;
+} ucc_mc_cpu_buffer_t;
+
+typedef struct ucc_mc_cpu_size_class {
+    ucc_mc_cpu_buffer_t *free_list;
+    unsigned             n_free;
+} ucc_mc_cpu_size_class_t;
+
 typedef struct ucc_mc_cpu_config {
     ucc_mc_config_t super;
     size_t          mpool_elem_size;
     int             mpool_max_elems;
+    size_t          mpool_max_retained;
+    int             mpool_hugetlb;
+    int             mpool_numa_local;
 } ucc_mc_cpu_config_t;
 
 typedef struct ucc_mc_cpu {
-    ucc_mc_base_t     super;
-    ucc_mpool_t       mpool;
-    int               mpool_init_flag;
-    ucc_spinlock_t    mpool_init_spinlock;
-    ucc_thread_mode_t thread_mode;
+    ucc_mc_base_t           super;
+    ucc_mc_cpu_size_class_t classes[UCC_MC_CPU_MAX_CLASSES];
+    unsigned                n_classes;
+    size_t                  retained;
+    /* buffers handed out and not freed yet, checked on finalize */
+    uint64_t                n_outstanding;
+    size_t                  huge_page_size;
+    ucc_spinlock_t          pool_lock;
+    ucc_thread_mode_t       thread_mode;
 } ucc_mc_cpu_t;
 
 extern ucc_mc_cpu_t ucc_mc_cpu;
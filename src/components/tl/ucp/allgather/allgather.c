@@ -12,20 +12,57 @@ ucc_base_coll_alg_info_t
         [UCC_TL_UCP_ALLGATHER_ALG_RING] =
             {.id   = UCC_TL_UCP_ALLGATHER_ALG_RING,
              .name = "ring",
-             .desc = "O(N) Ring"},
+             .desc = "O(N) Ring, steps are split into concurrent fragments"},
+        [UCC_TL_UCP_ALLGATHER_ALG_RD] =
+            {.id   = UCC_TL_UCP_ALLGATHER_ALG_RD,
+             .name = "rd",
+             .desc = "recursive doubling, log(N) steps, power of 2 team size"},
+        [UCC_TL_UCP_ALLGATHER_ALG_BRUCK] =
+            {.id   = UCC_TL_UCP_ALLGATHER_ALG_BRUCK,
+             .name = "bruck",
+             .desc = "Bruck algorithm with configurable radix, log(N) steps"},
+        [UCC_TL_UCP_ALLGATHER_ALG_NEIGHBOR] =
+            {.id   = UCC_TL_UCP_ALLGATHER_ALG_NEIGHBOR,
+             .name = "neighbor",
+             .desc = "neighbor exchange, N/2 steps, even team size"},
         [UCC_TL_UCP_ALLGATHER_ALG_LAST] = {
             .id = 0, .name = NULL, .desc = NULL}};
 
 ucc_status_t ucc_tl_ucp_allgather_init(ucc_tl_ucp_task_t *task)
 {
-    if ((!UCC_DT_IS_PREDEFINED((TASK_ARGS(task)).dst.info.datatype)) ||
-        (!UCC_IS_INPLACE(TASK_ARGS(task)) &&
-         (!UCC_DT_IS_PREDEFINED((TASK_ARGS(task)).src.info.datatype)))) {
-        tl_error(UCC_TASK_LIB(task), "user defined datatype is not supported");
-        return UCC_ERR_NOT_SUPPORTED;
-    }
+    ALLGATHER_CHECK_USERDEFINED_DT(TASK_ARGS(task), TASK_TEAM(task));
 
-    task->super.post     = ucc_tl_ucp_allgather_ring_start;
-    task->super.progress = ucc_tl_ucp_allgather_ring_progress;
+    task->allgather_ring.n_frags = 1;
+    task->allgather_ring.frag    = 0;
+    task->super.post             = ucc_tl_ucp_allgather_ring_start;
+    task->super.progress         = ucc_tl_ucp_allgather_ring_progress;
     return UCC_OK;
 }
+
+ucc_status_t ucc_tl_ucp_allgather_copy_local(ucc_tl_ucp_task_t       *task,
+                                             ucc_ee_executor_task_t **etask)
+{
+    ucc_coll_args_t            *args = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t          *team = TASK_TEAM(task);
+    size_t                      block_size;
+    ucc_ee_executor_task_args_t eargs;
+    ucc_ee_executor_t          *exec;
+    ucc_status_t                status;
+
+    *etask = NULL;
+    if (UCC_IS_INPLACE(*args)) {
+        return UCC_OK;
+    }
+    block_size = (args->dst.info.count / UCC_TL_TEAM_SIZE(team)) *
+                 ucc_dt_size(args->dst.info.datatype);
+    status = ucc_coll_task_get_executor(&task->super, &exec);
+    if (ucc_unlikely(status != UCC_OK)) {
+        return status;
+    }
+    eargs.task_type = UCC_EE_EXECUTOR_TASK_COPY;
+    eargs.copy.dst  = PTR_OFFSET(args->dst.info.buffer,
+                                 block_size * UCC_TL_TEAM_RANK(team));
+    eargs.copy.src  = args->src.info.buffer;
+    eargs.copy.len  = block_size;
+    return ucc_ee_executor_task_post(exec, &eargs, etask);
+}
@@ -10,18 +10,46 @@
 
 enum {
     UCC_TL_UCP_ALLGATHER_ALG_RING,
+    UCC_TL_UCP_ALLGATHER_ALG_RD,
+    UCC_TL_UCP_ALLGATHER_ALG_BRUCK,
+    UCC_TL_UCP_ALLGATHER_ALG_NEIGHBOR,
     UCC_TL_UCP_ALLGATHER_ALG_LAST
 };
 
 extern ucc_base_coll_alg_info_t
              ucc_tl_ucp_allgather_algs[UCC_TL_UCP_ALLGATHER_ALG_LAST + 1];
 
+/* log latency algorithms for small blocks, neighbor exchange for mid
+   size and segmented ring for large, msg range is the total dst size */
+#define UCC_TL_UCP_ALLGATHER_DEFAULT_ALG_SELECT_STR                            \
+    "allgather:0-16k:@1#allgather:16k-1M:@3#allgather:1M-inf:@0"
+
 ucc_status_t ucc_tl_ucp_allgather_init(ucc_tl_ucp_task_t *task);
 
 void  ucc_tl_ucp_allgather_ring_progress(ucc_coll_task_t *task);
 
 ucc_status_t ucc_tl_ucp_allgather_ring_start(ucc_coll_task_t *task);
 
+ucc_status_t ucc_tl_ucp_allgather_ring_init(ucc_base_coll_args_t *coll_args,
+                                            ucc_base_team_t      *team,
+                                            ucc_coll_task_t     **task_h);
+
+/* Falls back to bruck if team size is not power of 2 */
+ucc_status_t ucc_tl_ucp_allgather_rd_init(ucc_base_coll_args_t *coll_args,
+                                          ucc_base_team_t      *team,
+                                          ucc_coll_task_t     **task_h);
+
+/* Uses allgather_bruck_radix from config */
+ucc_status_t ucc_tl_ucp_allgather_bruck_init(ucc_base_coll_args_t *coll_args,
+                                             ucc_base_team_t      *team,
+                                             ucc_coll_task_t     **task_h);
+
+/* Falls back to ring if team size is odd */
+ucc_status_t
+ucc_tl_ucp_allgather_neighbor_init(ucc_base_coll_args_t *coll_args,
+                                   ucc_base_team_t      *team,
+                                   ucc_coll_task_t     **task_h);
+
 /* Uses allgather_kn_radix from config */
 ucc_status_t ucc_tl_ucp_allgather_knomial_init(ucc_base_coll_args_t *coll_args,
                                                ucc_base_team_t *     team,
@@ -31,4 +59,50 @@ ucc_status_t ucc_tl_ucp_allgather_knomial_init(ucc_base_coll_args_t *coll_args,
 ucc_status_t ucc_tl_ucp_allgather_knomial_init_r(
     ucc_base_coll_args_t *coll_args, ucc_base_team_t *team,
     ucc_coll_task_t **task_h, ucc_kn_radix_t radix);
+
+/* Posts the copy of the local block into dst for non inplace allgather.
+   etask is set to NULL if there is nothing to copy */
+ucc_status_t ucc_tl_ucp_allgather_copy_local(ucc_tl_ucp_task_t       *task,
+                                             ucc_ee_executor_task_t **etask);
+
+/* Returns UCC_INPROGRESS until the copy posted by
+   ucc_tl_ucp_allgather_copy_local is done */
+static inline ucc_status_t
+ucc_tl_ucp_allgather_copy_local_test(ucc_ee_executor_task_t **etask)
+{
+    ucc_status_t status;
+
+    if (*etask == NULL) {
+        return UCC_OK;
+    }
+    status = ucc_ee_executor_task_test(*etask);
+    if (status == UCC_INPROGRESS) {
+        return status;
+    }
+    ucc_ee_executor_task_finalize(*etask);
+    *etask = NULL;
+    return status;
+}
+
+#define ALLGATHER_CHECK_USERDEFINED_DT(_args, _team)                           \
+    do {                                                                       \
+        if ((!UCC_DT_IS_PREDEFINED((_args).dst.info.datatype)) ||              \
+            (!UCC_IS_INPLACE(_args) &&                                         \
+             (!UCC_DT_IS_PREDEFINED((_args).src.info.datatype)))) {            \
+            tl_error(UCC_TL_TEAM_LIB(_team),                                   \
+                     "user defined datatype is not supported");                \
+            return UCC_ERR_NOT_SUPPORTED;                                      \
+        }                                                                      \
+    } while (0)
+
+static inline int ucc_tl_ucp_allgather_alg_from_str(const char *str)
+{
+    int i;
+    for (i = 0; i < UCC_TL_UCP_ALLGATHER_ALG_LAST; i++) {
+        if (0 == strcasecmp(str, ucc_tl_ucp_allgather_algs[i].name)) {
+            break;
+        }
+    }
+    return i;
+}
 #endif
@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "allgather.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+#include "tl_ucp_generic_dt.h"
+
+/* Bruck allgather with radix r, ceil(log_r(N)) steps for any team size.
+   Before step k a rank owns n = r^k blocks rank, rank + 1, ..., rank + n - 1
+   (mod N). On step k it sends them to ranks rank - j * n and receives the
+   blocks of ranks rank + j * n, j = 1 .. r - 1.
+
+   The classic algorithm gathers the blocks into a rotated scratch buffer
+   and rotates them back in the end. Here the blocks are exchanged in place
+   in dst buffer instead: a range of blocks wraps around the end of the
+   buffer at most once and both sides split it at the same block index, so
+   the range is sent as at most 2 messages and no local copies are needed
+   except for the own block. */
+
+/* Posts send (or receive) of n blocks starting from block "start" */
+static inline ucc_status_t
+ucc_tl_ucp_allgather_bruck_post_range(ucc_tl_ucp_task_t *task, void *rbuf,
+                                      size_t block_size, ucc_rank_t start,
+                                      ucc_rank_t n, ucc_rank_t peer, int send)
+{
+    ucc_tl_ucp_team_t *team     = TASK_TEAM(task);
+    ucc_memory_type_t  mem_type = TASK_ARGS(task).dst.info.mem_type;
+    ucc_rank_t         n_tail   = ucc_min(n, UCC_TL_TEAM_SIZE(team) - start);
+    void              *buf      = PTR_OFFSET(rbuf, start * block_size);
+    ucc_status_t       status;
+
+    status = send ? ucc_tl_ucp_send_nb(buf, n_tail * block_size, mem_type,
+                                       peer, team, task)
+                  : ucc_tl_ucp_recv_nb(buf, n_tail * block_size, mem_type,
+                                       peer, team, task);
+    if (ucc_unlikely(UCC_OK != status) || n_tail == n) {
+        return status;
+    }
+    /* wrapped part of the range */
+    return send ? ucc_tl_ucp_send_nb(rbuf, (n - n_tail) * block_size,
+                                     mem_type, peer, team, task)
+                : ucc_tl_ucp_recv_nb(rbuf, (n - n_tail) * block_size,
+                                     mem_type, peer, team, task);
+}
+
+void ucc_tl_ucp_allgather_bruck_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task       = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args       = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team       = TASK_TEAM(task);
+    ucc_rank_t         rank       = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t         size       = UCC_TL_TEAM_SIZE(team);
+    uint32_t           radix      = task->allgather_bruck.radix;
+    void              *rbuf       = args->dst.info.buffer;
+    size_t             block_size = (args->dst.info.count / size) *
+                                    ucc_dt_size(args->dst.info.datatype);
+    ucc_rank_t         n, cnt, dist, sendto, recvfrom;
+    ucc_status_t       status;
+    uint32_t           j;
+
+    status = ucc_tl_ucp_allgather_copy_local_test(&task->allgather_bruck.etask);
+    if (status != UCC_OK) {
+        task->super.status = status;
+        return;
+    }
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        return;
+    }
+    while (task->allgather_bruck.n_blocks < size) {
+        n = task->allgather_bruck.n_blocks;
+        for (j = 1; j < radix; j++) {
+            dist = j * n;
+            if (dist >= size) {
+                break;
+            }
+            cnt      = ucc_min(n, size - dist);
+            sendto   = (rank - dist + size) % size;
+            recvfrom = (rank + dist) % size;
+            UCPCHECK_GOTO(ucc_tl_ucp_allgather_bruck_post_range(
+                              task, rbuf, block_size, rank, cnt, sendto, 1),
+                          task, out);
+            UCPCHECK_GOTO(ucc_tl_ucp_allgather_bruck_post_range(
+                              task, rbuf, block_size, recvfrom, cnt,
+                              recvfrom, 0),
+                          task, out);
+        }
+        task->allgather_bruck.n_blocks = (n > size / radix) ? size : n * radix;
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            return;
+        }
+    }
+    ucc_assert(UCC_TL_UCP_TASK_P2P_COMPLETE(task));
+    task->super.status = UCC_OK;
+out:
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allgather_bruck_done", 0);
+}
+
+ucc_status_t ucc_tl_ucp_allgather_bruck_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    ucc_status_t       status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allgather_bruck_start",
+                                     0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    task->allgather_bruck.n_blocks = 1;
+    status = ucc_tl_ucp_allgather_copy_local(task,
+                                             &task->allgather_bruck.etask);
+    if (ucc_unlikely(status != UCC_OK)) {
+        task->super.status = status;
+        return status;
+    }
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
+ucc_status_t ucc_tl_ucp_allgather_bruck_init(ucc_base_coll_args_t *coll_args,
+                                             ucc_base_team_t      *team,
+                                             ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_rank_t         size    = UCC_TL_TEAM_SIZE(tl_team);
+    ucc_tl_ucp_task_t *task;
+    uint32_t           radix;
+
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_allgather_bruck_init,
+                                          task_h);
+    }
+    ALLGATHER_CHECK_USERDEFINED_DT(coll_args->args, tl_team);
+
+    radix = UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.allgather_bruck_radix;
+    radix = ucc_max(2, ucc_min(radix, size));
+
+    task                          = ucc_tl_ucp_init_task(coll_args, team);
+    task->allgather_bruck.radix   = radix;
+    task->super.flags            |= UCC_COLL_TASK_FLAG_EXECUTOR;
+    task->super.post              = ucc_tl_ucp_allgather_bruck_start;
+    task->super.progress          = ucc_tl_ucp_allgather_bruck_progress;
+    *task_h                       = &task->super;
+    return UCC_OK;
+}
@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "allgather.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+#include "tl_ucp_generic_dt.h"
+
+/* Neighbor exchange allgather (Chen et al., 2005) for even team size.
+   Even ranks start with the right neighbor and odd ranks with the left one,
+   then every rank alternates between the 2 neighbors. Step 0 exchanges the
+   own blocks, each of the following N/2 - 1 steps forwards the pair of
+   blocks received on the previous step, so the algorithm takes N/2 steps
+   instead of N - 1 of the ring. The pair always starts at an even block
+   and is contiguous in dst buffer. */
+
+static inline void
+ucc_tl_ucp_allgather_neighbor_peers(ucc_rank_t rank, ucc_rank_t size,
+                                    ucc_rank_t *neighbor, ucc_rank_t *offset)
+{
+    if (rank % 2 == 0) {
+        neighbor[0] = (rank + 1) % size;
+        neighbor[1] = (rank - 1 + size) % size;
+        offset[0]   = 2;
+        offset[1]   = size - 2;
+    } else {
+        neighbor[0] = (rank - 1 + size) % size;
+        neighbor[1] = (rank + 1) % size;
+        offset[0]   = size - 2;
+        offset[1]   = 2;
+    }
+}
+
+void ucc_tl_ucp_allgather_neighbor_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task       = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args       = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team       = TASK_TEAM(task);
+    ucc_rank_t         rank       = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t         size       = UCC_TL_TEAM_SIZE(team);
+    void              *rbuf       = args->dst.info.buffer;
+    ucc_memory_type_t  mem_type   = args->dst.info.mem_type;
+    size_t             block_size = (args->dst.info.count / size) *
+                                    ucc_dt_size(args->dst.info.datatype);
+    ucc_rank_t        *recv_from  = task->allgather_neighbor.recv_from;
+    ucc_rank_t         neighbor[2], offset[2];
+    ucc_status_t       status;
+    int                i;
+
+    status = ucc_tl_ucp_allgather_copy_local_test(
+        &task->allgather_neighbor.etask);
+    if (status != UCC_OK) {
+        task->super.status = status;
+        return;
+    }
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        return;
+    }
+    ucc_tl_ucp_allgather_neighbor_peers(rank, size, neighbor, offset);
+    if (task->allgather_neighbor.step == 0) {
+        UCPCHECK_GOTO(ucc_tl_ucp_send_nb(PTR_OFFSET(rbuf, rank * block_size),
+                                         block_size, mem_type, neighbor[0],
+                                         team, task),
+                      task, out);
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(PTR_OFFSET(rbuf, neighbor[0] *
+                                                              block_size),
+                                         block_size, mem_type, neighbor[0],
+                                         team, task),
+                      task, out);
+        task->allgather_neighbor.step = 1;
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            return;
+        }
+    }
+    while (task->allgather_neighbor.step < size / 2) {
+        i            = task->allgather_neighbor.step % 2;
+        recv_from[i] = (recv_from[i] + offset[i]) % size;
+        UCPCHECK_GOTO(ucc_tl_ucp_send_nb(
+                          PTR_OFFSET(rbuf, task->allgather_neighbor.send_from *
+                                               block_size),
+                          2 * block_size, mem_type, neighbor[i], team, task),
+                      task, out);
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(PTR_OFFSET(rbuf, recv_from[i] *
+                                                              block_size),
+                                         2 * block_size, mem_type,
+                                         neighbor[i], team, task),
+                      task, out);
+        task->allgather_neighbor.send_from = recv_from[i];
+        task->allgather_neighbor.step++;
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            return;
+        }
+    }
+    ucc_assert(UCC_TL_UCP_TASK_P2P_COMPLETE(task));
+    task->super.status = UCC_OK;
+out:
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allgather_neighbor_done",
+                                     0);
+}
+
+ucc_status_t ucc_tl_ucp_allgather_neighbor_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    ucc_rank_t         rank = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t         size = UCC_TL_TEAM_SIZE(team);
+    ucc_rank_t         neighbor[2], offset[2];
+    ucc_status_t       status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allgather_neighbor_start",
+                                     0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    ucc_tl_ucp_allgather_neighbor_peers(rank, size, neighbor, offset);
+    /* the pair sent on step 1 is the own block and the block received from
+       neighbor[0] on step 0, it starts at the even one of them */
+    task->allgather_neighbor.step         = 0;
+    task->allgather_neighbor.send_from    = (rank % 2 == 0) ? rank
+                                                            : neighbor[0];
+    task->allgather_neighbor.recv_from[0] = task->allgather_neighbor.send_from;
+    task->allgather_neighbor.recv_from[1] = task->allgather_neighbor.send_from;
+    status = ucc_tl_ucp_allgather_copy_local(task,
+                                             &task->allgather_neighbor.etask);
+    if (ucc_unlikely(status != UCC_OK)) {
+        task->super.status = status;
+        return status;
+    }
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
+ucc_status_t
+ucc_tl_ucp_allgather_neighbor_init(ucc_base_coll_args_t *coll_args,
+                                   ucc_base_team_t      *team,
+                                   ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_rank_t         size    = UCC_TL_TEAM_SIZE(tl_team);
+    ucc_tl_ucp_task_t *task;
+
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_allgather_neighbor_init,
+                                          task_h);
+    }
+    ALLGATHER_CHECK_USERDEFINED_DT(coll_args->args, tl_team);
+    if (size % 2) {
+        tl_debug(UCC_TL_TEAM_LIB(tl_team), "team size %u is odd, "
+                 "using ring allgather", size);
+        return ucc_tl_ucp_allgather_ring_init(coll_args, team, task_h);
+    }
+
+    task                 = ucc_tl_ucp_init_task(coll_args, team);
+    task->super.flags   |= UCC_COLL_TASK_FLAG_EXECUTOR;
+    task->super.post     = ucc_tl_ucp_allgather_neighbor_start;
+    task->super.progress = ucc_tl_ucp_allgather_neighbor_progress;
+    *task_h              = &task->super;
+    return UCC_OK;
+}
@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "allgather.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+#include "tl_ucp_generic_dt.h"
+
+/* Recursive doubling allgather for power of 2 team size.
+   On the step with distance "dist" a rank owns the "dist" consecutive
+   blocks of its aligned group and exchanges them with rank ^ dist, all
+   the data is sent and received in place in dst buffer. */
+void ucc_tl_ucp_allgather_rd_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task       = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args       = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team       = TASK_TEAM(task);
+    ucc_rank_t         rank       = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t         size       = UCC_TL_TEAM_SIZE(team);
+    void              *rbuf       = args->dst.info.buffer;
+    ucc_memory_type_t  mem_type   = args->dst.info.mem_type;
+    size_t             block_size = (args->dst.info.count / size) *
+                                    ucc_dt_size(args->dst.info.datatype);
+    ucc_rank_t         dist, peer;
+    ucc_status_t       status;
+
+    status = ucc_tl_ucp_allgather_copy_local_test(&task->allgather_rd.etask);
+    if (status != UCC_OK) {
+        task->super.status = status;
+        return;
+    }
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        return;
+    }
+    while (task->allgather_rd.dist < size) {
+        dist = task->allgather_rd.dist;
+        peer = rank ^ dist;
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_send_nb(PTR_OFFSET(rbuf, (rank & ~(dist - 1)) *
+                                                    block_size),
+                               dist * block_size, mem_type, peer, team, task),
+            task, out);
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_recv_nb(PTR_OFFSET(rbuf, (peer & ~(dist - 1)) *
+                                                    block_size),
+                               dist * block_size, mem_type, peer, team, task),
+            task, out);
+        task->allgather_rd.dist = dist * 2;
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            return;
+        }
+    }
+    ucc_assert(UCC_TL_UCP_TASK_P2P_COMPLETE(task));
+    task->super.status = UCC_OK;
+out:
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allgather_rd_done", 0);
+}
+
+ucc_status_t ucc_tl_ucp_allgather_rd_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    ucc_status_t       status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allgather_rd_start", 0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    task->allgather_rd.dist = 1;
+    status = ucc_tl_ucp_allgather_copy_local(task, &task->allgather_rd.etask);
+    if (ucc_unlikely(status != UCC_OK)) {
+        task->super.status = status;
+        return status;
+    }
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
+ucc_status_t ucc_tl_ucp_allgather_rd_init(ucc_base_coll_args_t *coll_args,
+                                          ucc_base_team_t      *team,
+                                          ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_rank_t         size    = UCC_TL_TEAM_SIZE(tl_team);
+    ucc_tl_ucp_task_t *task;
+
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_allgather_rd_init,
+                                          task_h);
+    }
+    ALLGATHER_CHECK_USERDEFINED_DT(coll_args->args, tl_team);
+    if (size & (size - 1)) {
+        tl_debug(UCC_TL_TEAM_LIB(tl_team), "team size %u is not power of 2, "
+                 "using bruck allgather", size);
+        return ucc_tl_ucp_allgather_bruck_init(coll_args, team, task_h);
+    }
+
+    task                 = ucc_tl_ucp_init_task(coll_args, team);
+    task->super.flags   |= UCC_COLL_TASK_FLAG_EXECUTOR;
+    task->super.post     = ucc_tl_ucp_allgather_rd_start;
+    task->super.progress = ucc_tl_ucp_allgather_rd_progress;
+    *task_h              = &task->super;
+    return UCC_OK;
+}
@@ -12,6 +12,28 @@
 #include "utils/ucc_math.h"
 #include "utils/ucc_coll_utils.h"
 #include "components/mc/ucc_mc.h"
+#include "tl_ucp_generic_dt.h"
+
+/* Segmented ring: every block is split into n_frags fragments and
+   fragment i of all the blocks is moved around the ring by a separate task.
+   The tasks are started together from a schedule, so up to n_frags sends
+   and receives are in flight on each step while every task still posts
+   exactly one send and one receive per step. Single task (n_frags == 1) is
+   the plain ring, it is also used by the service allgather on a subset. */
+static inline void ucc_tl_ucp_allgather_ring_frag(ucc_tl_ucp_task_t *task,
+                                                  size_t block_count,
+                                                  size_t dt_size,
+                                                  size_t *frag_offset,
+                                                  size_t *frag_size)
+{
+    int n_frags = task->allgather_ring.n_frags;
+    int frag    = task->allgather_ring.frag;
+
+    *frag_offset = ucc_buffer_block_offset(block_count, n_frags, frag) *
+                   dt_size;
+    *frag_size   = ucc_buffer_block_count(block_count, n_frags, frag) *
+                   dt_size;
+}
 
 void ucc_tl_ucp_allgather_ring_progress(ucc_coll_task_t *coll_task)
 {
@@ -23,9 +45,11 @@ void ucc_tl_ucp_allgather_ring_progress(ucc_coll_task_t *coll_task)
     ucc_memory_type_t  rmem       = TASK_ARGS(task).dst.info.mem_type;
     size_t             count      = TASK_ARGS(task).dst.info.count;
     ucc_datatype_t     dt         = TASK_ARGS(task).dst.info.datatype;
-    size_t             data_size  = (count / group_size) * ucc_dt_size(dt);
+    size_t             dt_size    = ucc_dt_size(dt);
+    size_t             data_size  = (count / group_size) * dt_size;
     ucc_rank_t         sendto     = (group_rank + 1) % group_size;
     ucc_rank_t         recvfrom   = (group_rank - 1 + group_size) % group_size;
+    size_t             frag_offset, frag_size;
     int                step;
     void              *buf;
 
@@ -34,20 +58,20 @@ void ucc_tl_ucp_allgather_ring_progress(ucc_coll_task_t *coll_task)
     }
     sendto   = ucc_ep_map_eval(task->subset.map, sendto);
     recvfrom = ucc_ep_map_eval(task->subset.map, recvfrom);
+    ucc_tl_ucp_allgather_ring_frag(task, count / group_size, dt_size,
+                                   &frag_offset, &frag_size);
 
     while (task->tagged.send_posted < group_size - 1) {
         step = task->tagged.send_posted;
-        buf  = (void *)((ptrdiff_t)rbuf +
-                       ((group_rank - step + group_size) % group_size) *
-                           data_size);
+        buf  = PTR_OFFSET(rbuf, ((group_rank - step + group_size) %
+                                 group_size) * data_size + frag_offset);
         UCPCHECK_GOTO(
-            ucc_tl_ucp_send_nb(buf, data_size, rmem, sendto, team, task),
+            ucc_tl_ucp_send_nb(buf, frag_size, rmem, sendto, team, task),
             task, out);
-        buf = (void *)((ptrdiff_t)rbuf +
-                       ((group_rank - step - 1 + group_size) % group_size) *
-                           data_size);
+        buf = PTR_OFFSET(rbuf, ((group_rank - step - 1 + group_size) %
+                                group_size) * data_size + frag_offset);
         UCPCHECK_GOTO(
-            ucc_tl_ucp_recv_nb(buf, data_size, rmem, recvfrom, team, task),
+            ucc_tl_ucp_recv_nb(buf, frag_size, rmem, recvfrom, team, task),
             task, out);
         if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
             return;
@@ -69,17 +93,21 @@ ucc_status_t ucc_tl_ucp_allgather_ring_start(ucc_coll_task_t *coll_task)
     ucc_memory_type_t  smem      = TASK_ARGS(task).src.info.mem_type;
     ucc_memory_type_t  rmem      = TASK_ARGS(task).dst.info.mem_type;
     ucc_datatype_t     dt        = TASK_ARGS(task).dst.info.datatype;
-    size_t             data_size = (count / task->subset.map.ep_num) *
-        ucc_dt_size(dt);
+    size_t             dt_size   = ucc_dt_size(dt);
+    size_t             data_size = (count / task->subset.map.ep_num) * dt_size;
+    size_t             frag_offset, frag_size;
     ucc_status_t       status;
 
     UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allgather_ring_start", 0);
     ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
 
     if (!UCC_IS_INPLACE(TASK_ARGS(task))) {
-        status =
-            ucc_mc_memcpy(PTR_OFFSET(rbuf, data_size * task->subset.myrank),
-                          sbuf, data_size, rmem, smem);
+        ucc_tl_ucp_allgather_ring_frag(task, count / task->subset.map.ep_num,
+                                       dt_size, &frag_offset, &frag_size);
+        status = ucc_mc_memcpy(PTR_OFFSET(rbuf, data_size *
+                                          task->subset.myrank + frag_offset),
+                               PTR_OFFSET(sbuf, frag_offset), frag_size,
+                               rmem, smem);
         if (ucc_unlikely(UCC_OK != status)) {
             return status;
         }
@@ -87,3 +115,90 @@ ucc_status_t ucc_tl_ucp_allgather_ring_start(ucc_coll_task_t *coll_task)
 
     return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
 }
+
+static ucc_status_t
+ucc_tl_ucp_allgather_ring_sched_start(ucc_coll_task_t *coll_task)
+{
+    return ucc_schedule_start(coll_task);
+}
+
+static ucc_status_t
+ucc_tl_ucp_allgather_ring_sched_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_schedule_t *schedule = ucc_derived_of(coll_task, ucc_schedule_t);
+    ucc_status_t    status;
+
+    status = ucc_schedule_finalize(coll_task);
+    ucc_tl_ucp_put_schedule(schedule);
+    return status;
+}
+
+ucc_status_t ucc_tl_ucp_allgather_ring_init(ucc_base_coll_args_t *coll_args,
+                                            ucc_base_team_t      *team,
+                                            ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team     = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_lib_config_t *cfg   = &UCC_TL_UCP_TEAM_LIB(tl_team)->cfg;
+    size_t             block_count = coll_args->args.dst.info.count /
+                                     UCC_TL_TEAM_SIZE(tl_team);
+    size_t             block_size  = block_count *
+                        ucc_dt_size(coll_args->args.dst.info.datatype);
+    ucc_schedule_t    *schedule;
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+    int                n_frags, i;
+
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_allgather_ring_init,
+                                          task_h);
+    }
+    ALLGATHER_CHECK_USERDEFINED_DT(coll_args->args, tl_team);
+
+    n_frags = 1;
+    if (cfg->allgather_ring_frag_size > 0 &&
+        block_size > cfg->allgather_ring_frag_size) {
+        n_frags = ucc_min(ucc_div_round_up(block_size,
+                                           cfg->allgather_ring_frag_size),
+                          cfg->allgather_ring_max_frags);
+        n_frags = ucc_min(ucc_max(n_frags, 1), block_count);
+    }
+
+    if (n_frags == 1) {
+        task = ucc_tl_ucp_init_task(coll_args, team);
+        ucc_tl_ucp_allgather_init(task);
+        *task_h = &task->super;
+        return UCC_OK;
+    }
+
+    status = ucc_tl_ucp_get_schedule(tl_team, coll_args,
+                                     (ucc_tl_ucp_schedule_t **)&schedule);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    for (i = 0; i < n_frags; i++) {
+        task = ucc_tl_ucp_init_task(coll_args, team);
+        task->allgather_ring.n_frags = n_frags;
+        task->allgather_ring.frag    = i;
+        task->super.post             = ucc_tl_ucp_allgather_ring_start;
+        task->super.progress         = ucc_tl_ucp_allgather_ring_progress;
+        task->super.n_deps           = 1;
+        status = ucc_schedule_add_task(schedule, &task->super);
+        if (ucc_unlikely(UCC_OK != status)) {
+            task->super.finalize(&task->super);
+            goto err;
+        }
+        UCC_CHECK_GOTO(ucc_event_manager_subscribe(&schedule->super.em,
+                                                   UCC_EVENT_SCHEDULE_STARTED,
+                                                   &task->super,
+                                                   ucc_task_start_handler),
+                       err, status);
+    }
+    schedule->super.post     = ucc_tl_ucp_allgather_ring_sched_start;
+    schedule->super.finalize = ucc_tl_ucp_allgather_ring_sched_finalize;
+    *task_h                  = &schedule->super;
+    return UCC_OK;
+err:
+    ucc_tl_ucp_allgather_ring_sched_finalize(&schedule->super);
+    return status;
+}
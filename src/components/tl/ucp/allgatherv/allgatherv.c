@@ -18,19 +18,21 @@ ucc_base_coll_alg_info_t
         [UCC_TL_UCP_ALLGATHERV_ALG_RING] =
             {.id   = UCC_TL_UCP_ALLGATHERV_ALG_RING,
              .name = "ring",
-             .desc = "O(N) Ring"},
+             .desc = "O(N) Ring, blocks are split into concurrent fragments"},
+        [UCC_TL_UCP_ALLGATHERV_ALG_KNOMIAL] =
+            {.id   = UCC_TL_UCP_ALLGATHERV_ALG_KNOMIAL,
+             .name = "knomial",
+             .desc = "recursive knomial with arbitrary radix, log(N) steps"},
         [UCC_TL_UCP_ALLGATHERV_ALG_LAST] = {
             .id = 0, .name = NULL, .desc = NULL}};
 
 ucc_status_t ucc_tl_ucp_allgatherv_init(ucc_tl_ucp_task_t *task)
 {
-    if ((!UCC_DT_IS_PREDEFINED((TASK_ARGS(task)).dst.info_v.datatype)) ||
-        (!UCC_IS_INPLACE(TASK_ARGS(task)) &&
-         (!UCC_DT_IS_PREDEFINED((TASK_ARGS(task)).src.info.datatype)))) {
-        tl_error(UCC_TASK_LIB(task), "user defined datatype is not supported");
-        return UCC_ERR_NOT_SUPPORTED;
-    }
-    task->super.post     = ucc_tl_ucp_allgatherv_ring_start;
-    task->super.progress = ucc_tl_ucp_allgatherv_ring_progress;
+    ALLGATHERV_CHECK_USERDEFINED_DT(TASK_ARGS(task), TASK_TEAM(task));
+
+    task->allgatherv_ring.n_frags = 1;
+    task->allgatherv_ring.frag    = 0;
+    task->super.post              = ucc_tl_ucp_allgatherv_ring_start;
+    task->super.progress          = ucc_tl_ucp_allgatherv_ring_progress;
     return UCC_OK;
 }
@@ -12,12 +12,51 @@
 
 enum {
     UCC_TL_UCP_ALLGATHERV_ALG_RING,
+    UCC_TL_UCP_ALLGATHERV_ALG_KNOMIAL,
     UCC_TL_UCP_ALLGATHERV_ALG_LAST
 };
 
 extern ucc_base_coll_alg_info_t
              ucc_tl_ucp_allgatherv_algs[UCC_TL_UCP_ALLGATHERV_ALG_LAST + 1];
 
+/* msg range is the total dst size, ring switches to knomial for skewed
+   counts, see ALLGATHERV_RING_MAX_SKEW */
+#define UCC_TL_UCP_ALLGATHERV_DEFAULT_ALG_SELECT_STR                           \
+    "allgatherv:0-16k:@1#allgatherv:16k-inf:@0"
+
 ucc_status_t ucc_tl_ucp_allgatherv_init(ucc_tl_ucp_task_t *task);
 
+/* Falls back to knomial if the counts are skewed */
+ucc_status_t ucc_tl_ucp_allgatherv_ring_init(ucc_base_coll_args_t *coll_args,
+                                             ucc_base_team_t      *team,
+                                             ucc_coll_task_t     **task_h);
+
+/* Uses allgatherv_kn_radix from config */
+ucc_status_t
+ucc_tl_ucp_allgatherv_knomial_init(ucc_base_coll_args_t *coll_args,
+                                   ucc_base_team_t      *team,
+                                   ucc_coll_task_t     **task_h);
+
+#define ALLGATHERV_CHECK_USERDEFINED_DT(_args, _team)                          \
+    do {                                                                       \
+        if ((!UCC_DT_IS_PREDEFINED((_args).dst.info_v.datatype)) ||            \
+            (!UCC_IS_INPLACE(_args) &&                                         \
+             (!UCC_DT_IS_PREDEFINED((_args).src.info.datatype)))) {            \
+            tl_error(UCC_TL_TEAM_LIB(_team),                                   \
+                     "user defined datatype is not supported");                \
+            return UCC_ERR_NOT_SUPPORTED;                                      \
+        }                                                                      \
+    } while (0)
+
+static inline int ucc_tl_ucp_allgatherv_alg_from_str(const char *str)
+{
+    int i;
+    for (i = 0; i < UCC_TL_UCP_ALLGATHERV_ALG_LAST; i++) {
+        if (0 == strcasecmp(str, ucc_tl_ucp_allgatherv_algs[i].name)) {
+            break;
+        }
+    }
+    return i;
+}
+
 #endif
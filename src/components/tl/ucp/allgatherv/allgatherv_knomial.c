@@ -0,0 +1,286 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "allgatherv.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+
+/* Recursive knomial allgatherv, radix 2 is recursive doubling.
+   1. "Extra" ranks send their block to the proxy and receive the result
+      from it in the end.
+   2. On iteration i a loop rank owns the blocks of its group of radix^i
+      consecutive loop ranks (with their extra ranks) and exchanges them
+      with radix - 1 peers of the iteration.
+   3. Loop ranks of a group and their extra ranks form a contiguous range of
+      team ranks. If the blocks are stored in rank order without gaps the
+      range is sent as one message, otherwise every non empty block of the
+      range is sent separately. Empty blocks are never sent, so the latency
+      with skewed counts is defined by the number of steps only. */
+
+#define SAVE_STATE(_phase)                                                     \
+    do {                                                                       \
+        task->allgatherv_kn.phase = _phase;                                    \
+    } while (0)
+
+/* first and last team ranks of the loop rank */
+static inline ucc_rank_t
+ucc_tl_ucp_allgatherv_kn_first(ucc_knomial_pattern_t *p, ucc_rank_t loop_rank)
+{
+    return (loop_rank < p->n_extra) ? loop_rank * 2 : loop_rank + p->n_extra;
+}
+
+static inline ucc_rank_t
+ucc_tl_ucp_allgatherv_kn_last(ucc_knomial_pattern_t *p, ucc_rank_t loop_rank)
+{
+    return (loop_rank < p->n_extra) ? loop_rank * 2 + 1
+                                    : loop_rank + p->n_extra;
+}
+
+static inline ucc_status_t
+ucc_tl_ucp_allgatherv_kn_post_block(ucc_tl_ucp_task_t *task, size_t displ,
+                                    size_t count, ucc_rank_t peer, int send)
+{
+    ucc_coll_args_t   *args     = &TASK_ARGS(task);
+    ucc_memory_type_t  mem_type = args->dst.info_v.mem_type;
+    size_t             dt_size  = ucc_dt_size(args->dst.info_v.datatype);
+    void              *buf      = PTR_OFFSET(args->dst.info_v.buffer,
+                                             displ * dt_size);
+
+    if (count == 0) {
+        return UCC_OK;
+    }
+    return send ? ucc_tl_ucp_send_nb(buf, count * dt_size, mem_type, peer,
+                                     TASK_TEAM(task), task)
+                : ucc_tl_ucp_recv_nb(buf, count * dt_size, mem_type, peer,
+                                     TASK_TEAM(task), task);
+}
+
+/* Posts send (or receive) of the blocks of team ranks [start, end) */
+static ucc_status_t ucc_tl_ucp_allgatherv_kn_post(ucc_tl_ucp_task_t *task,
+                                                  ucc_rank_t start,
+                                                  ucc_rank_t end,
+                                                  ucc_rank_t peer, int send)
+{
+    ucc_coll_args_t *args = &TASK_ARGS(task);
+    size_t           displ, count;
+    ucc_status_t     status;
+    ucc_rank_t       r;
+
+    if (start == end) {
+        return UCC_OK;
+    }
+    if (task->allgatherv_kn.contig) {
+        displ = ucc_coll_args_get_displacement(
+            args, args->dst.info_v.displacements, start);
+        count = ucc_coll_args_get_displacement(
+                    args, args->dst.info_v.displacements, end - 1) +
+                ucc_coll_args_get_count(args, args->dst.info_v.counts,
+                                        end - 1) - displ;
+        return ucc_tl_ucp_allgatherv_kn_post_block(task, displ, count, peer,
+                                                   send);
+    }
+    for (r = start; r < end; r++) {
+        displ  = ucc_coll_args_get_displacement(
+            args, args->dst.info_v.displacements, r);
+        count  = ucc_coll_args_get_count(args, args->dst.info_v.counts, r);
+        status = ucc_tl_ucp_allgatherv_kn_post_block(task, displ, count, peer,
+                                                     send);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+    return UCC_OK;
+}
+
+void ucc_tl_ucp_allgatherv_knomial_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t     *task  = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t     *team  = TASK_TEAM(task);
+    ucc_knomial_pattern_t *p     = &task->allgatherv_kn.p;
+    ucc_rank_t             rank  = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t             size  = UCC_TL_TEAM_SIZE(team);
+    ucc_rank_t             peer, group, peer_group;
+    ucc_kn_radix_t         loop_step;
+    ucc_status_t           status;
+
+    if (task->allgatherv_kn.etask != NULL) {
+        status = ucc_ee_executor_task_test(task->allgatherv_kn.etask);
+        if (status == UCC_INPROGRESS) {
+            return;
+        }
+        ucc_ee_executor_task_finalize(task->allgatherv_kn.etask);
+        task->allgatherv_kn.etask = NULL;
+        if (ucc_unlikely(status < 0)) {
+            task->super.status = status;
+            return;
+        }
+    }
+
+    UCC_KN_GOTO_PHASE(task->allgatherv_kn.phase);
+    if (KN_NODE_EXTRA == p->node_type) {
+        peer = ucc_knomial_pattern_get_proxy(p, rank);
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_allgatherv_kn_post(task, rank, rank + 1, peer, 1),
+            task, out);
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_allgatherv_kn_post(task, 0, rank, peer, 0),
+            task, out);
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_allgatherv_kn_post(task, rank + 1, size, peer, 0),
+            task, out);
+    } else if (KN_NODE_PROXY == p->node_type) {
+        peer = ucc_knomial_pattern_get_extra(p, rank);
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_allgatherv_kn_post(task, peer, peer + 1, peer, 0),
+            task, out);
+    }
+UCC_KN_PHASE_EXTRA:
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        SAVE_STATE(UCC_KN_PHASE_EXTRA);
+        return;
+    }
+    if (KN_NODE_EXTRA == p->node_type) {
+        goto completed;
+    }
+    while (!ucc_knomial_pattern_loop_done(p)) {
+        group = ucc_knomial_pattern_loop_rank(p, rank);
+        group = group - group % p->radix_pow;
+        for (loop_step = 1; loop_step < p->radix; loop_step++) {
+            peer = ucc_knomial_pattern_get_loop_peer(p, rank, size, loop_step);
+            if (peer == UCC_KN_PEER_NULL) {
+                continue;
+            }
+            peer_group = ucc_knomial_pattern_loop_rank(p, peer);
+            peer_group = peer_group - peer_group % p->radix_pow;
+            UCPCHECK_GOTO(ucc_tl_ucp_allgatherv_kn_post(
+                              task, ucc_tl_ucp_allgatherv_kn_first(p, group),
+                              ucc_tl_ucp_allgatherv_kn_last(
+                                  p, group + p->radix_pow - 1) + 1,
+                              peer, 1),
+                          task, out);
+            UCPCHECK_GOTO(ucc_tl_ucp_allgatherv_kn_post(
+                              task,
+                              ucc_tl_ucp_allgatherv_kn_first(p, peer_group),
+                              ucc_tl_ucp_allgatherv_kn_last(
+                                  p, peer_group + p->radix_pow - 1) + 1,
+                              peer, 0),
+                          task, out);
+        }
+    UCC_KN_PHASE_LOOP:
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            SAVE_STATE(UCC_KN_PHASE_LOOP);
+            return;
+        }
+        ucc_knomial_pattern_next_iteration(p);
+    }
+
+    if (KN_NODE_PROXY == p->node_type) {
+        peer = ucc_knomial_pattern_get_extra(p, rank);
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_allgatherv_kn_post(task, 0, peer, peer, 1),
+            task, out);
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_allgatherv_kn_post(task, peer + 1, size, peer, 1),
+            task, out);
+    }
+UCC_KN_PHASE_PROXY:
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        SAVE_STATE(UCC_KN_PHASE_PROXY);
+        return;
+    }
+completed:
+    ucc_assert(UCC_TL_UCP_TASK_P2P_COMPLETE(task));
+    task->super.status = UCC_OK;
+out:
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allgatherv_kn_done", 0);
+}
+
+ucc_status_t ucc_tl_ucp_allgatherv_knomial_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task  = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args  = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team  = TASK_TEAM(task);
+    ucc_rank_t         rank  = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t         size  = UCC_TL_TEAM_SIZE(team);
+    size_t             dt_size;
+    ucc_ee_executor_task_args_t eargs;
+    ucc_ee_executor_t          *exec;
+    ucc_status_t                status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allgatherv_kn_start", 0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    ucc_knomial_pattern_init(size, rank, task->allgatherv_kn.p.radix,
+                             &task->allgatherv_kn.p);
+    task->allgatherv_kn.phase = UCC_KN_PHASE_INIT;
+    task->allgatherv_kn.etask = NULL;
+
+    if (!UCC_IS_INPLACE(*args)) {
+        status = ucc_coll_task_get_executor(&task->super, &exec);
+        if (ucc_unlikely(status != UCC_OK)) {
+            task->super.status = status;
+            return status;
+        }
+        dt_size         = ucc_dt_size(args->dst.info_v.datatype);
+        eargs.task_type = UCC_EE_EXECUTOR_TASK_COPY;
+        eargs.copy.src  = args->src.info.buffer;
+        eargs.copy.dst  = PTR_OFFSET(args->dst.info_v.buffer,
+                                     ucc_coll_args_get_displacement(
+                                         args, args->dst.info_v.displacements,
+                                         rank) * dt_size);
+        eargs.copy.len  = ucc_coll_args_get_count(
+                              args, args->dst.info_v.counts, rank) * dt_size;
+        status = ucc_ee_executor_task_post(exec, &eargs,
+                                           &task->allgatherv_kn.etask);
+        if (ucc_unlikely(status != UCC_OK)) {
+            task->super.status = status;
+            return status;
+        }
+    }
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
+ucc_status_t
+ucc_tl_ucp_allgatherv_knomial_init(ucc_base_coll_args_t *coll_args,
+                                   ucc_base_team_t      *team,
+                                   ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_coll_args_t   *args    = &coll_args->args;
+    ucc_rank_t         rank    = UCC_TL_TEAM_RANK(tl_team);
+    ucc_rank_t         size    = UCC_TL_TEAM_SIZE(tl_team);
+    ucc_tl_ucp_task_t *task;
+    ucc_kn_radix_t     radix;
+    ucc_rank_t         i;
+    int                contig;
+
+    ALLGATHERV_CHECK_USERDEFINED_DT(*args, tl_team);
+    radix = ucc_max(2, ucc_min(UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.
+                               allgatherv_kn_radix, size));
+    contig = 1;
+    for (i = 0; i + 1 < size; i++) {
+        if (ucc_coll_args_get_displacement(args, args->dst.info_v.displacements,
+                                           i) +
+            ucc_coll_args_get_count(args, args->dst.info_v.counts, i) !=
+            ucc_coll_args_get_displacement(args, args->dst.info_v.displacements,
+                                           i + 1)) {
+            contig = 0;
+            break;
+        }
+    }
+
+    task                       = ucc_tl_ucp_init_task(coll_args, team);
+    task->allgatherv_kn.contig = contig;
+    task->super.flags         |= UCC_COLL_TASK_FLAG_EXECUTOR;
+    task->super.post           = ucc_tl_ucp_allgatherv_knomial_start;
+    task->super.progress       = ucc_tl_ucp_allgatherv_knomial_progress;
+    ucc_knomial_pattern_init(size, rank, radix, &task->allgatherv_kn.p);
+    *task_h                    = &task->super;
+    return UCC_OK;
+}
@@ -12,6 +12,29 @@
 #include "utils/ucc_coll_utils.h"
 #include "tl_ucp_sendrecv.h"
 
+/* Segmented ring: every block is split into n_frags fragments according to
+   its own count and fragment i of all the blocks is moved around the ring by
+   a separate task. The tasks are started together from a schedule, so a
+   large block is forwarded in n_frags concurrent chunks. */
+static inline void ucc_tl_ucp_allgatherv_ring_frag(ucc_tl_ucp_task_t *task,
+                                                   ucc_rank_t block,
+                                                   size_t dt_size,
+                                                   size_t *frag_displ,
+                                                   size_t *frag_size)
+{
+    ucc_coll_args_t *args    = &TASK_ARGS(task);
+    int              n_frags = task->allgatherv_ring.n_frags;
+    int              frag    = task->allgatherv_ring.frag;
+    size_t           count   = ucc_coll_args_get_count(
+        args, args->dst.info_v.counts, block);
+
+    *frag_displ = (ucc_coll_args_get_displacement(
+                       args, args->dst.info_v.displacements, block) +
+                   ucc_buffer_block_offset(count, n_frags, frag)) *
+                  dt_size;
+    *frag_size  = ucc_buffer_block_count(count, n_frags, frag) * dt_size;
+}
+
 void ucc_tl_ucp_allgatherv_ring_progress(ucc_coll_task_t *coll_task)
 {
     ucc_tl_ucp_task_t *task     = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
@@ -32,22 +55,14 @@ void ucc_tl_ucp_allgatherv_ring_progress(ucc_coll_task_t *coll_task)
     }
     while (task->tagged.send_posted < gsize) {
         send_idx   = (grank - task->tagged.send_posted + 1 + gsize) % gsize;
-        data_displ = ucc_coll_args_get_displacement(
-                         args, args->dst.info_v.displacements, send_idx) *
-                     rdt_size;
-        data_size =
-            ucc_coll_args_get_count(args, args->dst.info_v.counts, send_idx) *
-            rdt_size;
+        ucc_tl_ucp_allgatherv_ring_frag(task, send_idx, rdt_size, &data_displ,
+                                        &data_size);
         UCPCHECK_GOTO(ucc_tl_ucp_send_nb((void *)(rbuf + data_displ), data_size,
                                          rmem, sendto, team, task),
                       task, out);
         recv_idx   = (grank - task->tagged.recv_posted + gsize) % gsize;
-        data_displ = ucc_coll_args_get_displacement(
-                         args, args->dst.info_v.displacements, recv_idx) *
-                     rdt_size;
-        data_size =
-            ucc_coll_args_get_count(args, args->dst.info_v.counts, recv_idx) *
-            rdt_size;
+        ucc_tl_ucp_allgatherv_ring_frag(task, recv_idx, rdt_size, &data_displ,
+                                        &data_size);
         UCPCHECK_GOTO(ucc_tl_ucp_recv_nb((void *)(rbuf + data_displ), data_size,
                                          rmem, recvfrom, team, task),
                       task, out);
@@ -70,26 +85,25 @@ ucc_status_t ucc_tl_ucp_allgatherv_ring_start(ucc_coll_task_t *coll_task)
     ucc_memory_type_t  smem  = TASK_ARGS(task).src.info.mem_type;
     ucc_memory_type_t  rmem  = TASK_ARGS(task).dst.info_v.mem_type;
     ucc_rank_t         grank = UCC_TL_TEAM_RANK(team);
-    size_t             data_size, data_displ, rdt_size;
+    size_t             data_size, data_displ, rdt_size, src_offset;
 
     ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
 
     if (!UCC_IS_INPLACE(TASK_ARGS(task))) {
         /* TODO replace local sendrecv with memcpy? */
         rdt_size   = ucc_dt_size(TASK_ARGS(task).dst.info_v.datatype);
-        data_displ = ucc_coll_args_get_displacement(
-                        &TASK_ARGS(task),
+        ucc_tl_ucp_allgatherv_ring_frag(task, grank, rdt_size, &data_displ,
+                                        &data_size);
+        src_offset = data_displ -
+                     ucc_coll_args_get_displacement(
+                         &TASK_ARGS(task),
                          TASK_ARGS(task).dst.info_v.displacements, grank) *
-                     rdt_size;
-        data_size =
-            ucc_coll_args_get_count(&TASK_ARGS(task),
-                                    TASK_ARGS(task).dst.info_v.counts, grank) *
-            rdt_size;
+                         rdt_size;
         UCPCHECK_GOTO(ucc_tl_ucp_recv_nb((void *)rbuf + data_displ, data_size,
                                          rmem, grank, team, task),
                       task, error);
-        UCPCHECK_GOTO(ucc_tl_ucp_send_nb((void *)sbuf, data_size, smem, grank,
-                                         team, task),
+        UCPCHECK_GOTO(ucc_tl_ucp_send_nb((void *)sbuf + src_offset, data_size,
+                                         smem, grank, team, task),
                       task, error);
     } else {
         /* to simplify progress fucnction and make it identical for
@@ -102,3 +116,97 @@ ucc_status_t ucc_tl_ucp_allgatherv_ring_start(ucc_coll_task_t *coll_task)
 error:
     return task->super.status;
 }
+
+static ucc_status_t
+ucc_tl_ucp_allgatherv_ring_sched_start(ucc_coll_task_t *coll_task)
+{
+    return ucc_schedule_start(coll_task);
+}
+
+static ucc_status_t
+ucc_tl_ucp_allgatherv_ring_sched_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_schedule_t *schedule = ucc_derived_of(coll_task, ucc_schedule_t);
+    ucc_status_t    status;
+
+    status = ucc_schedule_finalize(coll_task);
+    ucc_tl_ucp_put_schedule(schedule);
+    return status;
+}
+
+ucc_status_t ucc_tl_ucp_allgatherv_ring_init(ucc_base_coll_args_t *coll_args,
+                                             ucc_base_team_t      *team,
+                                             ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t       *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_lib_config_t *cfg     = &UCC_TL_UCP_TEAM_LIB(tl_team)->cfg;
+    ucc_coll_args_t         *args    = &coll_args->args;
+    ucc_rank_t               size    = UCC_TL_TEAM_SIZE(tl_team);
+    size_t                   dt_size = ucc_dt_size(args->dst.info_v.datatype);
+    size_t                   max_count, total_count, max_block_size;
+    ucc_schedule_t          *schedule;
+    ucc_tl_ucp_task_t       *task;
+    ucc_status_t             status;
+    int                      n_frags, i;
+
+    ALLGATHERV_CHECK_USERDEFINED_DT(*args, tl_team);
+    max_count   = ucc_coll_args_get_max_count(args, args->dst.info_v.counts,
+                                              size);
+    total_count = ucc_coll_args_get_total_count(args,
+                                                args->dst.info_v.counts, size);
+    if (cfg->allgatherv_ring_max_skew > 0 &&
+        max_count * size > total_count * cfg->allgatherv_ring_max_skew) {
+        tl_debug(UCC_TL_TEAM_LIB(tl_team), "allgatherv counts are skewed: "
+                 "max count %zd total count %zd, using knomial", max_count,
+                 total_count);
+        return ucc_tl_ucp_allgatherv_knomial_init(coll_args, team, task_h);
+    }
+
+    n_frags        = 1;
+    max_block_size = max_count * dt_size;
+    if (cfg->allgatherv_ring_frag_size > 0 &&
+        max_block_size > cfg->allgatherv_ring_frag_size) {
+        n_frags = ucc_min(ucc_div_round_up(max_block_size,
+                                           cfg->allgatherv_ring_frag_size),
+                          cfg->allgatherv_ring_max_frags);
+        n_frags = ucc_max(n_frags, 1);
+    }
+
+    if (n_frags == 1) {
+        task = ucc_tl_ucp_init_task(coll_args, team);
+        ucc_tl_ucp_allgatherv_init(task);
+        *task_h = &task->super;
+        return UCC_OK;
+    }
+
+    status = ucc_tl_ucp_get_schedule(tl_team, coll_args,
+                                     (ucc_tl_ucp_schedule_t **)&schedule);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    for (i = 0; i < n_frags; i++) {
+        task = ucc_tl_ucp_init_task(coll_args, team);
+        task->allgatherv_ring.n_frags = n_frags;
+        task->allgatherv_ring.frag    = i;
+        task->super.post              = ucc_tl_ucp_allgatherv_ring_start;
+        task->super.progress          = ucc_tl_ucp_allgatherv_ring_progress;
+        task->super.n_deps            = 1;
+        status = ucc_schedule_add_task(schedule, &task->super);
+        if (ucc_unlikely(UCC_OK != status)) {
+            task->super.finalize(&task->super);
+            goto err;
+        }
+        UCC_CHECK_GOTO(ucc_event_manager_subscribe(&schedule->super.em,
+                                                   UCC_EVENT_SCHEDULE_STARTED,
+                                                   &task->super,
+                                                   ucc_task_start_handler),
+                       err, status);
+    }
+    schedule->super.post     = ucc_tl_ucp_allgatherv_ring_sched_start;
+    schedule->super.finalize = ucc_tl_ucp_allgatherv_ring_sched_finalize;
+    *task_h                  = &schedule->super;
+    return UCC_OK;
+err:
+    ucc_tl_ucp_allgatherv_ring_sched_finalize(&schedule->super);
+    return status;
+}
@@ -20,6 +20,17 @@ ucc_base_coll_alg_info_t
              .name = "sra_knomial",
              .desc = "recursive knomial scatter-reduce followed by knomial "
                      "allgather (optimized for BW)"},
+        [UCC_TL_UCP_ALLREDUCE_ALG_RD] =
+            {.id   = UCC_TL_UCP_ALLREDUCE_ALG_RD,
+             .name = "rd",
+             .desc = "recursive doubling with preallocated scratch (optimized "
+                     "for latency of small host messages)"},
+        [UCC_TL_UCP_ALLREDUCE_ALG_DBT] =
+            {.id   = UCC_TL_UCP_ALLREDUCE_ALG_DBT,
+             .name = "dbt",
+             .desc = "pipelined double binary tree, every tree reduces and "
+                     "broadcasts half of the vector (optimized for medium "
+                     "messages)"},
         [UCC_TL_UCP_ALLREDUCE_ALG_LAST] = {
             .id = 0, .name = NULL, .desc = NULL}};
 
@@ -11,6 +11,8 @@
 enum {
     UCC_TL_UCP_ALLREDUCE_ALG_KNOMIAL,
     UCC_TL_UCP_ALLREDUCE_ALG_SRA_KNOMIAL,
+    UCC_TL_UCP_ALLREDUCE_ALG_RD,
+    UCC_TL_UCP_ALLREDUCE_ALG_DBT,
     UCC_TL_UCP_ALLREDUCE_ALG_LAST
 };
 
@@ -19,7 +21,8 @@ extern ucc_base_coll_alg_info_t
 ucc_status_t ucc_tl_ucp_allreduce_init(ucc_tl_ucp_task_t *task);
 
 #define UCC_TL_UCP_ALLREDUCE_DEFAULT_ALG_SELECT_STR                            \
-    "allreduce:0-4k:@0#allreduce:4k-inf:@1"
+    "allreduce:0-256:@2#allreduce:256-4k:@0#allreduce:4k-32k:@1"               \
+    "#allreduce:32k-4M:@3#allreduce:4M-inf:@1"
 
 #define CHECK_SAME_MEMTYPE(_args, _team)                                       \
     do {                                                                       \
@@ -55,6 +58,14 @@ ucc_status_t ucc_tl_ucp_allreduce_sra_knomial_start(ucc_coll_task_t *task);
 
 ucc_status_t ucc_tl_ucp_allreduce_sra_knomial_progress(ucc_coll_task_t *task);
 
+ucc_status_t ucc_tl_ucp_allreduce_rd_init(ucc_base_coll_args_t *coll_args,
+                                          ucc_base_team_t *     team,
+                                          ucc_coll_task_t **    task_h);
+
+ucc_status_t ucc_tl_ucp_allreduce_dbt_init(ucc_base_coll_args_t *coll_args,
+                                           ucc_base_team_t      *team,
+                                           ucc_coll_task_t     **task_h);
+
 static inline int ucc_tl_ucp_allreduce_alg_from_str(const char *str)
 {
     int i;
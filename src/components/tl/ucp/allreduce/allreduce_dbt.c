@@ -0,0 +1,406 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "allreduce.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "components/mc/ucc_mc.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+#include "utils/ucc_dt_reduce.h"
+
+/* Double binary tree allreduce: the vector is split in 2 halves, each half
+   is reduced to the root of its own binary tree and broadcast back, both
+   pipelined by segments of ALLREDUCE_DBT_SEG_SIZE. The second tree is the
+   first one mirrored (even team size) or shifted by one (odd team size),
+   so that leaves of one tree are interior ranks of the other and the
+   bandwidth of every rank is used by both halves.
+
+   Every tree is progressed by its own task (different tags, the same pair
+   of ranks may be linked in both trees). At step k a rank reduces segment
+   k - 1 received from the children and sends it to the parent, posts the
+   receives of segment k from the children and, being at depth d, receives
+   the result of segment k - 2d from the parent and forwards segment
+   k - 2d - 1 to the children. A child is always 1 step behind the parent
+   on the way up and the parent 1 step ahead of the child on the way down,
+   so waiting for all the operations of a step never deadlocks. */
+
+static void ucc_tl_ucp_allreduce_dbt_btree(ucc_rank_t size, ucc_rank_t rank,
+                                           ucc_rank_t *parent,
+                                           ucc_rank_t *children)
+{
+    ucc_rank_t bit, low, child;
+
+    children[0] = children[1] = UCC_RANK_INVALID;
+    for (bit = 1; bit < size; bit <<= 1) {
+        if (bit & rank) {
+            break;
+        }
+    }
+    if (rank == 0) {
+        *parent = UCC_RANK_INVALID;
+        if (size > 1) {
+            children[0] = bit >> 1;
+        }
+        return;
+    }
+    *parent = (rank ^ bit) | (bit << 1);
+    if (*parent >= size) {
+        *parent = rank ^ bit;
+    }
+    low = bit >> 1;
+    if (low == 0) {
+        return;
+    }
+    children[0] = rank - low;
+    child       = rank + low;
+    while (child >= size) {
+        low >>= 1;
+        if (low == 0) {
+            return;
+        }
+        child = rank + low;
+    }
+    children[1] = child;
+}
+
+#define DBT_MAP(_r, _size, _shift)                                             \
+    (((_r) == UCC_RANK_INVALID)                                                \
+         ? UCC_RANK_INVALID                                                    \
+         : ((_shift) ? ((_r) + 1) % (_size) : (_size) - 1 - (_r)))
+
+static void ucc_tl_ucp_allreduce_dbt_tree(ucc_rank_t size, ucc_rank_t rank,
+                                          int tree, ucc_rank_t *parent,
+                                          ucc_rank_t *children)
+{
+    int        shift = size % 2;
+    ucc_rank_t trank;
+
+    if (tree == 0) {
+        ucc_tl_ucp_allreduce_dbt_btree(size, rank, parent, children);
+        return;
+    }
+    trank = shift ? (rank - 1 + size) % size : size - 1 - rank;
+    ucc_tl_ucp_allreduce_dbt_btree(size, trank, parent, children);
+    *parent     = DBT_MAP(*parent, size, shift);
+    children[0] = DBT_MAP(children[0], size, shift);
+    children[1] = DBT_MAP(children[1], size, shift);
+}
+
+static inline void ucc_tl_ucp_allreduce_dbt_seg(ucc_tl_ucp_task_t *task,
+                                                size_t seg, size_t *offset,
+                                                size_t *count)
+{
+    size_t seg_offset = seg * task->allreduce_dbt.seg_count;
+
+    *offset = task->allreduce_dbt.offset + seg_offset;
+    *count  = ucc_min(task->allreduce_dbt.seg_count,
+                      task->allreduce_dbt.count - seg_offset);
+}
+
+static void ucc_tl_ucp_allreduce_dbt_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task       = ucc_derived_of(coll_task,
+                                                   ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args       = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team       = TASK_TEAM(task);
+    ucc_datatype_t     dt         = args->dst.info.datatype;
+    ucc_memory_type_t  mem_type   = args->dst.info.mem_type;
+    size_t             dt_size    = ucc_dt_size(dt);
+    ucc_rank_t         parent     = task->allreduce_dbt.parent;
+    ucc_rank_t        *children   = task->allreduce_dbt.children;
+    int                n_children = task->allreduce_dbt.n_children;
+    size_t             n_segs     = task->allreduce_dbt.n_segs;
+    size_t             depth      = task->allreduce_dbt.depth;
+    size_t             seg_size   = task->allreduce_dbt.seg_count * dt_size;
+    void              *sbuf       = UCC_IS_INPLACE(*args)
+                                        ? args->dst.info.buffer
+                                        : args->src.info.buffer;
+    void              *rbuf       = args->dst.info.buffer;
+    size_t             k, offset, count;
+    void              *bank, *local;
+    ucc_status_t       status;
+    int                i;
+
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        return;
+    }
+    while (task->allreduce_dbt.step <= n_segs + 2 * depth + 1) {
+        k = task->allreduce_dbt.step;
+        if (k >= 1 && k - 1 < n_segs) {
+            ucc_tl_ucp_allreduce_dbt_seg(task, k - 1, &offset, &count);
+            local = PTR_OFFSET(sbuf, offset * dt_size);
+            if (n_children > 0) {
+                bank   = PTR_OFFSET(task->allreduce_dbt.scratch,
+                                    (k - 1) % 2 * 2 * seg_size);
+                status = ucc_dt_reduce_strided(
+                    local, bank, PTR_OFFSET(rbuf, offset * dt_size),
+                    n_children, count, seg_size, dt, args,
+                    (parent == UCC_RANK_INVALID && args->op == UCC_OP_AVG)
+                        ? UCC_EEE_TASK_FLAG_REDUCE_WITH_ALPHA
+                        : 0,
+                    AVG_ALPHA(task), task->allreduce_dbt.executor,
+                    &task->allreduce_dbt.etask);
+                if (ucc_unlikely(UCC_OK != status)) {
+                    tl_error(UCC_TASK_LIB(task),
+                             "failed to perform dt reduction");
+                    task->super.status = status;
+                    return;
+                }
+                EXEC_TASK_WAIT(task->allreduce_dbt.etask);
+                local = PTR_OFFSET(rbuf, offset * dt_size);
+            } else if (local != PTR_OFFSET(rbuf, offset * dt_size) &&
+                       parent == UCC_RANK_INVALID) {
+                /* single rank team */
+                status = ucc_mc_memcpy(PTR_OFFSET(rbuf, offset * dt_size),
+                                       local, count * dt_size, mem_type,
+                                       args->src.info.mem_type);
+                if (ucc_unlikely(UCC_OK != status)) {
+                    task->super.status = status;
+                    return;
+                }
+            }
+            if (parent != UCC_RANK_INVALID) {
+                UCPCHECK_GOTO(ucc_tl_ucp_send_nz(local, count * dt_size,
+                                                 mem_type, parent, team, task),
+                              task, out);
+            } else {
+                for (i = 0; i < n_children; i++) {
+                    UCPCHECK_GOTO(ucc_tl_ucp_send_nz(
+                                      local, count * dt_size, mem_type,
+                                      children[i], team, task),
+                                  task, out);
+                }
+            }
+        }
+        if (k < n_segs) {
+            ucc_tl_ucp_allreduce_dbt_seg(task, k, &offset, &count);
+            bank = PTR_OFFSET(task->allreduce_dbt.scratch, k % 2 * 2 * seg_size);
+            for (i = 0; i < n_children; i++) {
+                UCPCHECK_GOTO(ucc_tl_ucp_recv_nz(
+                                  PTR_OFFSET(bank, i * seg_size),
+                                  count * dt_size, mem_type, children[i],
+                                  team, task),
+                              task, out);
+            }
+        }
+        if (parent != UCC_RANK_INVALID) {
+            if (k >= 2 * depth && k - 2 * depth < n_segs) {
+                ucc_tl_ucp_allreduce_dbt_seg(task, k - 2 * depth, &offset,
+                                             &count);
+                UCPCHECK_GOTO(ucc_tl_ucp_recv_nz(
+                                  PTR_OFFSET(rbuf, offset * dt_size),
+                                  count * dt_size, mem_type, parent, team,
+                                  task),
+                              task, out);
+            }
+            if (k >= 2 * depth + 1 && k - 2 * depth - 1 < n_segs) {
+                ucc_tl_ucp_allreduce_dbt_seg(task, k - 2 * depth - 1, &offset,
+                                             &count);
+                for (i = 0; i < n_children; i++) {
+                    UCPCHECK_GOTO(ucc_tl_ucp_send_nz(
+                                      PTR_OFFSET(rbuf, offset * dt_size),
+                                      count * dt_size, mem_type, children[i],
+                                      team, task),
+                                  task, out);
+                }
+            }
+        }
+        task->allreduce_dbt.step++;
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            return;
+        }
+    }
+    ucc_assert(UCC_TL_UCP_TASK_P2P_COMPLETE(task));
+    task->super.status = UCC_OK;
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allreduce_dbt_done", 0);
+out:
+    return;
+}
+
+static ucc_status_t ucc_tl_ucp_allreduce_dbt_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    ucc_status_t       status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allreduce_dbt_start", 0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    task->allreduce_dbt.step  = 0;
+    task->allreduce_dbt.etask = NULL;
+    status = ucc_coll_task_get_executor(&task->super,
+                                        &task->allreduce_dbt.executor);
+    if (ucc_unlikely(status != UCC_OK)) {
+        return status;
+    }
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
+static ucc_status_t
+ucc_tl_ucp_allreduce_dbt_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+
+    if (task->allreduce_dbt.scratch_mc_header) {
+        ucc_mc_free(task->allreduce_dbt.scratch_mc_header);
+    }
+    return ucc_tl_ucp_coll_finalize(coll_task);
+}
+
+static ucc_status_t
+ucc_tl_ucp_allreduce_dbt_task_init(ucc_base_coll_args_t *coll_args,
+                                   ucc_base_team_t *team, int tree,
+                                   int n_trees, ucc_tl_ucp_task_t **task_p)
+{
+    ucc_tl_ucp_team_t *tl_team   = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_coll_args_t   *args      = &coll_args->args;
+    ucc_rank_t         size      = UCC_TL_TEAM_SIZE(tl_team);
+    ucc_rank_t         rank      = UCC_TL_TEAM_RANK(tl_team);
+    size_t             count     = args->dst.info.count;
+    size_t             dt_size   = ucc_dt_size(args->dst.info.datatype);
+    size_t             seg_count = ucc_max(
+        UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.allreduce_dbt_seg_size / dt_size, 1);
+    ucc_rank_t         children[2], p, c[2];
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+    int                i;
+
+    task                 = ucc_tl_ucp_init_task(coll_args, team);
+    task->super.flags   |= UCC_COLL_TASK_FLAG_EXECUTOR;
+    task->super.post     = ucc_tl_ucp_allreduce_dbt_start;
+    task->super.progress = ucc_tl_ucp_allreduce_dbt_progress;
+    task->super.finalize = ucc_tl_ucp_allreduce_dbt_finalize;
+
+    ucc_tl_ucp_allreduce_dbt_tree(size, rank, tree,
+                                  &task->allreduce_dbt.parent, children);
+    task->allreduce_dbt.n_children = 0;
+    for (i = 0; i < 2; i++) {
+        if (children[i] != UCC_RANK_INVALID) {
+            task->allreduce_dbt.children[task->allreduce_dbt.n_children++] =
+                children[i];
+        }
+    }
+    task->allreduce_dbt.depth = 0;
+    p = task->allreduce_dbt.parent;
+    while (p != UCC_RANK_INVALID) {
+        task->allreduce_dbt.depth++;
+        ucc_tl_ucp_allreduce_dbt_tree(size, p, tree, &p, c);
+    }
+    task->allreduce_dbt.offset    = ucc_buffer_block_offset(count, n_trees,
+                                                            tree);
+    task->allreduce_dbt.count     = ucc_buffer_block_count(count, n_trees,
+                                                           tree);
+    task->allreduce_dbt.seg_count = ucc_min(seg_count,
+                                            ucc_max(task->allreduce_dbt.count,
+                                                    1));
+    task->allreduce_dbt.n_segs    =
+        ucc_div_round_up(task->allreduce_dbt.count,
+                         task->allreduce_dbt.seg_count);
+    task->allreduce_dbt.scratch           = NULL;
+    task->allreduce_dbt.scratch_mc_header = NULL;
+
+    if (task->allreduce_dbt.n_children > 0 &&
+        task->allreduce_dbt.count > 0) {
+        /* 2 banks of a segment per child */
+        status = ucc_mc_alloc(&task->allreduce_dbt.scratch_mc_header,
+                              4 * task->allreduce_dbt.seg_count * dt_size,
+                              args->dst.info.mem_type);
+        if (ucc_unlikely(UCC_OK != status)) {
+            ucc_tl_ucp_put_task(task);
+            return status;
+        }
+        task->allreduce_dbt.scratch =
+            task->allreduce_dbt.scratch_mc_header->addr;
+    }
+    *task_p = task;
+    return UCC_OK;
+}
+
+static ucc_status_t
+ucc_tl_ucp_allreduce_dbt_sched_start(ucc_coll_task_t *coll_task)
+{
+    return ucc_schedule_start(coll_task);
+}
+
+static ucc_status_t
+ucc_tl_ucp_allreduce_dbt_sched_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_schedule_t *schedule = ucc_derived_of(coll_task, ucc_schedule_t);
+    ucc_status_t    status;
+
+    status = ucc_schedule_finalize(coll_task);
+    ucc_tl_ucp_put_schedule(schedule);
+    return status;
+}
+
+ucc_status_t ucc_tl_ucp_allreduce_dbt_init(ucc_base_coll_args_t *coll_args,
+                                           ucc_base_team_t      *team,
+                                           ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_coll_args_t   *args    = &coll_args->args;
+    int                n_trees =
+        UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.allreduce_dbt_n_trees;
+    ucc_schedule_t    *schedule;
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+    int                i;
+
+    ALLREDUCE_TASK_CHECK(*args, tl_team);
+    if (!UCC_DT_IS_PREDEFINED(args->dst.info.datatype)) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    if (UCC_TL_TEAM_SIZE(tl_team) < 3 ||
+        (args->mask & UCC_COLL_ARGS_FIELD_TAG)) {
+        /* with 2 ranks both trees have the same edge, with user tag the
+           tasks of the 2 trees can not be told apart */
+        n_trees = 1;
+    }
+    n_trees = ucc_max(ucc_min(n_trees, 2), 1);
+
+    if (n_trees == 1) {
+        status = ucc_tl_ucp_allreduce_dbt_task_init(coll_args, team, 0, 1,
+                                                    &task);
+        if (ucc_likely(UCC_OK == status)) {
+            *task_h = &task->super;
+        }
+        return status;
+    }
+
+    status = ucc_tl_ucp_get_schedule(tl_team, coll_args,
+                                     (ucc_tl_ucp_schedule_t **)&schedule);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    for (i = 0; i < n_trees; i++) {
+        status = ucc_tl_ucp_allreduce_dbt_task_init(coll_args, team, i,
+                                                    n_trees, &task);
+        if (ucc_unlikely(UCC_OK != status)) {
+            goto err;
+        }
+        task->super.n_deps = 1;
+        status = ucc_schedule_add_task(schedule, &task->super);
+        if (ucc_unlikely(UCC_OK != status)) {
+            task->super.finalize(&task->super);
+            goto err;
+        }
+        UCC_CHECK_GOTO(ucc_event_manager_subscribe(&schedule->super.em,
+                                                   UCC_EVENT_SCHEDULE_STARTED,
+                                                   &task->super,
+                                                   ucc_task_start_handler),
+                       err, status);
+    }
+    schedule->super.post     = ucc_tl_ucp_allreduce_dbt_sched_start;
+    schedule->super.finalize = ucc_tl_ucp_allreduce_dbt_sched_finalize;
+    *task_h                  = &schedule->super;
+    return UCC_OK;
+err:
+    ucc_tl_ucp_allreduce_dbt_sched_finalize(&schedule->super);
+out:
+    return status;
+}
@@ -0,0 +1,397 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "allreduce.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "coll_patterns/recursive_knomial.h"
+#include "utils/ucc_coll_utils.h"
+#include "utils/ucc_math_op.h"
+#include "utils/ucc_atomic.h"
+
+/* Recursive doubling allreduce for small host messages. Scratch comes from
+   the per-team mpool, created on the first use. Sends use eager protocol
+   and the reduction of a step is done by the host loop below directly in
+   the completion callback of the step, whichever of send and receive
+   completes last: no executor and no extra progress round trip. */
+
+#define SAVE_STATE(_phase)                                                     \
+    do {                                                                       \
+        task->allreduce_rd.phase = _phase;                                     \
+    } while (0)
+
+#define RD_REDUCE_LOOP(_type, _OP)                                             \
+    do {                                                                       \
+        const _type *s1 = (const _type *)src1;                                 \
+        const _type *s2 = (const _type *)src2;                                 \
+        _type       *d  = (_type *)dst;                                        \
+        for (i = 0; i < count; i++) {                                          \
+            d[i] = _OP##_2(s1[i], s2[i]);                                      \
+        }                                                                      \
+    } while (0)
+
+#define RD_REDUCE_INT(_type)                                                   \
+    do {                                                                       \
+        switch (op) {                                                          \
+        case UCC_OP_SUM:                                                       \
+            RD_REDUCE_LOOP(_type, DO_OP_SUM);                                  \
+            break;                                                             \
+        case UCC_OP_PROD:                                                      \
+            RD_REDUCE_LOOP(_type, DO_OP_PROD);                                 \
+            break;                                                             \
+        case UCC_OP_MAX:                                                       \
+            RD_REDUCE_LOOP(_type, DO_OP_MAX);                                  \
+            break;                                                             \
+        case UCC_OP_MIN:                                                       \
+            RD_REDUCE_LOOP(_type, DO_OP_MIN);                                  \
+            break;                                                             \
+        case UCC_OP_BAND:                                                      \
+            RD_REDUCE_LOOP(_type, DO_OP_BAND);                                 \
+            break;                                                             \
+        case UCC_OP_BOR:                                                       \
+            RD_REDUCE_LOOP(_type, DO_OP_BOR);                                  \
+            break;                                                             \
+        case UCC_OP_BXOR:                                                      \
+            RD_REDUCE_LOOP(_type, DO_OP_BXOR);                                 \
+            break;                                                             \
+        default:                                                               \
+            return UCC_ERR_NOT_SUPPORTED;                                      \
+        }                                                                      \
+    } while (0)
+
+#define RD_REDUCE_FLOAT(_type)                                                 \
+    do {                                                                       \
+        switch (op) {                                                          \
+        case UCC_OP_AVG:                                                       \
+        case UCC_OP_SUM:                                                       \
+            RD_REDUCE_LOOP(_type, DO_OP_SUM);                                  \
+            break;                                                             \
+        case UCC_OP_PROD:                                                      \
+            RD_REDUCE_LOOP(_type, DO_OP_PROD);                                 \
+            break;                                                             \
+        case UCC_OP_MAX:                                                       \
+            RD_REDUCE_LOOP(_type, DO_OP_MAX);                                  \
+            break;                                                             \
+        case UCC_OP_MIN:                                                       \
+            RD_REDUCE_LOOP(_type, DO_OP_MIN);                                  \
+            break;                                                             \
+        default:                                                               \
+            return UCC_ERR_NOT_SUPPORTED;                                      \
+        }                                                                      \
+        if (is_avg) {                                                          \
+            for (i = 0; i < count; i++) {                                      \
+                ((_type *)dst)[i] *= (_type)alpha;                             \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
+/* Datatypes and ops of the host loop, anything else uses knomial */
+static inline int ucc_tl_ucp_allreduce_rd_supported(ucc_datatype_t     dt,
+                                                    ucc_reduction_op_t op)
+{
+    switch (dt) {
+    case UCC_DT_INT32:
+    case UCC_DT_INT64:
+    case UCC_DT_UINT32:
+    case UCC_DT_UINT64:
+        return op == UCC_OP_SUM || op == UCC_OP_PROD || op == UCC_OP_MAX ||
+               op == UCC_OP_MIN || op == UCC_OP_BAND || op == UCC_OP_BOR ||
+               op == UCC_OP_BXOR;
+    case UCC_DT_FLOAT32:
+    case UCC_DT_FLOAT64:
+        return op == UCC_OP_SUM || op == UCC_OP_PROD || op == UCC_OP_MAX ||
+               op == UCC_OP_MIN || op == UCC_OP_AVG;
+    default:
+        return 0;
+    }
+}
+
+static inline ucc_status_t
+ucc_tl_ucp_allreduce_rd_reduce(const void *src1, const void *src2, void *dst,
+                               size_t count, ucc_datatype_t dt,
+                               ucc_reduction_op_t op, int is_avg, double alpha)
+{
+    size_t i;
+
+    switch (dt) {
+    case UCC_DT_INT32:
+        RD_REDUCE_INT(int32_t);
+        break;
+    case UCC_DT_INT64:
+        RD_REDUCE_INT(int64_t);
+        break;
+    case UCC_DT_UINT32:
+        RD_REDUCE_INT(uint32_t);
+        break;
+    case UCC_DT_UINT64:
+        RD_REDUCE_INT(uint64_t);
+        break;
+    case UCC_DT_FLOAT32:
+        RD_REDUCE_FLOAT(float);
+        break;
+    case UCC_DT_FLOAT64:
+        RD_REDUCE_FLOAT(double);
+        break;
+    default:
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    return UCC_OK;
+}
+
+/* Called from send and receive completion of a step, the last one reduces
+   the received data into dst before the step is reported completed */
+static inline void ucc_tl_ucp_allreduce_rd_step_done(ucc_tl_ucp_task_t *task,
+                                                     ucs_status_t status)
+{
+    ucc_coll_args_t *args = &TASK_ARGS(task);
+    ucc_status_t     st;
+
+    if (ucc_unlikely(UCS_OK != status)) {
+        tl_error(UCC_TASK_LIB(task), "failure in rd p2p completion %s",
+                 ucs_status_string(status));
+        task->super.status = ucs_status_to_ucc_status(status);
+    }
+    if (ucc_atomic_fadd32(&task->allreduce_rd.pending, (uint32_t)-1) != 1 ||
+        task->super.status != UCC_INPROGRESS) {
+        return;
+    }
+    st = ucc_tl_ucp_allreduce_rd_reduce(
+        task->allreduce_rd.reduce_src, task->allreduce_rd.scratch,
+        args->dst.info.buffer, args->dst.info.count, args->dst.info.datatype,
+        args->op, task->allreduce_rd.is_avg, AVG_ALPHA(task));
+    if (ucc_unlikely(UCC_OK != st)) {
+        tl_error(UCC_TASK_LIB(task), "failed to perform dt reduction");
+        task->super.status = st;
+    }
+}
+
+static void ucc_tl_ucp_allreduce_rd_send_cb(void *request, ucs_status_t status,
+                                            void *user_data)
+{
+    ucc_tl_ucp_task_t *task = (ucc_tl_ucp_task_t *)user_data;
+
+    ucc_tl_ucp_allreduce_rd_step_done(task, status);
+    task->tagged.send_completed++;
+    if (request) {
+        ucp_request_free(request);
+    }
+}
+
+static void ucc_tl_ucp_allreduce_rd_recv_cb(void *request, ucs_status_t status,
+                                            const ucp_tag_recv_info_t *info, /* NOLINT */
+                                            void *user_data)
+{
+    ucc_tl_ucp_task_t *task = (ucc_tl_ucp_task_t *)user_data;
+
+    ucc_tl_ucp_allreduce_rd_step_done(task, status);
+    task->tagged.recv_completed++;
+    if (request) {
+        ucp_request_free(request);
+    }
+}
+
+static void ucc_tl_ucp_allreduce_rd_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t     *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t       *args = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t     *team = TASK_TEAM(task);
+    int                    avg_pre_op = UCC_TL_UCP_TEAM_LIB(team)->cfg.reduce_avg_pre_op;
+    ucc_knomial_pattern_t *p          = &task->allreduce_rd.p;
+    uint8_t                node_type  = p->node_type;
+    void                  *scratch    = task->allreduce_rd.scratch;
+    void                  *sbuf       = args->src.info.buffer;
+    void                  *rbuf       = args->dst.info.buffer;
+    ucc_memory_type_t      mem_type   = args->dst.info.mem_type;
+    size_t                 data_size  = args->dst.info.count *
+                                        ucc_dt_size(args->dst.info.datatype);
+    ucc_rank_t             size       = (ucc_rank_t)task->subset.map.ep_num;
+    ucc_rank_t             rank       = task->subset.myrank;
+    void                  *send_buf;
+    ucc_rank_t             peer;
+
+    if (UCC_IS_INPLACE(*args)) {
+        sbuf = rbuf;
+    }
+    UCC_KN_GOTO_PHASE(task->allreduce_rd.phase);
+
+    if (KN_NODE_EXTRA == node_type) {
+        peer = ucc_ep_map_eval(task->subset.map,
+                               ucc_knomial_pattern_get_proxy(p, rank));
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_send_nb(sbuf, data_size, mem_type, peer, team, task),
+            task, out);
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_recv_nb(rbuf, data_size, mem_type, peer, team, task),
+            task, out);
+    }
+
+    if (KN_NODE_PROXY == node_type) {
+        peer = ucc_ep_map_eval(task->subset.map,
+                               ucc_knomial_pattern_get_extra(p, rank));
+        task->allreduce_rd.reduce_src = sbuf;
+        task->allreduce_rd.is_avg     = 0;
+        task->allreduce_rd.pending    = 1;
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_recv_cb(scratch, data_size, mem_type, peer, team, task,
+                               ucc_tl_ucp_allreduce_rd_recv_cb),
+            task, out);
+    }
+UCC_KN_PHASE_EXTRA:
+    if (KN_NODE_PROXY == node_type || KN_NODE_EXTRA == node_type) {
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            SAVE_STATE(UCC_KN_PHASE_EXTRA);
+            return;
+        }
+        if (KN_NODE_EXTRA == node_type) {
+            goto completion;
+        }
+    }
+    while (!ucc_knomial_pattern_loop_done(p)) {
+        peer = ucc_knomial_pattern_get_loop_peer(p, rank, size, 1);
+        ucc_assert(peer != UCC_KN_PEER_NULL);
+        peer = ucc_ep_map_eval(task->subset.map, peer);
+        if ((ucc_knomial_pattern_loop_first_iteration(p)) &&
+            (KN_NODE_PROXY != node_type) && !UCC_IS_INPLACE(*args)) {
+            send_buf = sbuf;
+        } else {
+            send_buf = rbuf;
+        }
+        task->allreduce_rd.reduce_src = send_buf;
+        task->allreduce_rd.is_avg =
+            args->op == UCC_OP_AVG &&
+            (avg_pre_op ? ucc_knomial_pattern_loop_first_iteration(p)
+                        : ucc_knomial_pattern_loop_last_iteration(p));
+        /* both send and recv must complete before rbuf is overwritten */
+        task->allreduce_rd.pending = 2;
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_send_eager_cb(send_buf, data_size, mem_type, peer, team,
+                                     task, ucc_tl_ucp_allreduce_rd_send_cb),
+            task, out);
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_recv_cb(scratch, data_size, mem_type, peer, team, task,
+                               ucc_tl_ucp_allreduce_rd_recv_cb),
+            task, out);
+    UCC_KN_PHASE_LOOP:
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            SAVE_STATE(UCC_KN_PHASE_LOOP);
+            return;
+        }
+        ucc_knomial_pattern_next_iteration(p);
+    }
+    if (KN_NODE_PROXY == node_type) {
+        peer = ucc_ep_map_eval(task->subset.map,
+                               ucc_knomial_pattern_get_extra(p, rank));
+        UCPCHECK_GOTO(
+            ucc_tl_ucp_send_nb(rbuf, data_size, mem_type, peer, team, task),
+            task, out);
+        goto UCC_KN_PHASE_PROXY;
+    } else {
+        goto completion;
+    }
+
+UCC_KN_PHASE_PROXY:
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        SAVE_STATE(UCC_KN_PHASE_PROXY);
+        return;
+    }
+
+completion:
+    ucc_assert(UCC_TL_UCP_TASK_P2P_COMPLETE(task));
+    task->super.status = UCC_OK;
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allreduce_rd_done", 0);
+out:
+    return;
+}
+
+static ucc_status_t ucc_tl_ucp_allreduce_rd_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_allreduce_rd_start", 0);
+    task->allreduce_rd.phase = UCC_KN_PHASE_INIT;
+    ucc_knomial_pattern_init((ucc_rank_t)task->subset.map.ep_num,
+                             task->subset.myrank, 2, &task->allreduce_rd.p);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
+static ucc_status_t ucc_tl_ucp_allreduce_rd_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+
+    ucc_mpool_put(task->allreduce_rd.scratch);
+    return ucc_tl_ucp_coll_finalize(&task->super);
+}
+
+/* Scratch mpool is created on the first rd allreduce of the team, so that
+   the teams never running it do not have it */
+static ucc_status_t ucc_tl_ucp_allreduce_rd_scratch_init(ucc_tl_ucp_team_t *team)
+{
+    ucc_status_t status = UCC_OK;
+
+    ucc_spin_lock(&team->rd_scratch_lock);
+    if (!team->rd_scratch_init) {
+        status = ucc_mpool_init(&team->rd_scratch_mp, 0,
+                                UCC_TL_UCP_TEAM_LIB(team)->cfg.
+                                allreduce_rd_scratch_size, 0,
+                                UCC_CACHE_LINE_SIZE, 4, UINT_MAX, NULL,
+                                UCC_TL_CORE_CTX(team)->thread_mode,
+                                "tl_ucp_rd_scratch_mp");
+        if (UCC_OK == status) {
+            team->rd_scratch_init = 1;
+        } else {
+            tl_error(UCC_TL_TEAM_LIB(team),
+                     "failed to initialize rd scratch mpool");
+        }
+    }
+    ucc_spin_unlock(&team->rd_scratch_lock);
+    return status;
+}
+
+ucc_status_t ucc_tl_ucp_allreduce_rd_init(ucc_base_coll_args_t *coll_args,
+                                          ucc_base_team_t *     team,
+                                          ucc_coll_task_t **    task_h)
+{
+    ucc_tl_ucp_team_t *tl_team   = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_coll_args_t   *args      = &coll_args->args;
+    size_t             data_size = args->dst.info.count *
+                                   ucc_dt_size(args->dst.info.datatype);
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+
+    ALLREDUCE_TASK_CHECK(coll_args->args, tl_team);
+    if (args->dst.info.mem_type != UCC_MEMORY_TYPE_HOST ||
+        data_size > UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.allreduce_rd_scratch_size ||
+        !ucc_tl_ucp_allreduce_rd_supported(args->dst.info.datatype,
+                                           args->op) ||
+        IS_SERVICE_TEAM(tl_team)) {
+        /* rd is for small host messages reduced by the host loop, use
+           knomial for everything else */
+        return ucc_tl_ucp_allreduce_knomial_init(coll_args, team, task_h);
+    }
+    if (ucc_unlikely(!tl_team->rd_scratch_init)) {
+        status = ucc_tl_ucp_allreduce_rd_scratch_init(tl_team);
+        if (UCC_OK != status) {
+            return status;
+        }
+    }
+    task = ucc_tl_ucp_init_task(coll_args, team);
+    task->allreduce_rd.scratch = ucc_mpool_get(&tl_team->rd_scratch_mp);
+    if (ucc_unlikely(!task->allreduce_rd.scratch)) {
+        tl_error(UCC_TASK_LIB(task), "failed to get rd scratch buffer");
+        ucc_tl_ucp_put_task(task);
+        return UCC_ERR_NO_MEMORY;
+    }
+    task->super.post     = ucc_tl_ucp_allreduce_rd_start;
+    task->super.progress = ucc_tl_ucp_allreduce_rd_progress;
+    task->super.finalize = ucc_tl_ucp_allreduce_rd_finalize;
+    *task_h              = &task->super;
+    status               = UCC_OK;
+out:
+    return status;
+}
@@ -117,8 +117,14 @@ static ucc_status_t ucc_tl_ucp_allreduce_sra_knomial_frag_init(
                  "failed to init reduce_scatter_knomial task");
         goto out;
     }
-    ucc_schedule_add_task(schedule, task);
-    ucc_task_subscribe_dep(&schedule->super, task, UCC_EVENT_SCHEDULE_STARTED);
+    status = ucc_schedule_add_task(schedule, task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        task->finalize(task);
+        goto out;
+    }
+    UCC_CHECK_GOTO(ucc_task_subscribe_dep(&schedule->super, task,
+                                          UCC_EVENT_SCHEDULE_STARTED),
+                   err, status);
     rs_task = task;
     /* 2nd step of allreduce: knomial allgather. 2nd task subscribes
      to completion event of reduce_scatter task. */
@@ -128,15 +134,23 @@ static ucc_status_t ucc_tl_ucp_allreduce_sra_knomial_frag_init(
     if (UCC_OK != status) {
         tl_error(UCC_TL_TEAM_LIB(tl_team),
                  "failed to init allgather_knomial task");
-        goto out;
+        goto err;
+    }
+    status = ucc_schedule_add_task(schedule, task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        task->finalize(task);
+        goto err;
     }
-    ucc_schedule_add_task(schedule, task);
-    ucc_task_subscribe_dep(rs_task, task, UCC_EVENT_COMPLETED);
+    UCC_CHECK_GOTO(ucc_task_subscribe_dep(rs_task, task, UCC_EVENT_COMPLETED),
+                   err, status);
     schedule->super.finalize = ucc_tl_ucp_allreduce_sra_knomial_frag_finalize;
     schedule->super.post     = ucc_tl_ucp_allreduce_sra_knomial_frag_start;
     *frag_p                  = schedule;
     return UCC_OK;
+err:
+    ucc_schedule_finalize(&schedule->super);
 out:
+    ucc_tl_ucp_put_schedule(schedule);
     return status;
 }
 
@@ -184,10 +198,24 @@ ucc_tl_ucp_allreduce_sra_knomial_init(ucc_base_coll_args_t *coll_args,
 {
     ucc_tl_ucp_team_t        *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
     ucc_tl_ucp_lib_config_t  *cfg     = &UCC_TL_UCP_TEAM_LIB(tl_team)->cfg;
-    int                       n_frags, pipeline_depth;
+    int                       n_frags, pipeline_depth, cacheable;
     ucc_schedule_pipelined_t *schedule_p;
+    ucc_schedule_cache_key_t  key;
     ucc_status_t status;
 
+    cacheable = (UCC_OK == ucc_schedule_cache_key_init(
+                               &key, UCC_TL_UCP_ALLREDUCE_ALG_SRA_KNOMIAL,
+                               coll_args));
+    if (cacheable) {
+        schedule_p = ucc_schedule_cache_get(&tl_team->sched_cache, &key,
+                                            coll_args);
+        if (schedule_p) {
+            ucc_tl_ucp_schedule_retag(tl_team, schedule_p, coll_args);
+            *task_h = &schedule_p->super.super;
+            return UCC_OK;
+        }
+    }
+
     status = ucc_tl_ucp_get_schedule(tl_team, coll_args,
                                      (ucc_tl_ucp_schedule_t **)&schedule_p);
     if (ucc_unlikely(UCC_OK != status)) {
@@ -208,6 +236,10 @@ ucc_tl_ucp_allreduce_sra_knomial_init(ucc_base_coll_args_t *coll_args,
         ucc_tl_ucp_allreduce_sra_knomial_finalize;
     schedule_p->super.super.triggered_post = ucc_triggered_post;
     schedule_p->super.super.post = ucc_tl_ucp_allreduce_sra_knomial_start;
+    if (cacheable) {
+        ucc_schedule_pipelined_set_cache(schedule_p, &tl_team->sched_cache,
+                                         &key);
+    }
     *task_h                                = &schedule_p->super.super;
     return UCC_OK;
 }
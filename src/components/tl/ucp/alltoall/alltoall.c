@@ -7,6 +7,8 @@
 #include "config.h"
 #include "tl_ucp.h"
 #include "alltoall.h"
+#include "tl_ucp_heap.h"
+#include "tl_ucp_generic_dt.h"
 
 ucc_status_t ucc_tl_ucp_alltoall_pairwise_start(ucc_coll_task_t *task);
 void ucc_tl_ucp_alltoall_pairwise_progress(ucc_coll_task_t *task);
@@ -24,6 +26,11 @@ ucc_base_coll_alg_info_t
             {.id   = UCC_TL_UCP_ALLTOALL_ALG_ONESIDED,
              .name = "onesided",
              .desc = "naive, linear one-sided implementation"},
+        [UCC_TL_UCP_ALLTOALL_ALG_BRUCK] =
+            {.id   = UCC_TL_UCP_ALLTOALL_ALG_BRUCK,
+             .name = "bruck",
+             .desc = "Bruck algorithm with configurable radix, log(N) "
+                     "steps, for small messages"},
         [UCC_TL_UCP_ALLTOALL_ALG_LAST] = {.id = 0, .name = NULL, .desc = NULL}};
 
 ucc_status_t ucc_tl_ucp_alltoall_init(ucc_tl_ucp_task_t *task)
@@ -44,6 +51,11 @@ ucc_status_t ucc_tl_ucp_alltoall_pairwise_init(ucc_base_coll_args_t *coll_args,
     ucc_tl_ucp_task_t *task;
     ucc_status_t       status;
 
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_alltoall_pairwise_init,
+                                          task_h);
+    }
     ALLTOALL_TASK_CHECK(coll_args->args, tl_team);
     task                 = ucc_tl_ucp_init_task(coll_args, team);
     *task_h              = &task->super;
@@ -63,12 +75,18 @@ ucc_status_t ucc_tl_ucp_alltoall_onesided_init(ucc_base_coll_args_t *coll_args,
     ALLTOALL_TASK_CHECK(coll_args->args, tl_team);
 
     if (!(coll_args->args.mask & UCC_COLL_ARGS_FIELD_GLOBAL_WORK_BUFFER)) {
-        tl_error(UCC_TL_TEAM_LIB(tl_team),
-                 "global work buffer not provided nor associated with team");
-        status = UCC_ERR_NOT_SUPPORTED;
-        goto out;
-    }
-    if (coll_args->args.mask & UCC_COLL_ARGS_FIELD_FLAGS) {
+        /* blocks of all the peers are staged in a slot of the team heap */
+        if (!ucc_tl_ucp_heap_available(tl_team) ||
+            coll_args->args.dst.info.count *
+                    ucc_dt_size(coll_args->args.dst.info.datatype) >
+                ucc_tl_ucp_heap_scratch_size(tl_team)) {
+            tl_error(UCC_TL_TEAM_LIB(tl_team),
+                     "global work buffer not provided and message does not "
+                     "fit team heap");
+            status = UCC_ERR_NOT_SUPPORTED;
+            goto out;
+        }
+    } else if (coll_args->args.mask & UCC_COLL_ARGS_FIELD_FLAGS) {
         if (!(coll_args->args.flags & UCC_COLL_ARGS_FLAG_MEM_MAPPED_BUFFERS)) {
             tl_error(UCC_TL_TEAM_LIB(tl_team),
                      "non memory mapped buffers are not supported");
@@ -13,13 +13,24 @@
 enum {
     UCC_TL_UCP_ALLTOALL_ALG_PAIRWISE,
     UCC_TL_UCP_ALLTOALL_ALG_ONESIDED,
+    UCC_TL_UCP_ALLTOALL_ALG_BRUCK,
     UCC_TL_UCP_ALLTOALL_ALG_LAST
 };
 
 extern ucc_base_coll_alg_info_t
     ucc_tl_ucp_alltoall_algs[UCC_TL_UCP_ALLTOALL_ALG_LAST + 1];
 
-#define UCC_TL_UCP_ALLTOALL_DEFAULT_ALG_SELECT_STR "alltoall:0-inf:@0"
+/* Bruck for blocks up to ~256 bytes on large teams, msg range is the
+   total src size, so the threshold scales with the team size */
+#define UCC_TL_UCP_ALLTOALL_DEFAULT_ALG_SELECT_STR                             \
+    "alltoall:0-inf:@0:team_size=1-15"                                         \
+    "#alltoall:0-4k:@2:team_size=16-63#alltoall:4k-inf:@0:team_size=16-63"     \
+    "#alltoall:0-16k:@2:team_size=64-255"                                      \
+    "#alltoall:16k-inf:@0:team_size=64-255"                                    \
+    "#alltoall:0-64k:@2:team_size=256-1023"                                    \
+    "#alltoall:64k-inf:@0:team_size=256-1023"                                  \
+    "#alltoall:0-256k:@2:team_size=1024-inf"                                   \
+    "#alltoall:256k-inf:@0:team_size=1024-inf"
 
 ucc_status_t ucc_tl_ucp_alltoall_init(ucc_tl_ucp_task_t *task);
 
@@ -33,6 +44,10 @@ ucc_status_t ucc_tl_ucp_alltoall_onesided_init(ucc_base_coll_args_t *coll_args,
                                                ucc_base_team_t *     team,
                                                ucc_coll_task_t **    task_h);
 
+ucc_status_t ucc_tl_ucp_alltoall_bruck_init(ucc_base_coll_args_t *coll_args,
+                                            ucc_base_team_t      *team,
+                                            ucc_coll_task_t     **task_h);
+
 #define ALLTOALL_CHECK_INPLACE(_args, _team)                \
     do {                                                    \
         if (UCC_IS_INPLACE(_args)) {                        \
@@ -0,0 +1,420 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "alltoall.h"
+#include "core/ucc_progress_queue.h"
+#include "components/mc/ucc_mc.h"
+#include "utils/ucc_math.h"
+#include "tl_ucp_sendrecv.h"
+#include "tl_ucp_generic_dt.h"
+
+/* Bruck alltoall with radix r: ceil(log_r(N)) steps, each step exchanges
+   (r-1) messages of ~N/r blocks.
+
+   1. Local rotation: block destined to rank (rank + i) % N is placed at
+      index i of the scratch.
+   2. For every digit d of the base r representation of the block index
+      (weight pow = r^d) and every digit value j = 1..r-1: blocks with digit
+      d equal to j are packed and sent to rank + j * pow, the same blocks are
+      received from rank - j * pow and unpacked at the same indices.
+   3. Inverse rotation: block i came from rank (rank - i) % N.
+
+   All the local copies (rotations, pack and unpack) go through the executor
+   in batches of UCC_EE_EXECUTOR_NUM_COPY_BUFS. */
+
+enum {
+    UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_ROTATE,
+    UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_PACK,
+    UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_EXCHANGE,
+    UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_UNPACK,
+    UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_FINAL
+};
+
+typedef struct ucc_tl_ucp_a2a_bruck_copy {
+    void  *src;
+    void  *dst;
+    size_t len;
+} ucc_tl_ucp_a2a_bruck_copy_t;
+
+#define BRUCK_TASK(_task) (&(_task)->alltoall_bruck)
+
+#define BRUCK_COPIES(_task)                                                    \
+    ((ucc_tl_ucp_a2a_bruck_copy_t *)BRUCK_TASK(_task)->copies)
+
+static inline size_t ucc_tl_ucp_alltoall_bruck_block_size(
+    ucc_tl_ucp_task_t *task)
+{
+    ucc_coll_args_t *args = &TASK_ARGS(task);
+
+    return (args->src.info.count / UCC_TL_TEAM_SIZE(TASK_TEAM(task))) *
+           ucc_dt_size(args->src.info.datatype);
+}
+
+/* number of block indices in [0, size) with digit of weight pow equal to j */
+static inline size_t ucc_tl_ucp_alltoall_bruck_n_blocks(ucc_rank_t size,
+                                                        uint32_t   radix,
+                                                        ucc_rank_t pow,
+                                                        uint32_t   j)
+{
+    size_t period = (size_t)radix * pow;
+    size_t rem    = size % period;
+    size_t tail   = rem > (size_t)j * pow ? rem - (size_t)j * pow : 0;
+
+    return (size / period) * pow + ucc_min(tail, (size_t)pow);
+}
+
+static inline void *ucc_tl_ucp_alltoall_bruck_sbuf(ucc_tl_ucp_task_t *task,
+                                                   uint32_t j)
+{
+    ucc_rank_t size = UCC_TL_TEAM_SIZE(TASK_TEAM(task));
+    size_t     bs   = ucc_tl_ucp_alltoall_bruck_block_size(task);
+
+    return PTR_OFFSET(BRUCK_TASK(task)->scratch,
+                      (size + (j - 1) * BRUCK_TASK(task)->max_blocks) * bs);
+}
+
+static inline void *ucc_tl_ucp_alltoall_bruck_rbuf(ucc_tl_ucp_task_t *task,
+                                                   uint32_t j)
+{
+    ucc_rank_t size = UCC_TL_TEAM_SIZE(TASK_TEAM(task));
+    size_t     bs   = ucc_tl_ucp_alltoall_bruck_block_size(task);
+
+    return PTR_OFFSET(BRUCK_TASK(task)->scratch,
+                      (size + (BRUCK_TASK(task)->radix - 2 + j) *
+                       BRUCK_TASK(task)->max_blocks) * bs);
+}
+
+static void ucc_tl_ucp_alltoall_bruck_add_copy(ucc_tl_ucp_task_t *task,
+                                               void *src, void *dst,
+                                               size_t len)
+{
+    ucc_tl_ucp_a2a_bruck_copy_t *copies = BRUCK_COPIES(task);
+    ucc_tl_ucp_a2a_bruck_copy_t *last;
+
+    if (len == 0) {
+        return;
+    }
+    if (BRUCK_TASK(task)->n_copies > 0) {
+        last = &copies[BRUCK_TASK(task)->n_copies - 1];
+        if (PTR_OFFSET(last->src, last->len) == src &&
+            PTR_OFFSET(last->dst, last->len) == dst) {
+            last->len += len;
+            return;
+        }
+    }
+    copies[BRUCK_TASK(task)->n_copies].src = src;
+    copies[BRUCK_TASK(task)->n_copies].dst = dst;
+    copies[BRUCK_TASK(task)->n_copies].len = len;
+    BRUCK_TASK(task)->n_copies++;
+}
+
+/* Collects pack (pack != 0) or unpack copies of the current step */
+static void ucc_tl_ucp_alltoall_bruck_pack(ucc_tl_ucp_task_t *task, int pack)
+{
+    ucc_rank_t size  = UCC_TL_TEAM_SIZE(TASK_TEAM(task));
+    uint32_t   radix = BRUCK_TASK(task)->radix;
+    ucc_rank_t pow   = BRUCK_TASK(task)->pow;
+    size_t     bs    = ucc_tl_ucp_alltoall_bruck_block_size(task);
+    void      *tmp   = BRUCK_TASK(task)->scratch;
+    void      *buf;
+    size_t     start, n, offset;
+    uint32_t   j;
+
+    BRUCK_TASK(task)->n_copies      = 0;
+    BRUCK_TASK(task)->copies_posted = 0;
+    for (j = 1; j < radix && (size_t)j * pow < size; j++) {
+        buf    = pack ? ucc_tl_ucp_alltoall_bruck_sbuf(task, j)
+                      : ucc_tl_ucp_alltoall_bruck_rbuf(task, j);
+        offset = 0;
+        for (start = (size_t)j * pow; start < size;
+             start += (size_t)radix * pow) {
+            n = ucc_min((size_t)pow, size - start);
+            if (pack) {
+                ucc_tl_ucp_alltoall_bruck_add_copy(
+                    task, PTR_OFFSET(tmp, start * bs),
+                    PTR_OFFSET(buf, offset), n * bs);
+            } else {
+                ucc_tl_ucp_alltoall_bruck_add_copy(
+                    task, PTR_OFFSET(buf, offset),
+                    PTR_OFFSET(tmp, start * bs), n * bs);
+            }
+            offset += n * bs;
+        }
+    }
+}
+
+/* Posts the collected copies to the executor, returns UCC_INPROGRESS until
+   all of them are completed */
+static ucc_status_t
+ucc_tl_ucp_alltoall_bruck_copy_progress(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_a2a_bruck_copy_t *copies;
+    ucc_ee_executor_task_args_t  eargs;
+    ucc_ee_executor_t           *exec;
+    ucc_status_t                 status;
+    uint32_t                     i, n;
+
+    for (;;) {
+        if (BRUCK_TASK(task)->etask) {
+            status = ucc_ee_executor_task_test(BRUCK_TASK(task)->etask);
+            if (UCC_INPROGRESS == status) {
+                return status;
+            }
+            ucc_ee_executor_task_finalize(BRUCK_TASK(task)->etask);
+            BRUCK_TASK(task)->etask = NULL;
+            if (ucc_unlikely(status < 0)) {
+                return status;
+            }
+        }
+        if (BRUCK_TASK(task)->copies_posted == BRUCK_TASK(task)->n_copies) {
+            return UCC_OK;
+        }
+        status = ucc_coll_task_get_executor(&task->super, &exec);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+        copies = BRUCK_COPIES(task) + BRUCK_TASK(task)->copies_posted;
+        n      = ucc_min(BRUCK_TASK(task)->n_copies -
+                             BRUCK_TASK(task)->copies_posted,
+                         UCC_EE_EXECUTOR_NUM_COPY_BUFS);
+        eargs.task_type              = UCC_EE_EXECUTOR_TASK_COPY_MULTI;
+        eargs.copy_multi.num_vectors = n;
+        for (i = 0; i < n; i++) {
+            eargs.copy_multi.src[i]    = copies[i].src;
+            eargs.copy_multi.dst[i]    = copies[i].dst;
+            eargs.copy_multi.counts[i] = copies[i].len;
+        }
+        status = ucc_ee_executor_task_post(exec, &eargs,
+                                           &BRUCK_TASK(task)->etask);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+        BRUCK_TASK(task)->copies_posted += n;
+    }
+}
+
+static ucc_status_t
+ucc_tl_ucp_alltoall_bruck_exchange(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_team_t *team  = TASK_TEAM(task);
+    ucc_rank_t         rank  = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t         size  = UCC_TL_TEAM_SIZE(team);
+    uint32_t           radix = BRUCK_TASK(task)->radix;
+    ucc_rank_t         pow   = BRUCK_TASK(task)->pow;
+    ucc_memory_type_t  mtype = TASK_ARGS(task).dst.info.mem_type;
+    size_t             bs    = ucc_tl_ucp_alltoall_bruck_block_size(task);
+    size_t             len;
+    ucc_rank_t         dist;
+    uint32_t           j;
+
+    for (j = 1; j < radix && (size_t)j * pow < size; j++) {
+        dist = j * pow;
+        len  = ucc_tl_ucp_alltoall_bruck_n_blocks(size, radix, pow, j) * bs;
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(ucc_tl_ucp_alltoall_bruck_rbuf(task,
+                                                                        j),
+                                         len, mtype,
+                                         (rank - dist + size) % size, team,
+                                         task),
+                      task, out);
+        UCPCHECK_GOTO(ucc_tl_ucp_send_nb(ucc_tl_ucp_alltoall_bruck_sbuf(task,
+                                                                        j),
+                                         len, mtype, (rank + dist) % size,
+                                         team, task),
+                      task, out);
+    }
+    return UCC_OK;
+out:
+    return task->super.status;
+}
+
+/* Collects copies of the next step: pack if there are digits left,
+   inverse rotation otherwise */
+static void ucc_tl_ucp_alltoall_bruck_next_step(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    ucc_rank_t         rank = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t         size = UCC_TL_TEAM_SIZE(team);
+    size_t             bs   = ucc_tl_ucp_alltoall_bruck_block_size(task);
+    void              *dst  = TASK_ARGS(task).dst.info.buffer;
+    ucc_rank_t         i;
+
+    if (BRUCK_TASK(task)->pow < size) {
+        ucc_tl_ucp_alltoall_bruck_pack(task, 1);
+        BRUCK_TASK(task)->phase = UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_PACK;
+        return;
+    }
+    BRUCK_TASK(task)->n_copies      = 0;
+    BRUCK_TASK(task)->copies_posted = 0;
+    for (i = 0; i < size; i++) {
+        ucc_tl_ucp_alltoall_bruck_add_copy(
+            task, PTR_OFFSET(BRUCK_TASK(task)->scratch, (size_t)i * bs),
+            PTR_OFFSET(dst, (size_t)((rank - i + size) % size) * bs), bs);
+    }
+    BRUCK_TASK(task)->phase = UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_FINAL;
+}
+
+void ucc_tl_ucp_alltoall_bruck_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_status_t       status;
+
+    for (;;) {
+        if (BRUCK_TASK(task)->phase ==
+            UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_EXCHANGE) {
+            if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+                return;
+            }
+            ucc_tl_ucp_alltoall_bruck_pack(task, 0);
+            BRUCK_TASK(task)->phase = UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_UNPACK;
+        }
+        status = ucc_tl_ucp_alltoall_bruck_copy_progress(task);
+        if (UCC_INPROGRESS == status) {
+            return;
+        } else if (ucc_unlikely(UCC_OK != status)) {
+            task->super.status = status;
+            return;
+        }
+        switch (BRUCK_TASK(task)->phase) {
+        case UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_ROTATE:
+            ucc_tl_ucp_alltoall_bruck_next_step(task);
+            break;
+        case UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_PACK:
+            status = ucc_tl_ucp_alltoall_bruck_exchange(task);
+            if (ucc_unlikely(UCC_OK != status)) {
+                return;
+            }
+            BRUCK_TASK(task)->phase = UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_EXCHANGE;
+            break;
+        case UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_UNPACK:
+            BRUCK_TASK(task)->pow *= BRUCK_TASK(task)->radix;
+            ucc_tl_ucp_alltoall_bruck_next_step(task);
+            break;
+        default:
+            ucc_assert(BRUCK_TASK(task)->phase ==
+                       UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_FINAL);
+            task->super.status = UCC_OK;
+            UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task,
+                                             "ucp_alltoall_bruck_done", 0);
+            return;
+        }
+    }
+}
+
+ucc_status_t ucc_tl_ucp_alltoall_bruck_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    ucc_coll_args_t   *args = &TASK_ARGS(task);
+    ucc_rank_t         rank = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t         size = UCC_TL_TEAM_SIZE(team);
+    size_t             bs   = ucc_tl_ucp_alltoall_bruck_block_size(task);
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_alltoall_bruck_start", 0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    BRUCK_TASK(task)->phase         = UCC_TL_UCP_ALLTOALL_BRUCK_PHASE_ROTATE;
+    BRUCK_TASK(task)->pow           = 1;
+    BRUCK_TASK(task)->etask         = NULL;
+    BRUCK_TASK(task)->n_copies      = 0;
+    BRUCK_TASK(task)->copies_posted = 0;
+    ucc_tl_ucp_alltoall_bruck_add_copy(
+        task, PTR_OFFSET(args->src.info.buffer, (size_t)rank * bs),
+        BRUCK_TASK(task)->scratch, (size_t)(size - rank) * bs);
+    ucc_tl_ucp_alltoall_bruck_add_copy(
+        task, args->src.info.buffer,
+        PTR_OFFSET(BRUCK_TASK(task)->scratch, (size_t)(size - rank) * bs),
+        (size_t)rank * bs);
+
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
+ucc_status_t ucc_tl_ucp_alltoall_bruck_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+
+    if (BRUCK_TASK(task)->etask) {
+        ucc_ee_executor_task_finalize(BRUCK_TASK(task)->etask);
+    }
+    ucc_mc_free(BRUCK_TASK(task)->scratch_mc_header);
+    ucc_free(BRUCK_TASK(task)->copies);
+    return ucc_tl_ucp_coll_finalize(coll_task);
+}
+
+ucc_status_t ucc_tl_ucp_alltoall_bruck_init(ucc_base_coll_args_t *coll_args,
+                                            ucc_base_team_t      *team,
+                                            ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_rank_t         size    = UCC_TL_TEAM_SIZE(tl_team);
+    ucc_coll_args_t   *args    = &coll_args->args;
+    size_t             max_blocks = 0;
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+    uint32_t           radix, j;
+    ucc_rank_t         pow;
+    size_t             bs;
+
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_alltoall_bruck_init,
+                                          task_h);
+    }
+    ALLTOALL_TASK_CHECK(coll_args->args, tl_team);
+    if (args->src.info.mem_type != args->dst.info.mem_type) {
+        tl_debug(UCC_TL_TEAM_LIB(tl_team),
+                 "bruck alltoall requires same src and dst memory types");
+        status = UCC_ERR_NOT_SUPPORTED;
+        goto out;
+    }
+
+    radix = ucc_max(2, ucc_min(UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.
+                                   alltoall_bruck_radix, size));
+    for (pow = 1; pow < size; pow *= radix) {
+        for (j = 1; j < radix && (size_t)j * pow < size; j++) {
+            max_blocks = ucc_max(max_blocks, ucc_tl_ucp_alltoall_bruck_n_blocks(
+                                                 size, radix, pow, j));
+        }
+        if ((size_t)pow * radix >= size) {
+            break;
+        }
+    }
+
+    task = ucc_tl_ucp_init_task(coll_args, team);
+    task->super.flags    |= UCC_COLL_TASK_FLAG_EXECUTOR;
+    task->super.post     = ucc_tl_ucp_alltoall_bruck_start;
+    task->super.progress = ucc_tl_ucp_alltoall_bruck_progress;
+    task->super.finalize = ucc_tl_ucp_alltoall_bruck_finalize;
+    BRUCK_TASK(task)->radix      = radix;
+    BRUCK_TASK(task)->max_blocks = max_blocks;
+    BRUCK_TASK(task)->etask      = NULL;
+
+    bs     = ucc_tl_ucp_alltoall_bruck_block_size(task);
+    status = ucc_mc_alloc(&BRUCK_TASK(task)->scratch_mc_header,
+                          ucc_max((size + 2 * (radix - 1) * max_blocks) * bs,
+                                  1),
+                          args->dst.info.mem_type);
+    if (ucc_unlikely(UCC_OK != status)) {
+        tl_error(UCC_TL_TEAM_LIB(tl_team), "failed to allocate scratch");
+        ucc_tl_ucp_put_task(task);
+        return status;
+    }
+    BRUCK_TASK(task)->scratch = BRUCK_TASK(task)->scratch_mc_header->addr;
+    /* max number of copies in a phase: final inverse rotation */
+    BRUCK_TASK(task)->copies  = ucc_malloc(
+        (size + 1) * sizeof(ucc_tl_ucp_a2a_bruck_copy_t), "a2a_bruck_copies");
+    if (ucc_unlikely(!BRUCK_TASK(task)->copies)) {
+        tl_error(UCC_TL_TEAM_LIB(tl_team), "failed to allocate %zd bytes",
+                 (size + 1) * sizeof(ucc_tl_ucp_a2a_bruck_copy_t));
+        ucc_mc_free(BRUCK_TASK(task)->scratch_mc_header);
+        ucc_tl_ucp_put_task(task);
+        return UCC_ERR_NO_MEMORY;
+    }
+    *task_h = &task->super;
+    status  = UCC_OK;
+out:
+    return status;
+}
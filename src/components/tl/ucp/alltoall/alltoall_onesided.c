@@ -10,12 +10,12 @@
 #include "core/ucc_progress_queue.h"
 #include "utils/ucc_math.h"
 #include "tl_ucp_sendrecv.h"
+#include "tl_ucp_heap.h"
 
 void ucc_tl_ucp_alltoall_onesided_progress(ucc_coll_task_t *ctask);
 
-ucc_status_t ucc_tl_ucp_alltoall_onesided_start(ucc_coll_task_t *ctask)
+static ucc_status_t ucc_tl_ucp_alltoall_onesided_post(ucc_tl_ucp_task_t *task)
 {
-    ucc_tl_ucp_task_t *task   = ucc_derived_of(ctask, ucc_tl_ucp_task_t);
     ucc_tl_ucp_team_t *team   = TASK_TEAM(task);
     ptrdiff_t          src    = (ptrdiff_t)TASK_ARGS(task).src.info.buffer;
     ptrdiff_t          dest   = (ptrdiff_t)TASK_ARGS(task).dst.info.buffer;
@@ -24,43 +24,101 @@ ucc_status_t ucc_tl_ucp_alltoall_onesided_start(ucc_coll_task_t *ctask)
     ucc_rank_t         gsize  = UCC_TL_TEAM_SIZE(team);
     ucc_rank_t         start  = (grank + 1) % gsize;
     long *             pSync  = TASK_ARGS(task).global_work_buffer;
+    int                slot   = task->alltoall_onesided.heap_slot;
     ucc_rank_t         peer;
 
-    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
-    /* TODO: change when support for library-based work buffers is complete */
+    if (slot >= 0) {
+        /* blocks are put into the heap slot of the peer and copied to dst
+           by the peer itself */
+        pSync = (long *)ucc_tl_ucp_heap_sync(team, slot);
+        dest  = (ptrdiff_t)ucc_tl_ucp_heap_scratch(team, slot);
+    }
+    task->alltoall_onesided.posted = 1;
     nelems = (nelems / gsize) * ucc_dt_size(TASK_ARGS(task).src.info.datatype);
     dest   = dest + grank * nelems;
-    UCPCHECK_GOTO(ucc_tl_ucp_put_nb((void *)(src + start * nelems),
-                                    (void *)dest, nelems, start, team, task),
-                  task, out);
-    UCPCHECK_GOTO(ucc_tl_ucp_atomic_inc(pSync, start, team), task, out);
-
-    for (peer = (start + 1) % gsize; peer != start; peer = (peer + 1) % gsize) {
+    peer   = start;
+    do {
         UCPCHECK_GOTO(ucc_tl_ucp_put_nb((void *)(src + peer * nelems),
                                         (void *)dest, nelems, peer, team, task),
                       task, out);
-        UCPCHECK_GOTO(ucc_tl_ucp_atomic_inc(pSync, peer, team), task,
-                      out);
-    }
-
-    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+        peer = (peer + 1) % gsize;
+    } while (peer != start);
+    /* sync counter of the peer must not be updated before the data */
+    ucp_worker_fence(UCC_TL_UCP_WORKER(team));
+    do {
+        UCPCHECK_GOTO(ucc_tl_ucp_atomic_inc(
+                          &pSync[UCC_TL_UCP_HEAP_SYNC_ARRIVED], peer, team),
+                      task, out);
+        peer = (peer + 1) % gsize;
+    } while (peer != start);
+    return UCC_OK;
 out:
     return task->super.status;
 }
 
+ucc_status_t ucc_tl_ucp_alltoall_onesided_start(ucc_coll_task_t *ctask)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(ctask, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    uint32_t           seq;
+
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    task->alltoall_onesided.heap_slot = -1;
+    task->alltoall_onesided.posted    = 0;
+    if (!(TASK_ARGS(task).mask & UCC_COLL_ARGS_FIELD_GLOBAL_WORK_BUFFER)) {
+        seq = ucc_tl_ucp_heap_next_seq(team);
+        task->alltoall_onesided.heap_seq  = seq;
+        task->alltoall_onesided.heap_slot = ucc_tl_ucp_heap_seq_slot(seq);
+        if (!ucc_tl_ucp_heap_slot_ready(team, seq)) {
+            /* peers still consume the previous collective in this slot,
+               puts are posted from progress */
+            goto enqueue;
+        }
+    }
+    if (UCC_OK != ucc_tl_ucp_alltoall_onesided_post(task)) {
+        return task->super.status;
+    }
+enqueue:
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
 void ucc_tl_ucp_alltoall_onesided_progress(ucc_coll_task_t *ctask)
 {
     ucc_tl_ucp_task_t *task  = ucc_derived_of(ctask, ucc_tl_ucp_task_t);
     ucc_tl_ucp_team_t *team  = TASK_TEAM(task);
     ucc_rank_t         gsize = UCC_TL_TEAM_SIZE(team);
+    int                slot  = task->alltoall_onesided.heap_slot;
     long *             pSync = TASK_ARGS(task).global_work_buffer;
 
-    if ((*pSync < gsize) ||
+    if (!task->alltoall_onesided.posted) {
+        if (!ucc_tl_ucp_heap_slot_ready(team,
+                                        task->alltoall_onesided.heap_seq)) {
+            ucp_worker_progress(UCC_TL_UCP_TEAM_CTX(team)->ucp_worker);
+            return;
+        }
+        if (UCC_OK != ucc_tl_ucp_alltoall_onesided_post(task)) {
+            return;
+        }
+    }
+    if (slot >= 0) {
+        pSync = (long *)ucc_tl_ucp_heap_sync(team, slot);
+    }
+    if ((pSync[UCC_TL_UCP_HEAP_SYNC_ARRIVED] < gsize) ||
         (task->onesided.put_completed < task->onesided.put_posted)) {
-        ucp_worker_progress(UCC_TL_UCP_TEAM_CTX(team)->ucp_worker);
+        if (ucc_tl_ucp_task_polls(task)) {
+            ucp_worker_progress(UCC_TL_UCP_TEAM_CTX(team)->ucp_worker);
+        }
         return;
     }
 
-    pSync[0]           = 0;
+    pSync[UCC_TL_UCP_HEAP_SYNC_ARRIVED] = 0;
+    if (slot >= 0) {
+        memcpy(TASK_ARGS(task).dst.info.buffer,
+               ucc_tl_ucp_heap_scratch(team, slot),
+               TASK_ARGS(task).dst.info.count *
+                   ucc_dt_size(TASK_ARGS(task).dst.info.datatype));
+        task->super.status = ucc_tl_ucp_heap_slot_release(team, slot);
+        return;
+    }
     task->super.status = UCC_OK;
 }
@@ -33,7 +33,8 @@ void ucc_tl_ucp_alltoall_pairwise_progress(ucc_coll_task_t *coll_task)
     ucc_memory_type_t  rmem  = TASK_ARGS(task).dst.info.mem_type;
     ucc_rank_t         grank = UCC_TL_TEAM_RANK(team);
     ucc_rank_t         gsize = UCC_TL_TEAM_SIZE(team);
-    int                polls = 0;
+    uint32_t           n_polls = ucc_tl_ucp_task_polls(task);
+    uint32_t           polls   = 0;
     ucc_rank_t         peer;
     int                posts, nreqs;
     size_t             data_size;
@@ -44,8 +45,11 @@ void ucc_tl_ucp_alltoall_pairwise_progress(ucc_coll_task_t *coll_task)
                 ucc_dt_size(TASK_ARGS(task).src.info.datatype);
     while ((task->tagged.send_posted < gsize ||
             task->tagged.recv_posted < gsize) &&
-           (polls++ < task->n_polls)) {
-        ucp_worker_progress(UCC_TL_UCP_TEAM_CTX(team)->ucp_worker);
+           (polls++ < ucc_max(n_polls, 1))) {
+        /* n_polls == 0: worker was progressed by the context, only post */
+        if (n_polls) {
+            ucp_worker_progress(UCC_TL_UCP_TEAM_CTX(team)->ucp_worker);
+        }
         while ((task->tagged.recv_posted < gsize) &&
                ((task->tagged.recv_posted - task->tagged.recv_completed) <
                 nreqs)) {
@@ -70,7 +74,7 @@ void ucc_tl_ucp_alltoall_pairwise_progress(ucc_coll_task_t *coll_task)
         return;
     }
 
-    task->super.status = ucc_tl_ucp_test(task);
+    task->super.status = ucc_tl_ucp_test_polls(task, n_polls);
 out:
     if (task->super.status != UCC_INPROGRESS) {
         UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task,
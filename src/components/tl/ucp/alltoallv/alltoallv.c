@@ -7,6 +7,7 @@
 #include "config.h"
 #include "tl_ucp.h"
 #include "alltoallv.h"
+#include "tl_ucp_generic_dt.h"
 
 ucc_status_t ucc_tl_ucp_alltoallv_pairwise_start(ucc_coll_task_t *task);
 ucc_status_t ucc_tl_ucp_alltoallv_pairwise_progress(ucc_coll_task_t *task);
@@ -18,6 +19,11 @@ ucc_base_coll_alg_info_t
              .name = "pairwise",
              .desc = "O(N) pairwise exchange with adjustable number "
              "of outstanding sends/recvs"},
+        [UCC_TL_UCP_ALLTOALLV_ALG_ONESIDED] =
+            {.id   = UCC_TL_UCP_ALLTOALLV_ALG_ONESIDED,
+             .name = "onesided",
+             .desc = "O(N) zero copy exchange: receivers get their blocks "
+             "directly from the peers source buffers"},
         [UCC_TL_UCP_ALLTOALLV_ALG_LAST] = {
             .id = 0, .name = NULL, .desc = NULL}};
 
@@ -39,6 +45,11 @@ ucc_status_t ucc_tl_ucp_alltoallv_pairwise_init(ucc_base_coll_args_t *coll_args,
     ucc_tl_ucp_task_t *task;
     ucc_status_t       status;
 
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_alltoallv_pairwise_init,
+                                          task_h);
+    }
     ALLTOALLV_TASK_CHECK(coll_args->args, tl_team);
     task                 = ucc_tl_ucp_init_task(coll_args, team);
     *task_h              = &task->super;
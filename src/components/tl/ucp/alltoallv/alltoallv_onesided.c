@@ -0,0 +1,422 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "alltoallv.h"
+#include "core/ucc_progress_queue.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+#include "tl_ucp_sendrecv.h"
+#include "tl_ucp_rcache.h"
+
+/* One-sided alltoallv: in contrast to alltoall onesided it does not require
+   memory mapped at context creation nor global work buffer.
+
+   1. Every rank registers its source buffer through the registration cache
+      (or reuses the context mapped segment containing it) and sends to each
+      peer a small header with the address of the block destined to that
+      peer and the registration id followed by the packed rkey. Receiver
+      unpacks the rkey only if (peer, id) is not in the team rkey cache, so
+      repeated collectives on the same buffers do not register or unpack.
+   2. Receiver gets exactly its block from every peer directly into the
+      destination buffer. Number of outstanding gets is limited by
+      ALLTOALLV_ONESIDED_NUM_GETS.
+   3. Once all gets are completed receiver notifies the peers with zero
+      length message, source buffer is released when notifications from all
+      the peers arrived.
+
+   All the control messages use the tag of the collective, ordering of the
+   messages from the same sender guarantees header/rkey/fin are matched
+   correctly. */
+
+enum {
+    UCC_TL_UCP_A2AV_ONESIDED_PHASE_HDR,
+    UCC_TL_UCP_A2AV_ONESIDED_PHASE_KEYS,
+    UCC_TL_UCP_A2AV_ONESIDED_PHASE_GET,
+    UCC_TL_UCP_A2AV_ONESIDED_PHASE_FIN
+};
+
+typedef struct ucc_tl_ucp_a2av_onesided_hdr {
+    uint64_t va;
+    uint64_t key_len;
+    uint64_t reg_id;
+} ucc_tl_ucp_a2av_onesided_hdr_t;
+
+#define A2AV_TASK(_task) (&(_task)->alltoallv_onesided)
+
+#define A2AV_SEND_HDRS(_task)                                                  \
+    ((ucc_tl_ucp_a2av_onesided_hdr_t *)A2AV_TASK(_task)->scratch)
+
+#define A2AV_RECV_HDRS(_task, _size) (A2AV_SEND_HDRS(_task) + (_size))
+
+#define A2AV_RKEYS(_task, _size)                                               \
+    ((ucc_tl_ucp_rkey_t **)(A2AV_SEND_HDRS(_task) + 2 * (_size)))
+
+static void ucc_tl_ucp_alltoallv_onesided_get_cb(void *request,
+                                                 ucs_status_t status,
+                                                 void *user_data)
+{
+    ucc_tl_ucp_task_t *task = (ucc_tl_ucp_task_t *)user_data;
+
+    if (ucc_unlikely(UCS_OK != status)) {
+        tl_error(UCC_TASK_LIB(task), "failure in get completion %s",
+                 ucs_status_string(status));
+        task->super.status = ucs_status_to_ucc_status(status);
+    }
+    A2AV_TASK(task)->get_completed++;
+    ucp_request_free(request);
+}
+
+static size_t ucc_tl_ucp_alltoallv_onesided_src_len(ucc_tl_ucp_task_t *task)
+{
+    ucc_coll_args_t *args = &TASK_ARGS(task);
+    ucc_rank_t       size = UCC_TL_TEAM_SIZE(TASK_TEAM(task));
+    size_t           len  = 0;
+    size_t           count, displ;
+    ucc_rank_t       i;
+
+    for (i = 0; i < size; i++) {
+        count = ucc_coll_args_get_count(args, args->src.info_v.counts, i);
+        if (count == 0) {
+            continue;
+        }
+        displ = ucc_coll_args_get_displacement(args,
+                                               args->src.info_v.displacements,
+                                               i);
+        len   = ucc_max(len, displ + count);
+    }
+    return len * ucc_dt_size(args->src.info_v.datatype);
+}
+
+static ucc_status_t
+ucc_tl_ucp_alltoallv_onesided_pack_key(ucc_tl_ucp_task_t *task, void *addr,
+                                       size_t len)
+{
+    ucc_tl_ucp_context_t *ctx  = TASK_CTX(task);
+    ucc_status_t          status;
+    int                   i;
+
+    A2AV_TASK(task)->region         = NULL;
+    A2AV_TASK(task)->packed_key     = NULL;
+    A2AV_TASK(task)->packed_key_len = 0;
+    A2AV_TASK(task)->reg_id         = 0;
+    if (len == 0) {
+        return UCC_OK;
+    }
+    /* source buffer is a part of the segment mapped at context creation,
+       its key is already packed */
+    for (i = 0; i < ctx->n_rinfo_segs; i++) {
+        if ((ptrdiff_t)addr >= (ptrdiff_t)ctx->remote_info[i].va_base &&
+            (ptrdiff_t)addr + len <= (ptrdiff_t)ctx->remote_info[i].va_base +
+                                         ctx->remote_info[i].len) {
+            A2AV_TASK(task)->packed_key     = ctx->remote_info[i].packed_key;
+            A2AV_TASK(task)->packed_key_len =
+                ctx->remote_info[i].packed_key_len;
+            A2AV_TASK(task)->reg_id         = ctx->remote_info[i].id;
+            return UCC_OK;
+        }
+    }
+
+    status = ucc_tl_ucp_mem_reg(
+        ctx, addr, len, ucc_memtype_to_ucs[TASK_ARGS(task).src.info_v.mem_type],
+        &A2AV_TASK(task)->region);
+    if (ucc_unlikely(UCC_OK != status)) {
+        A2AV_TASK(task)->region = NULL;
+        return status;
+    }
+    A2AV_TASK(task)->packed_key     = A2AV_TASK(task)->region->packed_key;
+    A2AV_TASK(task)->packed_key_len = A2AV_TASK(task)->region->packed_key_len;
+    A2AV_TASK(task)->reg_id         = A2AV_TASK(task)->region->id;
+    return UCC_OK;
+}
+
+static void ucc_tl_ucp_alltoallv_onesided_release(ucc_tl_ucp_task_t *task)
+{
+    ucc_rank_t          size  = UCC_TL_TEAM_SIZE(TASK_TEAM(task));
+    ucc_tl_ucp_rkey_t **rkeys = A2AV_RKEYS(task, size);
+    ucc_rank_t          i;
+
+    for (i = 0; i < size; i++) {
+        if (rkeys[i]) {
+            ucc_tl_ucp_rkey_put(rkeys[i]);
+            rkeys[i] = NULL;
+        }
+    }
+    if (A2AV_TASK(task)->region) {
+        ucc_tl_ucp_mem_dereg(TASK_CTX(task), A2AV_TASK(task)->region);
+        A2AV_TASK(task)->region = NULL;
+    }
+    A2AV_TASK(task)->packed_key = NULL;
+    ucc_free(A2AV_TASK(task)->keys);
+    A2AV_TASK(task)->keys = NULL;
+}
+
+static ucc_status_t
+ucc_tl_ucp_alltoallv_onesided_post_gets(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_team_t              *team  = TASK_TEAM(task);
+    ucc_coll_args_t                *args  = &TASK_ARGS(task);
+    ucc_rank_t                      grank = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t                      gsize = UCC_TL_TEAM_SIZE(team);
+    ucc_tl_ucp_a2av_onesided_hdr_t *rhdrs = A2AV_RECV_HDRS(task, gsize);
+    ucc_tl_ucp_rkey_t             **rkeys = A2AV_RKEYS(task, gsize);
+    ptrdiff_t                       rbuf  = (ptrdiff_t)args->dst.info_v.buffer;
+    size_t                          rdt_size;
+    ucp_request_param_t             req_param;
+    ucs_status_ptr_t                ucp_status;
+    ucc_status_t                    status;
+    uint32_t                        nreqs;
+    size_t                          data_size, data_displ;
+    ucc_rank_t                      peer;
+    ucp_ep_h                        ep;
+
+    nreqs    = UCC_TL_UCP_TEAM_LIB(team)->cfg.alltoallv_onesided_num_gets;
+    nreqs    = (nreqs > gsize || nreqs == 0) ? gsize : nreqs;
+    rdt_size = ucc_dt_size(args->dst.info_v.datatype);
+
+    req_param.op_attr_mask = UCP_OP_ATTR_FIELD_CALLBACK |
+                             UCP_OP_ATTR_FIELD_USER_DATA |
+                             UCP_OP_ATTR_FIELD_MEMORY_TYPE;
+    req_param.cb.send      = ucc_tl_ucp_alltoallv_onesided_get_cb;
+    req_param.user_data    = (void *)task;
+    req_param.memory_type  = ucc_memtype_to_ucs[args->dst.info_v.mem_type];
+
+    while ((A2AV_TASK(task)->get_posted < gsize) &&
+           ((A2AV_TASK(task)->get_posted - A2AV_TASK(task)->get_completed) <
+            nreqs)) {
+        peer      = (grank + A2AV_TASK(task)->get_posted) % gsize;
+        data_size = ucc_coll_args_get_count(args, args->dst.info_v.counts,
+                                            peer) * rdt_size;
+        A2AV_TASK(task)->get_posted++;
+        if (data_size == 0) {
+            A2AV_TASK(task)->get_completed++;
+            continue;
+        }
+        data_displ = ucc_coll_args_get_displacement(
+                         args, args->dst.info_v.displacements, peer) *
+                     rdt_size;
+        status = ucc_tl_ucp_get_ep(team, peer, &ep);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+        if (!rkeys[peer]) {
+            status = ucc_tl_ucp_rkey_get(
+                team, peer, rhdrs[peer].reg_id,
+                PTR_OFFSET(A2AV_TASK(task)->keys, rhdrs[peer].key_len),
+                &rkeys[peer]);
+            if (ucc_unlikely(UCC_OK != status)) {
+                return status;
+            }
+        }
+        ucp_status = ucp_get_nbx(ep, (void *)(rbuf + data_displ), data_size,
+                                 rhdrs[peer].va, rkeys[peer]->rkey,
+                                 &req_param);
+        if (UCS_OK != ucp_status) {
+            if (UCS_PTR_IS_ERR(ucp_status)) {
+                return ucs_status_to_ucc_status(UCS_PTR_STATUS(ucp_status));
+            }
+        } else {
+            A2AV_TASK(task)->get_completed++;
+        }
+    }
+    return UCC_OK;
+}
+
+void ucc_tl_ucp_alltoallv_onesided_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t              *task  = ucc_derived_of(coll_task,
+                                                           ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t              *team  = TASK_TEAM(task);
+    ucc_rank_t                      gsize = UCC_TL_TEAM_SIZE(team);
+    ucc_tl_ucp_a2av_onesided_hdr_t *rhdrs = A2AV_RECV_HDRS(task, gsize);
+    uint32_t                        n_polls = ucc_tl_ucp_task_polls(task);
+    uint32_t                        polls   = 0;
+    size_t                          keys_len, key_len, offset;
+    ucc_rank_t                      peer;
+
+    switch (A2AV_TASK(task)->phase) {
+    case UCC_TL_UCP_A2AV_ONESIDED_PHASE_HDR:
+        if (task->tagged.recv_posted != task->tagged.recv_completed) {
+            if (n_polls) {
+                ucp_worker_progress(UCC_TL_UCP_TEAM_CTX(team)->ucp_worker);
+            }
+            return;
+        }
+        keys_len = 0;
+        for (peer = 0; peer < gsize; peer++) {
+            keys_len += rhdrs[peer].key_len;
+        }
+        A2AV_TASK(task)->keys = ucc_malloc(keys_len ? keys_len : 1,
+                                           "a2av_onesided_keys");
+        if (ucc_unlikely(!A2AV_TASK(task)->keys)) {
+            tl_error(UCC_TASK_LIB(task), "failed to allocate %zd bytes",
+                     keys_len);
+            task->super.status = UCC_ERR_NO_MEMORY;
+            goto out;
+        }
+        offset = 0;
+        for (peer = 0; peer < gsize; peer++) {
+            if (rhdrs[peer].key_len == 0) {
+                continue;
+            }
+            UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(PTR_OFFSET(A2AV_TASK(task)->keys,
+                                                        offset),
+                                             rhdrs[peer].key_len,
+                                             UCC_MEMORY_TYPE_HOST, peer, team,
+                                             task),
+                          task, out);
+            key_len = rhdrs[peer].key_len;
+            /* length is not needed anymore, keep offset of the key instead */
+            rhdrs[peer].key_len = offset;
+            offset             += key_len;
+        }
+        A2AV_TASK(task)->phase = UCC_TL_UCP_A2AV_ONESIDED_PHASE_KEYS;
+        /* fall through */
+    case UCC_TL_UCP_A2AV_ONESIDED_PHASE_KEYS:
+        if (task->tagged.recv_posted != task->tagged.recv_completed) {
+            if (n_polls) {
+                ucp_worker_progress(UCC_TL_UCP_TEAM_CTX(team)->ucp_worker);
+            }
+            return;
+        }
+        for (peer = 0; peer < gsize; peer++) {
+            UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(NULL, 0, UCC_MEMORY_TYPE_HOST,
+                                             peer, team, task),
+                          task, out);
+        }
+        A2AV_TASK(task)->phase = UCC_TL_UCP_A2AV_ONESIDED_PHASE_GET;
+        /* fall through */
+    case UCC_TL_UCP_A2AV_ONESIDED_PHASE_GET:
+        while (A2AV_TASK(task)->get_completed < gsize) {
+            UCPCHECK_GOTO(ucc_tl_ucp_alltoallv_onesided_post_gets(task), task,
+                          out);
+            if (A2AV_TASK(task)->get_completed == gsize) {
+                break;
+            }
+            if (polls++ == n_polls) {
+                return;
+            }
+            ucp_worker_progress(UCC_TL_UCP_TEAM_CTX(team)->ucp_worker);
+        }
+        for (peer = 0; peer < gsize; peer++) {
+            UCPCHECK_GOTO(ucc_tl_ucp_send_nb(NULL, 0, UCC_MEMORY_TYPE_HOST,
+                                             peer, team, task),
+                          task, out);
+        }
+        A2AV_TASK(task)->phase = UCC_TL_UCP_A2AV_ONESIDED_PHASE_FIN;
+        /* fall through */
+    case UCC_TL_UCP_A2AV_ONESIDED_PHASE_FIN:
+        if (UCC_INPROGRESS == ucc_tl_ucp_test_polls(task, n_polls)) {
+            return;
+        }
+        break;
+    }
+    ucc_tl_ucp_alltoallv_onesided_release(task);
+    task->super.status = UCC_OK;
+out:
+    if (task->super.status != UCC_INPROGRESS) {
+        UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task,
+                                         "ucp_alltoallv_onesided_done", 0);
+    }
+}
+
+ucc_status_t ucc_tl_ucp_alltoallv_onesided_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t              *task  = ucc_derived_of(coll_task,
+                                                           ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t              *team  = TASK_TEAM(task);
+    ucc_coll_args_t                *args  = &TASK_ARGS(task);
+    ucc_rank_t                      gsize = UCC_TL_TEAM_SIZE(team);
+    ucc_tl_ucp_a2av_onesided_hdr_t *shdrs = A2AV_SEND_HDRS(task);
+    ucc_tl_ucp_a2av_onesided_hdr_t *rhdrs = A2AV_RECV_HDRS(task, gsize);
+    ptrdiff_t                       sbuf  = (ptrdiff_t)args->src.info_v.buffer;
+    size_t                          sdt_size;
+    ucc_status_t                    status;
+    ucc_rank_t                      peer;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_alltoallv_onesided_start",
+                                     0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    A2AV_TASK(task)->phase         = UCC_TL_UCP_A2AV_ONESIDED_PHASE_HDR;
+    A2AV_TASK(task)->get_posted    = 0;
+    A2AV_TASK(task)->get_completed = 0;
+
+    status = ucc_tl_ucp_alltoallv_onesided_pack_key(
+        task, (void *)sbuf, ucc_tl_ucp_alltoallv_onesided_src_len(task));
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    sdt_size = ucc_dt_size(args->src.info_v.datatype);
+    for (peer = 0; peer < gsize; peer++) {
+        shdrs[peer].va      = sbuf + ucc_coll_args_get_displacement(
+                                         args, args->src.info_v.displacements,
+                                         peer) * sdt_size;
+        shdrs[peer].key_len = A2AV_TASK(task)->packed_key_len;
+        shdrs[peer].reg_id  = A2AV_TASK(task)->reg_id;
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(&rhdrs[peer], sizeof(*rhdrs),
+                                         UCC_MEMORY_TYPE_HOST, peer, team,
+                                         task),
+                      task, out);
+    }
+    for (peer = 0; peer < gsize; peer++) {
+        UCPCHECK_GOTO(ucc_tl_ucp_send_nb(&shdrs[peer], sizeof(*shdrs),
+                                         UCC_MEMORY_TYPE_HOST, peer, team,
+                                         task),
+                      task, out);
+        if (A2AV_TASK(task)->packed_key_len) {
+            UCPCHECK_GOTO(ucc_tl_ucp_send_nb(A2AV_TASK(task)->packed_key,
+                                             A2AV_TASK(task)->packed_key_len,
+                                             UCC_MEMORY_TYPE_HOST, peer, team,
+                                             task),
+                          task, out);
+        }
+    }
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+out:
+    return task->super.status;
+}
+
+ucc_status_t ucc_tl_ucp_alltoallv_onesided_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+
+    /* resources are still held if the collective failed */
+    ucc_tl_ucp_alltoallv_onesided_release(task);
+    ucc_free(A2AV_TASK(task)->scratch);
+    return ucc_tl_ucp_coll_finalize(coll_task);
+}
+
+ucc_status_t ucc_tl_ucp_alltoallv_onesided_init(ucc_base_coll_args_t *coll_args,
+                                                ucc_base_team_t      *team,
+                                                ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_rank_t         gsize   = UCC_TL_TEAM_SIZE(tl_team);
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+
+    ALLTOALLV_TASK_CHECK(coll_args->args, tl_team);
+    task = ucc_tl_ucp_init_task(coll_args, team);
+    A2AV_TASK(task)->keys       = NULL;
+    A2AV_TASK(task)->region     = NULL;
+    A2AV_TASK(task)->packed_key = NULL;
+    A2AV_TASK(task)->scratch    =
+        ucc_calloc(gsize, 2 * sizeof(ucc_tl_ucp_a2av_onesided_hdr_t) +
+                          sizeof(ucc_tl_ucp_rkey_t *), "a2av_onesided_scratch");
+    if (ucc_unlikely(!A2AV_TASK(task)->scratch)) {
+        tl_error(UCC_TASK_LIB(task), "failed to allocate scratch");
+        ucc_tl_ucp_put_task(task);
+        return UCC_ERR_NO_MEMORY;
+    }
+    task->super.post     = ucc_tl_ucp_alltoallv_onesided_start;
+    task->super.progress = ucc_tl_ucp_alltoallv_onesided_progress;
+    task->super.finalize = ucc_tl_ucp_alltoallv_onesided_finalize;
+    *task_h              = &task->super;
+    status               = UCC_OK;
+out:
+    return status;
+}
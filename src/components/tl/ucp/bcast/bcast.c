@@ -6,6 +6,7 @@
 #include "config.h"
 #include "tl_ucp.h"
 #include "bcast.h"
+#include "tl_ucp_generic_dt.h"
 
 ucc_base_coll_alg_info_t
     ucc_tl_ucp_bcast_algs[UCC_TL_UCP_BCAST_ALG_LAST + 1] = {
@@ -42,6 +43,11 @@ ucc_status_t ucc_tl_ucp_bcast_knomial_init(ucc_base_coll_args_t *coll_args,
     ucc_tl_ucp_task_t *task;
     ucc_status_t       status;
 
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_bcast_knomial_init,
+                                          task_h);
+    }
     task    = ucc_tl_ucp_init_task(coll_args, team);
     status  = ucc_tl_ucp_bcast_init(task);
     *task_h = &task->super;
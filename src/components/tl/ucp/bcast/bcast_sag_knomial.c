@@ -15,6 +15,7 @@
 #include "components/mc/ucc_mc.h"
 #include "../scatter/scatter.h"
 #include "../allgather/allgather.h"
+#include "tl_ucp_generic_dt.h"
 
 /* SAG - scatter-allgather knomial algorithm
    1. The algorithm performs collective bcast operation for large messages
@@ -67,6 +68,11 @@ ucc_tl_ucp_bcast_sag_knomial_init(ucc_base_coll_args_t *coll_args,
     ucc_status_t         status;
     ucc_kn_radix_t       radix, cfg_radix;
 
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_bcast_sag_knomial_init,
+                                          task_h);
+    }
     if (UCC_COLL_ARGS_ACTIVE_SET(&coll_args->args)) {
         /* ActiveSets currently are only supported with KN alg */
         return ucc_tl_ucp_bcast_knomial_init(coll_args, team, task_h);
@@ -91,9 +97,15 @@ ucc_tl_ucp_bcast_sag_knomial_init(ucc_base_coll_args_t *coll_args,
                  "failed to init scatter_knomial task");
         goto out;
     }
-    ucc_schedule_add_task(schedule, task);
-    ucc_event_manager_subscribe(&schedule->super.em, UCC_EVENT_SCHEDULE_STARTED,
-                                task, ucc_task_start_handler);
+    status = ucc_schedule_add_task(schedule, task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        task->finalize(task);
+        goto out;
+    }
+    UCC_CHECK_GOTO(ucc_event_manager_subscribe(&schedule->super.em,
+                                               UCC_EVENT_SCHEDULE_STARTED,
+                                               task, ucc_task_start_handler),
+                   err, status);
     rs_task = task;
 
     /* 2nd step of bcast: knomial allgather. 2nd task subscribes
@@ -104,12 +116,18 @@ ucc_tl_ucp_bcast_sag_knomial_init(ucc_base_coll_args_t *coll_args,
     if (UCC_OK != status) {
         tl_error(UCC_TL_TEAM_LIB(tl_team),
                  "failed to init allgather_knomial task");
-        goto out;
+        goto err;
     }
 
-    ucc_schedule_add_task(schedule, task);
-    ucc_event_manager_subscribe(&rs_task->em, UCC_EVENT_COMPLETED, task,
-                                ucc_task_start_handler);
+    status = ucc_schedule_add_task(schedule, task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        task->finalize(task);
+        goto err;
+    }
+    UCC_CHECK_GOTO(ucc_event_manager_subscribe(&rs_task->em,
+                                               UCC_EVENT_COMPLETED, task,
+                                               ucc_task_start_handler),
+                   err, status);
 
     schedule->super.post           = ucc_tl_ucp_bcast_sag_knomial_start;
     schedule->super.progress       = NULL;
@@ -117,6 +135,8 @@ ucc_tl_ucp_bcast_sag_knomial_init(ucc_base_coll_args_t *coll_args,
     schedule->super.triggered_post = ucc_triggered_post;
     *task_h                        = &schedule->super;
     return UCC_OK;
+err:
+    ucc_schedule_finalize(&schedule->super);
 out:
     ucc_tl_ucp_put_schedule(schedule);
     return status;
@@ -6,6 +6,7 @@
 
 #include "config.h"
 #include "gather.h"
+#include "tl_ucp_generic_dt.h"
 
 ucc_base_coll_alg_info_t
     ucc_tl_ucp_gather_algs[UCC_TL_UCP_GATHER_ALG_LAST + 1] = {
@@ -14,6 +15,16 @@ ucc_base_coll_alg_info_t
              .name = "knomial",
              .desc = "gather over knomial tree with arbitrary radix "
                      "(optimized for latency)"},
+        [UCC_TL_UCP_GATHER_ALG_SEG_KNOMIAL] =
+            {.id   = UCC_TL_UCP_GATHER_ALG_SEG_KNOMIAL,
+             .name = "seg_knomial",
+             .desc = "gather over knomial tree forwarding subtree data in "
+                     "segments with bounded scratch, linear for large blocks"},
+        [UCC_TL_UCP_GATHER_ALG_LINEAR] =
+            {.id   = UCC_TL_UCP_GATHER_ALG_LINEAR,
+             .name = "linear",
+             .desc = "linear gather with bounded receive window at root "
+                     "(optimized for large blocks)"},
         [UCC_TL_UCP_GATHER_ALG_LAST] = {
             .id = 0, .name = NULL, .desc = NULL}};
 
@@ -76,3 +87,25 @@ ucc_status_t ucc_tl_ucp_gather_init(ucc_tl_ucp_task_t *task)
 
     return status;
 }
+
+ucc_status_t ucc_tl_ucp_gather_knomial_init(ucc_base_coll_args_t *coll_args,
+                                            ucc_base_team_t      *team,
+                                            ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_gather_knomial_init,
+                                          task_h);
+    }
+    task   = ucc_tl_ucp_init_task(coll_args, team);
+    status = ucc_tl_ucp_gather_init(task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        ucc_tl_ucp_put_task(task);
+        return status;
+    }
+    *task_h = &task->super;
+    return UCC_OK;
+}
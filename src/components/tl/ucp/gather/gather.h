@@ -11,12 +11,30 @@
 
 enum {
     UCC_TL_UCP_GATHER_ALG_KNOMIAL,
+    UCC_TL_UCP_GATHER_ALG_SEG_KNOMIAL,
+    UCC_TL_UCP_GATHER_ALG_LINEAR,
     UCC_TL_UCP_GATHER_ALG_LAST
 };
 
 extern ucc_base_coll_alg_info_t
              ucc_tl_ucp_gather_algs[UCC_TL_UCP_GATHER_ALG_LAST + 1];
 
+/* segmented knomial switches to linear itself once the per rank block
+   reaches GATHER_LINEAR_BLOCK_SIZE */
+#define UCC_TL_UCP_GATHER_DEFAULT_ALG_SELECT_STR                               \
+    "gather:0-256k:@0#gather:256k-inf:@1"
+
+static inline int ucc_tl_ucp_gather_alg_from_str(const char *str)
+{
+    int i;
+    for (i = 0; i < UCC_TL_UCP_GATHER_ALG_LAST; i++) {
+        if (0 == strcasecmp(str, ucc_tl_ucp_gather_algs[i].name)) {
+            break;
+        }
+    }
+    return i;
+}
+
 /* A set of convenience macros used to implement sw based progress
    of the gather algorithm that uses kn pattern */
 enum
@@ -45,4 +63,16 @@ void ucc_tl_ucp_gather_knomial_progress(ucc_coll_task_t *task);
 
 ucc_status_t ucc_tl_ucp_gather_knomial_finalize(ucc_coll_task_t *task);
 
+ucc_status_t ucc_tl_ucp_gather_knomial_init(ucc_base_coll_args_t *coll_args,
+                                            ucc_base_team_t      *team,
+                                            ucc_coll_task_t     **task_h);
+
+ucc_status_t ucc_tl_ucp_gather_seg_knomial_init(ucc_base_coll_args_t *coll_args,
+                                                ucc_base_team_t      *team,
+                                                ucc_coll_task_t     **task_h);
+
+ucc_status_t ucc_tl_ucp_gather_linear_init(ucc_base_coll_args_t *coll_args,
+                                           ucc_base_team_t      *team,
+                                           ucc_coll_task_t     **task_h);
+
 #endif
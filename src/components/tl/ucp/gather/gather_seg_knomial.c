@@ -0,0 +1,253 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "gather.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "tl_ucp_generic_dt.h"
+#include "components/mc/ucc_mc.h"
+#include "utils/ucc_math.h"
+
+/* Segmented knomial gather: every block is split into n_segs segments and
+   the data of a subtree travels to the parent as a stream of
+   subtree_size * n_segs messages ordered by vrank, own block first. Interior
+   ranks relay the streams of their children segment by segment through
+   2 banks of "window" segments: at step k batch k - 1 is sent to the parent
+   from one bank while batch k is received from the children into the
+   other one. Root receives directly into dst and non-root ranks never hold
+   more than 2 * window segments, independently of the subtree size.
+   With radix >= team size the tree is flat, that is linear gather with a
+   window of outstanding receives at root. */
+
+static inline void ucc_tl_ucp_gather_seg_msg(ucc_tl_ucp_task_t *task,
+                                             ucc_rank_t vrank, size_t msg,
+                                             ucc_rank_t *vblock,
+                                             size_t *offset, size_t *count)
+{
+    *vblock = vrank + msg / task->gather_seg.n_segs;
+    *offset = (msg % task->gather_seg.n_segs) * task->gather_seg.seg_count;
+    *count  = ucc_min(task->gather_seg.seg_count,
+                      task->gather_seg.block_count - *offset);
+}
+
+static inline void *ucc_tl_ucp_gather_seg_slot(ucc_tl_ucp_task_t *task,
+                                               size_t msg, size_t dt_size)
+{
+    size_t window = task->gather_seg.window;
+
+    return PTR_OFFSET(task->gather_seg.scratch,
+                      ((msg / window) % 2 * window + msg % window) *
+                          task->gather_seg.seg_count * dt_size);
+}
+
+static void ucc_tl_ucp_gather_seg_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task     = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args     = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team     = TASK_TEAM(task);
+    ucc_rank_t         size     = UCC_TL_TEAM_SIZE(team);
+    ucc_rank_t         root     = (ucc_rank_t)args->root;
+    ucc_rank_t         vrank    = VRANK(UCC_TL_TEAM_RANK(team), root, size);
+    uint32_t           radix    = task->gather_seg.radix;
+    size_t             window   = task->gather_seg.window;
+    size_t             n_segs   = task->gather_seg.n_segs;
+    size_t             n_msgs   = task->gather_seg.n_msgs;
+    size_t             n_steps  = ucc_div_round_up(n_msgs, window);
+    ucc_datatype_t     dt       = (vrank == 0) ? args->dst.info.datatype
+                                               : args->src.info.datatype;
+    ucc_memory_type_t  mem_type = (vrank == 0) ? args->dst.info.mem_type
+                                               : args->src.info.mem_type;
+    size_t             dt_size  = ucc_dt_size(dt);
+    ucc_rank_t         vblock, peer;
+    size_t             msg, k, offset, count;
+    void              *buf;
+
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        return;
+    }
+    while (task->gather_seg.step <= n_steps) {
+        k = task->gather_seg.step;
+        if (vrank != 0 && k > 0) {
+            peer = INV_VRANK(ucc_kn_tree_parent(vrank, radix), root, size);
+            for (msg = (k - 1) * window; msg < ucc_min(k * window, n_msgs);
+                 msg++) {
+                ucc_tl_ucp_gather_seg_msg(task, vrank, msg, &vblock, &offset,
+                                          &count);
+                buf = (msg < n_segs)
+                          ? PTR_OFFSET(args->src.info.buffer, offset * dt_size)
+                          : ucc_tl_ucp_gather_seg_slot(task, msg, dt_size);
+                UCPCHECK_GOTO(ucc_tl_ucp_send_nb(buf, count * dt_size,
+                                                 mem_type, peer, team, task),
+                              task, out);
+            }
+        }
+        for (msg = ucc_max(k * window, n_segs);
+             msg < ucc_min((k + 1) * window, n_msgs); msg++) {
+            ucc_tl_ucp_gather_seg_msg(task, vrank, msg, &vblock, &offset,
+                                      &count);
+            peer = INV_VRANK(ucc_kn_tree_child(vrank, vblock, radix), root,
+                             size);
+            buf  = (vrank == 0)
+                       ? PTR_OFFSET(args->dst.info.buffer,
+                                    (INV_VRANK(vblock, root, size) *
+                                         task->gather_seg.block_count +
+                                     offset) * dt_size)
+                       : ucc_tl_ucp_gather_seg_slot(task, msg, dt_size);
+            UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(buf, count * dt_size, mem_type,
+                                             peer, team, task),
+                          task, out);
+        }
+        task->gather_seg.step++;
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            return;
+        }
+    }
+    ucc_assert(UCC_TL_UCP_TASK_P2P_COMPLETE(task));
+    task->super.status = UCC_OK;
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_gather_seg_done", 0);
+out:
+    return;
+}
+
+static ucc_status_t ucc_tl_ucp_gather_seg_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    ucc_rank_t         rank = UCC_TL_TEAM_RANK(team);
+    size_t             dt_size;
+    ucc_status_t       status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_gather_seg_start", 0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    task->gather_seg.step = 0;
+
+    if (rank == args->root && !UCC_IS_INPLACE(*args)) {
+        dt_size = ucc_dt_size(args->dst.info.datatype);
+        status  = ucc_mc_memcpy(
+            PTR_OFFSET(args->dst.info.buffer,
+                       rank * task->gather_seg.block_count * dt_size),
+            args->src.info.buffer, task->gather_seg.block_count * dt_size,
+            args->dst.info.mem_type, args->src.info.mem_type);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
+static ucc_status_t ucc_tl_ucp_gather_seg_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+
+    if (task->gather_seg.scratch_mc_header) {
+        ucc_mc_free(task->gather_seg.scratch_mc_header);
+    }
+    return ucc_tl_ucp_coll_finalize(coll_task);
+}
+
+static ucc_status_t ucc_tl_ucp_gather_seg_init_r(ucc_base_coll_args_t *coll_args,
+                                                 ucc_base_team_t      *team,
+                                                 ucc_coll_task_t     **task_h,
+                                                 uint32_t              radix)
+{
+    ucc_tl_ucp_team_t       *tl_team  = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_lib_config_t *cfg      = &UCC_TL_UCP_TEAM_LIB(tl_team)->cfg;
+    ucc_coll_args_t         *args     = &coll_args->args;
+    ucc_rank_t               size     = UCC_TL_TEAM_SIZE(tl_team);
+    ucc_rank_t               rank     = UCC_TL_TEAM_RANK(tl_team);
+    ucc_rank_t               vrank    = VRANK(rank, args->root, size);
+    int                      is_root  = (rank == args->root);
+    ucc_datatype_t           dt       = is_root ? args->dst.info.datatype
+                                                : args->src.info.datatype;
+    ucc_memory_type_t        mem_type = is_root ? args->dst.info.mem_type
+                                                : args->src.info.mem_type;
+    size_t                   count    = is_root ? args->dst.info.count / size
+                                                : args->src.info.count;
+    size_t                   dt_size  = ucc_dt_size(dt);
+    ucc_tl_ucp_task_t       *task;
+    ucc_rank_t               subtree;
+    ucc_status_t             status;
+
+    task                 = ucc_tl_ucp_init_task(coll_args, team);
+    task->super.post     = ucc_tl_ucp_gather_seg_start;
+    task->super.progress = ucc_tl_ucp_gather_seg_progress;
+    task->super.finalize = ucc_tl_ucp_gather_seg_finalize;
+
+    subtree = ucc_kn_tree_subtree_size(vrank, radix, size);
+    task->gather_seg.radix       = radix;
+    task->gather_seg.block_count = count;
+    task->gather_seg.seg_count   =
+        ucc_min(ucc_max(cfg->gather_seg_size / dt_size, 1), ucc_max(count, 1));
+    task->gather_seg.n_segs      =
+        ucc_div_round_up(count, task->gather_seg.seg_count);
+    task->gather_seg.window      = ucc_max(cfg->gather_seg_window, 1);
+    task->gather_seg.n_msgs      = subtree * task->gather_seg.n_segs;
+    task->gather_seg.scratch           = NULL;
+    task->gather_seg.scratch_mc_header = NULL;
+
+    if (vrank != 0 && subtree > 1 && count > 0) {
+        status = ucc_mc_alloc(&task->gather_seg.scratch_mc_header,
+                              2 * task->gather_seg.window *
+                                  task->gather_seg.seg_count * dt_size,
+                              mem_type);
+        if (ucc_unlikely(UCC_OK != status)) {
+            ucc_tl_ucp_put_task(task);
+            return status;
+        }
+        task->gather_seg.scratch = task->gather_seg.scratch_mc_header->addr;
+    }
+    *task_h = &task->super;
+    return UCC_OK;
+}
+
+ucc_status_t ucc_tl_ucp_gather_seg_knomial_init(ucc_base_coll_args_t *coll_args,
+                                                ucc_base_team_t      *team,
+                                                ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t       *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_lib_config_t *cfg     = &UCC_TL_UCP_TEAM_LIB(tl_team)->cfg;
+    ucc_coll_args_t         *args    = &coll_args->args;
+    ucc_rank_t               size    = UCC_TL_TEAM_SIZE(tl_team);
+    uint32_t                 radix;
+    size_t                   block_size;
+
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_gather_seg_knomial_init,
+                                          task_h);
+    }
+    if (UCC_TL_TEAM_RANK(tl_team) == args->root) {
+        block_size = args->dst.info.count / size *
+                     ucc_dt_size(args->dst.info.datatype);
+    } else {
+        block_size = args->src.info.count *
+                     ucc_dt_size(args->src.info.datatype);
+    }
+    if (block_size >= cfg->gather_linear_block_size) {
+        radix = ucc_max(size, 2);
+    } else {
+        radix = ucc_max(ucc_min(cfg->gather_kn_radix, size), 2);
+    }
+    return ucc_tl_ucp_gather_seg_init_r(coll_args, team, task_h, radix);
+}
+
+ucc_status_t ucc_tl_ucp_gather_linear_init(ucc_base_coll_args_t *coll_args,
+                                           ucc_base_team_t      *team,
+                                           ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_gather_linear_init,
+                                          task_h);
+    }
+    return ucc_tl_ucp_gather_seg_init_r(
+        coll_args, team, task_h, ucc_max(UCC_TL_TEAM_SIZE(tl_team), 2));
+}
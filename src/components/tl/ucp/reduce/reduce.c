@@ -13,6 +13,16 @@ ucc_base_coll_alg_info_t
              .name = "knomial",
              .desc = "reduce over knomial tree with arbitrary radix "
                      "(optimized for latency)"},
+        [UCC_TL_UCP_REDUCE_ALG_SRG_KNOMIAL] =
+            {.id   = UCC_TL_UCP_REDUCE_ALG_SRG_KNOMIAL,
+             .name = "srg_knomial",
+             .desc = "recursive knomial scatter-reduce followed by knomial "
+                     "gather (optimized for BW)"},
+        [UCC_TL_UCP_REDUCE_ALG_CHAIN] =
+            {.id   = UCC_TL_UCP_REDUCE_ALG_CHAIN,
+             .name = "chain",
+             .desc = "segmented chain (optimized for BW of very large "
+                     "vectors)"},
         [UCC_TL_UCP_REDUCE_ALG_LAST] = {
             .id = 0, .name = NULL, .desc = NULL}};
 
@@ -66,3 +76,20 @@ ucc_status_t ucc_tl_ucp_reduce_init(ucc_tl_ucp_task_t *task)
 
     return status;
 }
+
+ucc_status_t ucc_tl_ucp_reduce_knomial_init(ucc_base_coll_args_t *coll_args,
+                                            ucc_base_team_t      *team,
+                                            ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+
+    task   = ucc_tl_ucp_init_task(coll_args, team);
+    status = ucc_tl_ucp_reduce_init(task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        ucc_tl_ucp_put_task(task);
+        return status;
+    }
+    *task_h = &task->super;
+    return UCC_OK;
+}
@@ -9,12 +9,32 @@
 
 enum {
     UCC_TL_UCP_REDUCE_ALG_KNOMIAL,
+    UCC_TL_UCP_REDUCE_ALG_SRG_KNOMIAL,
+    UCC_TL_UCP_REDUCE_ALG_CHAIN,
     UCC_TL_UCP_REDUCE_ALG_LAST
 };
 
 extern ucc_base_coll_alg_info_t
              ucc_tl_ucp_reduce_algs[UCC_TL_UCP_REDUCE_ALG_LAST + 1];
 
+/* chain is used for very large vectors on small teams only, its latency
+   grows linearly with the team size. It needs at least 2 ranks */
+#define UCC_TL_UCP_REDUCE_DEFAULT_ALG_SELECT_STR                               \
+    "reduce:0-64k:@0#reduce:64k-32M:@1"                                        \
+    "#reduce:32M-inf:@1:team_size=1#reduce:32M-inf:@1:team_size=17-inf"        \
+    "#reduce:32M-inf:@2:team_size=2-16"
+
+static inline int ucc_tl_ucp_reduce_alg_from_str(const char *str)
+{
+    int i;
+    for (i = 0; i < UCC_TL_UCP_REDUCE_ALG_LAST; i++) {
+        if (0 == strcasecmp(str, ucc_tl_ucp_reduce_algs[i].name)) {
+            break;
+        }
+    }
+    return i;
+}
+
 /* A set of convenience macros used to implement sw based progress
    of the reduce algorithm that uses kn pattern */
 enum {
@@ -44,4 +64,18 @@ void ucc_tl_ucp_reduce_knomial_progress(ucc_coll_task_t *task);
 
 ucc_status_t ucc_tl_ucp_reduce_knomial_finalize(ucc_coll_task_t *task);
 
+ucc_status_t ucc_tl_ucp_reduce_knomial_init(ucc_base_coll_args_t *coll_args,
+                                            ucc_base_team_t      *team,
+                                            ucc_coll_task_t     **task_h);
+
+/* Reduce-scatter + gather, uses reduce_srg_kn_radix from config */
+ucc_status_t
+ucc_tl_ucp_reduce_srg_knomial_init(ucc_base_coll_args_t *coll_args,
+                                   ucc_base_team_t      *team,
+                                   ucc_coll_task_t     **task_h);
+
+ucc_status_t ucc_tl_ucp_reduce_chain_init(ucc_base_coll_args_t *coll_args,
+                                          ucc_base_team_t      *team,
+                                          ucc_coll_task_t     **task_h);
+
 #endif
@@ -0,0 +1,260 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "reduce.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "components/mc/ucc_mc.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+#include "utils/ucc_dt_reduce.h"
+
+/* Segmented chain reduce: ranks form a chain ordered by virtual rank with
+   the root at the head. Vector is split into segments of
+   REDUCE_CHAIN_SEG_SIZE, every rank receives a segment from the next rank
+   of the chain, reduces it with the local one and forwards the result to
+   the previous rank. Every link carries the vector only once, so for very
+   large vectors the time is close to one vector transfer plus the chain
+   latency. */
+
+static inline ucc_status_t ucc_tl_ucp_test_chain(ucc_tl_ucp_task_t *task)
+{
+    uint32_t polls   = 0;
+    uint32_t n_polls = ucc_tl_ucp_task_polls(task);
+
+    while (!(task->tagged.send_posted - task->tagged.send_completed <= 1 &&
+             task->tagged.recv_posted == task->tagged.recv_completed)) {
+        if (polls++ == n_polls) {
+            return UCC_INPROGRESS;
+        }
+        ucp_worker_progress(TASK_CTX(task)->ucp_worker);
+    }
+    return UCC_OK;
+}
+
+static inline void ucc_tl_ucp_reduce_chain_seg(ucc_tl_ucp_task_t *task,
+                                               size_t count, size_t seg,
+                                               size_t *seg_offset,
+                                               size_t *seg_count)
+{
+    *seg_offset = seg * task->reduce_chain.seg_count;
+    *seg_count  = ucc_min(task->reduce_chain.seg_count, count - *seg_offset);
+}
+
+static void ucc_tl_ucp_reduce_chain_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task     = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args     = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team     = TASK_TEAM(task);
+    ucc_rank_t         rank     = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t         size     = UCC_TL_TEAM_SIZE(team);
+    ucc_rank_t         root     = (ucc_rank_t)args->root;
+    ucc_rank_t         vrank    = VRANK(rank, root, size);
+    ucc_rank_t         sendto   = INV_VRANK(vrank - 1, root, size);
+    int                is_root  = (rank == root);
+    ucc_datatype_t     dt       = is_root ? args->dst.info.datatype
+                                          : args->src.info.datatype;
+    ucc_memory_type_t  mem_type = is_root ? args->dst.info.mem_type
+                                          : args->src.info.mem_type;
+    size_t             count    = is_root ? args->dst.info.count
+                                          : args->src.info.count;
+    size_t             dt_size  = ucc_dt_size(dt);
+    size_t             seg_size = task->reduce_chain.seg_count * dt_size;
+    void              *sbuf     = (is_root && UCC_IS_INPLACE(*args)) ?
+        args->dst.info.buffer : args->src.info.buffer;
+    void              *r_scratch = task->reduce_chain.scratch;
+    ucc_rank_t         recvfrom;
+    size_t             seg_offset, seg_count;
+    void              *target;
+    ucc_status_t       status;
+
+    if (vrank == size - 1) {
+        /* tail of the chain: all segments were sent at start */
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            return;
+        }
+        task->super.status = UCC_OK;
+        return;
+    }
+    recvfrom = INV_VRANK(vrank + 1, root, size);
+    if (UCC_INPROGRESS == ucc_tl_ucp_test_chain(task)) {
+        return;
+    }
+    while (task->reduce_chain.step < task->reduce_chain.n_segs) {
+        /* at most 1 send is in flight, so the send scratch of step - 2
+           is free */
+        ucc_tl_ucp_reduce_chain_seg(task, count, task->reduce_chain.step,
+                                    &seg_offset, &seg_count);
+        target = is_root ? PTR_OFFSET(args->dst.info.buffer,
+                                      seg_offset * dt_size)
+                         : PTR_OFFSET(r_scratch, seg_size *
+                                      (1 + task->reduce_chain.step % 2));
+        status = ucc_dt_reduce(r_scratch,
+                               PTR_OFFSET(sbuf, seg_offset * dt_size), target,
+                               seg_count, dt, args,
+                               (is_root && args->op == UCC_OP_AVG)
+                                   ? UCC_EEE_TASK_FLAG_REDUCE_WITH_ALPHA
+                                   : 0,
+                               AVG_ALPHA(task), task->reduce_chain.executor,
+                               &task->reduce_chain.etask);
+        if (ucc_unlikely(UCC_OK != status)) {
+            tl_error(UCC_TASK_LIB(task), "failed to perform dt reduction");
+            task->super.status = status;
+            return;
+        }
+        EXEC_TASK_WAIT(task->reduce_chain.etask);
+        if (!is_root) {
+            UCPCHECK_GOTO(ucc_tl_ucp_send_nb(target, seg_count * dt_size,
+                                             mem_type, sendto, team, task),
+                          task, out);
+        }
+        task->reduce_chain.step++;
+        if (task->reduce_chain.step < task->reduce_chain.n_segs) {
+            ucc_tl_ucp_reduce_chain_seg(task, count, task->reduce_chain.step,
+                                        &seg_offset, &seg_count);
+            UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(r_scratch, seg_count * dt_size,
+                                             mem_type, recvfrom, team, task),
+                          task, out);
+        }
+        if (UCC_INPROGRESS == ucc_tl_ucp_test_chain(task)) {
+            return;
+        }
+    }
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        return;
+    }
+    task->super.status = UCC_OK;
+out:
+    return;
+}
+
+static ucc_status_t ucc_tl_ucp_reduce_chain_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task     = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args     = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team     = TASK_TEAM(task);
+    ucc_rank_t         rank     = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t         size     = UCC_TL_TEAM_SIZE(team);
+    ucc_rank_t         root     = (ucc_rank_t)args->root;
+    ucc_rank_t         vrank    = VRANK(rank, root, size);
+    int                is_root  = (rank == root);
+    ucc_datatype_t     dt       = is_root ? args->dst.info.datatype
+                                          : args->src.info.datatype;
+    ucc_memory_type_t  mem_type = is_root ? args->dst.info.mem_type
+                                          : args->src.info.mem_type;
+    size_t             count    = is_root ? args->dst.info.count
+                                          : args->src.info.count;
+    size_t             dt_size  = ucc_dt_size(dt);
+    size_t             seg, seg_offset, seg_count;
+    ucc_status_t       status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_reduce_chain_start", 0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    task->reduce_chain.step  = 0;
+    task->reduce_chain.etask = NULL;
+    status = ucc_coll_task_get_executor(&task->super,
+                                        &task->reduce_chain.executor);
+    if (ucc_unlikely(status != UCC_OK)) {
+        return status;
+    }
+
+    if (vrank == size - 1) {
+        for (seg = 0; seg < task->reduce_chain.n_segs; seg++) {
+            ucc_tl_ucp_reduce_chain_seg(task, count, seg, &seg_offset,
+                                        &seg_count);
+            UCPCHECK_GOTO(ucc_tl_ucp_send_nb(
+                              PTR_OFFSET(args->src.info.buffer,
+                                         seg_offset * dt_size),
+                              seg_count * dt_size, mem_type,
+                              INV_VRANK(vrank - 1, root, size), team, task),
+                          task, out);
+        }
+    } else if (task->reduce_chain.n_segs > 0) {
+        ucc_tl_ucp_reduce_chain_seg(task, count, 0, &seg_offset, &seg_count);
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(task->reduce_chain.scratch,
+                                         seg_count * dt_size, mem_type,
+                                         INV_VRANK(vrank + 1, root, size),
+                                         team, task),
+                      task, out);
+    }
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+out:
+    return task->super.status;
+}
+
+static ucc_status_t
+ucc_tl_ucp_reduce_chain_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+
+    if (task->reduce_chain.scratch_mc_header) {
+        ucc_mc_free(task->reduce_chain.scratch_mc_header);
+    }
+    return ucc_tl_ucp_coll_finalize(coll_task);
+}
+
+ucc_status_t ucc_tl_ucp_reduce_chain_init(ucc_base_coll_args_t *coll_args,
+                                          ucc_base_team_t      *team,
+                                          ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team  = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_coll_args_t   *args     = &coll_args->args;
+    ucc_rank_t         rank     = UCC_TL_TEAM_RANK(tl_team);
+    ucc_rank_t         size     = UCC_TL_TEAM_SIZE(tl_team);
+    ucc_rank_t         vrank    = VRANK(rank, args->root, size);
+    int                is_root  = (rank == args->root);
+    ucc_datatype_t     dt       = is_root ? args->dst.info.datatype
+                                          : args->src.info.datatype;
+    ucc_memory_type_t  mem_type = is_root ? args->dst.info.mem_type
+                                          : args->src.info.mem_type;
+    size_t             count    = is_root ? args->dst.info.count
+                                          : args->src.info.count;
+    size_t             dt_size  = ucc_dt_size(dt);
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+    size_t             seg_count;
+
+    if (!UCC_DT_IS_PREDEFINED(dt)) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    if (size < 2) {
+        /* root would be both head and tail of the chain */
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    if (UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.reduce_avg_pre_op &&
+        args->op == UCC_OP_AVG) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    seg_count = ucc_max(UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.reduce_chain_seg_size /
+                        dt_size, 1);
+    seg_count = ucc_min(seg_count, ucc_max(count, 1));
+
+    task                 = ucc_tl_ucp_init_task(coll_args, team);
+    task->super.flags   |= UCC_COLL_TASK_FLAG_EXECUTOR;
+    task->super.post     = ucc_tl_ucp_reduce_chain_start;
+    task->super.progress = ucc_tl_ucp_reduce_chain_progress;
+    task->super.finalize = ucc_tl_ucp_reduce_chain_finalize;
+    task->reduce_chain.seg_count         = seg_count;
+    task->reduce_chain.n_segs            = ucc_div_round_up(count, seg_count);
+    task->reduce_chain.scratch_mc_header = NULL;
+    task->reduce_chain.scratch           = NULL;
+
+    if (vrank != size - 1) {
+        /* 1 segment to receive, 2 to alternate the sends */
+        status = ucc_mc_alloc(&task->reduce_chain.scratch_mc_header,
+                              seg_count * dt_size * (is_root ? 1 : 3),
+                              mem_type);
+        if (ucc_unlikely(UCC_OK != status)) {
+            ucc_tl_ucp_put_task(task);
+            return status;
+        }
+        task->reduce_chain.scratch = task->reduce_chain.scratch_mc_header->addr;
+    }
+    *task_h = &task->super;
+    return UCC_OK;
+}
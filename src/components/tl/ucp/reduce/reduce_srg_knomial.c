@@ -0,0 +1,430 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "reduce.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "components/mc/ucc_mc.h"
+#include "coll_patterns/sra_knomial.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+#include "../reduce_scatter/reduce_scatter.h"
+
+/* SRG - scatter-reduce-gather knomial algorithm
+   1. The algorithm performs reduce as a sequence of K-nomial Reduce-Scatter
+      followed by K-nomial gather (with the same radix K) of the reduced
+      segments to the root, Rabenseifner2004
+      (https://doi.org/10.1007/978-3-540-24685-5_1).
+   2. The gather goes along the exchange pattern of the knomial allgather
+      used by SRA allreduce, but on every iteration only the rank on the
+      path to the root receives, all the other ranks of the exchange group
+      send their segment to it and leave the loop.
+   3. Non root ranks require a scratch buffer of the size of the vector to
+      hold the reduce-scatter result.
+   4. The vector is split into fragments that are processed by a pipelined
+      schedule, see REDUCE_SRG_KN_FRAG_SIZE and REDUCE_SRG_KN_PIPELINE_DEPTH.
+ */
+
+#define SAVE_STATE(_phase)                                                     \
+    do {                                                                       \
+        task->reduce_srg_kn.phase = _phase;                                    \
+    } while (0)
+
+static inline ucc_rank_t
+ucc_tl_ucp_reduce_srg_kn_loop_rank_to_rank(ucc_knomial_pattern_t *p,
+                                           ucc_rank_t lrank)
+{
+    return (lrank < p->n_extra) ? lrank * 2 : lrank + p->n_extra;
+}
+
+static void ucc_tl_ucp_reduce_srg_kn_gather_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t     *task      = ucc_derived_of(coll_task,
+                                                      ucc_tl_ucp_task_t);
+    ucc_coll_args_t       *args      = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t     *team      = TASK_TEAM(task);
+    ucc_knomial_pattern_t *p         = &task->reduce_srg_kn.p;
+    ucc_kn_radix_t         radix     = p->radix;
+    ucc_rank_t             rank      = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t             size      = UCC_TL_TEAM_SIZE(team);
+    ucc_rank_t             root      = (ucc_rank_t)args->root;
+    ucc_memory_type_t      mem_type  = args->dst.info.mem_type;
+    size_t                 count     = args->dst.info.count;
+    size_t                 dt_size   = ucc_dt_size(args->dst.info.datatype);
+    ucc_rank_t             root_lrank, lrank, peer, step_radix, peer_seg_index,
+                           local_seg_index;
+    ptrdiff_t              peer_seg_offset, local_seg_offset;
+    size_t                 block_count, peer_seg_count, local_seg_count;
+    ucc_kn_radix_t         loop_step, digit, root_digit;
+    void                  *sbuf, *rbuf;
+
+    root_lrank = ucc_knomial_pattern_loop_rank(
+        p, (root < 2 * p->n_extra && root % 2) ? root - 1 : root);
+    UCC_KN_GOTO_PHASE(task->reduce_srg_kn.phase);
+    if (KN_NODE_EXTRA == p->node_type) {
+        if (rank != root) {
+            goto completed;
+        }
+        peer = ucc_knomial_pattern_get_proxy(p, rank);
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(args->dst.info.buffer,
+                                         count * dt_size, mem_type, peer,
+                                         team, task),
+                      task, out);
+    }
+UCC_KN_PHASE_EXTRA:
+    if (KN_NODE_EXTRA == p->node_type) {
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            SAVE_STATE(UCC_KN_PHASE_EXTRA);
+            return;
+        }
+        goto completed;
+    }
+    while (!ucc_knomial_pattern_loop_done_backward(p)) {
+        lrank            = ucc_knomial_pattern_loop_rank(p, rank);
+        digit            = (lrank / p->radix_pow) % radix;
+        root_digit       = (root_lrank / p->radix_pow) % radix;
+        step_radix       = ucc_sra_kn_compute_step_radix(rank, size, p);
+        block_count      = ucc_sra_kn_compute_block_count(count, rank, p);
+        local_seg_index  = ucc_sra_kn_compute_seg_index(rank, p->radix_pow, p);
+        local_seg_count  = ucc_sra_kn_compute_seg_size(block_count, step_radix,
+                                                       local_seg_index);
+        local_seg_offset = ucc_sra_kn_compute_seg_offset(
+            block_count, step_radix, local_seg_index);
+        sbuf             = task->reduce_srg_kn.sbuf;
+
+        if (digit != root_digit) {
+            /* the peer on the path to the root always exists: only the last
+               group of the top level is incomplete and it has full
+               subgroups */
+            peer = ucc_tl_ucp_reduce_srg_kn_loop_rank_to_rank(
+                p, lrank - digit * p->radix_pow + root_digit * p->radix_pow);
+            UCPCHECK_GOTO(ucc_tl_ucp_send_nb(sbuf, local_seg_count * dt_size,
+                                             mem_type, peer, team, task),
+                          task, out);
+            goto wait_send;
+        }
+
+        rbuf = PTR_OFFSET(sbuf, -local_seg_offset * dt_size);
+        for (loop_step = 1; loop_step < radix; loop_step++) {
+            peer = ucc_knomial_pattern_get_loop_peer(p, rank, size, loop_step);
+            if (peer == UCC_KN_PEER_NULL) {
+                continue;
+            }
+            peer_seg_index =
+                ucc_sra_kn_compute_seg_index(peer, p->radix_pow, p);
+            peer_seg_count = ucc_sra_kn_compute_seg_size(
+                block_count, step_radix, peer_seg_index);
+            peer_seg_offset = ucc_sra_kn_compute_seg_offset(
+                block_count, step_radix, peer_seg_index);
+            UCPCHECK_GOTO(
+                ucc_tl_ucp_recv_nb(PTR_OFFSET(rbuf, peer_seg_offset * dt_size),
+                                   peer_seg_count * dt_size, mem_type, peer,
+                                   team, task),
+                task, out);
+        }
+        task->reduce_srg_kn.sbuf = rbuf;
+    UCC_KN_PHASE_LOOP:
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            SAVE_STATE(UCC_KN_PHASE_LOOP);
+            return;
+        }
+        ucc_knomial_pattern_next_iteration_backward(p);
+    }
+
+    if (rank != root) {
+        /* root is the extra rank of this proxy */
+        UCPCHECK_GOTO(ucc_tl_ucp_send_nb(args->dst.info.buffer,
+                                         count * dt_size, mem_type, root,
+                                         team, task),
+                      task, out);
+    }
+wait_send:
+UCC_KN_PHASE_PROXY:
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        SAVE_STATE(UCC_KN_PHASE_PROXY);
+        return;
+    }
+completed:
+    ucc_assert(UCC_TL_UCP_TASK_P2P_COMPLETE(task));
+    task->super.status = UCC_OK;
+out:
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_reduce_srg_kn_gather_done",
+                                     0);
+}
+
+static ucc_status_t
+ucc_tl_ucp_reduce_srg_kn_gather_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task  = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args  = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team  = TASK_TEAM(task);
+    ucc_rank_t         rank  = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t         size  = UCC_TL_TEAM_SIZE(team);
+    ucc_kn_radix_t     radix = task->reduce_srg_kn.p.radix;
+    ptrdiff_t          offset;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task,
+                                     "ucp_reduce_srg_kn_gather_start", 0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    task->reduce_srg_kn.phase = UCC_KN_PHASE_INIT;
+    ucc_knomial_pattern_init_backward(size, rank, radix,
+                                      &task->reduce_srg_kn.p);
+    /* reduce-scatter left the local segment at sra offset of dst */
+    offset = ucc_sra_kn_get_offset(args->dst.info.count,
+                                   ucc_dt_size(args->dst.info.datatype), rank,
+                                   size, radix);
+    task->reduce_srg_kn.sbuf = PTR_OFFSET(args->dst.info.buffer, offset);
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
+static ucc_status_t
+ucc_tl_ucp_reduce_srg_kn_gather_init(ucc_base_coll_args_t *coll_args,
+                                     ucc_base_team_t *team,
+                                     ucc_coll_task_t **task_h,
+                                     ucc_kn_radix_t radix)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_task_t *task;
+
+    task                 = ucc_tl_ucp_init_task(coll_args, team);
+    task->super.post     = ucc_tl_ucp_reduce_srg_kn_gather_start;
+    task->super.progress = ucc_tl_ucp_reduce_srg_kn_gather_progress;
+    ucc_knomial_pattern_init_backward(UCC_TL_TEAM_SIZE(tl_team),
+                                      UCC_TL_TEAM_RANK(tl_team), radix,
+                                      &task->reduce_srg_kn.p);
+    *task_h = &task->super;
+    return UCC_OK;
+}
+
+static ucc_status_t
+ucc_tl_ucp_reduce_srg_knomial_frag_start(ucc_coll_task_t *task)
+{
+    return ucc_schedule_start(task);
+}
+
+static ucc_status_t
+ucc_tl_ucp_reduce_srg_knomial_frag_finalize(ucc_coll_task_t *task)
+{
+    ucc_schedule_t *schedule = ucc_derived_of(task, ucc_schedule_t);
+    ucc_status_t    status;
+
+    status = ucc_schedule_finalize(task);
+    ucc_tl_ucp_put_schedule(schedule);
+    return status;
+}
+
+/* dst of the fragment: user dst on the root, scratch on the other ranks */
+static inline void *
+ucc_tl_ucp_reduce_srg_knomial_dst(ucc_tl_ucp_schedule_t *schedule,
+                                  ucc_coll_args_t       *args,
+                                  ucc_rank_t             rank)
+{
+    return (rank == args->root) ? args->dst.info.buffer
+                                : schedule->scratch_mc_header->addr;
+}
+
+static ucc_status_t ucc_tl_ucp_reduce_srg_knomial_frag_setup(
+    ucc_schedule_pipelined_t *schedule_p, ucc_schedule_t *frag, int frag_num)
+{
+    ucc_tl_ucp_schedule_t *schedule =
+        ucc_derived_of(schedule_p, ucc_tl_ucp_schedule_t);
+    ucc_coll_args_t       *args     = &schedule_p->super.super.bargs.args;
+    ucc_rank_t             rank     = UCC_TL_TEAM_RANK(
+        ucc_derived_of(schedule_p->super.super.team, ucc_tl_ucp_team_t));
+    ucc_datatype_t         dt       = (rank == args->root) ?
+        args->dst.info.datatype : args->src.info.datatype;
+    size_t                 dt_size  = ucc_dt_size(dt);
+    size_t                 count    = (rank == args->root) ?
+        args->dst.info.count : args->src.info.count;
+    int                    n_frags  = schedule_p->super.n_tasks;
+    size_t                 frag_count, offset;
+    ucc_coll_args_t       *targs;
+    void                  *dst, *src;
+
+    frag_count = ucc_buffer_block_count(count, n_frags, frag_num);
+    offset     = ucc_buffer_block_offset(count, n_frags, frag_num);
+    dst        = ucc_tl_ucp_reduce_srg_knomial_dst(schedule, args, rank);
+    src        = UCC_IS_INPLACE(*args) ? dst : args->src.info.buffer;
+
+    targs = &frag->tasks[0]->bargs.args; //REDUCE_SCATTER
+    targs->src.info.buffer = PTR_OFFSET(src, offset * dt_size);
+    targs->dst.info.buffer = PTR_OFFSET(dst, offset * dt_size);
+    targs->src.info.count  = frag_count;
+    targs->dst.info.count  = frag_count;
+
+    targs = &frag->tasks[1]->bargs.args; //GATHER
+    targs->dst.info.buffer = PTR_OFFSET(dst, offset * dt_size);
+    targs->dst.info.count  = frag_count;
+    return UCC_OK;
+}
+
+static ucc_status_t ucc_tl_ucp_reduce_srg_knomial_frag_init(
+    ucc_base_coll_args_t     *coll_args,
+    ucc_schedule_pipelined_t *sp,
+    ucc_base_team_t *team, ucc_schedule_t **frag_p)
+{
+    ucc_tl_ucp_team_t    *tl_team  = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_schedule_t *tl_sched = ucc_derived_of(sp,
+                                                     ucc_tl_ucp_schedule_t);
+    ucc_rank_t            rank     = UCC_TL_TEAM_RANK(tl_team);
+    ucc_base_coll_args_t  args     = *coll_args;
+    ucc_schedule_t       *schedule;
+    ucc_coll_task_t      *task, *rs_task;
+    ucc_status_t          status;
+    ucc_kn_radix_t        radix, cfg_radix;
+
+    /* both phases work on the full vector in dst: non root ranks use
+       scratch of the same size */
+    if (rank != args.args.root) {
+        args.args.dst.info.buffer   = tl_sched->scratch_mc_header->addr;
+        args.args.dst.info.count    = args.args.src.info.count;
+        args.args.dst.info.datatype = args.args.src.info.datatype;
+        args.args.dst.info.mem_type = args.args.src.info.mem_type;
+    } else if (UCC_IS_INPLACE(args.args)) {
+        args.args.src.info = args.args.dst.info;
+    }
+    status = ucc_tl_ucp_get_schedule(tl_team, &args,
+                                     (ucc_tl_ucp_schedule_t **)&schedule);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    cfg_radix = UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.reduce_srg_kn_radix;
+    radix     = ucc_knomial_pattern_get_min_radix(cfg_radix,
+                                                  UCC_TL_TEAM_SIZE(tl_team),
+                                                  args.args.dst.info.count);
+
+    /* 1st step of reduce: knomial reduce_scatter */
+    status = ucc_tl_ucp_reduce_scatter_knomial_init_r(&args, team, &task,
+                                                      radix);
+    if (UCC_OK != status) {
+        tl_error(UCC_TL_TEAM_LIB(tl_team),
+                 "failed to init reduce_scatter_knomial task");
+        goto out;
+    }
+    status = ucc_schedule_add_task(schedule, task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        task->finalize(task);
+        goto out;
+    }
+    UCC_CHECK_GOTO(ucc_task_subscribe_dep(&schedule->super, task,
+                                          UCC_EVENT_SCHEDULE_STARTED),
+                   err, status);
+    rs_task = task;
+
+    /* 2nd step of reduce: knomial gather of the segments to the root */
+    status = ucc_tl_ucp_reduce_srg_kn_gather_init(&args, team, &task, radix);
+    if (UCC_OK != status) {
+        tl_error(UCC_TL_TEAM_LIB(tl_team), "failed to init gather task");
+        goto err;
+    }
+    status = ucc_schedule_add_task(schedule, task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        task->finalize(task);
+        goto err;
+    }
+    UCC_CHECK_GOTO(ucc_task_subscribe_dep(rs_task, task, UCC_EVENT_COMPLETED),
+                   err, status);
+    schedule->super.finalize = ucc_tl_ucp_reduce_srg_knomial_frag_finalize;
+    schedule->super.post     = ucc_tl_ucp_reduce_srg_knomial_frag_start;
+    *frag_p                  = schedule;
+    return UCC_OK;
+err:
+    ucc_schedule_finalize(&schedule->super);
+out:
+    ucc_tl_ucp_put_schedule(schedule);
+    return status;
+}
+
+static ucc_status_t
+ucc_tl_ucp_reduce_srg_knomial_finalize(ucc_coll_task_t *task)
+{
+    ucc_tl_ucp_schedule_t *schedule = ucc_derived_of(task,
+                                                     ucc_tl_ucp_schedule_t);
+    ucc_status_t status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(schedule, "ucp_reduce_srg_kn_done", 0);
+    if (schedule->scratch_mc_header) {
+        ucc_mc_free(schedule->scratch_mc_header);
+    }
+    status = ucc_schedule_pipelined_finalize(task);
+    ucc_tl_ucp_put_schedule(&schedule->super.super);
+    return status;
+}
+
+static ucc_status_t ucc_tl_ucp_reduce_srg_knomial_start(ucc_coll_task_t *task)
+{
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(task, "ucp_reduce_srg_kn_start", 0);
+    return ucc_schedule_pipelined_post(task);
+}
+
+ucc_status_t
+ucc_tl_ucp_reduce_srg_knomial_init(ucc_base_coll_args_t *coll_args,
+                                   ucc_base_team_t      *team,
+                                   ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t       *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_lib_config_t *cfg     = &UCC_TL_UCP_TEAM_LIB(tl_team)->cfg;
+    ucc_coll_args_t         *args    = &coll_args->args;
+    ucc_rank_t               rank    = UCC_TL_TEAM_RANK(tl_team);
+    int                      is_root = (rank == args->root);
+    size_t                   count   = is_root ? args->dst.info.count
+                                               : args->src.info.count;
+    ucc_datatype_t           dt      = is_root ? args->dst.info.datatype
+                                               : args->src.info.datatype;
+    ucc_memory_type_t        mtype   = is_root ? args->dst.info.mem_type
+                                               : args->src.info.mem_type;
+    size_t                   data_size = count * ucc_dt_size(dt);
+    ucc_tl_ucp_schedule_t   *schedule;
+    int                      n_frags, pipeline_depth;
+    ucc_status_t             status;
+
+    if (!UCC_DT_IS_PREDEFINED(dt)) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    if (cfg->reduce_avg_pre_op && args->op == UCC_OP_AVG) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    status = ucc_tl_ucp_get_schedule(tl_team, coll_args, &schedule);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    schedule->scratch_mc_header = NULL;
+    if (!is_root) {
+        status = ucc_mc_alloc(&schedule->scratch_mc_header, data_size, mtype);
+        if (ucc_unlikely(UCC_OK != status)) {
+            tl_error(team->context->lib, "failed to allocate scratch");
+            goto err;
+        }
+    }
+
+    n_frags = 1;
+    if (cfg->reduce_srg_kn_frag_size > 0 &&
+        data_size > cfg->reduce_srg_kn_frag_size) {
+        n_frags = ucc_div_round_up(data_size, cfg->reduce_srg_kn_frag_size);
+    }
+    pipeline_depth = ucc_min(n_frags, cfg->reduce_srg_kn_pipeline_depth);
+    pipeline_depth = ucc_max(pipeline_depth, 1);
+    status = ucc_schedule_pipelined_init(
+        coll_args, team, ucc_tl_ucp_reduce_srg_knomial_frag_init,
+        ucc_tl_ucp_reduce_srg_knomial_frag_setup, pipeline_depth, n_frags, 0,
+        &schedule->super);
+    if (UCC_OK != status) {
+        tl_error(team->context->lib, "failed to init pipelined schedule");
+        goto err;
+    }
+    schedule->super.super.super.finalize = ucc_tl_ucp_reduce_srg_knomial_finalize;
+    schedule->super.super.super.post     = ucc_tl_ucp_reduce_srg_knomial_start;
+    *task_h = &schedule->super.super.super;
+    return UCC_OK;
+err:
+    if (schedule->scratch_mc_header) {
+        ucc_mc_free(schedule->scratch_mc_header);
+    }
+    ucc_tl_ucp_put_schedule(&schedule->super.super);
+    return status;
+}
@@ -82,15 +82,17 @@ static inline void ucc_ring_frag_block_offset(ucc_tl_ucp_task_t *task,
 
 static inline ucc_status_t ucc_tl_ucp_test_ring(ucc_tl_ucp_task_t *task)
 {
-    int polls = 0;
-    while (polls++ < task->n_polls) {
-        if (task->tagged.send_posted - task->tagged.send_completed <= 1 &&
-            task->tagged.recv_posted == task->tagged.recv_completed) {
-            return UCC_OK;
+    uint32_t polls   = 0;
+    uint32_t n_polls = ucc_tl_ucp_task_polls(task);
+
+    while (!(task->tagged.send_posted - task->tagged.send_completed <= 1 &&
+             task->tagged.recv_posted == task->tagged.recv_completed)) {
+        if (polls++ == n_polls) {
+            return UCC_INPROGRESS;
         }
         ucp_worker_progress(TASK_CTX(task)->ucp_worker);
     }
-    return UCC_INPROGRESS;
+    return UCC_OK;
 }
 
 static void ucc_tl_ucp_reduce_scatter_ring_progress(ucc_coll_task_t *coll_task)
@@ -396,17 +398,26 @@ ucc_tl_ucp_reduce_scatter_ring_init(ucc_base_coll_args_t *coll_args,
                        to_alloc_per_set * i * dt_size), max_segcount);
         if (UCC_OK != status) {
             tl_error(UCC_TL_TEAM_LIB(tl_team), "failed to allocate ring task");
-            return status;
+            goto err;
         }
         ctask->n_deps = 1;
-        ucc_schedule_add_task(schedule, ctask);
-        ucc_event_manager_subscribe(&schedule->super.em,
-                                    UCC_EVENT_SCHEDULE_STARTED, ctask,
-                                    ucc_task_start_handler);
+        status = ucc_schedule_add_task(schedule, ctask);
+        if (ucc_unlikely(UCC_OK != status)) {
+            ctask->finalize(ctask);
+            goto err;
+        }
+        UCC_CHECK_GOTO(ucc_event_manager_subscribe(&schedule->super.em,
+                                                   UCC_EVENT_SCHEDULE_STARTED,
+                                                   ctask,
+                                                   ucc_task_start_handler),
+                       err, status);
     }
     schedule->super.flags   |= UCC_COLL_TASK_FLAG_EXECUTOR;
     schedule->super.post     = ucc_tl_ucp_reduce_scatter_ring_sched_post;
     schedule->super.finalize = ucc_tl_ucp_reduce_scatter_ring_sched_finalize;
     *task_h                  = &schedule->super;
     return UCC_OK;
+err:
+    ucc_tl_ucp_reduce_scatter_ring_sched_finalize(&schedule->super);
+    return status;
 }
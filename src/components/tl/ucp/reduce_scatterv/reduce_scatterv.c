@@ -13,5 +13,9 @@ ucc_base_coll_alg_info_t
             {.id   = UCC_TL_UCP_REDUCE_SCATTERV_ALG_RING,
              .name = "ring",
              .desc = "O(N) ring"},
+        [UCC_TL_UCP_REDUCE_SCATTERV_ALG_KNOMIAL] =
+            {.id   = UCC_TL_UCP_REDUCE_SCATTERV_ALG_KNOMIAL,
+             .name = "knomial",
+             .desc = "recursive knomial with arbitrary radix, log(N) steps"},
         [UCC_TL_UCP_REDUCE_SCATTERV_ALG_LAST] = {
             .id = 0, .name = NULL, .desc = NULL}};
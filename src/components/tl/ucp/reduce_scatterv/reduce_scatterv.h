@@ -10,14 +10,16 @@
 enum
 {
     UCC_TL_UCP_REDUCE_SCATTERV_ALG_RING,
+    UCC_TL_UCP_REDUCE_SCATTERV_ALG_KNOMIAL,
     UCC_TL_UCP_REDUCE_SCATTERV_ALG_LAST
 };
 
 extern ucc_base_coll_alg_info_t
     ucc_tl_ucp_reduce_scatterv_algs[UCC_TL_UCP_REDUCE_SCATTERV_ALG_LAST + 1];
 
+/* msg range is the total size of the vector */
 #define UCC_TL_UCP_REDUCE_SCATTERV_DEFAULT_ALG_SELECT_STR                      \
-    "reduce_scatterv:@ring"
+    "reduce_scatterv:0-256k:@1#reduce_scatterv:256k-inf:@0"
 
 static inline int ucc_tl_ucp_reduce_scatterv_alg_from_str(const char *str)
 {
@@ -34,4 +36,10 @@ ucc_status_t
 ucc_tl_ucp_reduce_scatterv_ring_init(ucc_base_coll_args_t *coll_args,
                                      ucc_base_team_t *     team,
                                      ucc_coll_task_t **    task_h);
+
+/* Uses reduce_scatterv_kn_radix from config */
+ucc_status_t
+ucc_tl_ucp_reduce_scatterv_knomial_init(ucc_base_coll_args_t *coll_args,
+                                        ucc_base_team_t      *team,
+                                        ucc_coll_task_t     **task_h);
 #endif
@@ -0,0 +1,356 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "reduce_scatterv.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "components/mc/ucc_mc.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+#include "utils/ucc_dt_reduce.h"
+
+/* Recursive knomial reduce_scatterv (recursive halving for radix 2).
+   1. "Extra" ranks send the whole vector to the proxy and receive their
+      block from it in the end.
+   2. The loop goes backward: on iteration i a loop rank owns the partial
+      result for the blocks of its group of radix^(i+1) consecutive loop
+      ranks. The group is split into radix subgroups of radix^i loop ranks,
+      the data of the peer subgroup is sent to the peer and the contributions
+      for the own subgroup are received into scratch and reduced.
+   3. Loop ranks of a subgroup and their extra ranks form a contiguous range
+      of team ranks, so the data of a subgroup is a contiguous part of the
+      vector of any size defined by the dst counts. */
+
+#define SAVE_STATE(_phase)                                                     \
+    do {                                                                       \
+        task->reduce_scatterv_kn.phase = _phase;                               \
+    } while (0)
+
+/* offset and count of the blocks of the subgroup of loop rank lrank */
+static inline void
+ucc_tl_ucp_reduce_scatterv_kn_range(ucc_tl_ucp_task_t *task, ucc_rank_t lrank,
+                                    size_t *offset, size_t *count)
+{
+    ucc_coll_args_t       *args  = &TASK_ARGS(task);
+    ucc_knomial_pattern_t *p     = &task->reduce_scatterv_kn.p;
+    ucc_rank_t             lsize = UCC_TL_TEAM_SIZE(TASK_TEAM(task)) -
+                                   p->n_extra;
+    ucc_rank_t             start = lrank - lrank % p->radix_pow;
+    ucc_rank_t             end   = ucc_min(start + p->radix_pow, lsize);
+    ucc_rank_t             first, last, r;
+
+    first   = (start < p->n_extra) ? start * 2 : start + p->n_extra;
+    last    = (end - 1 < p->n_extra) ? (end - 1) * 2 + 1
+                                     : end - 1 + p->n_extra;
+    *offset = 0;
+    *count  = 0;
+    for (r = 0; r < first; r++) {
+        *offset += ucc_coll_args_get_count(args, args->dst.info_v.counts, r);
+    }
+    for (r = first; r <= last; r++) {
+        *count += ucc_coll_args_get_count(args, args->dst.info_v.counts, r);
+    }
+}
+
+static inline size_t ucc_tl_ucp_reduce_scatterv_kn_offset(ucc_coll_args_t *args,
+                                                          ucc_rank_t rank)
+{
+    size_t     offset = 0;
+    ucc_rank_t r;
+
+    for (r = 0; r < rank; r++) {
+        offset += ucc_coll_args_get_count(args, args->dst.info_v.counts, r);
+    }
+    return offset;
+}
+
+void ucc_tl_ucp_reduce_scatterv_knomial_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t     *task      = ucc_derived_of(coll_task,
+                                                      ucc_tl_ucp_task_t);
+    ucc_coll_args_t       *args      = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t     *team      = TASK_TEAM(task);
+    ucc_knomial_pattern_t *p         = &task->reduce_scatterv_kn.p;
+    ucc_kn_radix_t         radix     = p->radix;
+    ucc_rank_t             rank      = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t             size      = UCC_TL_TEAM_SIZE(team);
+    ucc_memory_type_t      mem_type  = args->dst.info_v.mem_type;
+    ucc_datatype_t         dt        = args->dst.info_v.datatype;
+    size_t                 dt_size   = ucc_dt_size(dt);
+    size_t                 count     = task->reduce_scatterv_kn.count;
+    void                  *accum     = task->reduce_scatterv_kn.scratch;
+    void                  *rscratch  = PTR_OFFSET(accum, count * dt_size);
+    void                  *sbuf      = UCC_IS_INPLACE(*args) ?
+        args->dst.info_v.buffer : args->src.info.buffer;
+    size_t                 dst_offset = 0;
+    size_t                 local_offset, local_count, peer_offset, peer_count;
+    ucc_ee_executor_task_args_t eargs;
+    ucc_rank_t             peer, lrank;
+    ucc_kn_radix_t         loop_step;
+    ucc_status_t           status;
+    void                  *data;
+    int                    n_recv, is_avg;
+
+    if (UCC_IS_INPLACE(*args)) {
+        dst_offset = ucc_tl_ucp_reduce_scatterv_kn_offset(args, rank);
+    }
+    UCC_KN_REDUCE_GOTO_PHASE(task->reduce_scatterv_kn.phase);
+
+    if (KN_NODE_EXTRA == p->node_type) {
+        peer = ucc_knomial_pattern_get_proxy(p, rank);
+        UCPCHECK_GOTO(ucc_tl_ucp_send_nb(sbuf, count * dt_size, mem_type,
+                                         peer, team, task),
+                      task, out);
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(
+                          PTR_OFFSET(args->dst.info_v.buffer,
+                                     dst_offset * dt_size),
+                          ucc_coll_args_get_count(
+                              args, args->dst.info_v.counts, rank) * dt_size,
+                          mem_type, peer, team, task),
+                      task, out);
+    } else if (KN_NODE_PROXY == p->node_type) {
+        peer = ucc_knomial_pattern_get_extra(p, rank);
+        UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(accum, count * dt_size, mem_type,
+                                         peer, team, task),
+                      task, out);
+    }
+UCC_KN_PHASE_EXTRA:
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        SAVE_STATE(UCC_KN_PHASE_EXTRA);
+        return;
+    }
+    if (KN_NODE_EXTRA == p->node_type) {
+        goto completed;
+    }
+    if (KN_NODE_PROXY == p->node_type) {
+        status = ucc_dt_reduce(sbuf, accum, accum, count, dt, args, 0, 0,
+                               task->reduce_scatterv_kn.executor,
+                               &task->reduce_scatterv_kn.etask);
+        if (ucc_unlikely(status != UCC_OK)) {
+            tl_error(UCC_TASK_LIB(task), "failed to perform dt reduction");
+            task->super.status = status;
+            return;
+        }
+        task->reduce_scatterv_kn.reduced = 1;
+UCC_KN_PHASE_EXTRA_REDUCE:
+        EXEC_TASK_TEST(UCC_KN_PHASE_EXTRA_REDUCE,
+                       "failed to perform dt reduction",
+                       task->reduce_scatterv_kn.etask);
+    }
+    while (!ucc_knomial_pattern_loop_done_backward(p)) {
+        data  = task->reduce_scatterv_kn.reduced ? accum : sbuf;
+        lrank = ucc_knomial_pattern_loop_rank(p, rank);
+        ucc_tl_ucp_reduce_scatterv_kn_range(task, lrank, &local_offset,
+                                            &local_count);
+        n_recv = 0;
+        for (loop_step = 1; loop_step < radix; loop_step++) {
+            peer = ucc_knomial_pattern_get_loop_peer(p, rank, size, loop_step);
+            if (peer == UCC_KN_PEER_NULL) {
+                continue;
+            }
+            ucc_tl_ucp_reduce_scatterv_kn_range(
+                task, ucc_knomial_pattern_loop_rank(p, peer), &peer_offset,
+                &peer_count);
+            if (peer_count > 0) {
+                UCPCHECK_GOTO(ucc_tl_ucp_send_nb(
+                                  PTR_OFFSET(data, peer_offset * dt_size),
+                                  peer_count * dt_size, mem_type, peer, team,
+                                  task),
+                              task, out);
+            }
+            if (local_count > 0) {
+                UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(
+                                  PTR_OFFSET(rscratch,
+                                             n_recv * local_count * dt_size),
+                                  local_count * dt_size, mem_type, peer, team,
+                                  task),
+                              task, out);
+                n_recv++;
+            }
+        }
+    UCC_KN_PHASE_LOOP:
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            SAVE_STATE(UCC_KN_PHASE_LOOP);
+            return;
+        }
+        data  = task->reduce_scatterv_kn.reduced ? accum : sbuf;
+        lrank = ucc_knomial_pattern_loop_rank(p, rank);
+        ucc_tl_ucp_reduce_scatterv_kn_range(task, lrank, &local_offset,
+                                            &local_count);
+        n_recv = 0;
+        if (local_count > 0) {
+            for (loop_step = 1; loop_step < radix; loop_step++) {
+                if (ucc_knomial_pattern_get_loop_peer(p, rank, size,
+                                                      loop_step) !=
+                    UCC_KN_PEER_NULL) {
+                    n_recv++;
+                }
+            }
+        }
+        if (n_recv > 0) {
+            /* backward loop ends with iteration 0 */
+            is_avg = (args->op == UCC_OP_AVG) && (p->iteration == 0);
+            status = ucc_dt_reduce_strided(
+                PTR_OFFSET(data, local_offset * dt_size), rscratch,
+                PTR_OFFSET(accum, local_offset * dt_size), n_recv,
+                local_count, local_count * dt_size, dt, args,
+                is_avg ? UCC_EEE_TASK_FLAG_REDUCE_WITH_ALPHA : 0,
+                AVG_ALPHA(task), task->reduce_scatterv_kn.executor,
+                &task->reduce_scatterv_kn.etask);
+            if (ucc_unlikely(UCC_OK != status)) {
+                tl_error(UCC_TASK_LIB(task), "failed to perform dt reduction");
+                task->super.status = status;
+                return;
+            }
+            task->reduce_scatterv_kn.reduced = 1;
+UCC_KN_PHASE_REDUCE:
+            EXEC_TASK_TEST(UCC_KN_PHASE_REDUCE,
+                           "failed to perform dt reduction",
+                           task->reduce_scatterv_kn.etask);
+        }
+        ucc_knomial_pattern_next_iteration_backward(p);
+    }
+
+    data = task->reduce_scatterv_kn.reduced ? accum : sbuf;
+    if (KN_NODE_PROXY == p->node_type) {
+        peer        = ucc_knomial_pattern_get_extra(p, rank);
+        peer_count  = ucc_coll_args_get_count(args, args->dst.info_v.counts,
+                                              peer);
+        peer_offset = ucc_tl_ucp_reduce_scatterv_kn_offset(args, peer);
+        UCPCHECK_GOTO(ucc_tl_ucp_send_nb(PTR_OFFSET(data,
+                                                    peer_offset * dt_size),
+                                         peer_count * dt_size, mem_type, peer,
+                                         team, task),
+                      task, out);
+    }
+    local_count  = ucc_coll_args_get_count(args, args->dst.info_v.counts,
+                                           rank);
+    local_offset = ucc_tl_ucp_reduce_scatterv_kn_offset(args, rank);
+    if (local_count > 0 && data != args->dst.info_v.buffer) {
+        eargs.task_type = UCC_EE_EXECUTOR_TASK_COPY;
+        eargs.copy.dst  = PTR_OFFSET(args->dst.info_v.buffer,
+                                     dst_offset * dt_size);
+        eargs.copy.src  = PTR_OFFSET(data, local_offset * dt_size);
+        eargs.copy.len  = local_count * dt_size;
+        status = ucc_ee_executor_task_post(task->reduce_scatterv_kn.executor,
+                                           &eargs,
+                                           &task->reduce_scatterv_kn.etask);
+        if (ucc_unlikely(status != UCC_OK)) {
+            tl_error(UCC_TASK_LIB(task), "failed to copy data to dst buffer");
+            task->super.status = status;
+            return;
+        }
+UCC_KN_PHASE_COMPLETE:
+        EXEC_TASK_TEST(UCC_KN_PHASE_COMPLETE, "failed to perform memcpy",
+                       task->reduce_scatterv_kn.etask);
+    }
+UCC_KN_PHASE_PROXY:
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        SAVE_STATE(UCC_KN_PHASE_PROXY);
+        return;
+    }
+completed:
+    ucc_assert(UCC_TL_UCP_TASK_P2P_COMPLETE(task));
+    task->super.status = UCC_OK;
+out:
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_reduce_scatterv_kn_done",
+                                     0);
+}
+
+ucc_status_t
+ucc_tl_ucp_reduce_scatterv_knomial_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    ucc_status_t       status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_reduce_scatterv_kn_start",
+                                     0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    ucc_knomial_pattern_init_backward(UCC_TL_TEAM_SIZE(team),
+                                      UCC_TL_TEAM_RANK(team),
+                                      task->reduce_scatterv_kn.p.radix,
+                                      &task->reduce_scatterv_kn.p);
+    task->reduce_scatterv_kn.phase   = UCC_KN_PHASE_INIT;
+    task->reduce_scatterv_kn.reduced = 0;
+    task->reduce_scatterv_kn.etask   = NULL;
+    status = ucc_coll_task_get_executor(&task->super,
+                                        &task->reduce_scatterv_kn.executor);
+    if (ucc_unlikely(status != UCC_OK)) {
+        return status;
+    }
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
+ucc_status_t
+ucc_tl_ucp_reduce_scatterv_knomial_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+
+    if (task->reduce_scatterv_kn.scratch_mc_header) {
+        ucc_mc_free(task->reduce_scatterv_kn.scratch_mc_header);
+    }
+    return ucc_tl_ucp_coll_finalize(coll_task);
+}
+
+ucc_status_t
+ucc_tl_ucp_reduce_scatterv_knomial_init(ucc_base_coll_args_t *coll_args,
+                                        ucc_base_team_t      *team,
+                                        ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team  = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_coll_args_t   *args     = &coll_args->args;
+    ucc_rank_t         rank     = UCC_TL_TEAM_RANK(tl_team);
+    ucc_rank_t         size     = UCC_TL_TEAM_SIZE(tl_team);
+    size_t             dt_size  = ucc_dt_size(args->dst.info_v.datatype);
+    ucc_memory_type_t  mem_type = args->dst.info_v.mem_type;
+    ucc_tl_ucp_task_t *task;
+    ucc_knomial_pattern_t *p;
+    ucc_kn_radix_t     radix;
+    size_t             count, local_offset, local_count;
+    ucc_status_t       status;
+
+    if (UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.reduce_avg_pre_op &&
+        args->op == UCC_OP_AVG) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    count = ucc_coll_args_get_total_count(args, args->dst.info_v.counts, size);
+    radix = ucc_max(2, ucc_min(UCC_TL_UCP_TEAM_LIB(tl_team)->cfg.
+                               reduce_scatterv_kn_radix, size));
+
+    task                  = ucc_tl_ucp_init_task(coll_args, team);
+    task->super.flags    |= UCC_COLL_TASK_FLAG_EXECUTOR;
+    task->super.post      = ucc_tl_ucp_reduce_scatterv_knomial_start;
+    task->super.progress  = ucc_tl_ucp_reduce_scatterv_knomial_progress;
+    task->super.finalize  = ucc_tl_ucp_reduce_scatterv_knomial_finalize;
+
+    task->reduce_scatterv_kn.count             = count;
+    task->reduce_scatterv_kn.scratch_mc_header = NULL;
+    task->reduce_scatterv_kn.scratch           = NULL;
+    p = &task->reduce_scatterv_kn.p;
+    ucc_knomial_pattern_init_backward(size, rank, radix, p);
+
+    if (KN_NODE_EXTRA != p->node_type) {
+        /* the subgroup only shrinks, so the first iteration receives the
+           most: radix - 1 peer contributions of the own subgroup */
+        ucc_tl_ucp_reduce_scatterv_kn_range(
+            task, ucc_knomial_pattern_loop_rank(p, rank), &local_offset,
+            &local_count);
+        status = ucc_mc_alloc(&task->reduce_scatterv_kn.scratch_mc_header,
+                              (count + (radix - 1) * local_count) * dt_size,
+                              mem_type);
+        if (UCC_OK != status) {
+            ucc_tl_ucp_put_task(task);
+            return status;
+        }
+        task->reduce_scatterv_kn.scratch =
+            task->reduce_scatterv_kn.scratch_mc_header->addr;
+    }
+    *task_h = &task->super;
+    return UCC_OK;
+}
@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "scatter.h"
+
+ucc_base_coll_alg_info_t
+    ucc_tl_ucp_scatter_algs[UCC_TL_UCP_SCATTER_ALG_LAST + 1] = {
+        [UCC_TL_UCP_SCATTER_ALG_SEG_KNOMIAL] =
+            {.id   = UCC_TL_UCP_SCATTER_ALG_SEG_KNOMIAL,
+             .name = "seg_knomial",
+             .desc = "scatter over knomial tree forwarding subtree data in "
+                     "segments with bounded scratch, linear for large blocks"},
+        [UCC_TL_UCP_SCATTER_ALG_LINEAR] =
+            {.id   = UCC_TL_UCP_SCATTER_ALG_LINEAR,
+             .name = "linear",
+             .desc = "linear scatter with bounded send window at root "
+                     "(optimized for large blocks)"},
+        [UCC_TL_UCP_SCATTER_ALG_LAST] = {
+            .id = 0, .name = NULL, .desc = NULL}};
+
+ucc_status_t ucc_tl_ucp_scatter_init(ucc_tl_ucp_task_t *task)
+{
+    ucc_coll_args_t         *args = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t       *team = TASK_TEAM(task);
+    ucc_tl_ucp_lib_config_t *cfg  = &UCC_TL_UCP_TEAM_LIB(team)->cfg;
+    ucc_rank_t               size = UCC_TL_TEAM_SIZE(team);
+    size_t                   block_size;
+    uint32_t                 radix;
+
+    if (UCC_TL_TEAM_RANK(team) == args->root) {
+        block_size = args->src.info.count / size *
+                     ucc_dt_size(args->src.info.datatype);
+    } else {
+        block_size = args->dst.info.count *
+                     ucc_dt_size(args->dst.info.datatype);
+    }
+    if (block_size >= cfg->scatter_linear_block_size) {
+        radix = ucc_max(size, 2);
+    } else {
+        radix = ucc_max(ucc_min(cfg->scatter_kn_radix, size), 2);
+    }
+    return ucc_tl_ucp_scatter_seg_init_common(task, radix);
+}
+
+ucc_status_t
+ucc_tl_ucp_scatter_seg_knomial_init(ucc_base_coll_args_t *coll_args,
+                                    ucc_base_team_t      *team,
+                                    ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+
+    task   = ucc_tl_ucp_init_task(coll_args, team);
+    status = ucc_tl_ucp_scatter_init(task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        ucc_tl_ucp_put_task(task);
+        return status;
+    }
+    *task_h = &task->super;
+    return UCC_OK;
+}
+
+ucc_status_t ucc_tl_ucp_scatter_linear_init(ucc_base_coll_args_t *coll_args,
+                                            ucc_base_team_t      *team,
+                                            ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_task_t *task;
+    ucc_status_t       status;
+
+    task   = ucc_tl_ucp_init_task(coll_args, team);
+    status = ucc_tl_ucp_scatter_seg_init_common(
+        task, ucc_max(UCC_TL_TEAM_SIZE(tl_team), 2));
+    if (ucc_unlikely(UCC_OK != status)) {
+        ucc_tl_ucp_put_task(task);
+        return status;
+    }
+    *task_h = &task->super;
+    return UCC_OK;
+}
@@ -8,7 +8,45 @@
 #include "../tl_ucp.h"
 #include "../tl_ucp_coll.h"
 
-/* Base interface signature: uses scatter_kn_radix from config. */
+enum {
+    UCC_TL_UCP_SCATTER_ALG_SEG_KNOMIAL,
+    UCC_TL_UCP_SCATTER_ALG_LINEAR,
+    UCC_TL_UCP_SCATTER_ALG_LAST
+};
+
+extern ucc_base_coll_alg_info_t
+             ucc_tl_ucp_scatter_algs[UCC_TL_UCP_SCATTER_ALG_LAST + 1];
+
+static inline int ucc_tl_ucp_scatter_alg_from_str(const char *str)
+{
+    int i;
+    for (i = 0; i < UCC_TL_UCP_SCATTER_ALG_LAST; i++) {
+        if (0 == strcasecmp(str, ucc_tl_ucp_scatter_algs[i].name)) {
+            break;
+        }
+    }
+    return i;
+}
+
+/* Segmented knomial scatter of UCC_COLL_TYPE_SCATTER, switches to linear
+   once the per rank block reaches SCATTER_LINEAR_BLOCK_SIZE */
+ucc_status_t ucc_tl_ucp_scatter_init(ucc_tl_ucp_task_t *task);
+
+ucc_status_t ucc_tl_ucp_scatter_seg_init_common(ucc_tl_ucp_task_t *task,
+                                                uint32_t           radix);
+
+ucc_status_t
+ucc_tl_ucp_scatter_seg_knomial_init(ucc_base_coll_args_t *coll_args,
+                                    ucc_base_team_t      *team,
+                                    ucc_coll_task_t     **task_h);
+
+ucc_status_t ucc_tl_ucp_scatter_linear_init(ucc_base_coll_args_t *coll_args,
+                                            ucc_base_team_t      *team,
+                                            ucc_coll_task_t     **task_h);
+
+/* Knomial scatter of a vector into SRA blocks, used as a building block
+   of SAG bcast. Base interface signature: uses scatter_kn_radix from
+   config. */
 
 ucc_status_t
 ucc_tl_ucp_scatter_knomial_init(ucc_base_coll_args_t *coll_args,
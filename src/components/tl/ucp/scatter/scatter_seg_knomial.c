@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "scatter.h"
+#include "core/ucc_progress_queue.h"
+#include "tl_ucp_sendrecv.h"
+#include "tl_ucp_generic_dt.h"
+#include "components/mc/ucc_mc.h"
+#include "utils/ucc_math.h"
+
+/* Segmented knomial scatter, mirror of the segmented gather: a rank
+   receives the data of its subtree from the parent as a stream of
+   subtree_size * n_segs segments ordered by vrank. Own block segments go
+   directly to dst, the rest is relayed to the children through 2 banks of
+   "window" segments: at step k batch k is received into one bank while
+   batch k - 1 is sent to the children from the other one. Root sends
+   directly from src. With radix >= team size this is linear scatter with
+   a window of outstanding sends at root. */
+
+static inline void ucc_tl_ucp_scatter_seg_msg(ucc_tl_ucp_task_t *task,
+                                              ucc_rank_t vrank, size_t msg,
+                                              ucc_rank_t *vblock,
+                                              size_t *offset, size_t *count)
+{
+    *vblock = vrank + msg / task->scatter_seg.n_segs;
+    *offset = (msg % task->scatter_seg.n_segs) * task->scatter_seg.seg_count;
+    *count  = ucc_min(task->scatter_seg.seg_count,
+                      task->scatter_seg.block_count - *offset);
+}
+
+static inline void *ucc_tl_ucp_scatter_seg_slot(ucc_tl_ucp_task_t *task,
+                                                size_t msg, size_t dt_size)
+{
+    size_t window = task->scatter_seg.window;
+
+    return PTR_OFFSET(task->scatter_seg.scratch,
+                      ((msg / window) % 2 * window + msg % window) *
+                          task->scatter_seg.seg_count * dt_size);
+}
+
+static void ucc_tl_ucp_scatter_seg_progress(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task     = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args     = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team     = TASK_TEAM(task);
+    ucc_rank_t         size     = UCC_TL_TEAM_SIZE(team);
+    ucc_rank_t         root     = (ucc_rank_t)args->root;
+    ucc_rank_t         vrank    = VRANK(UCC_TL_TEAM_RANK(team), root, size);
+    uint32_t           radix    = task->scatter_seg.radix;
+    size_t             window   = task->scatter_seg.window;
+    size_t             n_segs   = task->scatter_seg.n_segs;
+    size_t             n_msgs   = task->scatter_seg.n_msgs;
+    size_t             n_steps  = ucc_div_round_up(n_msgs, window);
+    ucc_datatype_t     dt       = (vrank == 0) ? args->src.info.datatype
+                                               : args->dst.info.datatype;
+    ucc_memory_type_t  mem_type = (vrank == 0) ? args->src.info.mem_type
+                                               : args->dst.info.mem_type;
+    size_t             dt_size  = ucc_dt_size(dt);
+    ucc_rank_t         vblock, peer;
+    size_t             msg, k, offset, count;
+    void              *buf;
+
+    if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+        return;
+    }
+    while (task->scatter_seg.step <= n_steps) {
+        k = task->scatter_seg.step;
+        if (k > 0) {
+            for (msg = ucc_max((k - 1) * window, n_segs);
+                 msg < ucc_min(k * window, n_msgs); msg++) {
+                ucc_tl_ucp_scatter_seg_msg(task, vrank, msg, &vblock, &offset,
+                                           &count);
+                peer = INV_VRANK(ucc_kn_tree_child(vrank, vblock, radix), root,
+                                 size);
+                buf  = (vrank == 0)
+                           ? PTR_OFFSET(args->src.info.buffer,
+                                        (INV_VRANK(vblock, root, size) *
+                                             task->scatter_seg.block_count +
+                                         offset) * dt_size)
+                           : ucc_tl_ucp_scatter_seg_slot(task, msg, dt_size);
+                UCPCHECK_GOTO(ucc_tl_ucp_send_nb(buf, count * dt_size,
+                                                 mem_type, peer, team, task),
+                              task, out);
+            }
+        }
+        if (vrank != 0) {
+            peer = INV_VRANK(ucc_kn_tree_parent(vrank, radix), root, size);
+            for (msg = k * window; msg < ucc_min((k + 1) * window, n_msgs);
+                 msg++) {
+                ucc_tl_ucp_scatter_seg_msg(task, vrank, msg, &vblock, &offset,
+                                           &count);
+                buf = (msg < n_segs)
+                          ? PTR_OFFSET(args->dst.info.buffer, offset * dt_size)
+                          : ucc_tl_ucp_scatter_seg_slot(task, msg, dt_size);
+                UCPCHECK_GOTO(ucc_tl_ucp_recv_nb(buf, count * dt_size,
+                                                 mem_type, peer, team, task),
+                              task, out);
+            }
+        }
+        task->scatter_seg.step++;
+        if (UCC_INPROGRESS == ucc_tl_ucp_test(task)) {
+            return;
+        }
+    }
+    ucc_assert(UCC_TL_UCP_TASK_P2P_COMPLETE(task));
+    task->super.status = UCC_OK;
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_scatter_seg_done", 0);
+out:
+    return;
+}
+
+static ucc_status_t ucc_tl_ucp_scatter_seg_start(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+    ucc_coll_args_t   *args = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t *team = TASK_TEAM(task);
+    ucc_rank_t         rank = UCC_TL_TEAM_RANK(team);
+    size_t             dt_size;
+    ucc_status_t       status;
+
+    UCC_TL_UCP_PROFILE_REQUEST_EVENT(coll_task, "ucp_scatter_seg_start", 0);
+    ucc_tl_ucp_task_reset(task, UCC_INPROGRESS);
+    task->scatter_seg.step = 0;
+
+    if (rank == args->root && !UCC_IS_INPLACE(*args)) {
+        dt_size = ucc_dt_size(args->src.info.datatype);
+        status  = ucc_mc_memcpy(
+            args->dst.info.buffer,
+            PTR_OFFSET(args->src.info.buffer,
+                       rank * task->scatter_seg.block_count * dt_size),
+            task->scatter_seg.block_count * dt_size, args->dst.info.mem_type,
+            args->src.info.mem_type);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+    return ucc_progress_queue_enqueue(UCC_TL_CORE_CTX(team)->pq, &task->super);
+}
+
+static ucc_status_t
+ucc_tl_ucp_scatter_seg_finalize(ucc_coll_task_t *coll_task)
+{
+    ucc_tl_ucp_task_t *task = ucc_derived_of(coll_task, ucc_tl_ucp_task_t);
+
+    if (task->scatter_seg.scratch_mc_header) {
+        ucc_mc_free(task->scatter_seg.scratch_mc_header);
+    }
+    return ucc_tl_ucp_coll_finalize(coll_task);
+}
+
+ucc_status_t ucc_tl_ucp_scatter_seg_init_common(ucc_tl_ucp_task_t *task,
+                                                uint32_t           radix)
+{
+    ucc_coll_args_t         *args     = &TASK_ARGS(task);
+    ucc_tl_ucp_team_t       *team     = TASK_TEAM(task);
+    ucc_tl_ucp_lib_config_t *cfg      = &UCC_TL_UCP_TEAM_LIB(team)->cfg;
+    ucc_rank_t               size     = UCC_TL_TEAM_SIZE(team);
+    ucc_rank_t               rank     = UCC_TL_TEAM_RANK(team);
+    ucc_rank_t               vrank    = VRANK(rank, args->root, size);
+    int                      is_root  = (rank == args->root);
+    ucc_datatype_t           dt       = is_root ? args->src.info.datatype
+                                                : args->dst.info.datatype;
+    ucc_memory_type_t        mem_type = is_root ? args->src.info.mem_type
+                                                : args->dst.info.mem_type;
+    size_t                   count    = is_root ? args->src.info.count / size
+                                                : args->dst.info.count;
+    size_t                   dt_size  = ucc_dt_size(dt);
+    ucc_rank_t               subtree;
+    ucc_status_t             status;
+
+    if (UCC_TL_UCP_DT_NON_CONTIG(dt)) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    task->super.post     = ucc_tl_ucp_scatter_seg_start;
+    task->super.progress = ucc_tl_ucp_scatter_seg_progress;
+    task->super.finalize = ucc_tl_ucp_scatter_seg_finalize;
+
+    subtree = ucc_kn_tree_subtree_size(vrank, radix, size);
+    task->scatter_seg.radix       = radix;
+    task->scatter_seg.block_count = count;
+    task->scatter_seg.seg_count   =
+        ucc_min(ucc_max(cfg->scatter_seg_size / dt_size, 1), ucc_max(count, 1));
+    task->scatter_seg.n_segs      =
+        ucc_div_round_up(count, task->scatter_seg.seg_count);
+    task->scatter_seg.window      = ucc_max(cfg->scatter_seg_window, 1);
+    task->scatter_seg.n_msgs      = subtree * task->scatter_seg.n_segs;
+    task->scatter_seg.scratch           = NULL;
+    task->scatter_seg.scratch_mc_header = NULL;
+
+    if (vrank != 0 && subtree > 1 && count > 0) {
+        status = ucc_mc_alloc(&task->scatter_seg.scratch_mc_header,
+                              2 * task->scatter_seg.window *
+                                  task->scatter_seg.seg_count * dt_size,
+                              mem_type);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+        task->scatter_seg.scratch = task->scatter_seg.scratch_mc_header->addr;
+    }
+    return UCC_OK;
+}
@@ -19,6 +19,7 @@
 #include "reduce_scatterv/reduce_scatterv.h"
 #include "reduce/reduce.h"
 #include "gather/gather.h"
+#include "scatter/scatter.h"
 #include "fanout/fanout.h"
 #include "fanin/fanin.h"
 
@@ -37,12 +38,23 @@ static ucc_config_field_t ucc_tl_ucp_lib_config_table[] = {
      ucc_offsetof(ucc_tl_ucp_lib_config_t, alltoall_pairwise_num_posts),
      UCC_CONFIG_TYPE_UINT},
 
+    {"ALLTOALL_BRUCK_RADIX", "2",
+     "Radix of the Bruck alltoall algorithm",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, alltoall_bruck_radix),
+     UCC_CONFIG_TYPE_UINT},
+
     {"ALLTOALLV_PAIRWISE_NUM_POSTS", "1",
      "Maximum number of outstanding send and receive messages in alltoallv "
      "pairwise algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, alltoallv_pairwise_num_posts),
      UCC_CONFIG_TYPE_UINT},
 
+    {"ALLTOALLV_ONESIDED_NUM_GETS", "8",
+     "Maximum number of outstanding get operations in alltoallv onesided "
+     "algorithm, 0 - no limit",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, alltoallv_onesided_num_gets),
+     UCC_CONFIG_TYPE_UINT},
+
     {"KN_RADIX", "0",
      "Radix of all algorithms based on knomial pattern. When set to a "
      "positive value it is used as a convinience parameter to set all "
@@ -83,6 +95,13 @@ static ucc_config_field_t ucc_tl_ucp_lib_config_table[] = {
      ucc_offsetof(ucc_tl_ucp_lib_config_t, allreduce_sra_kn_frag_size),
      UCC_CONFIG_TYPE_MEMUNITS},
 
+    {"ALLREDUCE_RD_SCRATCH_SIZE", "4k",
+     "Size of the per-team preallocated scratch buffer used by recursive "
+     "doubling allreduce.\n"
+     "Larger messages are handled by knomial allreduce",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allreduce_rd_scratch_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
     {"ALLREDUCE_SRA_KN_N_FRAGS", "2",
      "Number of fragments each allreduce is split into when SRA knomial alg is "
      "used\n"
@@ -101,15 +120,72 @@ static ucc_config_field_t ucc_tl_ucp_lib_config_table[] = {
      ucc_offsetof(ucc_tl_ucp_lib_config_t, allreduce_sra_kn_seq),
      UCC_CONFIG_TYPE_BOOL},
 
+    {"ALLREDUCE_DBT_SEG_SIZE", "64k",
+     "Segment size of the double binary tree allreduce algorithm",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allreduce_dbt_seg_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"ALLREDUCE_DBT_N_TREES", "2",
+     "Number of trees of the double binary tree allreduce algorithm, 1 is "
+     "a single pipelined binary tree",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allreduce_dbt_n_trees),
+     UCC_CONFIG_TYPE_UINT},
+
     {"REDUCE_SCATTER_KN_RADIX", "4",
      "Radix of the knomial reduce-scatter algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, reduce_scatter_kn_radix),
      UCC_CONFIG_TYPE_UINT},
 
+    {"REDUCE_SCATTERV_KN_RADIX", "4",
+     "Radix of the knomial reduce-scatterv algorithm",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, reduce_scatterv_kn_radix),
+     UCC_CONFIG_TYPE_UINT},
+
     {"ALLGATHER_KN_RADIX", "4", "Radix of the knomial allgather algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, allgather_kn_radix),
      UCC_CONFIG_TYPE_UINT},
 
+    {"ALLGATHER_BRUCK_RADIX", "2", "Radix of the Bruck allgather algorithm",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allgather_bruck_radix),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"ALLGATHER_RING_FRAG_SIZE", "256k",
+     "Fragment size of the ring allgather algorithm. Every ring step is split "
+     "into fragments of this size which are progressed concurrently",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allgather_ring_frag_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"ALLGATHER_RING_MAX_FRAGS", "4",
+     "Maximum number of fragments of the ring allgather algorithm",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allgather_ring_max_frags),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"ALLGATHERV_KN_RADIX", "2",
+     "Radix of the knomial allgatherv algorithm, radix 2 is recursive "
+     "doubling",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allgatherv_kn_radix),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"ALLGATHERV_RING_FRAG_SIZE", "256k",
+     "Fragment size of the ring allgatherv algorithm. Every block is split "
+     "into fragments so that the largest block fragment does not exceed this "
+     "size, the fragments are progressed concurrently",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allgatherv_ring_frag_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"ALLGATHERV_RING_MAX_FRAGS", "4",
+     "Maximum number of fragments of the ring allgatherv algorithm",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allgatherv_ring_max_frags),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"ALLGATHERV_RING_MAX_SKEW", "4",
+     "Maximum skew of allgatherv counts for the ring algorithm: ring time is "
+     "proportional to team_size * max block, if it exceeds the total size "
+     "more than this many times knomial algorithm is used instead. "
+     "0 - disable",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, allgatherv_ring_max_skew),
+     UCC_CONFIG_TYPE_UINT},
+
     {"BCAST_KN_RADIX", "4", "Radix of the recursive-knomial bcast algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, bcast_kn_radix),
      UCC_CONFIG_TYPE_UINT},
@@ -123,14 +199,71 @@ static ucc_config_field_t ucc_tl_ucp_lib_config_table[] = {
      ucc_offsetof(ucc_tl_ucp_lib_config_t, reduce_kn_radix),
      UCC_CONFIG_TYPE_UINT},
 
+    {"REDUCE_SRG_KN_RADIX", "4",
+     "Radix of the scatter-reduce-gather (SRG) knomial reduce algorithm",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, reduce_srg_kn_radix),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"REDUCE_SRG_KN_FRAG_SIZE", "4M",
+     "Maximum fragment size of the SRG knomial reduce pipeline, 0 - no "
+     "fragmentation",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, reduce_srg_kn_frag_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"REDUCE_SRG_KN_PIPELINE_DEPTH", "2",
+     "Number of fragments of the SRG knomial reduce processed concurrently",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, reduce_srg_kn_pipeline_depth),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"REDUCE_CHAIN_SEG_SIZE", "128k",
+     "Segment size of the chain reduce algorithm",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, reduce_chain_seg_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
     {"GATHER_KN_RADIX", "4", "Radix of the knomial tree reduce algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, gather_kn_radix),
      UCC_CONFIG_TYPE_UINT},
 
+    {"GATHER_SEG_SIZE", "64k",
+     "Segment size of the segmented knomial and linear gather algorithms",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, gather_seg_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"GATHER_SEG_WINDOW", "8",
+     "Number of segments of the segmented gather a rank keeps in flight "
+     "in each direction. Interior ranks of the tree use 2 * window segments "
+     "of scratch",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, gather_seg_window),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"GATHER_LINEAR_BLOCK_SIZE", "256k",
+     "Per rank block size starting from which the segmented gather is done "
+     "over a flat tree, i.e. linear gather with a bounded receive window",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, gather_linear_block_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
     {"SCATTER_KN_RADIX", "4", "Radix of the knomial scatter algorithm",
      ucc_offsetof(ucc_tl_ucp_lib_config_t, scatter_kn_radix),
      UCC_CONFIG_TYPE_UINT},
 
+    {"SCATTER_SEG_SIZE", "64k",
+     "Segment size of the segmented knomial and linear scatter algorithms",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, scatter_seg_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"SCATTER_SEG_WINDOW", "8",
+     "Number of segments of the segmented scatter a rank keeps in flight "
+     "in each direction. Interior ranks of the tree use 2 * window segments "
+     "of scratch",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, scatter_seg_window),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"SCATTER_LINEAR_BLOCK_SIZE", "256k",
+     "Per rank block size starting from which the segmented scatter is done "
+     "over a flat tree, i.e. linear scatter with a bounded send window",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, scatter_linear_block_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
     {"REDUCE_AVG_PRE_OP", "1",
      "Reduce will perform division by team_size in early stages of the "
      "algorithm,\n"
@@ -149,6 +282,67 @@ static ucc_config_field_t ucc_tl_ucp_lib_config_table[] = {
      ucc_offsetof(ucc_tl_ucp_lib_config_t, reduce_scatterv_ring_bidirectional),
      UCC_CONFIG_TYPE_BOOL},
 
+    {"TUNER", "n",
+     "Enable online tuning of allreduce, bcast, alltoall and reduce_scatter.\n"
+     "On the first call for a given msg size bucket (power of 2) all the\n"
+     "algorithms are measured and the fastest one is used afterwards",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, tuner), UCC_CONFIG_TYPE_BOOL},
+
+    {"TUNER_N_ITERS", "8",
+     "Number of measured iterations of each algorithm during online tuning,\n"
+     "must be at least 1",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, tuner_n_iters),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"TUNER_N_WARMUP", "2",
+     "Number of warmup iterations of each algorithm during online tuning",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, tuner_n_warmup),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"TUNER_FILE", "",
+     "File used to store the results of online tuning. Records are keyed\n"
+     "by team size, ppn and number of nodes and are applied on team\n"
+     "creation, so the same configuration is not measured again",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, tuner_file),
+     UCC_CONFIG_TYPE_STRING},
+
+    {"GENERIC_DT_FRAG_SIZE", "256k",
+     "Size of the bounce fragment used by collectives with non contiguous "
+     "generic datatypes. Data is packed into fragments and the collective "
+     "is executed fragment by fragment on the packed data",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, generic_dt_frag_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"GENERIC_DT_PIPELINE_DEPTH", "2",
+     "Number of fragments simultaneously progressed by collectives with non "
+     "contiguous generic datatypes, packing of one fragment overlaps with "
+     "communication of another",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, generic_dt_pipeline_depth),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"TEAM_HEAP_SIZE", "1m",
+     "Size of the symmetric scratch heap registered by every team at "
+     "creation. It provides sync counters and staging space to one-sided "
+     "algorithms, so that they do not require user registered buffers. "
+     "0 - disable",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, team_heap_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"RKEY_CACHE_SIZE", "16",
+     "Number of unpacked remote keys of user buffers cached per peer of the "
+     "team. Least recently used key is destroyed when the limit is reached. "
+     "0 - disable",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, rkey_cache_size),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"SCHEDULE_CACHE_SIZE", "8",
+     "Number of built pipelined schedules kept by the team after finalize "
+     "of non persistent collectives. A collective of the same algorithm, "
+     "datatype, count and flags reuses the cached schedule instead of "
+     "building a new one. 0 - disable",
+     ucc_offsetof(ucc_tl_ucp_lib_config_t, schedule_cache_size),
+     UCC_CONFIG_TYPE_UINT},
+
     {NULL}};
 
 static ucs_config_field_t ucc_tl_ucp_context_config_table[] = {
@@ -175,6 +369,40 @@ static ucs_config_field_t ucc_tl_ucp_context_config_table[] = {
      ucc_offsetof(ucc_tl_ucp_context_config_t, pre_reg_mem),
      UCC_CONFIG_TYPE_UINT},
 
+    {"USE_AM", "n",
+     "Use UCP active messages instead of tagged send/recv for the p2p "
+     "traffic of collectives. Messages are matched by UCC in O(1) avoiding "
+     "long UCX unexpected tag queues at large scale.\n"
+     "Must be set to the same value on all the processes",
+     ucc_offsetof(ucc_tl_ucp_context_config_t, use_am), UCC_CONFIG_TYPE_BOOL},
+
+    {"WORKER_PROGRESS_ONCE", "y",
+     "Progress UCP worker once per ucc_context_progress call. Collective "
+     "tasks progressed from ucc_context_progress only check their state "
+     "instead of polling the worker NPOLLS times each. When disabled every "
+     "task polls the worker on its own",
+     ucc_offsetof(ucc_tl_ucp_context_config_t, worker_progress_once),
+     UCC_CONFIG_TYPE_BOOL},
+
+    {"RCACHE", "y",
+     "Use registration cache for user buffers accessed by one-sided "
+     "algorithms and pre-registered with PRE_REG_MEM. Registrations are "
+     "kept until the memory is released or evicted",
+     ucc_offsetof(ucc_tl_ucp_context_config_t, use_rcache),
+     UCC_CONFIG_TYPE_BOOL},
+
+    {"RCACHE_MAX_REGIONS", "inf",
+     "Max number of regions in the registration cache, least recently used "
+     "regions are evicted when the limit is reached",
+     ucc_offsetof(ucc_tl_ucp_context_config_t, rcache_max_regions),
+     UCC_CONFIG_TYPE_ULUNITS},
+
+    {"RCACHE_MAX_SIZE", "inf",
+     "Max total size of the regions in the registration cache, least "
+     "recently used regions are evicted when the limit is reached",
+     ucc_offsetof(ucc_tl_ucp_context_config_t, rcache_max_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
     {NULL}};
 
 UCC_CLASS_DEFINE_NEW_FUNC(ucc_tl_ucp_lib_t, ucc_base_lib_t,
@@ -297,6 +525,8 @@ __attribute__((constructor)) static void tl_ucp_iface_init(void)
         ucc_tl_ucp_reduce_algs;
     ucc_tl_ucp.super.alg_info[ucc_ilog2(UCC_COLL_TYPE_GATHER)] =
         ucc_tl_ucp_gather_algs;
+    ucc_tl_ucp.super.alg_info[ucc_ilog2(UCC_COLL_TYPE_SCATTER)] =
+        ucc_tl_ucp_scatter_algs;
     ucc_tl_ucp.super.alg_info[ucc_ilog2(UCC_COLL_TYPE_FANIN)] =
         ucc_tl_ucp_fanin_algs;
     ucc_tl_ucp.super.alg_info[ucc_ilog2(UCC_COLL_TYPE_FANOUT)] =
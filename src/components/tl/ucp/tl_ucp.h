@@ -10,6 +10,8 @@
 #include "components/tl/ucc_tl_log.h"
 #include "core/ucc_ee.h"
 #include "utils/ucc_mpool.h"
+#include "utils/ucc_rcache.h"
+#include "schedule/ucc_schedule_pipelined.h"
 #include "tl_ucp_ep_hash.h"
 #include <ucp/api/ucp.h>
 #include <ucs/memory/memory_type.h>
@@ -49,22 +51,54 @@ typedef struct ucc_tl_ucp_lib_config {
     uint32_t            allreduce_kn_radix;
     uint32_t            allreduce_sra_kn_radix;
     uint32_t            reduce_scatter_kn_radix;
+    uint32_t            reduce_scatterv_kn_radix;
     uint32_t            allgather_kn_radix;
+    uint32_t            allgather_bruck_radix;
+    size_t              allgather_ring_frag_size;
+    uint32_t            allgather_ring_max_frags;
+    uint32_t            allgatherv_kn_radix;
+    size_t              allgatherv_ring_frag_size;
+    uint32_t            allgatherv_ring_max_frags;
+    uint32_t            allgatherv_ring_max_skew;
     uint32_t            bcast_kn_radix;
     uint32_t            bcast_sag_kn_radix;
     uint32_t            reduce_kn_radix;
+    uint32_t            reduce_srg_kn_radix;
+    size_t              reduce_srg_kn_frag_size;
+    uint32_t            reduce_srg_kn_pipeline_depth;
+    size_t              reduce_chain_seg_size;
     uint32_t            gather_kn_radix;
+    size_t              gather_seg_size;
+    uint32_t            gather_seg_window;
+    size_t              gather_linear_block_size;
     uint32_t            scatter_kn_radix;
+    size_t              scatter_seg_size;
+    uint32_t            scatter_seg_window;
+    size_t              scatter_linear_block_size;
     uint32_t            alltoall_pairwise_num_posts;
+    uint32_t            alltoall_bruck_radix;
     uint32_t            alltoallv_pairwise_num_posts;
+    uint32_t            alltoallv_onesided_num_gets;
     uint32_t            allreduce_sra_kn_n_frags;
     uint32_t            allreduce_sra_kn_pipeline_depth;
     int                 allreduce_sra_kn_seq;
     size_t              allreduce_sra_kn_frag_thresh;
     size_t              allreduce_sra_kn_frag_size;
+    size_t              allreduce_rd_scratch_size;
+    size_t              allreduce_dbt_seg_size;
+    uint32_t            allreduce_dbt_n_trees;
     int                 reduce_avg_pre_op;
     int                 reduce_scatter_ring_bidirectional;
     int                 reduce_scatterv_ring_bidirectional;
+    int                 tuner;
+    uint32_t            tuner_n_iters;
+    uint32_t            tuner_n_warmup;
+    char               *tuner_file;
+    size_t              generic_dt_frag_size;
+    uint32_t            generic_dt_pipeline_depth;
+    size_t              team_heap_size;
+    uint32_t            rkey_cache_size;
+    uint32_t            schedule_cache_size;
 } ucc_tl_ucp_lib_config_t;
 
 typedef struct ucc_tl_ucp_context_config {
@@ -73,6 +107,11 @@ typedef struct ucc_tl_ucp_context_config {
     uint32_t                n_polls;
     uint32_t                oob_npolls;
     uint32_t                pre_reg_mem;
+    int                     use_am;
+    int                     worker_progress_once;
+    int                     use_rcache;
+    unsigned long           rcache_max_regions;
+    size_t                  rcache_max_size;
 } ucc_tl_ucp_context_config_t;
 
 typedef struct ucc_tl_ucp_lib {
@@ -89,8 +128,12 @@ typedef struct ucc_tl_ucp_remote_info {
     void * mem_h;
     void * packed_key;
     size_t packed_key_len;
+    /* registration id, see ucc_tl_ucp_rkey_get */
+    uint64_t id;
 } ucc_tl_ucp_remote_info_t;
 
+typedef struct ucc_tl_ucp_am_ctx ucc_tl_ucp_am_ctx_t;
+
 typedef struct ucc_tl_ucp_context {
     ucc_tl_context_t            super;
     ucc_tl_ucp_context_config_t cfg;
@@ -105,11 +148,50 @@ typedef struct ucc_tl_ucp_context {
     ucp_rkey_h *                rkeys;
     uint64_t                    n_rinfo_segs;
     uint64_t                    ucp_memory_types;
+    /* NULL if p2p traffic uses tag matching */
+    ucc_tl_ucp_am_ctx_t *       am;
+    /* incremented every time context progress hook progresses the worker */
+    uint32_t                    progress_seq;
+    /* worker event fd registered for ucc_context_wait, -1 if not used */
+    int                         wakeup_efd;
+    /* registration cache of user buffers, NULL if disabled */
+    ucc_rcache_t *              rcache;
+    /* id of the next local registration, never 0 */
+    uint64_t                    next_reg_id;
 } ucc_tl_ucp_context_t;
 UCC_CLASS_DECLARE(ucc_tl_ucp_context_t, const ucc_base_context_params_t *,
                   const ucc_base_config_t *);
 
-typedef struct ucc_tl_ucp_task ucc_tl_ucp_task_t;
+typedef struct ucc_tl_ucp_task  ucc_tl_ucp_task_t;
+typedef struct ucc_tl_ucp_tuner ucc_tl_ucp_tuner_t;
+typedef struct ucc_tl_ucp_rkey  ucc_tl_ucp_rkey_t;
+typedef struct ucc_tl_ucp_rcache_region ucc_tl_ucp_rcache_region_t;
+
+/* Symmetric scratch heap of the team, see tl_ucp_heap.h */
+typedef struct ucc_tl_ucp_heap {
+    /* team takes part in the heap exchange */
+    int              enabled;
+    /* heap of every rank is accessible */
+    int              ready;
+    void            *base; /* NULL if the heap is not available */
+    size_t           size;
+    ucp_mem_h        memh;
+    void            *packed_key;
+    size_t           packed_key_len;
+    /* per rank remote address and packed rkey length */
+    uint64_t        *rinfo;
+    /* per rank rkey buffer allocation status, part of rinfo allocation */
+    uint64_t        *flags;
+    /* per rank packed rkeys, max_key_len bytes each */
+    void            *rkey_bufs;
+    size_t           max_key_len;
+    ucp_rkey_h      *rkeys;
+    ucc_coll_task_t *exchange_task;
+    int              phase;
+    /* number of heap collectives started on the team, selects the slot */
+    uint32_t         seq;
+} ucc_tl_ucp_heap_t;
+
 typedef struct ucc_tl_ucp_team {
     ucc_tl_team_t              super;
     ucc_status_t               status;
@@ -117,6 +199,23 @@ typedef struct ucc_tl_ucp_team {
     ucc_tl_ucp_task_t         *preconnect_task;
     void *                     va_base[MAX_NR_SEGMENTS];
     size_t                     base_length[MAX_NR_SEGMENTS];
+    /* team rank -> ep, filled on first use so that p2p path does not
+       evaluate (possibly nested) team and context maps on every message */
+    ucp_ep_h                  *eps;
+    ucc_tl_ucp_tuner_t        *tuner;
+    /* Scratch buffers of the small msg recursive doubling allreduce,
+       mpool is initialized on the first use */
+    ucc_mpool_t                rd_scratch_mp;
+    int                        rd_scratch_init;
+    ucc_spinlock_t             rd_scratch_lock;
+    ucc_tl_ucp_heap_t          heap;
+    /* cache of unpacked remote keys of peer registrations, see
+       tl_ucp_rcache.h. RKEY_CACHE_SIZE entries per peer, allocated on
+       first use */
+    ucc_tl_ucp_rkey_t         *rkey_cache;
+    uint64_t                   rkey_cache_clock;
+    /* built pipelined schedules reused by collectives of the same shape */
+    ucc_schedule_cache_t       sched_cache;
 } ucc_tl_ucp_team_t;
 UCC_CLASS_DECLARE(ucc_tl_ucp_team_t, ucc_base_context_t *,
                   const ucc_base_team_params_t *);
@@ -126,7 +225,8 @@ UCC_CLASS_DECLARE(ucc_tl_ucp_team_t, ucc_base_context_t *,
      UCC_COLL_TYPE_ALLGATHER | UCC_COLL_TYPE_ALLGATHERV |                      \
      UCC_COLL_TYPE_ALLREDUCE | UCC_COLL_TYPE_BCAST | UCC_COLL_TYPE_BARRIER |   \
      UCC_COLL_TYPE_REDUCE | UCC_COLL_TYPE_FANIN | UCC_COLL_TYPE_FANOUT |       \
-     UCC_COLL_TYPE_REDUCE_SCATTER | UCC_COLL_TYPE_REDUCE_SCATTERV)
+     UCC_COLL_TYPE_REDUCE_SCATTER | UCC_COLL_TYPE_REDUCE_SCATTERV |          \
+     UCC_COLL_TYPE_SCATTER)
 
 #define UCC_TL_UCP_TEAM_LIB(_team)                                             \
     (ucc_derived_of((_team)->super.super.context->lib, ucc_tl_ucp_lib_t))
@@ -0,0 +1,358 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "tl_ucp_am.h"
+#include "tl_ucp_coll.h"
+#include "utils/arch/cpu.h"
+#include "components/mc/ucc_mc.h"
+
+static inline ucc_tl_ucp_am_queue_t *
+ucc_tl_ucp_am_queue_get(ucc_tl_ucp_am_ctx_t *am, uint64_t tag)
+{
+    ucc_tl_ucp_am_queue_t *q;
+    khiter_t               k;
+    int                    ret;
+
+    k = kh_get(tl_ucp_am_hash, am->queues, tag);
+    if (k != kh_end(am->queues)) {
+        return kh_value(am->queues, k);
+    }
+    q = ucc_mpool_get(&am->queue_mp);
+    if (ucc_unlikely(!q)) {
+        return NULL;
+    }
+    ucc_list_head_init(&q->posted);
+    ucc_list_head_init(&q->unexpected);
+    k = kh_put(tl_ucp_am_hash, am->queues, tag, &ret);
+    if (ucc_unlikely(ret < 0)) {
+        ucc_mpool_put(q);
+        return NULL;
+    }
+    kh_value(am->queues, k) = q;
+    return q;
+}
+
+/* Tags are reused by the subsequent collectives, so the queue is released
+   as soon as it is empty to keep the hash small */
+static inline void ucc_tl_ucp_am_queue_release(ucc_tl_ucp_am_ctx_t   *am,
+                                               ucc_tl_ucp_am_queue_t *q,
+                                               uint64_t               tag)
+{
+    khiter_t k;
+
+    if (ucc_list_is_empty(&q->posted) && ucc_list_is_empty(&q->unexpected)) {
+        k = kh_get(tl_ucp_am_hash, am->queues, tag);
+        ucc_assert(k != kh_end(am->queues));
+        kh_del(tl_ucp_am_hash, am->queues, k);
+        ucc_mpool_put(q);
+    }
+}
+
+static inline void ucc_tl_ucp_am_data_release(ucc_tl_ucp_context_t *ctx,
+                                              void *data, uint32_t flags)
+{
+    if (flags & UCC_TL_UCP_AM_UNEXP_COPY) {
+        ucc_free(data);
+    } else {
+        ucp_am_data_release(ctx->ucp_worker, data);
+    }
+}
+
+static inline void ucc_tl_ucp_am_recv_complete(ucc_tl_ucp_am_desc_t *desc,
+                                               ucs_status_t          status)
+{
+    ucc_tl_ucp_task_t *task = desc->recv.task;
+
+    if (ucc_unlikely(UCS_OK != status)) {
+        tl_error(UCC_TASK_LIB(task), "failure in am recv completion %s",
+                 ucs_status_string(status));
+        task->super.status = ucs_status_to_ucc_status(status);
+    }
+    if (desc->recv.cb) {
+        desc->recv.cb(NULL, status, NULL, (void *)task);
+    } else {
+        task->tagged.recv_completed++;
+    }
+    ucc_mpool_put(desc);
+}
+
+static void ucc_tl_ucp_am_recv_data_cb(void *request, ucs_status_t status,
+                                       size_t length, void *user_data)
+{
+    ucc_tl_ucp_am_desc_t *desc = (ucc_tl_ucp_am_desc_t *)user_data;
+
+    ucc_assert(UCS_OK != status || length == desc->recv.msglen);
+    ucc_tl_ucp_am_recv_complete(desc, status);
+    ucp_request_free(request);
+}
+
+/* Delivers the message "data" of size "length" to the posted receive.
+   Returns 1 if the data descriptor is consumed by ucp (rndv receive was
+   started), 0 otherwise. */
+static int ucc_tl_ucp_am_deliver(ucc_tl_ucp_context_t *ctx,
+                                 ucc_tl_ucp_am_desc_t *desc, void *data,
+                                 size_t length, int rndv)
+{
+    ucp_request_param_t req_param;
+    ucs_status_ptr_t    ucp_status;
+    ucc_status_t        status;
+
+    if (ucc_unlikely(length != desc->recv.msglen)) {
+        tl_error(ctx->super.super.lib,
+                 "am message size mismatch: expected %zd, received %zd",
+                 desc->recv.msglen, length);
+        desc->recv.task->super.status = UCC_ERR_NO_MESSAGE;
+        ucc_tl_ucp_am_recv_complete(desc, UCS_OK);
+        return 0;
+    }
+    if (rndv) {
+        req_param.op_attr_mask =
+            UCP_OP_ATTR_FIELD_CALLBACK | UCP_OP_ATTR_FIELD_DATATYPE |
+            UCP_OP_ATTR_FIELD_USER_DATA | UCP_OP_ATTR_FIELD_MEMORY_TYPE;
+        req_param.datatype     = ucp_dt_make_contig(length);
+        req_param.cb.recv_am   = ucc_tl_ucp_am_recv_data_cb;
+        req_param.memory_type  = ucc_memtype_to_ucs[desc->recv.mtype];
+        req_param.user_data    = (void *)desc;
+        ucp_status = ucp_am_recv_data_nbx(ctx->ucp_worker, data,
+                                          desc->recv.buffer, 1, &req_param);
+        if (UCS_PTR_IS_ERR(ucp_status)) {
+            ucc_tl_ucp_am_recv_complete(desc, UCS_PTR_STATUS(ucp_status));
+        } else if (UCS_OK == ucp_status) {
+            ucc_tl_ucp_am_recv_complete(desc, UCS_OK);
+        }
+        return 1;
+    }
+    status = ucc_mc_memcpy(desc->recv.buffer, data, length, desc->recv.mtype,
+                           UCC_MEMORY_TYPE_HOST);
+    ucc_tl_ucp_am_recv_complete(desc, UCC_OK == status ? UCS_OK
+                                                       : UCS_ERR_NO_MESSAGE);
+    return 0;
+}
+
+static ucs_status_t ucc_tl_ucp_am_recv_cb(void *arg, const void *header,
+                                          size_t header_length, void *data,
+                                          size_t length,
+                                          const ucp_am_recv_param_t *param)
+{
+    ucc_tl_ucp_context_t  *ctx  = (ucc_tl_ucp_context_t *)arg;
+    ucc_tl_ucp_am_ctx_t   *am   = ctx->am;
+    int                    rndv = !!(param->recv_attr &
+                                     UCP_AM_RECV_ATTR_FLAG_RNDV);
+    ucc_tl_ucp_am_desc_t  *desc;
+    ucc_tl_ucp_am_queue_t *q;
+    uint64_t               tag;
+    ucs_status_t           ret;
+
+    ucc_assert(header_length == sizeof(uint64_t));
+    memcpy(&tag, header, sizeof(tag));
+
+    ucc_spin_lock(&am->lock);
+    q = ucc_tl_ucp_am_queue_get(am, tag);
+    if (ucc_unlikely(!q)) {
+        ucc_spin_unlock(&am->lock);
+        goto err;
+    }
+    if (!ucc_list_is_empty(&q->posted)) {
+        desc = ucc_list_extract_head(&q->posted, ucc_tl_ucp_am_desc_t,
+                                     list_elem);
+        ucc_tl_ucp_am_queue_release(am, q, tag);
+        ucc_spin_unlock(&am->lock);
+        /* if rndv receive was not started ucp releases the data itself */
+        ucc_tl_ucp_am_deliver(ctx, desc, data, length, rndv);
+        return UCS_OK;
+    }
+    desc = ucc_mpool_get(&am->desc_mp);
+    if (ucc_unlikely(!desc)) {
+        ucc_tl_ucp_am_queue_release(am, q, tag);
+        ucc_spin_unlock(&am->lock);
+        goto err;
+    }
+    desc->unexp.length = length;
+    desc->unexp.flags  = rndv ? UCC_TL_UCP_AM_UNEXP_RNDV : 0;
+    if (rndv || (param->recv_attr & UCP_AM_RECV_ATTR_FLAG_DATA)) {
+        /* keep the data in ucp until the receive is posted */
+        desc->unexp.data = data;
+    } else {
+        desc->unexp.data = ucc_malloc(length, "tl_ucp_am_unexp");
+        if (ucc_unlikely(!desc->unexp.data && length)) {
+            ucc_mpool_put(desc);
+            ucc_tl_ucp_am_queue_release(am, q, tag);
+            ucc_spin_unlock(&am->lock);
+            goto err;
+        }
+        if (length) {
+            memcpy(desc->unexp.data, data, length);
+        }
+        desc->unexp.flags |= UCC_TL_UCP_AM_UNEXP_COPY;
+    }
+    /* desc can be consumed by the receive posted from another thread right
+       after the lock is released */
+    ret = (desc->unexp.flags & UCC_TL_UCP_AM_UNEXP_COPY) ? UCS_OK
+                                                         : UCS_INPROGRESS;
+    ucc_list_add_tail(&q->unexpected, &desc->list_elem);
+    ucc_spin_unlock(&am->lock);
+    return ret;
+err:
+    tl_error(ctx->super.super.lib, "failed to allocate am descriptor, "
+             "message with tag 0x%lx is dropped", (unsigned long)tag);
+    return UCS_OK;
+}
+
+ucc_status_t ucc_tl_ucp_am_recv(void *buffer, size_t msglen,
+                                ucc_memory_type_t mtype, uint64_t tag,
+                                ucc_tl_ucp_context_t *ctx,
+                                ucc_tl_ucp_task_t *task,
+                                ucp_tag_recv_nbx_callback_t cb)
+{
+    ucc_tl_ucp_am_ctx_t   *am = ctx->am;
+    ucc_tl_ucp_am_desc_t  *desc, *unexp;
+    ucc_tl_ucp_am_queue_t *q;
+    void                  *data;
+    size_t                 length;
+    uint32_t               flags;
+
+    desc = ucc_mpool_get(&am->desc_mp);
+    if (ucc_unlikely(!desc)) {
+        tl_error(ctx->super.super.lib, "failed to allocate am descriptor");
+        return UCC_ERR_NO_MEMORY;
+    }
+    desc->recv.buffer = buffer;
+    desc->recv.msglen = msglen;
+    desc->recv.mtype  = mtype;
+    desc->recv.task   = task;
+    desc->recv.cb     = cb;
+    task->tagged.recv_posted++;
+
+    ucc_spin_lock(&am->lock);
+    q = ucc_tl_ucp_am_queue_get(am, tag);
+    if (ucc_unlikely(!q)) {
+        ucc_spin_unlock(&am->lock);
+        task->tagged.recv_posted--;
+        ucc_mpool_put(desc);
+        return UCC_ERR_NO_MEMORY;
+    }
+    if (ucc_list_is_empty(&q->unexpected)) {
+        ucc_list_add_tail(&q->posted, &desc->list_elem);
+        ucc_spin_unlock(&am->lock);
+        return UCC_OK;
+    }
+    unexp = ucc_list_extract_head(&q->unexpected, ucc_tl_ucp_am_desc_t,
+                                  list_elem);
+    ucc_tl_ucp_am_queue_release(am, q, tag);
+    ucc_spin_unlock(&am->lock);
+
+    data   = unexp->unexp.data;
+    length = unexp->unexp.length;
+    flags  = unexp->unexp.flags;
+    ucc_mpool_put(unexp);
+    /* ucp calls are made outside of the lock: am callback takes it under
+       the worker lock */
+    if (!ucc_tl_ucp_am_deliver(ctx, desc, data, length,
+                               flags & UCC_TL_UCP_AM_UNEXP_RNDV)) {
+        ucc_tl_ucp_am_data_release(ctx, data, flags);
+    }
+    return UCC_OK;
+}
+
+ucc_status_t ucc_tl_ucp_am_init(ucc_tl_ucp_context_t *ctx,
+                                ucc_thread_mode_t     tm)
+{
+    ucp_am_handler_param_t param;
+    ucc_tl_ucp_am_ctx_t   *am;
+    ucs_status_t           ucs_status;
+    ucc_status_t           status;
+
+    am = ucc_malloc(sizeof(*am), "tl_ucp_am_ctx");
+    if (!am) {
+        tl_error(ctx->super.super.lib,
+                 "failed to allocate %zd bytes for am ctx", sizeof(*am));
+        return UCC_ERR_NO_MEMORY;
+    }
+    status = ucc_mpool_init(&am->desc_mp, 0, sizeof(ucc_tl_ucp_am_desc_t), 0,
+                            UCC_CACHE_LINE_SIZE, 128, UINT_MAX, NULL, tm,
+                            "tl_ucp_am_desc_mp");
+    if (UCC_OK != status) {
+        tl_error(ctx->super.super.lib, "failed to initialize am desc mpool");
+        goto err_desc_mp;
+    }
+    status = ucc_mpool_init(&am->queue_mp, 0, sizeof(ucc_tl_ucp_am_queue_t), 0,
+                            UCC_CACHE_LINE_SIZE, 128, UINT_MAX, NULL, tm,
+                            "tl_ucp_am_queue_mp");
+    if (UCC_OK != status) {
+        tl_error(ctx->super.super.lib, "failed to initialize am queue mpool");
+        goto err_queue_mp;
+    }
+    am->queues = kh_init(tl_ucp_am_hash);
+    if (!am->queues) {
+        status = UCC_ERR_NO_MEMORY;
+        goto err_hash;
+    }
+    ucc_spinlock_init(&am->lock, 0);
+    ctx->am = am;
+
+    param.field_mask = UCP_AM_HANDLER_PARAM_FIELD_ID |
+                       UCP_AM_HANDLER_PARAM_FIELD_FLAGS |
+                       UCP_AM_HANDLER_PARAM_FIELD_CB |
+                       UCP_AM_HANDLER_PARAM_FIELD_ARG;
+    param.id         = UCC_TL_UCP_AM_ID;
+    param.flags      = UCP_AM_FLAG_WHOLE_MSG | UCP_AM_FLAG_PERSISTENT_DATA;
+    param.cb         = ucc_tl_ucp_am_recv_cb;
+    param.arg        = ctx;
+    ucs_status = ucp_worker_set_am_recv_handler(ctx->ucp_worker, &param);
+    if (UCS_OK != ucs_status) {
+        tl_error(ctx->super.super.lib, "failed to set am handler, %s",
+                 ucs_status_string(ucs_status));
+        status  = ucs_status_to_ucc_status(ucs_status);
+        ctx->am = NULL;
+        goto err_handler;
+    }
+    return UCC_OK;
+
+err_handler:
+    ucc_spinlock_destroy(&am->lock);
+    kh_destroy(tl_ucp_am_hash, am->queues);
+err_hash:
+    ucc_mpool_cleanup(&am->queue_mp, 1);
+err_queue_mp:
+    ucc_mpool_cleanup(&am->desc_mp, 1);
+err_desc_mp:
+    ucc_free(am);
+    return status;
+}
+
+void ucc_tl_ucp_am_cleanup(ucc_tl_ucp_context_t *ctx)
+{
+    ucc_tl_ucp_am_ctx_t   *am = ctx->am;
+    ucp_am_handler_param_t param;
+    ucc_tl_ucp_am_queue_t *q;
+    ucc_tl_ucp_am_desc_t  *desc, *tmp;
+
+    if (!am) {
+        return;
+    }
+    param.field_mask = UCP_AM_HANDLER_PARAM_FIELD_ID |
+                       UCP_AM_HANDLER_PARAM_FIELD_CB;
+    param.id         = UCC_TL_UCP_AM_ID;
+    param.cb         = NULL;
+    ucp_worker_set_am_recv_handler(ctx->ucp_worker, &param);
+
+    kh_foreach_value(am->queues, q, {
+        ucc_list_for_each_safe(desc, tmp, &q->unexpected, list_elem) {
+            ucc_tl_ucp_am_data_release(ctx, desc->unexp.data,
+                                       desc->unexp.flags);
+        }
+        if (!ucc_list_is_empty(&q->posted)) {
+            tl_debug(ctx->super.super.lib,
+                     "am receive is not completed at context cleanup");
+        }
+    });
+    kh_destroy(tl_ucp_am_hash, am->queues);
+    ucc_spinlock_destroy(&am->lock);
+    ucc_mpool_cleanup(&am->queue_mp, 1);
+    ucc_mpool_cleanup(&am->desc_mp, 1);
+    ucc_free(am);
+    ctx->am = NULL;
+}
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_TL_UCP_AM_H_
+#define UCC_TL_UCP_AM_H_
+#include "config.h"
+#include "tl_ucp.h"
+#include "utils/khash.h"
+#include "utils/ucc_list.h"
+#include "utils/ucc_spinlock.h"
+
+/* Active message based p2p transport (UCC_TL_UCP_USE_AM=y).
+
+   Every message carries the same 64bit tag that is used in the tagged mode
+   (see tl_ucp_tag.h: it encodes team id, scope, coll tag and sender) as the
+   AM header. Receiver dispatches incoming messages by tag directly into the
+   posted receive descriptors, messages that arrive before the matching
+   receive is posted are kept as unexpected until it is. Both lookups are
+   O(1) in the hash keyed by tag, so the cost does not depend on the number
+   of outstanding messages as it does with UCX tag matching queues.
+
+   Unexpected queue is per context rather than per team: a message can
+   arrive before the receiver has created the team it belongs to. */
+
+#define UCC_TL_UCP_AM_ID 0x7cc
+
+enum {
+    UCC_TL_UCP_AM_UNEXP_RNDV = UCC_BIT(0), /* data is rndv descriptor */
+    UCC_TL_UCP_AM_UNEXP_COPY = UCC_BIT(1)  /* data was copied to malloc buffer,
+                                              ucp one was not persistent */
+};
+
+typedef struct ucc_tl_ucp_am_desc {
+    ucc_list_link_t list_elem;
+    union {
+        struct {
+            void                       *buffer;
+            size_t                      msglen;
+            ucc_memory_type_t           mtype;
+            ucc_tl_ucp_task_t          *task;
+            /* NULL for ucc_tl_ucp_recv_nb, completion is recv_completed++ */
+            ucp_tag_recv_nbx_callback_t cb;
+        } recv;
+        struct {
+            void                       *data;
+            size_t                      length;
+            uint32_t                    flags;
+        } unexp;
+    };
+} ucc_tl_ucp_am_desc_t;
+
+typedef struct ucc_tl_ucp_am_queue {
+    ucc_list_link_t posted;
+    ucc_list_link_t unexpected;
+} ucc_tl_ucp_am_queue_t;
+
+KHASH_MAP_INIT_INT64(tl_ucp_am_hash, ucc_tl_ucp_am_queue_t *);
+
+typedef struct ucc_tl_ucp_am_ctx {
+    ucc_spinlock_t           lock;
+    khash_t(tl_ucp_am_hash) *queues;
+    ucc_mpool_t              desc_mp;
+    ucc_mpool_t              queue_mp;
+} ucc_tl_ucp_am_ctx_t;
+
+ucc_status_t ucc_tl_ucp_am_init(ucc_tl_ucp_context_t *ctx,
+                                ucc_thread_mode_t     tm);
+
+void ucc_tl_ucp_am_cleanup(ucc_tl_ucp_context_t *ctx);
+
+/* Posts receive of the message with given tag. Completion is reported
+   either via task->tagged.recv_completed or via "cb" if it is not NULL */
+ucc_status_t ucc_tl_ucp_am_recv(void *buffer, size_t msglen,
+                                ucc_memory_type_t mtype, uint64_t tag,
+                                ucc_tl_ucp_context_t *ctx,
+                                ucc_tl_ucp_task_t *task,
+                                ucp_tag_recv_nbx_callback_t cb);
+#endif
@@ -6,6 +6,7 @@
 
 #include "tl_ucp.h"
 #include "tl_ucp_coll.h"
+#include "tl_ucp_generic_dt.h"
 #include "components/mc/ucc_mc.h"
 #include "core/ucc_team.h"
 #include "barrier/barrier.h"
@@ -19,16 +20,21 @@
 #include "bcast/bcast.h"
 #include "reduce/reduce.h"
 #include "gather/gather.h"
+#include "scatter/scatter.h"
 #include "fanin/fanin.h"
 #include "fanout/fanout.h"
 
 const char
     *ucc_tl_ucp_default_alg_select_str[UCC_TL_UCP_N_DEFAULT_ALG_SELECT_STR] = {
         UCC_TL_UCP_ALLREDUCE_DEFAULT_ALG_SELECT_STR,
+        UCC_TL_UCP_ALLGATHER_DEFAULT_ALG_SELECT_STR,
+        UCC_TL_UCP_ALLGATHERV_DEFAULT_ALG_SELECT_STR,
         UCC_TL_UCP_BCAST_DEFAULT_ALG_SELECT_STR,
         UCC_TL_UCP_ALLTOALL_DEFAULT_ALG_SELECT_STR,
         UCC_TL_UCP_REDUCE_SCATTER_DEFAULT_ALG_SELECT_STR,
-        UCC_TL_UCP_REDUCE_SCATTERV_DEFAULT_ALG_SELECT_STR};
+        UCC_TL_UCP_REDUCE_SCATTERV_DEFAULT_ALG_SELECT_STR,
+        UCC_TL_UCP_REDUCE_DEFAULT_ALG_SELECT_STR,
+        UCC_TL_UCP_GATHER_DEFAULT_ALG_SELECT_STR};
 
 void ucc_tl_ucp_send_completion_cb(void *request, ucs_status_t status,
                                    void *user_data)
@@ -96,9 +102,14 @@ ucc_status_t ucc_tl_ucp_coll_init(ucc_base_coll_args_t *coll_args,
                                   ucc_base_team_t *team,
                                   ucc_coll_task_t **task_h)
 {
-    ucc_tl_ucp_task_t    *task = ucc_tl_ucp_init_task(coll_args, team);
+    ucc_tl_ucp_task_t    *task;
     ucc_status_t          status;
 
+    if (ucc_tl_ucp_coll_is_generic_dt(coll_args, team)) {
+        return ucc_tl_ucp_generic_dt_init(coll_args, team,
+                                          ucc_tl_ucp_coll_init, task_h);
+    }
+    task = ucc_tl_ucp_init_task(coll_args, team);
     switch (coll_args->args.coll_type) {
     case UCC_COLL_TYPE_BARRIER:
         status = ucc_tl_ucp_barrier_init(task);
@@ -127,6 +138,9 @@ ucc_status_t ucc_tl_ucp_coll_init(ucc_base_coll_args_t *coll_args,
     case UCC_COLL_TYPE_GATHER:
         status = ucc_tl_ucp_gather_init(task);
         break;
+    case UCC_COLL_TYPE_SCATTER:
+        status = ucc_tl_ucp_scatter_init(task);
+        break;
     case UCC_COLL_TYPE_FANIN:
         status = ucc_tl_ucp_fanin_init(task);
         break;
@@ -150,14 +164,26 @@ static inline int alg_id_from_str(ucc_coll_type_t coll_type, const char *str)
     switch (coll_type) {
     case UCC_COLL_TYPE_ALLREDUCE:
         return ucc_tl_ucp_allreduce_alg_from_str(str);
+    case UCC_COLL_TYPE_ALLGATHER:
+        return ucc_tl_ucp_allgather_alg_from_str(str);
+    case UCC_COLL_TYPE_ALLGATHERV:
+        return ucc_tl_ucp_allgatherv_alg_from_str(str);
     case UCC_COLL_TYPE_BCAST:
         return ucc_tl_ucp_bcast_alg_from_str(str);
     case UCC_COLL_TYPE_ALLTOALL:
         return ucc_tl_ucp_alltoall_alg_from_str(str);
+    case UCC_COLL_TYPE_ALLTOALLV:
+        return ucc_tl_ucp_alltoallv_alg_from_str(str);
     case UCC_COLL_TYPE_REDUCE_SCATTER:
         return ucc_tl_ucp_reduce_scatter_alg_from_str(str);
     case UCC_COLL_TYPE_REDUCE_SCATTERV:
         return ucc_tl_ucp_reduce_scatterv_alg_from_str(str);
+    case UCC_COLL_TYPE_REDUCE:
+        return ucc_tl_ucp_reduce_alg_from_str(str);
+    case UCC_COLL_TYPE_GATHER:
+        return ucc_tl_ucp_gather_alg_from_str(str);
+    case UCC_COLL_TYPE_SCATTER:
+        return ucc_tl_ucp_scatter_alg_from_str(str);
     default:
         break;
     }
@@ -183,6 +209,44 @@ ucc_status_t ucc_tl_ucp_alg_id_to_init(int alg_id, const char *alg_id_str,
         case UCC_TL_UCP_ALLREDUCE_ALG_SRA_KNOMIAL:
             *init = ucc_tl_ucp_allreduce_sra_knomial_init;
             break;
+        case UCC_TL_UCP_ALLREDUCE_ALG_RD:
+            *init = ucc_tl_ucp_allreduce_rd_init;
+            break;
+        case UCC_TL_UCP_ALLREDUCE_ALG_DBT:
+            *init = ucc_tl_ucp_allreduce_dbt_init;
+            break;
+        default:
+            status = UCC_ERR_INVALID_PARAM;
+            break;
+        };
+        break;
+    case UCC_COLL_TYPE_ALLGATHER:
+        switch (alg_id) {
+        case UCC_TL_UCP_ALLGATHER_ALG_RING:
+            *init = ucc_tl_ucp_allgather_ring_init;
+            break;
+        case UCC_TL_UCP_ALLGATHER_ALG_RD:
+            *init = ucc_tl_ucp_allgather_rd_init;
+            break;
+        case UCC_TL_UCP_ALLGATHER_ALG_BRUCK:
+            *init = ucc_tl_ucp_allgather_bruck_init;
+            break;
+        case UCC_TL_UCP_ALLGATHER_ALG_NEIGHBOR:
+            *init = ucc_tl_ucp_allgather_neighbor_init;
+            break;
+        default:
+            status = UCC_ERR_INVALID_PARAM;
+            break;
+        };
+        break;
+    case UCC_COLL_TYPE_ALLGATHERV:
+        switch (alg_id) {
+        case UCC_TL_UCP_ALLGATHERV_ALG_RING:
+            *init = ucc_tl_ucp_allgatherv_ring_init;
+            break;
+        case UCC_TL_UCP_ALLGATHERV_ALG_KNOMIAL:
+            *init = ucc_tl_ucp_allgatherv_knomial_init;
+            break;
         default:
             status = UCC_ERR_INVALID_PARAM;
             break;
@@ -209,6 +273,22 @@ ucc_status_t ucc_tl_ucp_alg_id_to_init(int alg_id, const char *alg_id_str,
         case UCC_TL_UCP_ALLTOALL_ALG_ONESIDED:
             *init = ucc_tl_ucp_alltoall_onesided_init;
             break;
+        case UCC_TL_UCP_ALLTOALL_ALG_BRUCK:
+            *init = ucc_tl_ucp_alltoall_bruck_init;
+            break;
+        default:
+            status = UCC_ERR_INVALID_PARAM;
+            break;
+        };
+        break;
+    case UCC_COLL_TYPE_ALLTOALLV:
+        switch (alg_id) {
+        case UCC_TL_UCP_ALLTOALLV_ALG_PAIRWISE:
+            *init = ucc_tl_ucp_alltoallv_pairwise_init;
+            break;
+        case UCC_TL_UCP_ALLTOALLV_ALG_ONESIDED:
+            *init = ucc_tl_ucp_alltoallv_onesided_init;
+            break;
         default:
             status = UCC_ERR_INVALID_PARAM;
             break;
@@ -229,6 +309,54 @@ ucc_status_t ucc_tl_ucp_alg_id_to_init(int alg_id, const char *alg_id_str,
         case UCC_TL_UCP_REDUCE_SCATTERV_ALG_RING:
             *init = ucc_tl_ucp_reduce_scatterv_ring_init;
             break;
+        case UCC_TL_UCP_REDUCE_SCATTERV_ALG_KNOMIAL:
+            *init = ucc_tl_ucp_reduce_scatterv_knomial_init;
+            break;
+        default:
+            status = UCC_ERR_INVALID_PARAM;
+            break;
+        };
+        break;
+    case UCC_COLL_TYPE_REDUCE:
+        switch (alg_id) {
+        case UCC_TL_UCP_REDUCE_ALG_KNOMIAL:
+            *init = ucc_tl_ucp_reduce_knomial_init;
+            break;
+        case UCC_TL_UCP_REDUCE_ALG_SRG_KNOMIAL:
+            *init = ucc_tl_ucp_reduce_srg_knomial_init;
+            break;
+        case UCC_TL_UCP_REDUCE_ALG_CHAIN:
+            *init = ucc_tl_ucp_reduce_chain_init;
+            break;
+        default:
+            status = UCC_ERR_INVALID_PARAM;
+            break;
+        };
+        break;
+    case UCC_COLL_TYPE_GATHER:
+        switch (alg_id) {
+        case UCC_TL_UCP_GATHER_ALG_KNOMIAL:
+            *init = ucc_tl_ucp_gather_knomial_init;
+            break;
+        case UCC_TL_UCP_GATHER_ALG_SEG_KNOMIAL:
+            *init = ucc_tl_ucp_gather_seg_knomial_init;
+            break;
+        case UCC_TL_UCP_GATHER_ALG_LINEAR:
+            *init = ucc_tl_ucp_gather_linear_init;
+            break;
+        default:
+            status = UCC_ERR_INVALID_PARAM;
+            break;
+        };
+        break;
+    case UCC_COLL_TYPE_SCATTER:
+        switch (alg_id) {
+        case UCC_TL_UCP_SCATTER_ALG_SEG_KNOMIAL:
+            *init = ucc_tl_ucp_scatter_seg_knomial_init;
+            break;
+        case UCC_TL_UCP_SCATTER_ALG_LINEAR:
+            *init = ucc_tl_ucp_scatter_linear_init;
+            break;
         default:
             status = UCC_ERR_INVALID_PARAM;
             break;
@@ -15,7 +15,7 @@
 #include "components/ec/ucc_ec.h"
 #include "tl_ucp_tag.h"
 
-#define UCC_TL_UCP_N_DEFAULT_ALG_SELECT_STR 5
+#define UCC_TL_UCP_N_DEFAULT_ALG_SELECT_STR 9
 extern const char
     *ucc_tl_ucp_default_alg_select_str[UCC_TL_UCP_N_DEFAULT_ALG_SELECT_STR];
 
@@ -27,6 +27,51 @@ extern const char
         }                                                                     \
     } while (0)
 
+/* Knomial tree used by gather and scatter: vrank v > 0 is a child of
+   v - ((v / d) % radix) * d where d is the largest power of radix dividing v,
+   subtree of v covers vranks [v, v + subtree size) */
+static inline ucc_rank_t ucc_kn_tree_level_dist(ucc_rank_t vrank,
+                                                uint32_t radix)
+{
+    uint64_t dist = 1;
+
+    while (vrank % (dist * radix) == 0) {
+        dist *= radix;
+    }
+    return (ucc_rank_t)dist;
+}
+
+static inline ucc_rank_t ucc_kn_tree_parent(ucc_rank_t vrank, uint32_t radix)
+{
+    ucc_rank_t dist = ucc_kn_tree_level_dist(vrank, radix);
+
+    return vrank - ((vrank / dist) % radix) * dist;
+}
+
+static inline ucc_rank_t ucc_kn_tree_subtree_size(ucc_rank_t vrank,
+                                                  uint32_t radix,
+                                                  ucc_rank_t size)
+{
+    if (vrank == 0) {
+        return size;
+    }
+    return ucc_min(ucc_kn_tree_level_dist(vrank, radix), size - vrank);
+}
+
+/* child of vrank whose subtree holds vblock, vblock is in the subtree of
+   vrank and vblock != vrank */
+static inline ucc_rank_t ucc_kn_tree_child(ucc_rank_t vrank, ucc_rank_t vblock,
+                                           uint32_t radix)
+{
+    ucc_rank_t dist = 1;
+    ucc_rank_t off  = vblock - vrank;
+
+    while ((uint64_t)dist * radix <= off) {
+        dist *= radix;
+    }
+    return vrank + (off / dist) * dist;
+}
+
 #define VRANK(_rank, _root, _team_size)                                       \
     (((_rank) - (_root) + (_team_size)) % (_team_size))
 
@@ -79,6 +124,8 @@ typedef struct ucc_tl_ucp_task {
             uint32_t        recv_posted;
             uint32_t        recv_completed;
             uint32_t        tag;
+            /* AM header of the sends, must stay valid until completion */
+            uint64_t        am_tag;
         } tagged;
         struct {
             uint32_t        put_posted;
@@ -88,6 +135,8 @@ typedef struct ucc_tl_ucp_task {
         } onesided;
     };
     uint32_t        n_polls;
+    /* context progress_seq at the last check of the task */
+    uint32_t        progress_seq;
     ucc_subset_t    subset;
     union {
         struct {
@@ -102,6 +151,52 @@ typedef struct ucc_tl_ucp_task {
             ucc_ee_executor_task_t *etask;
             ucc_ee_executor_t      *executor;
         } allreduce_kn;
+        struct {
+            int                     phase;
+            ucc_knomial_pattern_t   p;
+            void                   *scratch;
+            /* reduction of the current step: dst = reduce_src op scratch */
+            void                   *reduce_src;
+            int                     is_avg;
+            /* p2p completions left in the current step */
+            uint32_t                pending;
+        } allreduce_rd;
+        struct {
+            int                         phase;
+            /* per peer send and recv headers followed by peer rkeys */
+            void                       *scratch;
+            void                       *keys;
+            /* NULL if src is a part of the context mapped segment */
+            ucc_tl_ucp_rcache_region_t *region;
+            void                       *packed_key;
+            size_t                      packed_key_len;
+            uint64_t                    reg_id;
+            uint32_t                    get_posted;
+            uint32_t                    get_completed;
+        } alltoallv_onesided;
+        struct {
+            int                     phase;
+            uint32_t                radix;
+            /* weight of the current digit: radix^step */
+            ucc_rank_t              pow;
+            /* rotated blocks followed by (radix-1) send and recv buffers */
+            void                   *scratch;
+            ucc_mc_buffer_header_t *scratch_mc_header;
+            size_t                  max_blocks;
+            /* local copies of the current phase, see alltoall_bruck.c */
+            void                   *copies;
+            uint32_t                n_copies;
+            uint32_t                copies_posted;
+            ucc_ee_executor_task_t *etask;
+        } alltoall_bruck;
+        struct {
+            /* slot of the team heap used for staging and sync, -1 if
+               user provided global work buffer and mapped buffers */
+            int                     heap_slot;
+            uint32_t                heap_seq;
+            /* puts are posted once the heap slots of the peers are free */
+            int                     posted;
+        } alltoall_onesided;
         struct {
             int                     phase;
             ucc_knomial_pattern_t   p;
@@ -130,6 +225,16 @@ typedef struct ucc_tl_ucp_task {
             ucc_ee_executor_task_t *etask;
             ucc_ee_executor_t      *executor;
         } reduce_scatterv_ring;
+        struct {
+            int                     phase;
+            int                     reduced;
+            ucc_knomial_pattern_t   p;
+            size_t                  count;
+            void                   *scratch;
+            ucc_mc_buffer_header_t *scratch_mc_header;
+            ucc_ee_executor_task_t *etask;
+            ucc_ee_executor_t      *executor;
+        } reduce_scatterv_kn;
         struct {
             int                     phase;
             ucc_knomial_pattern_t   p;
@@ -142,6 +247,40 @@ typedef struct ucc_tl_ucp_task {
             void                   *sbuf;
             ucc_ee_executor_task_t *etask;
         } allgather_kn;
+        struct {
+            /* every block is split into n_frags fragments, the task
+               moves fragment "frag" of all the blocks */
+            int                     n_frags;
+            int                     frag;
+        } allgather_ring;
+        struct {
+            ucc_rank_t              dist;
+            ucc_ee_executor_task_t *etask;
+        } allgather_rd;
+        struct {
+            /* number of blocks received so far, including own */
+            ucc_rank_t              n_blocks;
+            uint32_t                radix;
+            ucc_ee_executor_task_t *etask;
+        } allgather_bruck;
+        struct {
+            ucc_rank_t              step;
+            ucc_rank_t              send_from;
+            ucc_rank_t              recv_from[2];
+            ucc_ee_executor_task_t *etask;
+        } allgather_neighbor;
+        struct {
+            int                     phase;
+            ucc_knomial_pattern_t   p;
+            /* blocks are stored in rank order without gaps, a range of
+               ranks is sent as one message */
+            int                     contig;
+            ucc_ee_executor_task_t *etask;
+        } allgatherv_kn;
+        struct {
+            int                     n_frags;
+            int                     frag;
+        } allgatherv_ring;
         struct {
             ucc_rank_t              dist;
             uint32_t                radix;
@@ -157,6 +296,20 @@ typedef struct ucc_tl_ucp_task {
             ucc_ee_executor_task_t *etask;
             ucc_ee_executor_t      *executor;
         } reduce_kn;
+        struct {
+            int                     phase;
+            ucc_knomial_pattern_t   p;
+            void                   *sbuf;
+        } reduce_srg_kn;
+        struct {
+            void                   *scratch;
+            ucc_mc_buffer_header_t *scratch_mc_header;
+            size_t                  seg_count;
+            size_t                  n_segs;
+            size_t                  step;
+            ucc_ee_executor_task_t *etask;
+            ucc_ee_executor_t      *executor;
+        } reduce_chain;
         struct {
             ucc_rank_t              dist;
             ucc_rank_t              max_dist;
@@ -165,6 +318,43 @@ typedef struct ucc_tl_ucp_task {
             void *                  scratch;
             ucc_mc_buffer_header_t *scratch_mc_header;
         } gather_kn;
+        struct {
+            uint32_t                radix;
+            size_t                  block_count;
+            size_t                  seg_count;
+            size_t                  n_segs;
+            size_t                  window;
+            size_t                  n_msgs;
+            size_t                  step;
+            void                   *scratch;
+            ucc_mc_buffer_header_t *scratch_mc_header;
+        } gather_seg;
+        struct {
+            uint32_t                radix;
+            size_t                  block_count;
+            size_t                  seg_count;
+            size_t                  n_segs;
+            size_t                  window;
+            size_t                  n_msgs;
+            size_t                  step;
+            void                   *scratch;
+            ucc_mc_buffer_header_t *scratch_mc_header;
+        } scatter_seg;
+        struct {
+            ucc_rank_t              parent;
+            ucc_rank_t              children[2];
+            int                     n_children;
+            size_t                  depth;
+            size_t                  offset;
+            size_t                  count;
+            size_t                  seg_count;
+            size_t                  n_segs;
+            size_t                  step;
+            void                   *scratch;
+            ucc_mc_buffer_header_t *scratch_mc_header;
+            ucc_ee_executor_task_t *etask;
+            ucc_ee_executor_t      *executor;
+        } allreduce_dbt;
     };
 } ucc_tl_ucp_task_t;
 
@@ -190,6 +380,7 @@ static inline void ucc_tl_ucp_task_reset(ucc_tl_ucp_task_t *task,
     task->tagged.send_completed = 0;
     task->tagged.recv_posted    = 0;
     task->tagged.recv_completed = 0;
+    task->progress_seq          = TASK_CTX(task)->progress_seq;
     task->super.status          = status;
 }
 
@@ -283,25 +474,80 @@ ucc_tl_ucp_init_task(ucc_base_coll_args_t *coll_args, ucc_base_team_t *team)
     return task;
 }
 
+/* Assigns tags to the tasks of a pipelined schedule taken from the team
+   schedule cache in the order ucc_tl_ucp_init_task assigned them when the
+   schedule was built. Team seq_num advances the same way on cache hit and
+   miss, so the tags match on all ranks regardless of their cache state. */
+static inline void
+ucc_tl_ucp_schedule_retag(ucc_tl_ucp_team_t        *team,
+                          ucc_schedule_pipelined_t *schedule_p,
+                          ucc_base_coll_args_t     *coll_args)
+{
+    ucc_tl_ucp_task_t *task;
+    int                i, j;
+
+    for (i = 0; i < schedule_p->n_frags; i++) {
+        for (j = 0; j < schedule_p->frags[i]->n_tasks; j++) {
+            task = ucc_derived_of(schedule_p->frags[i]->tasks[j],
+                                  ucc_tl_ucp_task_t);
+            if (coll_args->mask & UCC_COLL_ARGS_FIELD_TAG) {
+                task->tagged.tag = coll_args->args.tag;
+            } else {
+                team->seq_num    = (team->seq_num + 1) %
+                                   UCC_TL_UCP_MAX_COLL_TAG;
+                task->tagged.tag = team->seq_num;
+            }
+        }
+    }
+}
+
 #define UCC_TL_UCP_TASK_P2P_COMPLETE(_task)                                    \
     (((_task)->tagged.send_posted == (_task)->tagged.send_completed) &&        \
      ((_task)->tagged.recv_posted == (_task)->tagged.recv_completed))
 
-static inline ucc_status_t ucc_tl_ucp_test(ucc_tl_ucp_task_t *task)
+/* Returns number of times the task may progress the worker in current
+   progress call. With WORKER_PROGRESS_ONCE the worker was already progressed
+   by the context hook if progress_seq changed since the last check, i.e. the
+   task is progressed from ucc_context_progress: it only has to check its
+   state. Otherwise (post, team create, service colls) the task polls the
+   worker itself as usual. */
+static inline uint32_t ucc_tl_ucp_task_polls(ucc_tl_ucp_task_t *task)
+{
+    ucc_tl_ucp_context_t *ctx = TASK_CTX(task);
+
+    if (ctx->cfg.worker_progress_once &&
+        task->progress_seq != ctx->progress_seq) {
+        task->progress_seq = ctx->progress_seq;
+        return 0;
+    }
+    return task->n_polls;
+}
+
+static inline ucc_status_t ucc_tl_ucp_test_polls(ucc_tl_ucp_task_t *task,
+                                                  uint32_t           n_polls)
 {
-    int polls = 0;
+    uint32_t polls = 0;
+
     if (UCC_TL_UCP_TASK_P2P_COMPLETE(task)) {
         return UCC_OK;
     }
-    while (polls++ < task->n_polls) {
+    while (polls++ < n_polls) {
+        ucp_worker_progress(TASK_CTX(task)->ucp_worker);
         if (UCC_TL_UCP_TASK_P2P_COMPLETE(task)) {
             return UCC_OK;
         }
-        ucp_worker_progress(TASK_CTX(task)->ucp_worker);
     }
     return UCC_INPROGRESS;
 }
 
+static inline ucc_status_t ucc_tl_ucp_test(ucc_tl_ucp_task_t *task)
+{
+    if (UCC_TL_UCP_TASK_P2P_COMPLETE(task)) {
+        return UCC_OK;
+    }
+    return ucc_tl_ucp_test_polls(task, ucc_tl_ucp_task_polls(task));
+}
+
 ucc_status_t ucc_tl_ucp_alg_id_to_init(int alg_id, const char *alg_id_str,
                                        ucc_coll_type_t          coll_type,
                                        ucc_memory_type_t        mem_type,
@@ -8,11 +8,35 @@
 #include "tl_ucp_tag.h"
 #include "tl_ucp_coll.h"
 #include "tl_ucp_ep.h"
+#include "tl_ucp_am.h"
+#include "tl_ucp_rcache.h"
 #include "utils/ucc_math.h"
 #include "utils/arch/cpu.h"
 #include "schedule/ucc_schedule_pipelined.h"
 #include <limits.h>
 
+/* Registered as context progress function: called once per
+   ucc_context_progress before the progress queue, see ucc_tl_ucp_task_polls */
+static unsigned ucc_tl_ucp_context_progress(void *arg)
+{
+    ucc_tl_ucp_context_t *ctx = arg;
+
+    ctx->progress_seq++;
+    return ucp_worker_progress(ctx->ucp_worker);
+}
+
+static ucc_status_t ucc_tl_ucp_context_arm(void *arg)
+{
+    ucc_tl_ucp_context_t *ctx = arg;
+    ucs_status_t          status;
+
+    status = ucp_worker_arm(ctx->ucp_worker);
+    if (UCS_ERR_BUSY == status) {
+        return UCC_INPROGRESS;
+    }
+    return ucs_status_to_ucc_status(status);
+}
+
 UCC_CLASS_INIT_FUNC(ucc_tl_ucp_context_t,
                     const ucc_base_context_params_t *params,
                     const ucc_base_config_t *config)
@@ -42,9 +66,12 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_context_t,
 
     ucp_params.field_mask =
         UCP_PARAM_FIELD_FEATURES | UCP_PARAM_FIELD_TAG_SENDER_MASK;
-    ucp_params.features = UCP_FEATURE_TAG | UCP_FEATURE_AM;
-    if (params->params.mask & UCC_CONTEXT_PARAM_FIELD_MEM_PARAMS) {
-        ucp_params.features |= UCP_FEATURE_RMA | UCP_FEATURE_AMO64;
+    /* RMA is used by one-sided algorithms on the team heap and on user
+       buffers registered on demand, not only on mem_params segments */
+    ucp_params.features = UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_RMA |
+                          UCP_FEATURE_AMO64;
+    if (params->context->wait_sleep) {
+        ucp_params.features |= UCP_FEATURE_WAKEUP;
     }
     ucp_params.tag_sender_mask = UCC_TL_UCP_TAG_SENDER_MASK;
 
@@ -113,6 +140,7 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_context_t,
     self->ucp_context = ucp_context;
     self->ucp_worker  = ucp_worker;
     self->worker_address = NULL;
+    self->progress_seq   = 0;
 
     ucc_status = ucc_mpool_init(
         &self->req_mp, 0,
@@ -125,12 +153,41 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_context_t,
         goto err_thread_mode;
     }
     if (UCC_OK != ucc_context_progress_register(
-                      params->context,
-                      (ucc_context_progress_fn_t)ucp_worker_progress,
-                      self->ucp_worker)) {
+                      params->context, ucc_tl_ucp_context_progress, self)) {
         tl_error(self->super.super.lib, "failed to register progress function");
         ucc_status = UCC_ERR_NO_MESSAGE;
-        goto err_thread_mode;
+        goto err_req_mp;
+    }
+    self->wakeup_efd = -1;
+    if (params->context->wait_sleep) {
+        status = ucp_worker_get_efd(ucp_worker, &self->wakeup_efd);
+        if (UCS_OK != status) {
+            tl_error(self->super.super.lib, "failed to get worker efd, %s",
+                     ucs_status_string(status));
+            ucc_status       = ucs_status_to_ucc_status(status);
+            self->wakeup_efd = -1;
+            goto err_progress;
+        }
+        ucc_status = ucc_context_event_register(
+            params->context, self->wakeup_efd, ucc_tl_ucp_context_arm, self);
+        if (UCC_OK != ucc_status) {
+            tl_error(self->super.super.lib, "failed to register worker efd");
+            self->wakeup_efd = -1;
+            goto err_progress;
+        }
+    }
+
+    self->am = NULL;
+    if (self->cfg.use_am) {
+        ucc_status = ucc_tl_ucp_am_init(self, params->thread_mode);
+        if (UCC_OK != ucc_status) {
+            goto err_efd;
+        }
+    }
+
+    ucc_status = ucc_tl_ucp_rcache_init(self);
+    if (UCC_OK != ucc_status) {
+        goto err_am;
     }
 
     self->remote_info  = NULL;
@@ -142,7 +199,7 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_context_t,
             self, params->params.mem_params, params->params.oob);
         if (UCC_OK != ucc_status) {
             tl_error(self->super.super.lib, "failed to gather RMA information");
-            goto err_thread_mode;
+            goto err_rcache;
         }
     }
     if (params->context->params.mask & UCC_CONTEXT_PARAM_FIELD_OOB) {
@@ -154,7 +211,7 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_context_t,
                      "failed to allocate %zd bytes for ucp_eps",
                      params->context->params.oob.n_oob_eps * sizeof(ucp_ep_h));
             ucc_status = UCC_ERR_NO_MEMORY;
-            goto err_thread_mode;
+            goto err_rcache;
         }
     } else {
         self->eps     = NULL;
@@ -163,6 +220,19 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_context_t,
     tl_info(self->super.super.lib, "initialized tl context: %p", self);
     return UCC_OK;
 
+err_rcache:
+    ucc_tl_ucp_rcache_cleanup(self);
+err_am:
+    ucc_tl_ucp_am_cleanup(self);
+err_efd:
+    if (self->wakeup_efd >= 0) {
+        ucc_context_event_deregister(params->context, self->wakeup_efd);
+    }
+err_progress:
+    ucc_context_progress_deregister(params->context,
+                                    ucc_tl_ucp_context_progress, self);
+err_req_mp:
+    ucc_mpool_cleanup(&self->req_mp, 1);
 err_thread_mode:
     ucp_worker_destroy(ucp_worker);
 err_worker_create:
@@ -245,12 +315,18 @@ UCC_CLASS_CLEANUP_FUNC(ucc_tl_ucp_context_t)
     if (self->remote_info) {
         ucc_tl_ucp_rinfo_destroy(self);
     }
+    ucc_tl_ucp_rcache_cleanup(self);
     if (UCC_TL_CTX_HAS_OOB(self)) {
         ucc_tl_ucp_context_barrier(self, &UCC_TL_CTX_OOB(self));
     }
     ucc_context_progress_deregister(
         self->super.super.ucc_context,
-        (ucc_context_progress_fn_t)ucp_worker_progress, self->ucp_worker);
+        ucc_tl_ucp_context_progress, self);
+    if (self->wakeup_efd >= 0) {
+        ucc_context_event_deregister(self->super.super.ucc_context,
+                                     self->wakeup_efd);
+    }
+    ucc_tl_ucp_am_cleanup(self);
     if (self->worker_address) {
         ucp_worker_release_address(self->ucp_worker, self->worker_address);
     }
@@ -265,9 +341,21 @@ ucc_status_t ucc_tl_ucp_populate_rcache(void *addr, size_t length,
                                         ucs_memory_type_t mem_type,
                                         ucc_tl_ucp_context_t *ctx)
 {
-    ucp_mem_map_params_t mmap_params;
-    ucp_mem_h            mh;
-    ucs_status_t         status;
+    ucp_mem_map_params_t        mmap_params;
+    ucp_mem_h                   mh;
+    ucs_status_t                status;
+    ucc_tl_ucp_rcache_region_t *region;
+    ucc_status_t                ucc_status;
+
+    if (ctx->rcache) {
+        /* registration stays in the cache until evicted or invalidated */
+        ucc_status = ucc_tl_ucp_mem_reg(ctx, addr, length, mem_type, &region);
+        if (ucc_unlikely(UCC_OK != ucc_status)) {
+            return ucc_status;
+        }
+        ucc_tl_ucp_mem_dereg(ctx, region);
+        return UCC_OK;
+    }
 
     mmap_params.field_mask  = UCP_MEM_MAP_PARAM_FIELD_ADDRESS |
                               UCP_MEM_MAP_PARAM_FIELD_LENGTH  |
@@ -355,6 +443,7 @@ ucc_status_t ucc_tl_ucp_ctx_remote_populate(ucc_tl_ucp_context_t * ctx,
         }
         ctx->remote_info[i].va_base = map.segments[i].address;
         ctx->remote_info[i].len     = map.segments[i].len;
+        ctx->remote_info[i].id      = ctx->next_reg_id++;
     }
     ctx->n_rinfo_segs = nsegs;
 
@@ -40,8 +40,10 @@ ucc_tl_ucp_get_team_ep_header(ucc_tl_ucp_team_t *team, ucc_rank_t core_rank)
                                   core_rank);
 }
 
-static inline ucc_status_t ucc_tl_ucp_get_ep(ucc_tl_ucp_team_t *team, ucc_rank_t rank,
-                                             ucp_ep_h *ep)
+/* Slow path of ucc_tl_ucp_get_ep: maps team rank to context ep storage
+   (array or hash), connects the ep if needed and caches it in team->eps */
+static inline ucc_status_t ucc_tl_ucp_lookup_ep(ucc_tl_ucp_team_t *team,
+                                                ucc_rank_t rank, ucp_ep_h *ep)
 {
     ucc_tl_ucp_context_t      *ctx      = UCC_TL_UCP_TEAM_CTX(team);
     ucc_context_addr_header_t *h        = NULL;
@@ -76,7 +78,18 @@ static inline ucc_status_t ucc_tl_ucp_get_ep(ucc_tl_ucp_team_t *team, ucc_rank_t
             tl_ucp_hash_put(ctx->ep_hash, h->ctx_id, *ep);
         }
     }
+    team->eps[rank] = *ep;
     return UCC_OK;
 }
 
+static inline ucc_status_t ucc_tl_ucp_get_ep(ucc_tl_ucp_team_t *team,
+                                             ucc_rank_t rank, ucp_ep_h *ep)
+{
+    *ep = team->eps[rank];
+    if (ucc_likely(NULL != *ep)) {
+        return UCC_OK;
+    }
+    return ucc_tl_ucp_lookup_ep(team, rank, ep);
+}
+
 #endif
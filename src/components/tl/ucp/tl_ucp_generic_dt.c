@@ -0,0 +1,577 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "tl_ucp.h"
+#include "tl_ucp_coll.h"
+#include "tl_ucp_generic_dt.h"
+#include "components/mc/ucc_mc.h"
+#include "schedule/ucc_schedule_pipelined.h"
+#include "utils/ucc_math.h"
+#include "utils/ucc_coll_utils.h"
+
+/* Packed data stream of a user buffer. gdt is NULL for contiguous datatypes,
+   in that case offsets in the stream are the byte offsets in the buffer */
+typedef struct ucc_tl_ucp_dt_stream {
+    ucc_dt_generic_t *gdt;
+    ucc_datatype_t    dt;
+    void             *buffer;
+    size_t            count;
+    void             *state;
+} ucc_tl_ucp_dt_stream_t;
+
+typedef struct ucc_tl_ucp_dt_schedule {
+    ucc_schedule_pipelined_t super;
+    ucc_base_coll_init_fn_t  init;
+    ucc_rank_t               team_size;
+    ucc_tl_ucp_dt_stream_t   pack;
+    ucc_tl_ucp_dt_stream_t   unpack;
+    size_t                   elem_size;   /* packed size of single element */
+    size_t                   count;       /* number of elements in a block */
+    size_t                   frag_count;  /* elements of a block per frag */
+    size_t                   pack_base;   /* first element of local block */
+    ucc_rank_t               n_pack_blocks;
+    ucc_rank_t               n_unpack_blocks;
+    size_t                   bounce_size;
+    size_t                   recv_offset; /* recv part of bounce buffer */
+    /* alltoallv only: byte counts and displacements in the bounce buffer
+       followed by element displacements in the user buffers, each array
+       has team size entries:
+       scounts, sdispls, rcounts, rdispls, src displs, dst displs */
+    uint64_t                *v;
+} ucc_tl_ucp_dt_schedule_t;
+
+typedef struct ucc_tl_ucp_dt_frag {
+    ucc_schedule_t            super;
+    ucc_coll_task_t           pack;
+    ucc_coll_task_t           unpack;
+    ucc_tl_ucp_dt_schedule_t *dts;
+    ucc_mc_buffer_header_t   *bounce;
+    int                       frag_num;
+} ucc_tl_ucp_dt_frag_t;
+
+#define DT_V(_dts, _i) (&(_dts)->v[(_i) * (_dts)->team_size])
+
+static inline void ucc_tl_ucp_dt_stream_init(ucc_tl_ucp_dt_stream_t *s,
+                                             ucc_datatype_t dt, void *buffer,
+                                             size_t count)
+{
+    s->gdt    = UCC_TL_UCP_DT_NON_CONTIG(dt) ? ucc_dt_to_generic(dt) : NULL;
+    s->dt     = dt;
+    s->buffer = buffer;
+    s->count  = count;
+    s->state  = NULL;
+}
+
+static inline void ucc_tl_ucp_dt_stream_start(ucc_tl_ucp_dt_stream_t *s,
+                                              int is_pack)
+{
+    if (!s->gdt || !s->buffer) {
+        return;
+    }
+    s->state = is_pack ? s->gdt->ops.start_pack(s->gdt->context, s->buffer,
+                                                s->count)
+                       : s->gdt->ops.start_unpack(s->gdt->context, s->buffer,
+                                                  s->count);
+}
+
+static inline void ucc_tl_ucp_dt_stream_finish(ucc_tl_ucp_dt_stream_t *s)
+{
+    if (s->state) {
+        s->gdt->ops.finish(s->state);
+        s->state = NULL;
+    }
+}
+
+static ucc_status_t ucc_tl_ucp_dt_stream_pack(ucc_tl_ucp_dt_stream_t *s,
+                                              size_t offset, void *dst,
+                                              size_t len)
+{
+    size_t packed;
+
+    if (!s->gdt) {
+        memcpy(dst, PTR_OFFSET(s->buffer, offset), len);
+        return UCC_OK;
+    }
+    while (len > 0) {
+        packed = s->gdt->ops.pack(s->state, offset, dst, len);
+        if (ucc_unlikely(packed == 0 || packed > len)) {
+            return UCC_ERR_INVALID_PARAM;
+        }
+        offset += packed;
+        len    -= packed;
+        dst     = PTR_OFFSET(dst, packed);
+    }
+    return UCC_OK;
+}
+
+static ucc_status_t ucc_tl_ucp_dt_stream_unpack(ucc_tl_ucp_dt_stream_t *s,
+                                                size_t offset, const void *src,
+                                                size_t len)
+{
+    if (!s->gdt) {
+        memcpy(PTR_OFFSET(s->buffer, offset), src, len);
+        return UCC_OK;
+    }
+    return s->gdt->ops.unpack(s->state, offset, src, len);
+}
+
+static ucc_status_t ucc_tl_ucp_dt_frag_pack_start(ucc_coll_task_t *task)
+{
+    ucc_tl_ucp_dt_frag_t     *frag   = ucc_container_of(task,
+                                                       ucc_tl_ucp_dt_frag_t,
+                                                       pack);
+    ucc_tl_ucp_dt_schedule_t *dts    = frag->dts;
+    void                     *bounce = frag->bounce->addr;
+    size_t                    s      = dts->elem_size;
+    size_t                    fb     = dts->frag_count * s;
+    size_t                    offset = frag->frag_num * dts->frag_count;
+    size_t                    n;
+    ucc_rank_t                b;
+    ucc_status_t              status = UCC_OK;
+
+    if (dts->v) {
+        for (b = 0; b < dts->n_pack_blocks && status == UCC_OK; b++) {
+            status = ucc_tl_ucp_dt_stream_pack(
+                &dts->pack, DT_V(dts, 4)[b] * s,
+                PTR_OFFSET(bounce, DT_V(dts, 1)[b]), DT_V(dts, 0)[b]);
+        }
+    } else {
+        n = ucc_min(dts->frag_count, dts->count - offset) * s;
+        for (b = 0; b < dts->n_pack_blocks && status == UCC_OK; b++) {
+            status = ucc_tl_ucp_dt_stream_pack(
+                &dts->pack, (dts->pack_base + b * dts->count + offset) * s,
+                PTR_OFFSET(bounce, b * fb), n);
+        }
+    }
+    if (ucc_unlikely(UCC_OK != status)) {
+        tl_error(UCC_TASK_LIB(task), "failed to pack fragment %d",
+                 frag->frag_num);
+    }
+    task->status = status;
+    return ucc_task_complete(task);
+}
+
+static ucc_status_t ucc_tl_ucp_dt_frag_unpack_start(ucc_coll_task_t *task)
+{
+    ucc_tl_ucp_dt_frag_t     *frag   = ucc_container_of(task,
+                                                       ucc_tl_ucp_dt_frag_t,
+                                                       unpack);
+    ucc_tl_ucp_dt_schedule_t *dts    = frag->dts;
+    void                     *recv   = PTR_OFFSET(frag->bounce->addr,
+                                                  dts->recv_offset);
+    size_t                    s      = dts->elem_size;
+    size_t                    fb     = dts->frag_count * s;
+    size_t                    offset = frag->frag_num * dts->frag_count;
+    size_t                    n;
+    ucc_rank_t                b;
+    ucc_status_t              status = UCC_OK;
+
+    if (dts->v) {
+        for (b = 0; b < dts->n_unpack_blocks && status == UCC_OK; b++) {
+            status = ucc_tl_ucp_dt_stream_unpack(
+                &dts->unpack, DT_V(dts, 5)[b] * s,
+                PTR_OFFSET(recv, DT_V(dts, 3)[b]), DT_V(dts, 2)[b]);
+        }
+    } else {
+        n = ucc_min(dts->frag_count, dts->count - offset) * s;
+        for (b = 0; b < dts->n_unpack_blocks && status == UCC_OK; b++) {
+            status = ucc_tl_ucp_dt_stream_unpack(
+                &dts->unpack, (b * dts->count + offset) * s,
+                PTR_OFFSET(recv, b * fb), n);
+        }
+    }
+    if (ucc_unlikely(UCC_OK != status)) {
+        tl_error(UCC_TASK_LIB(task), "failed to unpack fragment %d",
+                 frag->frag_num);
+    }
+    task->status = status;
+    return ucc_task_complete(task);
+}
+
+/* Args of the collective running on the bounce buffer of a fragment */
+static void ucc_tl_ucp_dt_frag_args(ucc_tl_ucp_dt_schedule_t *dts,
+                                    void *bounce, ucc_coll_args_t *args)
+{
+    ucc_rank_t size = dts->team_size;
+    void      *recv = PTR_OFFSET(bounce, dts->recv_offset);
+    size_t     fb   = dts->frag_count * dts->elem_size;
+
+    if (args->mask & UCC_COLL_ARGS_FIELD_FLAGS) {
+        args->flags &= ~UCC_COLL_ARGS_FLAG_IN_PLACE;
+    }
+    if (args->coll_type == UCC_COLL_TYPE_ALLTOALLV) {
+        args->mask                    |= UCC_COLL_ARGS_FIELD_FLAGS;
+        args->flags                   |= UCC_COLL_ARGS_FLAG_COUNT_64BIT |
+                                         UCC_COLL_ARGS_FLAG_DISPLACEMENTS_64BIT;
+        args->src.info_v.buffer        = bounce;
+        args->src.info_v.counts        = (ucc_count_t *)DT_V(dts, 0);
+        args->src.info_v.displacements = (ucc_aint_t *)DT_V(dts, 1);
+        args->src.info_v.datatype      = UCC_DT_UINT8;
+        args->src.info_v.mem_type      = UCC_MEMORY_TYPE_HOST;
+        args->dst.info_v.buffer        = recv;
+        args->dst.info_v.counts        = (ucc_count_t *)DT_V(dts, 2);
+        args->dst.info_v.displacements = (ucc_aint_t *)DT_V(dts, 3);
+        args->dst.info_v.datatype      = UCC_DT_UINT8;
+        args->dst.info_v.mem_type      = UCC_MEMORY_TYPE_HOST;
+        return;
+    }
+    args->src.info.buffer   = bounce;
+    args->src.info.count    = fb;
+    args->src.info.datatype = UCC_DT_UINT8;
+    args->src.info.mem_type = UCC_MEMORY_TYPE_HOST;
+    args->dst.info.buffer   = recv;
+    args->dst.info.count    = size * fb;
+    args->dst.info.datatype = UCC_DT_UINT8;
+    args->dst.info.mem_type = UCC_MEMORY_TYPE_HOST;
+    if (args->coll_type == UCC_COLL_TYPE_ALLTOALL) {
+        args->src.info.count = size * fb;
+    }
+}
+
+static ucc_status_t ucc_tl_ucp_dt_frag_finalize(ucc_coll_task_t *task)
+{
+    ucc_tl_ucp_dt_frag_t *frag = ucc_derived_of(task, ucc_tl_ucp_dt_frag_t);
+    ucc_status_t          status;
+
+    status = ucc_schedule_finalize(task);
+    ucc_mc_free(frag->bounce);
+    ucc_free(frag);
+    return status;
+}
+
+static ucc_status_t
+ucc_tl_ucp_dt_frag_setup(ucc_schedule_pipelined_t *schedule_p, //NOLINT
+                         ucc_schedule_t *frag, int frag_num)
+{
+    ucc_derived_of(frag, ucc_tl_ucp_dt_frag_t)->frag_num = frag_num;
+    return UCC_OK;
+}
+
+static ucc_status_t
+ucc_tl_ucp_dt_frag_init(ucc_base_coll_args_t     *coll_args,
+                        ucc_schedule_pipelined_t *schedule_p,
+                        ucc_base_team_t *team, ucc_schedule_t **frag_p)
+{
+    ucc_tl_ucp_dt_schedule_t *dts  = ucc_derived_of(schedule_p,
+                                                    ucc_tl_ucp_dt_schedule_t);
+    ucc_base_coll_args_t      args = *coll_args;
+    ucc_tl_ucp_dt_frag_t     *frag;
+    ucc_coll_task_t          *task;
+    ucc_status_t              status;
+
+    frag = ucc_calloc(1, sizeof(*frag), "tl_ucp_dt_frag");
+    if (ucc_unlikely(!frag)) {
+        tl_error(team->context->lib, "failed to allocate %zd bytes for frag",
+                 sizeof(*frag));
+        return UCC_ERR_NO_MEMORY;
+    }
+    frag->dts = dts;
+    status    = ucc_mc_alloc(&frag->bounce, ucc_max(dts->bounce_size, 1),
+                             UCC_MEMORY_TYPE_HOST);
+    if (ucc_unlikely(UCC_OK != status)) {
+        tl_error(team->context->lib, "failed to allocate bounce buffer");
+        goto err_bounce;
+    }
+    status = ucc_schedule_init(&frag->super, coll_args, team);
+    if (ucc_unlikely(UCC_OK != status)) {
+        goto err_init;
+    }
+    ucc_tl_ucp_dt_frag_args(dts, frag->bounce->addr, &args.args);
+    status = dts->init(&args, team, &task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        tl_error(team->context->lib, "failed to init %s on packed data",
+                 ucc_coll_type_str(args.args.coll_type));
+        goto err_init;
+    }
+    UCC_CHECK_GOTO(ucc_coll_task_init(&frag->pack, NULL, team), err_task,
+                   status);
+    UCC_CHECK_GOTO(ucc_coll_task_init(&frag->unpack, NULL, team), err_task,
+                   status);
+    frag->pack.post   = ucc_tl_ucp_dt_frag_pack_start;
+    frag->unpack.post = ucc_tl_ucp_dt_frag_unpack_start;
+
+    UCC_CHECK_GOTO(ucc_schedule_add_task(&frag->super, &frag->pack), err_task,
+                   status);
+    UCC_CHECK_GOTO(ucc_task_subscribe_dep(&frag->super.super, &frag->pack,
+                                          UCC_EVENT_SCHEDULE_STARTED),
+                   err_task, status);
+    UCC_CHECK_GOTO(ucc_schedule_add_task(&frag->super, task), err_task,
+                   status);
+    UCC_CHECK_GOTO(ucc_task_subscribe_dep(&frag->pack, task,
+                                          UCC_EVENT_COMPLETED),
+                   err_task, status);
+    UCC_CHECK_GOTO(ucc_schedule_add_task(&frag->super, &frag->unpack),
+                   err_task, status);
+    UCC_CHECK_GOTO(ucc_task_subscribe_dep(task, &frag->unpack,
+                                          UCC_EVENT_COMPLETED),
+                   err_task, status);
+
+    frag->super.super.post     = ucc_schedule_start;
+    frag->super.super.finalize = ucc_tl_ucp_dt_frag_finalize;
+    *frag_p                    = &frag->super;
+    return UCC_OK;
+
+err_task:
+    task->finalize(task);
+err_init:
+    ucc_mc_free(frag->bounce);
+err_bounce:
+    ucc_free(frag);
+    return status;
+}
+
+static ucc_status_t ucc_tl_ucp_generic_dt_start(ucc_coll_task_t *task)
+{
+    ucc_tl_ucp_dt_schedule_t *dts = ucc_derived_of(task,
+                                                   ucc_tl_ucp_dt_schedule_t);
+
+    /* persistent collective: states of the previous post are released
+       on the next post or on finalize */
+    ucc_tl_ucp_dt_stream_finish(&dts->pack);
+    ucc_tl_ucp_dt_stream_finish(&dts->unpack);
+    if (dts->n_pack_blocks) {
+        ucc_tl_ucp_dt_stream_start(&dts->pack, 1);
+    }
+    if (dts->n_unpack_blocks) {
+        ucc_tl_ucp_dt_stream_start(&dts->unpack, 0);
+    }
+    return ucc_schedule_pipelined_post(task);
+}
+
+static ucc_status_t ucc_tl_ucp_generic_dt_finalize(ucc_coll_task_t *task)
+{
+    ucc_tl_ucp_dt_schedule_t *dts = ucc_derived_of(task,
+                                                   ucc_tl_ucp_dt_schedule_t);
+    ucc_status_t              status;
+
+    ucc_tl_ucp_dt_stream_finish(&dts->pack);
+    ucc_tl_ucp_dt_stream_finish(&dts->unpack);
+    status = ucc_schedule_pipelined_finalize(task);
+    ucc_free(dts->v);
+    ucc_free(dts);
+    return status;
+}
+
+/* Packed size of a single element, taken from the non contiguous stream */
+static size_t ucc_tl_ucp_dt_elem_size(ucc_tl_ucp_dt_schedule_t *dts)
+{
+    ucc_tl_ucp_dt_stream_t *s = dts->pack.gdt ? &dts->pack : &dts->unpack;
+
+    if (!s->gdt || s->count == 0) {
+        return 0;
+    }
+    return ucc_dt_packed_size(s->dt, s->buffer, s->count) / s->count;
+}
+
+static ucc_status_t ucc_tl_ucp_dt_alltoallv_init(ucc_tl_ucp_dt_schedule_t *dts,
+                                                 ucc_coll_args_t *args)
+{
+    ucc_rank_t size  = dts->team_size;
+    size_t     s_max = 0, r_max = 0, s_total = 0, r_total = 0, c, d;
+    ucc_rank_t i;
+
+    dts->v = ucc_malloc(6 * size * sizeof(uint64_t), "tl_ucp_dt_a2av");
+    if (ucc_unlikely(!dts->v)) {
+        return UCC_ERR_NO_MEMORY;
+    }
+    for (i = 0; i < size; i++) {
+        c = ucc_coll_args_get_count(args, args->src.info_v.counts, i);
+        d = ucc_coll_args_get_displacement(args,
+                                           args->src.info_v.displacements, i);
+        dts->v[4 * size + i] = d;
+        dts->v[i]            = c;
+        s_max                = ucc_max(s_max, c + d);
+        c = ucc_coll_args_get_count(args, args->dst.info_v.counts, i);
+        d = ucc_coll_args_get_displacement(args,
+                                           args->dst.info_v.displacements, i);
+        dts->v[5 * size + i] = d;
+        dts->v[2 * size + i] = c;
+        r_max                = ucc_max(r_max, c + d);
+    }
+    ucc_tl_ucp_dt_stream_init(&dts->pack, args->src.info_v.datatype,
+                              args->src.info_v.buffer, s_max);
+    ucc_tl_ucp_dt_stream_init(&dts->unpack, args->dst.info_v.datatype,
+                              args->dst.info_v.buffer, r_max);
+    dts->elem_size = ucc_tl_ucp_dt_elem_size(dts);
+    /* element counts -> byte counts and displacements in bounce buffer */
+    for (i = 0; i < size; i++) {
+        dts->v[i]            *= dts->elem_size;
+        dts->v[size + i]      = s_total;
+        s_total              += dts->v[i];
+        dts->v[2 * size + i] *= dts->elem_size;
+        dts->v[3 * size + i]  = r_total;
+        r_total              += dts->v[2 * size + i];
+    }
+    dts->n_pack_blocks   = size;
+    dts->n_unpack_blocks = size;
+    dts->recv_offset     = s_total;
+    dts->bounce_size     = s_total + r_total;
+    return UCC_OK;
+}
+
+ucc_status_t ucc_tl_ucp_generic_dt_init(ucc_base_coll_args_t   *coll_args,
+                                        ucc_base_team_t        *team,
+                                        ucc_base_coll_init_fn_t init,
+                                        ucc_coll_task_t       **task_h)
+{
+    ucc_tl_ucp_team_t        *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_lib_config_t  *cfg     = &UCC_TL_UCP_TEAM_LIB(tl_team)->cfg;
+    ucc_coll_args_t          *args    = &coll_args->args;
+    ucc_rank_t                size    = UCC_TL_TEAM_SIZE(tl_team);
+    ucc_rank_t                rank    = UCC_TL_TEAM_RANK(tl_team);
+    int                       inplace = UCC_IS_INPLACE(*args);
+    int                       n_frags = 1;
+    size_t                    mult    = 1;
+    size_t                    fb;
+    ucc_tl_ucp_dt_schedule_t *dts;
+    ucc_memory_type_t         mt;
+    ucc_status_t              status;
+
+    if (args->coll_type == UCC_COLL_TYPE_ALLTOALLV) {
+        mt = args->dst.info_v.mem_type;
+        if (!inplace && args->src.info_v.mem_type != mt) {
+            mt = UCC_MEMORY_TYPE_UNKNOWN;
+        }
+    } else if (args->coll_type == UCC_COLL_TYPE_BCAST ||
+               (args->coll_type == UCC_COLL_TYPE_GATHER &&
+                rank != args->root)) {
+        mt = args->src.info.mem_type;
+    } else {
+        mt = args->dst.info.mem_type;
+        if (!inplace && args->src.info.mem_type != mt) {
+            mt = UCC_MEMORY_TYPE_UNKNOWN;
+        }
+    }
+    if (mt != UCC_MEMORY_TYPE_HOST) {
+        tl_debug(team->context->lib,
+                 "generic datatypes are supported for host memory only");
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+
+    dts = ucc_calloc(1, sizeof(*dts), "tl_ucp_dt_schedule");
+    if (ucc_unlikely(!dts)) {
+        tl_error(team->context->lib, "failed to allocate %zd bytes for "
+                 "generic dt schedule", sizeof(*dts));
+        return UCC_ERR_NO_MEMORY;
+    }
+    dts->init      = init;
+    dts->team_size = size;
+
+    switch (args->coll_type) {
+    case UCC_COLL_TYPE_ALLTOALLV:
+        if (inplace) {
+            status = UCC_ERR_NOT_SUPPORTED;
+            goto err;
+        }
+        status = ucc_tl_ucp_dt_alltoallv_init(dts, args);
+        if (ucc_unlikely(UCC_OK != status)) {
+            goto err;
+        }
+        break;
+    case UCC_COLL_TYPE_BCAST:
+        dts->count = args->src.info.count;
+        if (rank == args->root) {
+            ucc_tl_ucp_dt_stream_init(&dts->pack, args->src.info.datatype,
+                                      args->src.info.buffer, dts->count);
+            dts->n_pack_blocks = 1;
+        } else {
+            ucc_tl_ucp_dt_stream_init(&dts->unpack, args->src.info.datatype,
+                                      args->src.info.buffer, dts->count);
+            dts->n_unpack_blocks = 1;
+        }
+        break;
+    case UCC_COLL_TYPE_ALLGATHER:
+    case UCC_COLL_TYPE_GATHER:
+        mult = size + 1;
+        if (args->coll_type == UCC_COLL_TYPE_GATHER && rank != args->root) {
+            dts->count = args->src.info.count;
+            ucc_tl_ucp_dt_stream_init(&dts->pack, args->src.info.datatype,
+                                      args->src.info.buffer, dts->count);
+            dts->n_pack_blocks = 1;
+            break;
+        }
+        dts->count = args->dst.info.count / size;
+        if (inplace) {
+            ucc_tl_ucp_dt_stream_init(&dts->pack, args->dst.info.datatype,
+                                      args->dst.info.buffer,
+                                      args->dst.info.count);
+            dts->pack_base = rank * dts->count;
+        } else {
+            ucc_tl_ucp_dt_stream_init(&dts->pack, args->src.info.datatype,
+                                      args->src.info.buffer, dts->count);
+        }
+        ucc_tl_ucp_dt_stream_init(&dts->unpack, args->dst.info.datatype,
+                                  args->dst.info.buffer, args->dst.info.count);
+        dts->n_pack_blocks   = 1;
+        dts->n_unpack_blocks = size;
+        break;
+    case UCC_COLL_TYPE_ALLTOALL:
+        mult       = 2 * size;
+        dts->count = args->dst.info.count / size;
+        if (inplace) {
+            ucc_tl_ucp_dt_stream_init(&dts->pack, args->dst.info.datatype,
+                                      args->dst.info.buffer,
+                                      args->dst.info.count);
+        } else {
+            ucc_tl_ucp_dt_stream_init(&dts->pack, args->src.info.datatype,
+                                      args->src.info.buffer,
+                                      args->src.info.count);
+        }
+        ucc_tl_ucp_dt_stream_init(&dts->unpack, args->dst.info.datatype,
+                                  args->dst.info.buffer, args->dst.info.count);
+        dts->n_pack_blocks   = size;
+        dts->n_unpack_blocks = size;
+        break;
+    default:
+        status = UCC_ERR_NOT_SUPPORTED;
+        goto err;
+    }
+
+    if (!dts->v) {
+        /* frag_count is the same on all the ranks: it depends only on the
+           block size and on the coll type */
+        dts->elem_size = ucc_tl_ucp_dt_elem_size(dts);
+        if (dts->count && dts->elem_size) {
+            dts->frag_count = ucc_max(1, cfg->generic_dt_frag_size /
+                                             (dts->elem_size * mult));
+            n_frags         = ucc_div_round_up(dts->count, dts->frag_count);
+            dts->frag_count = ucc_div_round_up(dts->count, n_frags);
+            n_frags         = ucc_div_round_up(dts->count, dts->frag_count);
+        }
+        fb = dts->frag_count * dts->elem_size;
+        if (args->coll_type == UCC_COLL_TYPE_BCAST) {
+            /* bcast runs inplace on the bounce buffer */
+            dts->recv_offset = 0;
+            dts->bounce_size = fb;
+        } else {
+            dts->recv_offset = dts->n_pack_blocks * fb;
+            dts->bounce_size = dts->recv_offset + dts->n_unpack_blocks * fb;
+        }
+    }
+
+    status = ucc_schedule_pipelined_init(
+        coll_args, team, ucc_tl_ucp_dt_frag_init, ucc_tl_ucp_dt_frag_setup,
+        ucc_max(ucc_min(n_frags, (int)cfg->generic_dt_pipeline_depth), 1),
+        n_frags, 0, &dts->super);
+    if (UCC_OK != status) {
+        tl_error(team->context->lib, "failed to init pipelined schedule");
+        goto err;
+    }
+    dts->super.super.super.post           = ucc_tl_ucp_generic_dt_start;
+    dts->super.super.super.finalize       = ucc_tl_ucp_generic_dt_finalize;
+    dts->super.super.super.triggered_post = ucc_triggered_post;
+    *task_h = &dts->super.super.super;
+    tl_trace(team->context->lib, "generic dt %s: count %zd, elem size %zd, "
+             "n_frags %d", ucc_coll_type_str(args->coll_type), dts->count,
+             dts->elem_size, n_frags);
+    return UCC_OK;
+
+err:
+    ucc_free(dts->v);
+    ucc_free(dts);
+    return status;
+}
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_TL_UCP_GENERIC_DT_H_
+#define UCC_TL_UCP_GENERIC_DT_H_
+
+#include "tl_ucp.h"
+#include "core/ucc_dt.h"
+
+/* Support of non contiguous generic datatypes for data movement collectives.
+
+   The user buffers are never accessed by the collective algorithm directly:
+   data is packed with the datatype pack callback into a bounce buffer, the
+   collective runs on the packed bytes (UCC_DT_UINT8) and the result is
+   unpacked into the destination with the unpack callback. Large messages
+   are split into fragments of UCC_TL_UCP_GENERIC_DT_FRAG_SIZE and processed
+   by the pipelined schedule, so that packing of the next fragment overlaps
+   with the data exchange of the current one.
+
+   Packed size of a single element is assumed to be the same for all the
+   elements of a buffer and on all the ranks. */
+
+#define UCC_TL_UCP_DT_NON_CONTIG(_dt)                                          \
+    (UCC_DT_IS_GENERIC(_dt) && !UCC_DT_IS_CONTIG(_dt))
+
+static inline int ucc_tl_ucp_coll_is_generic_dt(ucc_base_coll_args_t *bargs,
+                                                ucc_base_team_t      *team)
+{
+    ucc_coll_args_t *args = &bargs->args;
+    ucc_rank_t       rank;
+
+    switch (args->coll_type) {
+    case UCC_COLL_TYPE_BCAST:
+        return UCC_TL_UCP_DT_NON_CONTIG(args->src.info.datatype);
+    case UCC_COLL_TYPE_ALLGATHER:
+    case UCC_COLL_TYPE_ALLTOALL:
+        return UCC_TL_UCP_DT_NON_CONTIG(args->dst.info.datatype) ||
+               (!UCC_IS_INPLACE(*args) &&
+                UCC_TL_UCP_DT_NON_CONTIG(args->src.info.datatype));
+    case UCC_COLL_TYPE_ALLTOALLV:
+        return UCC_TL_UCP_DT_NON_CONTIG(args->dst.info_v.datatype) ||
+               (!UCC_IS_INPLACE(*args) &&
+                UCC_TL_UCP_DT_NON_CONTIG(args->src.info_v.datatype));
+    case UCC_COLL_TYPE_GATHER:
+        rank = UCC_TL_TEAM_RANK(ucc_derived_of(team, ucc_tl_ucp_team_t));
+        if (rank != args->root) {
+            return UCC_TL_UCP_DT_NON_CONTIG(args->src.info.datatype);
+        }
+        return UCC_TL_UCP_DT_NON_CONTIG(args->dst.info.datatype) ||
+               (!UCC_IS_INPLACE(*args) &&
+                UCC_TL_UCP_DT_NON_CONTIG(args->src.info.datatype));
+    default:
+        break;
+    }
+    return 0;
+}
+
+/* Wraps the collective "init" into pack/unpack pipeline. "init" is called
+   for every fragment with the same coll_type and UCC_DT_UINT8 bounce
+   buffers. */
+ucc_status_t ucc_tl_ucp_generic_dt_init(ucc_base_coll_args_t   *coll_args,
+                                        ucc_base_team_t        *team,
+                                        ucc_base_coll_init_fn_t init,
+                                        ucc_coll_task_t       **task_h);
+
+#endif
@@ -0,0 +1,241 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "tl_ucp.h"
+#include "tl_ucp_heap.h"
+#include "tl_ucp_coll.h"
+#include "tl_ucp_sendrecv.h"
+#include "core/ucc_context.h"
+#include "utils/ucc_malloc.h"
+
+ucc_status_t ucc_tl_ucp_heap_init(ucc_tl_ucp_team_t *team)
+{
+    ucc_tl_ucp_context_t *ctx   = UCC_TL_UCP_TEAM_CTX(team);
+    ucc_tl_ucp_heap_t    *heap  = &team->heap;
+    size_t                size  = UCC_TL_UCP_TEAM_LIB(team)->cfg.team_heap_size;
+    ucc_rank_t            tsize = UCC_TL_TEAM_SIZE(team);
+    ucp_mem_map_params_t  mmap_params;
+    ucs_status_t          status;
+
+    memset(heap, 0, sizeof(*heap));
+    if (size == 0 || IS_SERVICE_TEAM(team)) {
+        return UCC_OK;
+    }
+    /* exchange buffers are allocated upfront: once the exchange started a
+       rank can not leave it, peers would hang in the service allgather */
+    heap->rinfo = ucc_malloc(3 * (tsize + 1) * sizeof(uint64_t),
+                             "tl_ucp_heap_rinfo");
+    if (!heap->rinfo) {
+        tl_error(UCC_TL_TEAM_LIB(team), "failed to allocate %zd bytes "
+                 "for heap rinfo", 3 * (tsize + 1) * sizeof(uint64_t));
+        return UCC_ERR_NO_MEMORY;
+    }
+    heap->flags = heap->rinfo + 2 * (tsize + 1);
+    heap->rkeys = ucc_calloc(tsize, sizeof(ucp_rkey_h), "tl_ucp_heap_rkeys");
+    if (!heap->rkeys) {
+        tl_error(UCC_TL_TEAM_LIB(team), "failed to allocate %zd bytes "
+                 "for heap rkeys", tsize * sizeof(ucp_rkey_h));
+        ucc_free(heap->rinfo);
+        heap->rinfo = NULL;
+        return UCC_ERR_NO_MEMORY;
+    }
+    /* the exchange is joined even if the heap can not be set up locally,
+       peers agree on the heap availability there */
+    heap->enabled = 1;
+    size       = ucc_max(size, UCC_TL_UCP_HEAP_N_SLOTS * 2 *
+                                   UCC_TL_UCP_HEAP_SYNC_SIZE);
+    heap->base = ucc_malloc(size, "tl_ucp_team_heap");
+    if (!heap->base) {
+        tl_debug(UCC_TL_TEAM_LIB(team),
+                 "failed to allocate %zd bytes for team heap", size);
+        return UCC_OK;
+    }
+    memset(heap->base, 0, size);
+    mmap_params.field_mask =
+        UCP_MEM_MAP_PARAM_FIELD_ADDRESS | UCP_MEM_MAP_PARAM_FIELD_LENGTH;
+    mmap_params.address = heap->base;
+    mmap_params.length  = size;
+    status = ucp_mem_map(ctx->ucp_context, &mmap_params, &heap->memh);
+    if (UCS_OK != status) {
+        tl_debug(UCC_TL_TEAM_LIB(team), "failed to register team heap: %s",
+                 ucs_status_string(status));
+        goto err_map;
+    }
+    status = ucp_rkey_pack(ctx->ucp_context, heap->memh, &heap->packed_key,
+                           &heap->packed_key_len);
+    if (UCS_OK != status) {
+        tl_debug(UCC_TL_TEAM_LIB(team), "failed to pack team heap rkey: %s",
+                 ucs_status_string(status));
+        goto err_pack;
+    }
+    heap->size = size;
+    return UCC_OK;
+
+err_pack:
+    ucp_mem_unmap(ctx->ucp_context, heap->memh);
+    heap->memh = NULL;
+err_map:
+    ucc_free(heap->base);
+    heap->base = NULL;
+    return UCC_OK;
+}
+
+/* Releases the heap on all the ranks together, the decision is taken on the
+   allgathered data */
+static ucc_status_t ucc_tl_ucp_heap_disable(ucc_tl_ucp_team_t *team,
+                                            ucc_rank_t          rank)
+{
+    tl_debug(UCC_TL_TEAM_LIB(team), "team heap is not available on rank %u, "
+             "team %p is created without heap", rank, team);
+    ucc_tl_ucp_heap_cleanup(team);
+    return UCC_OK;
+}
+
+ucc_status_t ucc_tl_ucp_heap_exchange_test(ucc_tl_ucp_team_t *team)
+{
+    ucc_tl_ucp_heap_t *heap = &team->heap;
+    ucc_rank_t         size = UCC_TL_TEAM_SIZE(team);
+    ucc_rank_t         rank = UCC_TL_TEAM_RANK(team);
+    ucc_subset_t       subset;
+    ucc_status_t       status;
+    void              *sbuf;
+    ucc_rank_t         i;
+
+    if (!heap->enabled || heap->ready) {
+        return UCC_OK;
+    }
+    if (heap->exchange_task) {
+        status = ucc_collective_test(&heap->exchange_task->super);
+        if (UCC_INPROGRESS == status) {
+            ucc_context_progress(UCC_TL_CORE_CTX(team));
+            return UCC_INPROGRESS;
+        }
+        ucc_collective_finalize(&heap->exchange_task->super);
+        heap->exchange_task = NULL;
+        if (UCC_OK != status) {
+            tl_error(UCC_TL_TEAM_LIB(team), "team heap exchange failed");
+            return status;
+        }
+    }
+
+    subset.map.type   = UCC_EP_MAP_FULL;
+    subset.map.ep_num = size;
+    subset.myrank     = rank;
+    switch (heap->phase) {
+    case 0:
+        /* remote addresses and packed rkey lengths, the extra entry in the
+           end is the send buffer. NULL address means the heap could not be
+           set up on that rank */
+        heap->rinfo[2 * size]     = (uint64_t)heap->base;
+        heap->rinfo[2 * size + 1] = heap->packed_key_len;
+        sbuf                      = &heap->rinfo[2 * size];
+        status = UCC_TL_TEAM_IFACE(&team->super)->scoll.allgather(
+            &team->super.super, sbuf, heap->rinfo, 2 * sizeof(uint64_t),
+            subset, &heap->exchange_task);
+        break;
+    case 1:
+        for (i = 0; i < size; i++) {
+            if (!heap->rinfo[2 * i]) {
+                return ucc_tl_ucp_heap_disable(team, i);
+            }
+        }
+        /* size of the rkey buffer is known only now, its allocation status
+           is agreed on before the rkeys are exchanged */
+        for (i = 0; i < size; i++) {
+            heap->max_key_len = ucc_max(heap->max_key_len,
+                                        heap->rinfo[2 * i + 1]);
+        }
+        heap->rkey_bufs = ucc_malloc((size + 1) * heap->max_key_len,
+                                     "tl_ucp_heap_rkeys");
+        if (!heap->rkey_bufs) {
+            tl_debug(UCC_TL_TEAM_LIB(team), "failed to allocate %zd bytes "
+                     "for heap rkeys", (size + 1) * heap->max_key_len);
+        }
+        heap->flags[size] = (heap->rkey_bufs != NULL);
+        status = UCC_TL_TEAM_IFACE(&team->super)->scoll.allgather(
+            &team->super.super, &heap->flags[size], heap->flags,
+            sizeof(uint64_t), subset, &heap->exchange_task);
+        break;
+    case 2:
+        for (i = 0; i < size; i++) {
+            if (!heap->flags[i]) {
+                return ucc_tl_ucp_heap_disable(team, i);
+            }
+        }
+        /* packed rkeys padded to the max length */
+        sbuf = PTR_OFFSET(heap->rkey_bufs, size * heap->max_key_len);
+        memcpy(sbuf, heap->packed_key, heap->packed_key_len);
+        status = UCC_TL_TEAM_IFACE(&team->super)->scoll.allgather(
+            &team->super.super, sbuf, heap->rkey_bufs, heap->max_key_len,
+            subset, &heap->exchange_task);
+        break;
+    default:
+        ucp_rkey_buffer_release(heap->packed_key);
+        heap->packed_key = NULL;
+        heap->ready      = 1;
+        tl_debug(UCC_TL_TEAM_LIB(team), "team %p heap %p size %zd is ready",
+                 team, heap->base, heap->size);
+        return UCC_OK;
+    }
+    if (UCC_OK != status) {
+        tl_error(UCC_TL_TEAM_LIB(team), "failed to start team heap exchange");
+        return status;
+    }
+    heap->phase++;
+    return UCC_INPROGRESS;
+}
+
+void ucc_tl_ucp_heap_cleanup(ucc_tl_ucp_team_t *team)
+{
+    ucc_tl_ucp_context_t *ctx  = UCC_TL_UCP_TEAM_CTX(team);
+    ucc_tl_ucp_heap_t    *heap = &team->heap;
+    ucc_rank_t            i;
+
+    if (!heap->enabled) {
+        return;
+    }
+    if (heap->exchange_task) {
+        ucc_collective_finalize(&heap->exchange_task->super);
+    }
+    if (heap->rkeys) {
+        for (i = 0; i < UCC_TL_TEAM_SIZE(team); i++) {
+            if (heap->rkeys[i]) {
+                ucp_rkey_destroy(heap->rkeys[i]);
+            }
+        }
+    }
+    if (heap->packed_key) {
+        ucp_rkey_buffer_release(heap->packed_key);
+    }
+    if (heap->memh) {
+        ucp_mem_unmap(ctx->ucp_context, heap->memh);
+    }
+    ucc_free(heap->rkeys);
+    ucc_free(heap->rkey_bufs);
+    ucc_free(heap->rinfo);
+    ucc_free(heap->base);
+    memset(heap, 0, sizeof(*heap));
+}
+
+ucc_status_t ucc_tl_ucp_heap_slot_release(ucc_tl_ucp_team_t *team, int slot)
+{
+    uint64_t    *sync = ucc_tl_ucp_heap_sync(team, slot);
+    ucc_rank_t   size = UCC_TL_TEAM_SIZE(team);
+    ucc_rank_t   peer;
+    ucc_status_t status;
+
+    /* reset of ARRIVED counter must be visible before the peers reuse the
+       slot */
+    ucc_memory_cpu_store_fence();
+    for (peer = 0; peer < size; peer++) {
+        status = ucc_tl_ucp_atomic_inc(&sync[UCC_TL_UCP_HEAP_SYNC_RELEASED],
+                                       peer, team);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+    return UCC_OK;
+}
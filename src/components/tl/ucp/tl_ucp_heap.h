@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_TL_UCP_HEAP_H_
+#define UCC_TL_UCP_HEAP_H_
+
+#include "tl_ucp.h"
+#include "utils/ucc_math.h"
+#include "utils/arch/cpu.h"
+
+/* Symmetric scratch heap of the team.
+
+   Every non service team allocates UCC_TL_UCP_TEAM_HEAP_SIZE bytes at
+   creation, registers them with ucp and exchanges the remote address and
+   the packed rkey with the peers (service allgathers in team_create_test).
+   Every rank joins the exchange even if its own heap could not be set up,
+   the heap is used only if it is available on all the ranks, so one-sided
+   algorithms make the same selection on every rank.
+   Heap has the same layout on all the ranks, so one-sided algorithms address
+   the heap of a peer with local pointers, resolve_p2p_by_va translates them
+   into the remote address of the peer.
+
+   The heap is split into 2 slots, every collective using the heap takes the
+   next slot with ucc_tl_ucp_heap_next_seq. Slot starts with
+   UCC_TL_UCP_HEAP_SYNC_SIZE bytes of sync counters followed by staging space.
+   ARRIVED counter of the slot is incremented by the peers writing into it and
+   reset by the owner once the data is consumed. The owner then increments
+   RELEASED counter of the same slot on every peer: a rank writes into the
+   slot of its peers only after all of them released it from the previous
+   use (ucc_tl_ucp_heap_slot_ready), so non blocking heap collectives can be
+   posted back to back without overwriting staging data still in use. */
+
+#define UCC_TL_UCP_HEAP_N_SLOTS   2
+#define UCC_TL_UCP_HEAP_SYNC_SIZE UCC_CACHE_LINE_SIZE
+
+/* uint64_t counters in the sync area of the slot */
+enum {
+    UCC_TL_UCP_HEAP_SYNC_ARRIVED  = 0,
+    UCC_TL_UCP_HEAP_SYNC_RELEASED = 1
+};
+
+/* Allocates and registers the heap, the team is created without the heap
+   if that fails on any rank. Returns error only if the exchange buffers can
+   not be allocated */
+ucc_status_t ucc_tl_ucp_heap_init(ucc_tl_ucp_team_t *team);
+
+/* Non blocking exchange of the heap rkeys, returns UCC_INPROGRESS until
+   the heap of every peer is accessible */
+ucc_status_t ucc_tl_ucp_heap_exchange_test(ucc_tl_ucp_team_t *team);
+
+void ucc_tl_ucp_heap_cleanup(ucc_tl_ucp_team_t *team);
+
+/* Called by the owner once the data in the slot is consumed and ARRIVED
+   counter is reset, lets the peers reuse the slot */
+ucc_status_t ucc_tl_ucp_heap_slot_release(ucc_tl_ucp_team_t *team, int slot);
+
+static inline int ucc_tl_ucp_heap_available(ucc_tl_ucp_team_t *team)
+{
+    return team->heap.ready;
+}
+
+static inline size_t ucc_tl_ucp_heap_slot_size(ucc_tl_ucp_team_t *team)
+{
+    return ucc_align_down(team->heap.size / UCC_TL_UCP_HEAP_N_SLOTS,
+                          UCC_CACHE_LINE_SIZE);
+}
+
+static inline size_t ucc_tl_ucp_heap_scratch_size(ucc_tl_ucp_team_t *team)
+{
+    return ucc_tl_ucp_heap_slot_size(team) - UCC_TL_UCP_HEAP_SYNC_SIZE;
+}
+
+/* Returns the heap sequence number of the collective, every rank of the team
+   must start heap collectives in the same order */
+static inline uint32_t ucc_tl_ucp_heap_next_seq(ucc_tl_ucp_team_t *team)
+{
+    return team->heap.seq++;
+}
+
+static inline int ucc_tl_ucp_heap_seq_slot(uint32_t seq)
+{
+    return seq % UCC_TL_UCP_HEAP_N_SLOTS;
+}
+
+static inline uint64_t *ucc_tl_ucp_heap_sync(ucc_tl_ucp_team_t *team,
+                                             int slot)
+{
+    return PTR_OFFSET(team->heap.base,
+                      slot * ucc_tl_ucp_heap_slot_size(team));
+}
+
+/* Slots of the peers can be written by the collective with sequence number
+   seq once every peer released them after the previous use */
+static inline int ucc_tl_ucp_heap_slot_ready(ucc_tl_ucp_team_t *team,
+                                             uint32_t seq)
+{
+    volatile uint64_t *sync =
+        ucc_tl_ucp_heap_sync(team, ucc_tl_ucp_heap_seq_slot(seq));
+
+    return sync[UCC_TL_UCP_HEAP_SYNC_RELEASED] >=
+           (uint64_t)(seq / UCC_TL_UCP_HEAP_N_SLOTS) * UCC_TL_TEAM_SIZE(team);
+}
+
+static inline void *ucc_tl_ucp_heap_scratch(ucc_tl_ucp_team_t *team, int slot)
+{
+    return PTR_OFFSET(ucc_tl_ucp_heap_sync(team, slot),
+                      UCC_TL_UCP_HEAP_SYNC_SIZE);
+}
+
+static inline int ucc_tl_ucp_heap_contains(ucc_tl_ucp_team_t *team, void *va)
+{
+    return ucc_tl_ucp_heap_available(team) &&
+           (uint64_t)va >= (uint64_t)team->heap.base &&
+           (uint64_t)va < (uint64_t)team->heap.base + team->heap.size;
+}
+
+/* peer is the team rank */
+static inline ucc_status_t
+ucc_tl_ucp_heap_resolve(ucc_tl_ucp_team_t *team, void *va, ucp_ep_h ep,
+                        ucc_rank_t peer, uint64_t *rva, ucp_rkey_h *rkey)
+{
+    ucc_tl_ucp_heap_t *heap = &team->heap;
+    ucs_status_t       status;
+
+    if (ucc_unlikely(NULL == heap->rkeys[peer])) {
+        status = ucp_ep_rkey_unpack(ep, PTR_OFFSET(heap->rkey_bufs,
+                                                   peer * heap->max_key_len),
+                                    &heap->rkeys[peer]);
+        if (UCS_OK != status) {
+            return ucs_status_to_ucc_status(status);
+        }
+    }
+    *rkey = heap->rkeys[peer];
+    *rva  = heap->rinfo[2 * peer] + ((uint64_t)va - (uint64_t)heap->base);
+    return UCC_OK;
+}
+
+#endif
@@ -34,6 +34,11 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_lib_t, const ucc_base_lib_params_t *params,
         self->cfg.scatter_kn_radix        = tl_ucp_config->kn_radix;
         self->cfg.gather_kn_radix         = tl_ucp_config->kn_radix;
     }
+    if (self->cfg.tuner && self->cfg.tuner_n_iters == 0) {
+        /* measurement averages over the iterations */
+        tl_warn(&self->super, "UCC_TL_UCP_TUNER_N_ITERS=0 is invalid, using 1");
+        self->cfg.tuner_n_iters = 1;
+    }
 
     self->tlcp_configs = NULL;
     if (n_plugins) {
@@ -0,0 +1,281 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "tl_ucp.h"
+#include "tl_ucp_rcache.h"
+#include "tl_ucp_ep.h"
+#include "utils/ucc_malloc.h"
+#include <limits.h>
+
+static ucs_status_t
+ucc_tl_ucp_mem_map_region(ucc_tl_ucp_context_t *ctx, void *address,
+                          size_t length, ucs_memory_type_t mem_type,
+                          ucc_tl_ucp_rcache_region_t *region)
+{
+    ucp_mem_map_params_t mmap_params;
+    ucs_status_t         status;
+
+    mmap_params.field_mask  = UCP_MEM_MAP_PARAM_FIELD_ADDRESS |
+                              UCP_MEM_MAP_PARAM_FIELD_LENGTH  |
+                              UCP_MEM_MAP_PARAM_FIELD_MEMORY_TYPE;
+    mmap_params.address     = address;
+    mmap_params.length      = length;
+    mmap_params.memory_type = mem_type;
+    status = ucp_mem_map(ctx->ucp_context, &mmap_params, &region->memh);
+    if (UCS_OK != status) {
+        tl_error(ctx->super.super.lib, "ucp_mem_map failed: %s, addr %p "
+                 "len %zd", ucs_status_string(status), address, length);
+        return status;
+    }
+    status = ucp_rkey_pack(ctx->ucp_context, region->memh,
+                           &region->packed_key, &region->packed_key_len);
+    if (UCS_OK != status) {
+        tl_error(ctx->super.super.lib, "ucp_rkey_pack failed: %s",
+                 ucs_status_string(status));
+        ucp_mem_unmap(ctx->ucp_context, region->memh);
+        return status;
+    }
+    region->id = ctx->next_reg_id++;
+    return UCS_OK;
+}
+
+static void ucc_tl_ucp_mem_unmap_region(ucc_tl_ucp_context_t       *ctx,
+                                        ucc_tl_ucp_rcache_region_t *region)
+{
+    ucp_rkey_buffer_release(region->packed_key);
+    ucp_mem_unmap(ctx->ucp_context, region->memh);
+}
+
+static ucs_status_t
+ucc_tl_ucp_rcache_mem_reg_cb(void *context, ucc_rcache_t *rcache, void *arg,
+                             ucc_rcache_region_t *rregion, uint16_t flags)
+{
+    ucc_tl_ucp_context_t       *ctx    = (ucc_tl_ucp_context_t *)context;
+    ucc_tl_ucp_rcache_region_t *region =
+        ucc_derived_of(rregion, ucc_tl_ucp_rcache_region_t);
+
+    return ucc_tl_ucp_mem_map_region(
+        ctx, (void *)rregion->super.start,
+        (size_t)(rregion->super.end - rregion->super.start),
+        *(ucs_memory_type_t *)arg, region);
+}
+
+static void ucc_tl_ucp_rcache_mem_dereg_cb(void *context, ucc_rcache_t *rcache,
+                                           ucc_rcache_region_t *rregion)
+{
+    ucc_tl_ucp_context_t       *ctx    = (ucc_tl_ucp_context_t *)context;
+    ucc_tl_ucp_rcache_region_t *region =
+        ucc_derived_of(rregion, ucc_tl_ucp_rcache_region_t);
+
+    ucc_tl_ucp_mem_unmap_region(ctx, region);
+}
+
+static void
+ucc_tl_ucp_rcache_dump_region_cb(void *context, ucs_rcache_t *rcache,
+                                 ucs_rcache_region_t *rregion, char *buf,
+                                 size_t max)
+{
+    ucc_tl_ucp_rcache_region_t *region =
+        ucc_derived_of(rregion, ucc_tl_ucp_rcache_region_t);
+
+    snprintf(buf, max, "memh:%p id:%lu", region->memh, region->id);
+}
+
+static ucc_rcache_ops_t ucc_tl_ucp_rcache_ops = {
+    .mem_reg     = ucc_tl_ucp_rcache_mem_reg_cb,
+    .mem_dereg   = ucc_tl_ucp_rcache_mem_dereg_cb,
+    .dump_region = ucc_tl_ucp_rcache_dump_region_cb
+};
+
+ucc_status_t ucc_tl_ucp_rcache_init(ucc_tl_ucp_context_t *ctx)
+{
+    ucc_rcache_params_t rcache_params;
+    ucc_status_t        status;
+
+    ctx->rcache      = NULL;
+    ctx->next_reg_id = 1;
+    if (!ctx->cfg.use_rcache) {
+        return UCC_OK;
+    }
+    rcache_params.alignment          = 64;
+    rcache_params.ucm_event_priority = 1000;
+    rcache_params.max_regions        = ctx->cfg.rcache_max_regions;
+    rcache_params.max_size           = ctx->cfg.rcache_max_size;
+    rcache_params.region_struct_size = sizeof(ucc_tl_ucp_rcache_region_t);
+    rcache_params.max_alignment      = getpagesize();
+    rcache_params.ucm_events         = UCM_EVENT_VM_UNMAPPED |
+                                       UCM_EVENT_MEM_TYPE_FREE;
+    rcache_params.context            = ctx;
+    rcache_params.ops                = &ucc_tl_ucp_rcache_ops;
+    rcache_params.flags              = 0;
+
+    status = ucc_rcache_create(&rcache_params, "TL_UCP", &ctx->rcache);
+    if (UCC_OK != status) {
+        /* user buffers are registered on every use */
+        tl_warn(ctx->super.super.lib, "failed to create rcache: %s",
+                ucc_status_string(status));
+        ctx->rcache = NULL;
+    }
+    return UCC_OK;
+}
+
+void ucc_tl_ucp_rcache_cleanup(ucc_tl_ucp_context_t *ctx)
+{
+    if (ctx->rcache) {
+        ucc_rcache_destroy(ctx->rcache);
+        ctx->rcache = NULL;
+    }
+}
+
+ucc_status_t ucc_tl_ucp_mem_reg(ucc_tl_ucp_context_t *ctx, void *addr,
+                                size_t length, ucs_memory_type_t mem_type,
+                                ucc_tl_ucp_rcache_region_t **region)
+{
+    ucc_rcache_region_t        *rregion;
+    ucc_tl_ucp_rcache_region_t *r;
+    ucc_status_t                status;
+    ucs_status_t                ucs_status;
+
+    if (ctx->rcache) {
+        status = ucc_rcache_get(ctx->rcache, addr, length, &mem_type,
+                                &rregion);
+        if (ucc_unlikely(UCC_OK != status)) {
+            tl_error(ctx->super.super.lib, "ucc_rcache_get failed: %s",
+                     ucc_status_string(status));
+            return status;
+        }
+        *region = ucc_derived_of(rregion, ucc_tl_ucp_rcache_region_t);
+        return UCC_OK;
+    }
+
+    r = ucc_malloc(sizeof(*r), "tl_ucp_reg");
+    if (ucc_unlikely(!r)) {
+        tl_error(ctx->super.super.lib, "failed to allocate %zd bytes",
+                 sizeof(*r));
+        return UCC_ERR_NO_MEMORY;
+    }
+    ucs_status = ucc_tl_ucp_mem_map_region(ctx, addr, length, mem_type, r);
+    if (ucc_unlikely(UCS_OK != ucs_status)) {
+        ucc_free(r);
+        return ucs_status_to_ucc_status(ucs_status);
+    }
+    *region = r;
+    return UCC_OK;
+}
+
+void ucc_tl_ucp_mem_dereg(ucc_tl_ucp_context_t       *ctx,
+                          ucc_tl_ucp_rcache_region_t *region)
+{
+    if (ctx->rcache) {
+        ucc_rcache_region_put(ctx->rcache, &region->super);
+    } else {
+        ucc_tl_ucp_mem_unmap_region(ctx, region);
+        ucc_free(region);
+    }
+}
+
+ucc_status_t ucc_tl_ucp_rkey_get(ucc_tl_ucp_team_t *team, ucc_rank_t peer,
+                                 uint64_t id, void *packed_key,
+                                 ucc_tl_ucp_rkey_t **rkey)
+{
+    uint32_t           n_entries = UCC_TL_UCP_TEAM_LIB(team)->cfg.rkey_cache_size;
+    ucc_tl_ucp_rkey_t *victim    = NULL;
+    ucc_tl_ucp_rkey_t *entries;
+    ucs_status_t       status;
+    ucc_status_t       ucc_status;
+    ucp_ep_h           ep;
+    uint32_t           i;
+
+    ucc_status = ucc_tl_ucp_get_ep(team, peer, &ep);
+    if (ucc_unlikely(UCC_OK != ucc_status)) {
+        return ucc_status;
+    }
+    if (n_entries && !team->rkey_cache) {
+        team->rkey_cache = ucc_calloc((size_t)UCC_TL_TEAM_SIZE(team) *
+                                          n_entries,
+                                      sizeof(ucc_tl_ucp_rkey_t),
+                                      "tl_ucp_rkey_cache");
+        if (!team->rkey_cache) {
+            tl_debug(UCC_TL_TEAM_LIB(team), "failed to allocate rkey cache");
+        }
+    }
+    team->rkey_cache_clock++;
+    if (team->rkey_cache) {
+        entries = team->rkey_cache + (size_t)peer * n_entries;
+        for (i = 0; i < n_entries; i++) {
+            if (entries[i].id == id) {
+                entries[i].last_use = team->rkey_cache_clock;
+                entries[i].refcount++;
+                *rkey = &entries[i];
+                return UCC_OK;
+            }
+            if (entries[i].refcount == 0 &&
+                (!victim || entries[i].last_use < victim->last_use)) {
+                victim = &entries[i];
+            }
+        }
+    }
+    if (victim) {
+        if (victim->id) {
+            ucp_rkey_destroy(victim->rkey);
+            victim->id = 0;
+        }
+        victim->cached = 1;
+    } else {
+        /* all the entries are in use by outstanding collectives */
+        victim = ucc_malloc(sizeof(*victim), "tl_ucp_rkey");
+        if (ucc_unlikely(!victim)) {
+            tl_error(UCC_TL_TEAM_LIB(team), "failed to allocate %zd bytes",
+                     sizeof(*victim));
+            return UCC_ERR_NO_MEMORY;
+        }
+        victim->cached = 0;
+    }
+    status = ucp_ep_rkey_unpack(ep, packed_key, &victim->rkey);
+    if (ucc_unlikely(UCS_OK != status)) {
+        tl_error(UCC_TL_TEAM_LIB(team), "failed to unpack rkey: %s",
+                 ucs_status_string(status));
+        if (!victim->cached) {
+            ucc_free(victim);
+        }
+        return ucs_status_to_ucc_status(status);
+    }
+    victim->id       = id;
+    victim->last_use = team->rkey_cache_clock;
+    victim->refcount = 1;
+    *rkey            = victim;
+    return UCC_OK;
+}
+
+void ucc_tl_ucp_rkey_put(ucc_tl_ucp_rkey_t *rkey)
+{
+    if (rkey->cached) {
+        ucc_assert(rkey->refcount > 0);
+        rkey->refcount--;
+    } else {
+        ucp_rkey_destroy(rkey->rkey);
+        ucc_free(rkey);
+    }
+}
+
+void ucc_tl_ucp_rkey_cache_cleanup(ucc_tl_ucp_team_t *team)
+{
+    size_t n_entries;
+    size_t i;
+
+    if (!team->rkey_cache) {
+        return;
+    }
+    n_entries = (size_t)UCC_TL_TEAM_SIZE(team) *
+                UCC_TL_UCP_TEAM_LIB(team)->cfg.rkey_cache_size;
+    for (i = 0; i < n_entries; i++) {
+        if (team->rkey_cache[i].id) {
+            ucp_rkey_destroy(team->rkey_cache[i].rkey);
+        }
+    }
+    ucc_free(team->rkey_cache);
+    team->rkey_cache = NULL;
+}
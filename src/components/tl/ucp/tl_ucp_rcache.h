@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_TL_UCP_RCACHE_H_
+#define UCC_TL_UCP_RCACHE_H_
+
+#include "tl_ucp.h"
+
+/* Registration of user buffers for one-sided algorithms.
+
+   Local side: ucc_tl_ucp_mem_reg maps the buffer with ucp and packs its
+   rkey. With UCC_TL_UCP_RCACHE=y registrations are kept in the context
+   rcache after ucc_tl_ucp_mem_dereg and reused by subsequent collectives on
+   the same buffer. Regions are invalidated when the memory is unmapped or
+   freed and evicted in LRU order when RCACHE_MAX_REGIONS/RCACHE_MAX_SIZE
+   is reached.
+
+   Every registration gets a context unique id which is sent to the peers
+   together with the packed rkey. Remote side: ucc_tl_ucp_rkey_get looks up
+   (peer, id) in the team rkey cache and unpacks the key only on a miss.
+   Re-registration of the same buffer gets a new id, so stale keys are never
+   returned and are eventually evicted by LRU. */
+
+struct ucc_tl_ucp_rcache_region {
+    ucc_rcache_region_t super;
+    ucp_mem_h           memh;
+    void               *packed_key;
+    size_t              packed_key_len;
+    uint64_t            id;
+};
+
+struct ucc_tl_ucp_rkey {
+    uint64_t   id; /* 0 - empty entry */
+    ucp_rkey_h rkey;
+    /* value of team rkey_cache_clock at last lookup */
+    uint64_t   last_use;
+    /* number of tasks using the key, entry is not evicted while held */
+    uint32_t   refcount;
+    /* 0 if the key does not fit into the cache, it is destroyed on put */
+    int        cached;
+};
+
+ucc_status_t ucc_tl_ucp_rcache_init(ucc_tl_ucp_context_t *ctx);
+
+void ucc_tl_ucp_rcache_cleanup(ucc_tl_ucp_context_t *ctx);
+
+ucc_status_t ucc_tl_ucp_mem_reg(ucc_tl_ucp_context_t *ctx, void *addr,
+                                size_t length, ucs_memory_type_t mem_type,
+                                ucc_tl_ucp_rcache_region_t **region);
+
+void ucc_tl_ucp_mem_dereg(ucc_tl_ucp_context_t       *ctx,
+                          ucc_tl_ucp_rcache_region_t *region);
+
+/* Returns unpacked rkey of the registration "id" of team rank "peer",
+   packed_key is only accessed on a cache miss */
+ucc_status_t ucc_tl_ucp_rkey_get(ucc_tl_ucp_team_t *team, ucc_rank_t peer,
+                                 uint64_t id, void *packed_key,
+                                 ucc_tl_ucp_rkey_t **rkey);
+
+void ucc_tl_ucp_rkey_put(ucc_tl_ucp_rkey_t *rkey);
+
+void ucc_tl_ucp_rkey_cache_cleanup(ucc_tl_ucp_team_t *team);
+
+#endif
@@ -12,6 +12,8 @@
 
 #include "tl_ucp_tag.h"
 #include "tl_ucp_ep.h"
+#include "tl_ucp_am.h"
+#include "tl_ucp_heap.h"
 #include "utils/ucc_compiler_def.h"
 #include "components/mc/base/ucc_mc_base.h"
 
@@ -65,10 +67,13 @@ void ucc_tl_ucp_recv_completion_cb(void *request, ucs_status_t status,
         }                                                                      \
     } while (0)
 
+/* am_flags are UCP_AM_SEND_FLAG_* applied in active message mode only */
 static inline ucs_status_ptr_t
-ucc_tl_ucp_send_common(void *buffer, size_t msglen, ucc_memory_type_t mtype,
-                       ucc_rank_t dest_group_rank, ucc_tl_ucp_team_t *team,
-                       ucc_tl_ucp_task_t *task, ucp_send_nbx_callback_t cb)
+ucc_tl_ucp_send_common_flags(void *buffer, size_t msglen,
+                             ucc_memory_type_t mtype,
+                             ucc_rank_t dest_group_rank,
+                             ucc_tl_ucp_team_t *team, ucc_tl_ucp_task_t *task,
+                             ucp_send_nbx_callback_t cb, uint32_t am_flags)
 {
     ucc_coll_args_t    *args = &TASK_ARGS(task);
     ucp_request_param_t req_param;
@@ -91,9 +96,28 @@ ucc_tl_ucp_send_common(void *buffer, size_t msglen, ucc_memory_type_t mtype,
     req_param.memory_type = ucc_memtype_to_ucs[mtype];
     req_param.user_data   = (void *)task;
     task->tagged.send_posted++;
+    if (UCC_TL_UCP_TEAM_CTX(team)->am) {
+        task->tagged.am_tag = ucp_tag;
+        if (am_flags) {
+            req_param.op_attr_mask |= UCP_OP_ATTR_FIELD_FLAGS;
+            req_param.flags         = am_flags;
+        }
+        return ucp_am_send_nbx(ep, UCC_TL_UCP_AM_ID, &task->tagged.am_tag,
+                               sizeof(task->tagged.am_tag), buffer, 1,
+                               &req_param);
+    }
     return ucp_tag_send_nbx(ep, buffer, 1, ucp_tag, &req_param);
 }
 
+static inline ucs_status_ptr_t
+ucc_tl_ucp_send_common(void *buffer, size_t msglen, ucc_memory_type_t mtype,
+                       ucc_rank_t dest_group_rank, ucc_tl_ucp_team_t *team,
+                       ucc_tl_ucp_task_t *task, ucp_send_nbx_callback_t cb)
+{
+    return ucc_tl_ucp_send_common_flags(buffer, msglen, mtype,
+                                        dest_group_rank, team, task, cb, 0);
+}
+
 static inline ucc_status_t
 ucc_tl_ucp_send_nb(void *buffer, size_t msglen, ucc_memory_type_t mtype,
                    ucc_rank_t dest_group_rank, ucc_tl_ucp_team_t *team,
@@ -128,6 +152,27 @@ ucc_tl_ucp_send_cb(void *buffer, size_t msglen, ucc_memory_type_t mtype,
     return UCC_OK;
 }
 
+/* Same as ucc_tl_ucp_send_cb but forces eager protocol in active message
+   mode, so that the data is delivered to the receive callback without rndv
+   handshake. Tagged sends of small messages are eager anyway. */
+static inline ucc_status_t
+ucc_tl_ucp_send_eager_cb(void *buffer, size_t msglen, ucc_memory_type_t mtype,
+                         ucc_rank_t dest_group_rank, ucc_tl_ucp_team_t *team,
+                         ucc_tl_ucp_task_t *task, ucp_send_nbx_callback_t cb)
+{
+    ucs_status_ptr_t ucp_status;
+
+    ucp_status = ucc_tl_ucp_send_common_flags(buffer, msglen, mtype,
+                                              dest_group_rank, team, task, cb,
+                                              UCP_AM_SEND_FLAG_EAGER);
+    if (UCS_OK != ucp_status) {
+        UCC_TL_UCP_CHECK_REQ_STATUS();
+    } else {
+        cb(NULL, UCS_OK, (void*)task);
+    }
+    return UCC_OK;
+}
+
 static inline ucs_status_ptr_t
 ucc_tl_ucp_recv_common(void *buffer, size_t msglen, ucc_memory_type_t mtype,
                        ucc_rank_t dest_group_rank, ucc_tl_ucp_team_t *team,
@@ -156,6 +201,27 @@ ucc_tl_ucp_recv_common(void *buffer, size_t msglen, ucc_memory_type_t mtype,
                             ucp_tag_mask, &req_param);
 }
 
+static inline ucc_status_t
+ucc_tl_ucp_am_recv_common(void *buffer, size_t msglen, ucc_memory_type_t mtype,
+                          ucc_rank_t dest_group_rank, ucc_tl_ucp_team_t *team,
+                          ucc_tl_ucp_task_t *task,
+                          ucp_tag_recv_nbx_callback_t cb)
+{
+    ucc_coll_args_t *args = &TASK_ARGS(task);
+    ucp_tag_t        ucp_tag, ucp_tag_mask;
+
+    // coverity[result_independent_of_operands:FALSE]
+    UCC_TL_UCP_MAKE_RECV_TAG(ucp_tag, ucp_tag_mask,
+                             (args->mask & UCC_COLL_ARGS_FIELD_TAG),
+                             task->tagged.tag, dest_group_rank,
+                             team->super.super.params.id,
+                             team->super.super.params.scope_id,
+                             team->super.super.params.scope);
+    (void)ucp_tag_mask;
+    return ucc_tl_ucp_am_recv(buffer, msglen, mtype, ucp_tag,
+                              UCC_TL_UCP_TEAM_CTX(team), task, cb);
+}
+
 static inline ucc_status_t
 ucc_tl_ucp_recv_nb(void *buffer, size_t msglen, ucc_memory_type_t mtype,
                    ucc_rank_t dest_group_rank, ucc_tl_ucp_team_t *team,
@@ -163,6 +229,11 @@ ucc_tl_ucp_recv_nb(void *buffer, size_t msglen, ucc_memory_type_t mtype,
 {
     ucs_status_ptr_t ucp_status;
 
+    if (UCC_TL_UCP_TEAM_CTX(team)->am) {
+        return ucc_tl_ucp_am_recv_common(buffer, msglen, mtype,
+                                         dest_group_rank, team, task, NULL);
+    }
+
     ucp_status = ucc_tl_ucp_recv_common(buffer, msglen, mtype, dest_group_rank,
                                         team, task, ucc_tl_ucp_recv_completion_cb);
     if (UCS_OK != ucp_status) {
@@ -181,6 +252,10 @@ ucc_tl_ucp_recv_cb(void *buffer, size_t msglen, ucc_memory_type_t mtype,
 {
     ucs_status_ptr_t ucp_status;
 
+    if (UCC_TL_UCP_TEAM_CTX(team)->am) {
+        return ucc_tl_ucp_am_recv_common(buffer, msglen, mtype,
+                                         dest_group_rank, team, task, cb);
+    }
     ucp_status = ucc_tl_ucp_recv_common(buffer, msglen, mtype, dest_group_rank,
                                         team, task, cb);
     if (UCS_OK != ucp_status) {
@@ -238,6 +313,10 @@ ucc_tl_ucp_resolve_p2p_by_va(ucc_tl_ucp_team_t *team, void *va, ucp_ep_h *ep,
     void                 *offset;
     ptrdiff_t             base_offset;
 
+    if (ucc_tl_ucp_heap_contains(team, va)) {
+        *segment = 0;
+        return ucc_tl_ucp_heap_resolve(team, va, *ep, peer, rva, rkey);
+    }
     *segment  = -1;
     core_rank = ucc_ep_map_eval(UCC_TL_TEAM_MAP(team), peer);
     ucc_assert(UCC_TL_CORE_TEAM(team));
@@ -152,6 +152,8 @@ ucc_status_t ucc_tl_ucp_service_allgather(ucc_base_team_t *team, void *sbuf,
     task->subset         = subset;
     task->tagged.tag     = UCC_TL_UCP_SERVICE_TAG;
     task->n_polls        = UCC_TL_UCP_TEAM_CTX(tl_team)->cfg.oob_npolls;
+    task->allgather_ring.n_frags = 1;
+    task->allgather_ring.frag    = 0;
     task->super.progress = ucc_tl_ucp_allgather_ring_progress;
     task->super.finalize = ucc_tl_ucp_coll_finalize;
 
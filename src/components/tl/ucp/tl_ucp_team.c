@@ -8,6 +8,9 @@
 #include "tl_ucp_ep.h"
 #include "tl_ucp_coll.h"
 #include "tl_ucp_sendrecv.h"
+#include "tl_ucp_tuner.h"
+#include "tl_ucp_heap.h"
+#include "tl_ucp_rcache.h"
 #include "utils/ucc_malloc.h"
 #include "coll_score/ucc_coll_score.h"
 
@@ -16,6 +19,7 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_team_t, ucc_base_context_t *tl_context,
 {
     ucc_tl_ucp_context_t *ctx =
         ucc_derived_of(tl_context, ucc_tl_ucp_context_t);
+    ucc_status_t          status;
 
     UCC_CLASS_CALL_SUPER_INIT(ucc_tl_team_t, &ctx->super, params);
     /* TODO: init based on ctx settings and on params: need to check
@@ -31,14 +35,62 @@ UCC_CLASS_INIT_FUNC(ucc_tl_ucp_team_t, ucc_base_context_t *tl_context,
     self->preconnect_task    = NULL;
     self->seq_num            = 0;
     self->status             = UCC_INPROGRESS;
+    self->tuner              = NULL;
+    self->rd_scratch_init    = 0;
+    self->eps                = ucc_calloc(UCC_TL_TEAM_SIZE(self),
+                                          sizeof(ucp_ep_h), "tl_ucp_team_eps");
+    if (!self->eps) {
+        tl_error(tl_context->lib, "failed to allocate %zd bytes for team eps",
+                 UCC_TL_TEAM_SIZE(self) * sizeof(ucp_ep_h));
+        return UCC_ERR_NO_MEMORY;
+    }
+
+    ucc_spinlock_init(&self->rd_scratch_lock, 0);
+    status = ucc_tl_ucp_heap_init(self);
+    if (UCC_OK != status) {
+        goto err_heap;
+    }
+    self->rkey_cache       = NULL;
+    self->rkey_cache_clock = 0;
+
+    status = ucc_schedule_cache_init(
+        &self->sched_cache, UCC_TL_UCP_TEAM_LIB(self)->cfg.schedule_cache_size);
+    if (UCC_OK != status) {
+        goto err_sched_cache;
+    }
+
+    if (UCC_TL_UCP_TEAM_LIB(self)->cfg.tuner && !IS_SERVICE_TEAM(self)) {
+        status = ucc_tl_ucp_tuner_init(self);
+        if (UCC_OK != status) {
+            goto err_tuner;
+        }
+    }
 
     tl_info(tl_context->lib, "posted tl team: %p", self);
     return UCC_OK;
+
+err_tuner:
+    ucc_schedule_cache_cleanup(&self->sched_cache);
+err_sched_cache:
+    ucc_tl_ucp_heap_cleanup(self);
+err_heap:
+    ucc_spinlock_destroy(&self->rd_scratch_lock);
+    ucc_free(self->eps);
+    return status;
 }
 
 UCC_CLASS_CLEANUP_FUNC(ucc_tl_ucp_team_t)
 {
     tl_info(self->super.super.context->lib, "finalizing tl team: %p", self);
+    ucc_tl_ucp_tuner_cleanup(self);
+    ucc_schedule_cache_cleanup(&self->sched_cache);
+    ucc_tl_ucp_rkey_cache_cleanup(self);
+    ucc_tl_ucp_heap_cleanup(self);
+    if (self->rd_scratch_init) {
+        ucc_mpool_cleanup(&self->rd_scratch_mp, 1);
+    }
+    ucc_spinlock_destroy(&self->rd_scratch_lock);
+    ucc_free(self->eps);
 }
 
 UCC_CLASS_DEFINE_DELETE_FUNC(ucc_tl_ucp_team_t, ucc_base_team_t);
@@ -108,6 +160,13 @@ ucc_status_t ucc_tl_ucp_team_create_test(ucc_base_team_t *tl_team)
         }
     }
 
+    status = ucc_tl_ucp_heap_exchange_test(team);
+    if (UCC_INPROGRESS == status) {
+        return UCC_INPROGRESS;
+    } else if (UCC_OK != status) {
+        return status;
+    }
+
     if (ctx->remote_info) {
         for (int i = 0; i < ctx->n_rinfo_segs; i++) {
             team->va_base[i]     = ctx->remote_info[i].va_base;
@@ -167,6 +226,11 @@ ucc_status_t ucc_tl_ucp_team_get_scores(ucc_base_team_t   *tl_team,
             goto err;
         }
     }
+    status = ucc_tl_ucp_tuner_update_score(team, score);
+    if (UCC_OK != status) {
+        tl_error(tl_team->context->lib, "failed to apply tuner settings");
+        goto err;
+    }
     if (strlen(ctx->score_str) > 0) {
         status = ucc_coll_score_update_from_str(
             ctx->score_str, score, UCC_TL_TEAM_SIZE(team), NULL,
@@ -0,0 +1,459 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "tl_ucp.h"
+#include "tl_ucp_coll.h"
+#include "tl_ucp_tuner.h"
+#include "core/ucc_team.h"
+#include "components/mc/ucc_mc.h"
+#include "components/topo/ucc_topo.h"
+#include "utils/ucc_malloc.h"
+#include "utils/ucc_time.h"
+#include <float.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+#define UCC_TL_UCP_TUNER_LINE_MAX 256
+
+static inline int ucc_tl_ucp_tuner_bucket(size_t msgsize)
+{
+    return (msgsize > 1) ? (int)ucc_ilog2(msgsize) : 0;
+}
+
+static inline size_t ucc_tl_ucp_tuner_bucket_start(int bucket)
+{
+    return (bucket == 0) ? 0 : ((size_t)1 << bucket);
+}
+
+static inline size_t ucc_tl_ucp_tuner_bucket_end(int bucket)
+{
+    return (bucket == UCC_TL_UCP_TUNER_N_BUCKETS - 1) ? UCC_MSG_MAX
+                                                       : ((size_t)2 << bucket);
+}
+
+ucc_status_t ucc_tl_ucp_tuner_init(ucc_tl_ucp_team_t *team)
+{
+    ucc_team_t         *core_team = UCC_TL_CORE_TEAM(team);
+    ucc_tl_ucp_tuner_t *tuner;
+
+    tuner = ucc_malloc(sizeof(*tuner), "tl_ucp_tuner");
+    if (!tuner) {
+        tl_error(UCC_TL_TEAM_LIB(team), "failed to allocate %zd bytes for "
+                 "tuner", sizeof(*tuner));
+        return UCC_ERR_NO_MEMORY;
+    }
+    memset(tuner->alg, UCC_TL_UCP_TUNER_ALG_UNKNOWN, sizeof(tuner->alg));
+    /* PPN and number of nodes are only known if the core team has topo
+       and this TL team spans the whole core team. Otherwise only team size
+       is used as a key of the tuning records. */
+    tuner->ppn    = 0;
+    tuner->nnodes = 0;
+    if (core_team && core_team->topo &&
+        core_team->size == UCC_TL_TEAM_SIZE(team)) {
+        tuner->ppn    = ucc_topo_max_ppn(core_team->topo);
+        tuner->nnodes = ucc_topo_nnodes(core_team->topo);
+    }
+    team->tuner = tuner;
+    return UCC_OK;
+}
+
+void ucc_tl_ucp_tuner_cleanup(ucc_tl_ucp_team_t *team)
+{
+    ucc_free(team->tuner);
+    team->tuner = NULL;
+}
+
+/* Tuning file record: "<team_size> <ppn> <nnodes> <TUNE token>", where the
+   token uses the same syntax as UCC_TL_UCP_TUNE, e.g.:
+   "16 8 2 allreduce:host:4096-8192:@sra_knomial" */
+static ucc_status_t ucc_tl_ucp_tuner_load(ucc_tl_ucp_team_t *team,
+                                          ucc_coll_score_t  *score)
+{
+    const char         *fname = UCC_TL_UCP_TEAM_LIB(team)->cfg.tuner_file;
+    ucc_tl_ucp_tuner_t *tuner = team->tuner;
+    char               *str   = NULL;
+    size_t              len   = 0;
+    char                line[UCC_TL_UCP_TUNER_LINE_MAX];
+    char                token[UCC_TL_UCP_TUNER_LINE_MAX];
+    unsigned            tsize, ppn, nnodes;
+    ucc_status_t        status;
+    FILE               *f;
+    char               *tmp;
+
+    f = fopen(fname, "r");
+    if (!f) {
+        tl_debug(UCC_TL_TEAM_LIB(team), "tuning file %s is not available",
+                 fname);
+        return UCC_OK;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        if (4 != sscanf(line, "%u %u %u %255s", &tsize, &ppn, &nnodes,
+                        token) ||
+            tsize != UCC_TL_TEAM_SIZE(team) || ppn != tuner->ppn ||
+            nnodes != tuner->nnodes) {
+            continue;
+        }
+        tmp = ucc_realloc(str, len + strlen(token) + 2, "tuner_str");
+        if (!tmp) {
+            tl_error(UCC_TL_TEAM_LIB(team), "failed to allocate tuner str");
+            status = UCC_ERR_NO_MEMORY;
+            goto out;
+        }
+        str = tmp;
+        if (len) {
+            str[len++] = '#';
+        }
+        strcpy(str + len, token);
+        len += strlen(token);
+    }
+    status = UCC_OK;
+    if (str) {
+        tl_debug(UCC_TL_TEAM_LIB(team), "applying tuning records: %s", str);
+        status = ucc_coll_score_update_from_str(
+            str, score, UCC_TL_TEAM_SIZE(team), ucc_tl_ucp_coll_init,
+            &team->super.super, UCC_TL_UCP_DEFAULT_SCORE,
+            ucc_tl_ucp_alg_id_to_init);
+        if (UCC_ERR_INVALID_PARAM == status) {
+            /* Stale or corrupted file - don't fail team creation */
+            tl_warn(UCC_TL_TEAM_LIB(team), "failed to apply tuning file %s",
+                    fname);
+            status = UCC_OK;
+        }
+    }
+out:
+    ucc_free(str);
+    fclose(f);
+    return status;
+}
+
+/* Several processes (or teams of the same process) may tune the same
+   configuration concurrently: the file is locked while it is checked for
+   the record with the same key and appended, so every key is stored once */
+static void ucc_tl_ucp_tuner_store(ucc_tl_ucp_team_t *team,
+                                   ucc_coll_type_t coll_type, int bucket,
+                                   const char *alg_name)
+{
+    const char *fname = UCC_TL_UCP_TEAM_LIB(team)->cfg.tuner_file;
+    char        range_str[64];
+    char        record[UCC_TL_UCP_TUNER_LINE_MAX];
+    char        line[UCC_TL_UCP_TUNER_LINE_MAX];
+    int         key_len, fd;
+    FILE       *f;
+
+    if (strlen(fname) == 0 || UCC_TL_TEAM_RANK(team) != 0) {
+        return;
+    }
+    if (bucket == UCC_TL_UCP_TUNER_N_BUCKETS - 1) {
+        ucc_snprintf_safe(range_str, sizeof(range_str), "%zu-inf",
+                          ucc_tl_ucp_tuner_bucket_start(bucket));
+    } else {
+        ucc_snprintf_safe(range_str, sizeof(range_str), "%zu-%zu",
+                          ucc_tl_ucp_tuner_bucket_start(bucket),
+                          ucc_tl_ucp_tuner_bucket_end(bucket));
+    }
+    /* key is everything but the alg name */
+    key_len = snprintf(record, sizeof(record), "%u %u %u %s:host:%s:@",
+                       UCC_TL_TEAM_SIZE(team), team->tuner->ppn,
+                       team->tuner->nnodes, ucc_coll_type_str(coll_type),
+                       range_str);
+    ucc_snprintf_safe(record + key_len, sizeof(record) - key_len, "%s\n",
+                      alg_name);
+
+    fd = open(fname, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        tl_warn(UCC_TL_TEAM_LIB(team), "failed to open tuning file %s: %s",
+                fname, strerror(errno));
+        return;
+    }
+    if (flock(fd, LOCK_EX)) {
+        tl_warn(UCC_TL_TEAM_LIB(team), "failed to lock tuning file %s: %s",
+                fname, strerror(errno));
+        close(fd);
+        return;
+    }
+    f = fdopen(fd, "a+");
+    if (!f) {
+        tl_warn(UCC_TL_TEAM_LIB(team), "failed to open tuning file %s: %s",
+                fname, strerror(errno));
+        flock(fd, LOCK_UN);
+        close(fd);
+        return;
+    }
+    rewind(f);
+    while (fgets(line, sizeof(line), f)) {
+        if (0 == strncmp(line, record, key_len)) {
+            tl_debug(UCC_TL_TEAM_LIB(team), "tuning record %.*s is already "
+                     "stored", key_len - 2, record);
+            goto out;
+        }
+    }
+    /* O_APPEND: written at the end regardless of the read position */
+    if (fputs(record, f) < 0 || fflush(f)) {
+        tl_warn(UCC_TL_TEAM_LIB(team), "failed to write tuning file %s",
+                fname);
+    }
+out:
+    flock(fd, LOCK_UN);
+    fclose(f);
+}
+
+ucc_status_t ucc_tl_ucp_tuner_update_score(ucc_tl_ucp_team_t *team,
+                                           ucc_coll_score_t  *score)
+{
+    ucc_tl_ucp_lib_t *lib = UCC_TL_UCP_TEAM_LIB(team);
+    char              str[128];
+    ucc_status_t      status;
+
+    if (!team->tuner) {
+        return UCC_OK;
+    }
+    ucc_snprintf_safe(str, sizeof(str),
+                      "allreduce,bcast,alltoall,reduce_scatter:host:%d",
+                      UCC_TL_UCP_DEFAULT_SCORE);
+    status = ucc_coll_score_update_from_str(
+        str, score, UCC_TL_TEAM_SIZE(team), ucc_tl_ucp_tuner_coll_init,
+        &team->super.super, UCC_TL_UCP_DEFAULT_SCORE,
+        ucc_tl_ucp_alg_id_to_init);
+    if (UCC_OK != status) {
+        return status;
+    }
+    if (strlen(lib->cfg.tuner_file) > 0) {
+        /* Ranges stored in the tuning file replace tuner init fn, so they
+           are not measured again */
+        return ucc_tl_ucp_tuner_load(team, score);
+    }
+    return UCC_OK;
+}
+
+static ucc_status_t ucc_tl_ucp_tuner_wait(ucc_tl_ucp_team_t *team,
+                                          ucc_coll_task_t   *task)
+{
+    ucc_status_t status;
+
+    do {
+        ucc_context_progress(UCC_TL_CORE_CTX(team));
+        status = ucc_collective_test(&task->super);
+    } while (status == UCC_INPROGRESS);
+    return status;
+}
+
+/* Reduces the array of values over the team using service allreduce,
+   so every rank makes the same decision */
+static ucc_status_t ucc_tl_ucp_tuner_agree(ucc_tl_ucp_team_t *team,
+                                           double *vals, int n)
+{
+    double           sbuf[UCC_TL_UCP_TUNER_MAX_ALGS];
+    ucc_subset_t     subset;
+    ucc_coll_task_t *req;
+    ucc_status_t     status;
+
+    memcpy(sbuf, vals, n * sizeof(double));
+    subset.map.type   = UCC_EP_MAP_FULL;
+    subset.map.ep_num = UCC_TL_TEAM_SIZE(team);
+    subset.myrank     = UCC_TL_TEAM_RANK(team);
+    status = UCC_TL_TEAM_IFACE(&team->super)->scoll.allreduce(
+        &team->super.super, sbuf, vals, UCC_DT_FLOAT64, n, UCC_OP_MAX, subset,
+        &req);
+    if (UCC_OK != status) {
+        return status;
+    }
+    status = ucc_tl_ucp_tuner_wait(team, req);
+    ucc_collective_finalize(&req->super);
+    return status;
+}
+
+static ucc_status_t ucc_tl_ucp_tuner_task_init(ucc_base_coll_init_fn_t init,
+                                               ucc_base_coll_args_t   *bargs,
+                                               ucc_tl_ucp_team_t      *team,
+                                               ucc_coll_task_t       **task_p)
+{
+    ucc_ee_executor_params_t eparams;
+    ucc_coll_task_t         *task;
+    ucc_status_t             status;
+
+    status = init(bargs, &team->super.super, &task);
+    if (UCC_OK != status) {
+        return status;
+    }
+    if (task->flags & UCC_COLL_TASK_FLAG_EXECUTOR) {
+        task->flags    |= UCC_COLL_TASK_FLAG_EXECUTOR_STOP;
+        eparams.mask    = UCC_EE_EXECUTOR_PARAM_FIELD_TYPE;
+        eparams.ee_type = UCC_EE_CPU_THREAD;
+        status = ucc_ee_executor_init(&eparams, &task->executor);
+        if (UCC_OK != status) {
+            task->finalize(task);
+            return status;
+        }
+    }
+    *task_p = task;
+    return UCC_OK;
+}
+
+static double ucc_tl_ucp_tuner_measure(ucc_tl_ucp_team_t *team,
+                                       ucc_coll_task_t   *task)
+{
+    ucc_tl_ucp_lib_t *lib    = UCC_TL_UCP_TEAM_LIB(team);
+    unsigned          n_iter = lib->cfg.tuner_n_warmup + lib->cfg.tuner_n_iters;
+    double            t0     = 0;
+    ucc_status_t      status;
+    unsigned          i;
+
+    for (i = 0; i < n_iter; i++) {
+        if (i == lib->cfg.tuner_n_warmup) {
+            t0 = ucc_get_time();
+        }
+        status = ucc_collective_post(&task->super);
+        if (UCC_OK != status) {
+            return DBL_MAX;
+        }
+        status = ucc_tl_ucp_tuner_wait(team, task);
+        if (UCC_OK != status) {
+            return DBL_MAX;
+        }
+    }
+    return (ucc_get_time() - t0) / lib->cfg.tuner_n_iters;
+}
+
+static int ucc_tl_ucp_tuner_run(ucc_tl_ucp_team_t    *team,
+                                ucc_base_coll_args_t *coll_args)
+{
+    ucc_coll_type_t           ct       = coll_args->args.coll_type;
+    ucc_base_coll_alg_info_t *algs     = ucc_tl_ucp.super.alg_info[
+                                                           ucc_ilog2(ct)];
+    ucc_coll_task_t          *tasks[UCC_TL_UCP_TUNER_MAX_ALGS] = {NULL};
+    double                    times[UCC_TL_UCP_TUNER_MAX_ALGS];
+    ucc_mc_buffer_header_t   *scratch  = NULL;
+    int                       winner   = UCC_TL_UCP_TUNER_ALG_NONE;
+    size_t                    src_size = 0;
+    size_t                    dst_size = 0;
+    ucc_base_coll_args_t      bargs;
+    ucc_base_coll_init_fn_t   init;
+    ucc_status_t              status;
+    int                       n_algs, i;
+
+    n_algs = 0;
+    while (algs && algs[n_algs].name && n_algs < UCC_TL_UCP_TUNER_MAX_ALGS) {
+        n_algs++;
+    }
+    if (n_algs < 2) {
+        return n_algs ? algs[0].id : UCC_TL_UCP_TUNER_ALG_NONE;
+    }
+
+    /* Candidates are measured on scratch buffers of the same size as
+       user ones */
+    memcpy(&bargs, coll_args, sizeof(bargs));
+    if (!UCC_IS_INPLACE(bargs.args) || ct == UCC_COLL_TYPE_BCAST) {
+        src_size = bargs.args.src.info.count *
+                   ucc_dt_size(bargs.args.src.info.datatype);
+    }
+    if (ct != UCC_COLL_TYPE_BCAST) {
+        dst_size = bargs.args.dst.info.count *
+                   ucc_dt_size(bargs.args.dst.info.datatype);
+    }
+    status = ucc_mc_alloc(&scratch, src_size + dst_size + 1,
+                          UCC_MEMORY_TYPE_HOST);
+    if (UCC_OK != status) {
+        tl_error(UCC_TL_TEAM_LIB(team), "failed to allocate tuner scratch");
+        return UCC_TL_UCP_TUNER_ALG_NONE;
+    }
+    memset(scratch->addr, 0, src_size + dst_size);
+    bargs.args.src.info.buffer   = scratch->addr;
+    bargs.args.src.info.mem_type = UCC_MEMORY_TYPE_HOST;
+    bargs.args.dst.info.buffer   = PTR_OFFSET(scratch->addr, src_size);
+    bargs.args.dst.info.mem_type = UCC_MEMORY_TYPE_HOST;
+    bargs.args.mask &= ~(UCC_COLL_ARGS_FIELD_TAG | UCC_COLL_ARGS_FIELD_CB |
+                         UCC_COLL_ARGS_FIELD_GLOBAL_WORK_BUFFER);
+    bargs.args.mask  |= UCC_COLL_ARGS_FIELD_FLAGS;
+    bargs.args.flags &= ~(UCC_COLL_ARGS_FLAG_MEM_MAPPED_BUFFERS |
+                          UCC_COLL_ARGS_FLAG_TIMEOUT);
+    bargs.args.flags |= UCC_COLL_ARGS_FLAG_PERSISTENT;
+
+    /* Candidates that are not supported on some rank are excluded on all */
+    for (i = 0; i < n_algs; i++) {
+        times[i] = 0;
+        if (UCC_OK != ucc_tl_ucp_alg_id_to_init(algs[i].id, NULL, ct,
+                                                UCC_MEMORY_TYPE_HOST, &init) ||
+            UCC_OK != ucc_tl_ucp_tuner_task_init(init, &bargs, team,
+                                                 &tasks[i])) {
+            tasks[i] = NULL;
+            times[i] = DBL_MAX;
+        }
+    }
+    if (UCC_OK != ucc_tl_ucp_tuner_agree(team, times, n_algs)) {
+        goto out;
+    }
+    for (i = 0; i < n_algs; i++) {
+        if (times[i] == DBL_MAX) {
+            continue;
+        }
+        times[i] = ucc_tl_ucp_tuner_measure(team, tasks[i]);
+    }
+    /* Slowest rank defines the time of collective */
+    if (UCC_OK != ucc_tl_ucp_tuner_agree(team, times, n_algs)) {
+        goto out;
+    }
+    for (i = 0; i < n_algs; i++) {
+        if (times[i] != DBL_MAX &&
+            (winner < 0 || times[i] < times[winner])) {
+            winner = i;
+        }
+    }
+out:
+    for (i = 0; i < n_algs; i++) {
+        if (tasks[i]) {
+            ucc_collective_finalize(&tasks[i]->super);
+        }
+    }
+    ucc_mc_free(scratch);
+    if (winner >= 0) {
+        tl_debug(UCC_TL_TEAM_LIB(team), "tuner: %s msgsize %zd, selected %s "
+                 "(%g us)", ucc_coll_type_str(ct),
+                 ucc_coll_args_msgsize(&coll_args->args,
+                                       UCC_TL_TEAM_RANK(team),
+                                       UCC_TL_TEAM_SIZE(team)),
+                 algs[winner].name, times[winner] * 1e6);
+        return algs[winner].id;
+    }
+    return UCC_TL_UCP_TUNER_ALG_NONE;
+}
+
+ucc_status_t ucc_tl_ucp_tuner_coll_init(ucc_base_coll_args_t *coll_args,
+                                        ucc_base_team_t      *team,
+                                        ucc_coll_task_t     **task_h)
+{
+    ucc_tl_ucp_team_t      *tl_team = ucc_derived_of(team, ucc_tl_ucp_team_t);
+    ucc_tl_ucp_tuner_t     *tuner   = tl_team->tuner;
+    ucc_coll_type_t         ct      = coll_args->args.coll_type;
+    ucc_base_coll_init_fn_t init;
+    size_t                  msgsize;
+    int                     bucket, alg;
+
+    if (!tuner || !(ct & UCC_TL_UCP_TUNER_COLLS)) {
+        return ucc_tl_ucp_coll_init(coll_args, team, task_h);
+    }
+    msgsize = ucc_coll_args_msgsize(&coll_args->args, UCC_TL_TEAM_RANK(tl_team),
+                                    UCC_TL_TEAM_SIZE(tl_team));
+    bucket  = ucc_tl_ucp_tuner_bucket(msgsize);
+    alg     = tuner->alg[ucc_ilog2(ct)][bucket];
+    /* Active set bcast is not called by the whole team, can't measure */
+    if (alg == UCC_TL_UCP_TUNER_ALG_UNKNOWN &&
+        !UCC_COLL_ARGS_ACTIVE_SET(&coll_args->args)) {
+        alg = ucc_tl_ucp_tuner_run(tl_team, coll_args);
+        tuner->alg[ucc_ilog2(ct)][bucket] = alg;
+        if (alg >= 0) {
+            ucc_tl_ucp_tuner_store(tl_team, ct, bucket,
+                ucc_tl_ucp.super.alg_info[ucc_ilog2(ct)][alg].name);
+        }
+    }
+    if (alg >= 0 &&
+        UCC_OK == ucc_tl_ucp_alg_id_to_init(alg, NULL, ct,
+                                            UCC_MEMORY_TYPE_HOST, &init)) {
+        return init(coll_args, team, task_h);
+    }
+    return ucc_tl_ucp_coll_init(coll_args, team, task_h);
+}
@@ -0,0 +1,50 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_TL_UCP_TUNER_H_
+#define UCC_TL_UCP_TUNER_H_
+#include "tl_ucp.h"
+#include "coll_score/ucc_coll_score.h"
+
+/* Collectives that can be tuned online: msgsize must be the same on all
+   ranks and the algorithm must be selectable through alg_id_to_init */
+#define UCC_TL_UCP_TUNER_COLLS                                                 \
+    (UCC_COLL_TYPE_ALLREDUCE | UCC_COLL_TYPE_BCAST | UCC_COLL_TYPE_ALLTOALL |  \
+     UCC_COLL_TYPE_REDUCE_SCATTER)
+
+/* Msg size buckets are powers of 2: bucket "b" covers [2^b, 2^(b+1)] */
+#define UCC_TL_UCP_TUNER_N_BUCKETS 64
+#define UCC_TL_UCP_TUNER_MAX_ALGS  8
+
+enum {
+    UCC_TL_UCP_TUNER_ALG_UNKNOWN = -1, /* bucket was not measured yet */
+    UCC_TL_UCP_TUNER_ALG_NONE    = -2  /* measurement failed, use default */
+};
+
+typedef struct ucc_tl_ucp_tuner {
+    /* Winner alg id per coll_type and msg size bucket */
+    int8_t     alg[UCC_COLL_TYPE_NUM][UCC_TL_UCP_TUNER_N_BUCKETS];
+    /* Key of the tuning file records */
+    ucc_rank_t ppn;
+    ucc_rank_t nnodes;
+} ucc_tl_ucp_tuner_t;
+
+ucc_status_t ucc_tl_ucp_tuner_init(ucc_tl_ucp_team_t *team);
+
+void ucc_tl_ucp_tuner_cleanup(ucc_tl_ucp_team_t *team);
+
+/* Installs tuner init fn for the tunable collectives and applies the records
+   of the tuning file that match the team key */
+ucc_status_t ucc_tl_ucp_tuner_update_score(ucc_tl_ucp_team_t *team,
+                                           ucc_coll_score_t  *score);
+
+/* Coll init fn used for the ranges handled by tuner: on the first call for
+   a given (coll_type, msg size bucket) all candidate algorithms are measured
+   and the fastest one (agreed across the team) is used afterwards */
+ucc_status_t ucc_tl_ucp_tuner_coll_init(ucc_base_coll_args_t *coll_args,
+                                        ucc_base_team_t      *team,
+                                        ucc_coll_task_t     **task_h);
+#endif
@@ -17,6 +17,7 @@
 #include "schedule/ucc_schedule.h"
 #include "coll_score/ucc_coll_score.h"
 #include "ucc_ee.h"
+#include "ucc_coll_group.h"
 
 #define UCC_BUFFER_INFO_CHECK_MEM_TYPE(_info) do {                             \
     if ((_info).mem_type == UCC_MEMORY_TYPE_UNKNOWN) {                         \
@@ -149,6 +150,144 @@ static ucc_status_t ucc_coll_args_check_mem_type(ucc_coll_args_t *coll_args,
     };
 }
 
+/* Buffer of a collective that is split into contiguous stripes, one per
+   context of the team. NULL if the collective can not be striped */
+static ucc_coll_buffer_info_t *ucc_coll_stripe_buffer(ucc_coll_args_t *args,
+                                                      ucc_rank_t rank)
+{
+    if (args->mask & UCC_COLL_ARGS_FIELD_ACTIVE_SET) {
+        return NULL;
+    }
+    switch (args->coll_type) {
+    case UCC_COLL_TYPE_ALLREDUCE:
+        return &args->dst.info;
+    case UCC_COLL_TYPE_BCAST:
+        return &args->src.info;
+    case UCC_COLL_TYPE_REDUCE:
+        return (UCC_IS_ROOT(*args, rank) && UCC_IS_INPLACE(*args))
+                   ? &args->dst.info
+                   : &args->src.info;
+    default:
+        return NULL;
+    }
+}
+
+static inline int ucc_coll_stripe_required(ucc_team_t      *team,
+                                           ucc_coll_args_t *args)
+{
+    ucc_coll_buffer_info_t *info;
+
+    if (!team->ctx_teams) {
+        return 0;
+    }
+    info = ucc_coll_stripe_buffer(args, team->rank);
+    if (!info || !(UCC_DT_IS_PREDEFINED(info->datatype) ||
+                   UCC_DT_IS_CONTIG(info->datatype))) {
+        return 0;
+    }
+    return info->count * ucc_dt_size(info->datatype) >=
+           team->contexts[0]->stripe_thresh;
+}
+
+static ucc_status_t ucc_coll_stripe_finalize(ucc_coll_task_t *task)
+{
+    ucc_schedule_t *schedule = ucc_derived_of(task, ucc_schedule_t);
+    ucc_status_t    status;
+
+    status = ucc_schedule_finalize(task);
+    ucc_free(schedule);
+    return status;
+}
+
+static inline void ucc_coll_stripe_buffer_info(ucc_coll_buffer_info_t *info,
+                                               size_t offset, size_t count)
+{
+    info->buffer = PTR_OFFSET(info->buffer,
+                              offset * ucc_dt_size(info->datatype));
+    info->count  = count;
+}
+
+static void ucc_coll_stripe_args(ucc_coll_args_t *args, ucc_rank_t rank,
+                                 size_t offset, size_t count)
+{
+    if (args->coll_type == UCC_COLL_TYPE_ALLREDUCE ||
+        (args->coll_type == UCC_COLL_TYPE_REDUCE && UCC_IS_ROOT(*args, rank))) {
+        ucc_coll_stripe_buffer_info(&args->dst.info, offset, count);
+        if (UCC_IS_INPLACE(*args)) {
+            return;
+        }
+    }
+    ucc_coll_stripe_buffer_info(&args->src.info, offset, count);
+}
+
+/* Splits the collective into n_stripes collectives on the teams of
+   different contexts, each one on its own contiguous part of the buffer(s).
+   Every part is progressed by the progress queue and transport resources of
+   its context. The schedule completes when all of them are done. */
+static ucc_status_t ucc_coll_init_striped(ucc_team_t           *team,
+                                          ucc_base_coll_args_t *op_args,
+                                          ucc_coll_task_t     **task_h)
+{
+    ucc_rank_t              n_stripes = team->num_contexts;
+    size_t                  total     =
+        ucc_coll_stripe_buffer(&op_args->args, team->rank)->count;
+    ucc_base_coll_args_t    bargs;
+    ucc_schedule_t         *schedule;
+    ucc_coll_task_t        *task;
+    ucc_status_t            status;
+    size_t                  count, offset;
+    ucc_rank_t              i;
+
+    schedule = ucc_malloc(sizeof(*schedule), "stripe_schedule");
+    if (!schedule) {
+        ucc_error("failed to allocate %zd bytes for stripe schedule",
+                  sizeof(*schedule));
+        return UCC_ERR_NO_MEMORY;
+    }
+    schedule->n_tasks = 0;
+    for (i = 0; i < n_stripes; i++) {
+        memcpy(&bargs, op_args, sizeof(bargs));
+        bargs.team = (i == 0) ? team : team->ctx_teams[i - 1];
+        count      = ucc_buffer_block_count(total, n_stripes, i);
+        offset     = ucc_buffer_block_offset(total, n_stripes, i);
+        ucc_coll_stripe_args(&bargs.args, team->rank, offset, count);
+        status = ucc_coll_init(bargs.team->score_map, &bargs, &task);
+        if (ucc_unlikely(UCC_OK != status)) {
+            goto err;
+        }
+        if (i == 0) {
+            status = ucc_schedule_init(schedule, op_args, task->team);
+            if (ucc_unlikely(UCC_OK != status)) {
+                task->finalize(task);
+                goto err;
+            }
+        }
+        status = ucc_schedule_add_task(schedule, task);
+        if (ucc_unlikely(UCC_OK != status)) {
+            task->finalize(task);
+            goto err;
+        }
+        status = ucc_event_manager_subscribe(&schedule->super.em,
+                                             UCC_EVENT_SCHEDULE_STARTED, task,
+                                             ucc_task_start_handler);
+        if (ucc_unlikely(UCC_OK != status)) {
+            goto err;
+        }
+    }
+    schedule->super.post     = ucc_schedule_start;
+    schedule->super.progress = NULL;
+    schedule->super.finalize = ucc_coll_stripe_finalize;
+    *task_h                  = &schedule->super;
+    return UCC_OK;
+
+err:
+    if (schedule->n_tasks > 0) {
+        ucc_schedule_finalize(&schedule->super);
+    }
+    ucc_free(schedule);
+    return status;
+}
+
 UCC_CORE_PROFILE_FUNC(ucc_status_t, ucc_collective_init,
                       (coll_args, request, team), ucc_coll_args_t *coll_args,
                       ucc_coll_req_h *request, ucc_team_h team)
@@ -190,7 +329,13 @@ UCC_CORE_PROFILE_FUNC(ucc_status_t, ucc_collective_init,
     UCC_COPY_PARAM_BY_FIELD(&op_args.args, coll_args, UCC_COLL_ARGS_FIELD_FLAGS,
                             flags);
 
-    status = ucc_coll_init(team->score_map, &op_args, &task);
+    if (ucc_coll_group_fusable(team, &op_args.args)) {
+        status = ucc_coll_group_add_member(team, &op_args, &task);
+    } else if (ucc_coll_stripe_required(team, &op_args.args)) {
+        status = ucc_coll_init_striped(team, &op_args, &task);
+    } else {
+        status = ucc_coll_init(team->score_map, &op_args, &task);
+    }
     if (UCC_ERR_NOT_SUPPORTED == status) {
         ucc_debug("failed to init collective: not supported");
         return status;
@@ -372,8 +517,14 @@ static ucc_status_t ucc_trigger_complete(ucc_coll_task_t *parent_task,
     } else {
         ucc_assert(task->super.status == UCC_INPROGRESS);
         // TODO use CB instead of EM
-        ucc_event_manager_subscribe(&task->em, UCC_EVENT_COMPLETED, task,
-                                    ucc_triggered_coll_complete);
+        status = ucc_event_manager_subscribe(&task->em, UCC_EVENT_COMPLETED,
+                                             task, ucc_triggered_coll_complete);
+        if (ucc_unlikely(status != UCC_OK)) {
+            ucc_error("failed to subscribe triggered coll, task %p, "
+                      "seq_num %u, %s", task, task->seq_num,
+                      ucc_status_string(status));
+            return status;
+        }
     }
     return UCC_OK;
 }
@@ -452,6 +603,7 @@ ucc_status_t ucc_triggered_post(ucc_ee_h ee, ucc_ev_t *ev,
                                 ucc_coll_task_t *task)
 {
     ucc_coll_task_t *ev_task;
+    ucc_status_t     status;
 
     if (ev->ev_type != UCC_EVENT_COMPUTE_COMPLETE) {
         ucc_error("event type %d is not supported", ev->ev_type);
@@ -465,7 +617,10 @@ ucc_status_t ucc_triggered_post(ucc_ee_h ee, ucc_ev_t *ev,
         return UCC_ERR_NO_MEMORY;
     }
 
-    ucc_coll_task_init(ev_task, NULL, task->team);
+    status = ucc_coll_task_init(ev_task, NULL, task->team);
+    if (ucc_unlikely(status != UCC_OK)) {
+        goto free_ev_task;
+    }
     ev_task->ee             = ee;
     ev_task->ev             = NULL;
     ev_task->triggered_task = task;
@@ -479,10 +634,16 @@ ucc_status_t ucc_triggered_post(ucc_ee_h ee, ucc_ev_t *ev,
     if (UCC_COLL_TIMEOUT_REQUIRED(task)) {
         UCC_COLL_SET_TIMEOUT(ev_task, task->bargs.args.timeout);
     }
-    ucc_event_manager_subscribe(&ev_task->em, UCC_EVENT_COMPLETED, task,
-                                ucc_trigger_complete);
+    status = ucc_event_manager_subscribe(&ev_task->em, UCC_EVENT_COMPLETED,
+                                         task, ucc_trigger_complete);
+    if (ucc_unlikely(status != UCC_OK)) {
+        goto free_ev_task;
+    }
 
     return ucc_progress_queue_enqueue(UCC_TASK_CORE_CTX(ev_task)->pq, ev_task);
+free_ev_task:
+    ucc_free(ev_task);
+    return status;
 }
 
 ucc_status_t ucc_collective_triggered_post(ucc_ee_h ee, ucc_ev_t *ev)
@@ -0,0 +1,538 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * See file LICENSE for terms.
+ */
+
+#include "config.h"
+#include "ucc_coll_group.h"
+#include "ucc_team.h"
+#include "ucc_context.h"
+#include "ucc_progress_queue.h"
+#include "components/mc/ucc_mc.h"
+#include "components/ec/ucc_ec.h"
+#include "components/cl/ucc_cl.h"
+#include "coll_score/ucc_coll_score.h"
+#include "utils/ucc_malloc.h"
+#include "utils/ucc_log.h"
+#include "utils/ucc_atomic.h"
+#include "utils/ucc_coll_utils.h"
+
+typedef struct ucc_coll_group_op ucc_coll_group_op_t;
+
+typedef struct ucc_coll_group_member {
+    ucc_coll_task_t      super;
+    ucc_coll_group_t    *group;  /*< open group the member is linked to */
+    ucc_coll_group_op_t *op;     /*< fused op, set by group_end */
+    uint32_t             idx;    /*< index in op->members */
+    size_t               offset; /*< offset in op scratch, bytes */
+} ucc_coll_group_member_t;
+
+typedef struct ucc_coll_group_copy {
+    ucc_coll_task_t         super;
+    int                     unpack;
+    uint32_t                next;  /*< next member to copy */
+    ucc_ee_executor_task_t *etask;
+} ucc_coll_group_copy_t;
+
+struct ucc_coll_group_op {
+    ucc_schedule_t            super;
+    ucc_coll_group_copy_t     pack;
+    ucc_coll_group_copy_t     unpack;
+    ucc_mc_buffer_header_t   *scratch; /*< NULL for single member op */
+    ucc_coll_group_member_t **members;
+    uint32_t                  n_members;
+    uint32_t                  n_posted;
+    uint32_t                  n_released;
+};
+
+static inline size_t ucc_coll_group_member_len(ucc_coll_group_member_t *m)
+{
+    ucc_coll_args_t *args = &m->super.bargs.args;
+
+    return args->dst.info.count * ucc_dt_size(args->dst.info.datatype);
+}
+
+static inline int ucc_coll_group_compatible(ucc_coll_group_member_t *m1,
+                                            ucc_coll_group_member_t *m2)
+{
+    ucc_coll_args_t *a1 = &m1->super.bargs.args;
+    ucc_coll_args_t *a2 = &m2->super.bargs.args;
+
+    return a1->op == a2->op &&
+           a1->dst.info.datatype == a2->dst.info.datatype &&
+           a1->dst.info.mem_type == a2->dst.info.mem_type;
+}
+
+static void ucc_coll_group_copy_progress(ucc_coll_task_t *task)
+{
+    ucc_coll_group_copy_t      *copy = ucc_derived_of(task,
+                                                      ucc_coll_group_copy_t);
+    ucc_coll_group_op_t        *op   = ucc_derived_of(task->schedule,
+                                                      ucc_coll_group_op_t);
+    ucc_ee_executor_task_args_t eargs;
+    ucc_ee_executor_t          *exec;
+    ucc_coll_group_member_t    *m;
+    ucc_coll_args_t            *args;
+    ucc_status_t                st;
+    void                       *fused;
+    uint32_t                    i, n;
+
+    st = ucc_coll_task_get_executor(task, &exec);
+    if (ucc_unlikely(UCC_OK != st)) {
+        task->status = st;
+        return;
+    }
+    for (;;) {
+        if (copy->etask) {
+            st = ucc_ee_executor_task_test(copy->etask);
+            if (st == UCC_INPROGRESS) {
+                return;
+            }
+            ucc_ee_executor_task_finalize(copy->etask);
+            copy->etask = NULL;
+            if (ucc_unlikely(UCC_OK != st)) {
+                task->status = st;
+                return;
+            }
+        }
+        if (copy->next == op->n_members) {
+            break;
+        }
+        n = ucc_min(op->n_members - copy->next,
+                    UCC_EE_EXECUTOR_NUM_COPY_BUFS);
+        eargs.task_type              = UCC_EE_EXECUTOR_TASK_COPY_MULTI;
+        eargs.flags                  = 0;
+        eargs.copy_multi.num_vectors = n;
+        for (i = 0; i < n; i++) {
+            m     = op->members[copy->next + i];
+            args  = &m->super.bargs.args;
+            fused = PTR_OFFSET(op->scratch->addr, m->offset);
+            if (copy->unpack) {
+                eargs.copy_multi.src[i] = fused;
+                eargs.copy_multi.dst[i] = args->dst.info.buffer;
+            } else {
+                eargs.copy_multi.src[i] = UCC_IS_INPLACE(*args)
+                                              ? args->dst.info.buffer
+                                              : args->src.info.buffer;
+                eargs.copy_multi.dst[i] = fused;
+            }
+            eargs.copy_multi.counts[i] = ucc_coll_group_member_len(m);
+        }
+        st = ucc_ee_executor_task_post(exec, &eargs, &copy->etask);
+        if (ucc_unlikely(UCC_OK != st)) {
+            task->status = st;
+            return;
+        }
+        copy->next += n;
+    }
+    task->status = UCC_OK;
+}
+
+static ucc_status_t ucc_coll_group_copy_start(ucc_coll_task_t *task)
+{
+    ucc_coll_group_copy_t *copy = ucc_derived_of(task, ucc_coll_group_copy_t);
+
+    copy->next   = 0;
+    copy->etask  = NULL;
+    task->status = UCC_INPROGRESS;
+    return ucc_progress_queue_enqueue(UCC_TASK_CORE_CTX(task)->pq, task);
+}
+
+static ucc_status_t ucc_coll_group_copy_init(ucc_coll_group_copy_t *copy,
+                                             ucc_base_team_t       *team,
+                                             int                    unpack)
+{
+    ucc_status_t status;
+
+    status = ucc_coll_task_init(&copy->super, NULL, team);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
+    copy->unpack         = unpack;
+    copy->etask          = NULL;
+    copy->super.flags    = UCC_COLL_TASK_FLAG_EXECUTOR;
+    copy->super.post     = ucc_coll_group_copy_start;
+    copy->super.progress = ucc_coll_group_copy_progress;
+    copy->super.finalize = NULL;
+    return UCC_OK;
+}
+
+/* Completion of the fused op is reported to all its members. Once the status
+   of a member is published it can be finalized from another thread, and
+   finalize of the last member releases the op, so neither is accessed after
+   that (same as in ucc_task_complete) */
+static void ucc_coll_group_op_cb(void *data, ucc_status_t status)
+{
+    ucc_coll_group_op_t     *op        = data;
+    uint32_t                 n_members = op->n_members;
+    ucc_coll_group_member_t *m;
+    ucc_coll_callback_t      cb;
+    int                      has_cb;
+    uint32_t                 i;
+
+    for (i = 0; i < n_members; i++) {
+        m                     = op->members[i];
+        cb                    = m->super.cb;
+        has_cb                = m->super.flags & UCC_COLL_TASK_FLAG_CB;
+        m->super.status       = status;
+        m->super.super.status = status;
+        if (has_cb) {
+            cb.cb(cb.data, status);
+        }
+    }
+}
+
+static ucc_status_t ucc_coll_group_op_release(ucc_coll_group_op_t *op)
+{
+    ucc_status_t status = UCC_OK;
+    ucc_status_t st;
+
+    if (op->super.n_tasks) {
+        status = ucc_schedule_finalize(&op->super.super);
+    }
+    if (op->super.super.executor) {
+        st = ucc_ee_executor_finalize(op->super.super.executor);
+        if (ucc_unlikely(UCC_OK != st)) {
+            status = st;
+        }
+    }
+    if (op->scratch) {
+        st = ucc_mc_free(op->scratch);
+        if (ucc_unlikely(UCC_OK != st)) {
+            status = st;
+        }
+    }
+    ucc_free(op->members);
+    ucc_free(op);
+    return status;
+}
+
+static ucc_status_t ucc_coll_group_op_executor_init(ucc_coll_group_op_t *op,
+                                                    ucc_memory_type_t    mt)
+{
+    ucc_ee_executor_params_t params;
+
+    switch (mt) {
+    case UCC_MEMORY_TYPE_CUDA:
+        params.ee_type = UCC_EE_CUDA_STREAM;
+        break;
+    case UCC_MEMORY_TYPE_ROCM:
+        params.ee_type = UCC_EE_ROCM_STREAM;
+        break;
+    case UCC_MEMORY_TYPE_HOST:
+        params.ee_type = UCC_EE_CPU_THREAD;
+        break;
+    default:
+        ucc_error("no suitable executor available for memory type %s",
+                  ucc_memory_type_names[mt]);
+        return UCC_ERR_INVALID_PARAM;
+    }
+    params.mask = UCC_EE_EXECUTOR_PARAM_FIELD_TYPE;
+    op->super.super.flags |= UCC_COLL_TASK_FLAG_EXECUTOR_STOP;
+    return ucc_ee_executor_init(&params, &op->super.super.executor);
+}
+
+/* Creates fused op for "n_members" compatible members which take "total"
+   bytes. Takes ownership of the "members" array. */
+static ucc_status_t ucc_coll_group_op_init(ucc_team_t               *team,
+                                           ucc_coll_group_member_t **members,
+                                           uint32_t                  n_members,
+                                           size_t                    total)
+{
+    ucc_coll_args_t     *args0 = &members[0]->super.bargs.args;
+    ucc_memory_type_t    mt    = args0->dst.info.mem_type;
+    ucc_base_coll_args_t bargs;
+    ucc_coll_group_op_t *op;
+    ucc_coll_task_t     *task;
+    ucc_status_t         status;
+    size_t               offset;
+    uint32_t             i;
+
+    op = ucc_calloc(1, sizeof(*op), "coll_group_op");
+    if (!op) {
+        ucc_error("failed to allocate %zd bytes for coll group op",
+                  sizeof(*op));
+        ucc_free(members);
+        return UCC_ERR_NO_MEMORY;
+    }
+    op->members   = members;
+    op->n_members = n_members;
+
+    memcpy(&bargs, &members[0]->super.bargs, sizeof(bargs));
+    bargs.team = team;
+    if (n_members > 1) {
+        status = ucc_mc_alloc(&op->scratch, total, mt);
+        if (ucc_unlikely(UCC_OK != status)) {
+            ucc_error("failed to allocate %zd bytes for fused collective",
+                      total);
+            goto err;
+        }
+        bargs.args.mask              = UCC_COLL_ARGS_FIELD_FLAGS;
+        bargs.args.flags             = UCC_COLL_ARGS_FLAG_IN_PLACE;
+        bargs.args.dst.info.buffer   = op->scratch->addr;
+        bargs.args.dst.info.count    = total /
+                                       ucc_dt_size(args0->dst.info.datatype);
+    } else {
+        /* single member: run its allreduce as is, only the callback is
+           reported through the member */
+        bargs.args.mask &= ~UCC_COLL_ARGS_FIELD_CB;
+    }
+
+    status = ucc_coll_init(team->score_map, &bargs, &task);
+    if (ucc_unlikely(UCC_OK != status)) {
+        goto err;
+    }
+    status = ucc_schedule_init(&op->super, &bargs, task->team);
+    if (ucc_unlikely(UCC_OK != status)) {
+        task->finalize(task);
+        goto err;
+    }
+    if (n_members > 1) {
+        UCC_CHECK_GOTO(ucc_coll_group_copy_init(&op->pack, task->team, 0),
+                       err_task, status);
+        UCC_CHECK_GOTO(ucc_coll_group_copy_init(&op->unpack, task->team, 1),
+                       err_task, status);
+        UCC_CHECK_GOTO(ucc_schedule_add_task(&op->super, &op->pack.super),
+                       err_task, status);
+        UCC_CHECK_GOTO(ucc_schedule_add_task(&op->super, task), err_task,
+                       status);
+        UCC_CHECK_GOTO(ucc_schedule_add_task(&op->super, &op->unpack.super),
+                       err, status);
+        UCC_CHECK_GOTO(ucc_event_manager_subscribe(&op->super.super.em,
+                                                   UCC_EVENT_SCHEDULE_STARTED,
+                                                   &op->pack.super,
+                                                   ucc_task_start_handler),
+                       err, status);
+        UCC_CHECK_GOTO(ucc_event_manager_subscribe(&op->pack.super.em,
+                                                   UCC_EVENT_COMPLETED, task,
+                                                   ucc_task_start_handler),
+                       err, status);
+        UCC_CHECK_GOTO(ucc_event_manager_subscribe(&task->em,
+                                                   UCC_EVENT_COMPLETED,
+                                                   &op->unpack.super,
+                                                   ucc_task_start_handler),
+                       err, status);
+    } else {
+        UCC_CHECK_GOTO(ucc_schedule_add_task(&op->super, task), err_task,
+                       status);
+        UCC_CHECK_GOTO(ucc_event_manager_subscribe(&op->super.super.em,
+                                                   UCC_EVENT_SCHEDULE_STARTED,
+                                                   task,
+                                                   ucc_task_start_handler),
+                       err, status);
+    }
+    if (op->super.super.flags & UCC_COLL_TASK_FLAG_EXECUTOR) {
+        status = ucc_coll_group_op_executor_init(op, mt);
+        if (ucc_unlikely(UCC_OK != status)) {
+            ucc_error("failed to init executor: %s",
+                      ucc_status_string(status));
+            goto err;
+        }
+    }
+    op->super.super.post     = ucc_schedule_start;
+    op->super.super.progress = NULL;
+    op->super.super.finalize = NULL;
+    op->super.super.flags   |= UCC_COLL_TASK_FLAG_CB;
+    op->super.super.cb.cb    = ucc_coll_group_op_cb;
+    op->super.super.cb.data  = op;
+
+    for (i = 0, offset = 0; i < n_members; i++) {
+        members[i]->op     = op;
+        members[i]->idx    = i;
+        members[i]->offset = offset;
+        offset += ucc_coll_group_member_len(members[i]);
+    }
+    return UCC_OK;
+
+err_task:
+    /* not owned by the schedule yet */
+    task->finalize(task);
+err:
+    ucc_coll_group_op_release(op);
+    return status;
+}
+
+static ucc_status_t ucc_coll_group_op_post(ucc_coll_group_op_t *op)
+{
+    ucc_coll_task_t *task = &op->super.super;
+    ucc_status_t     status;
+
+    if (task->executor) {
+        status = ucc_ee_executor_start(task->executor, NULL);
+        if (ucc_unlikely(UCC_OK != status)) {
+            ucc_error("failed to start executor: %s",
+                      ucc_status_string(status));
+            return status;
+        }
+    }
+    return task->post(task);
+}
+
+static ucc_status_t ucc_coll_group_member_post(ucc_coll_task_t *task)
+{
+    ucc_coll_group_member_t *m  = ucc_derived_of(task,
+                                                 ucc_coll_group_member_t);
+    ucc_coll_group_op_t     *op = m->op;
+
+    if (ucc_unlikely(!op)) {
+        ucc_error("member of collective group %p is posted before "
+                  "ucc_collective_group_end", task);
+        return UCC_ERR_INVALID_PARAM;
+    }
+    task->status       = UCC_INPROGRESS;
+    task->super.status = UCC_INPROGRESS;
+    if (ucc_atomic_fadd32(&op->n_posted, 1) + 1 < op->n_members) {
+        return UCC_OK;
+    }
+    return ucc_coll_group_op_post(op);
+}
+
+static ucc_status_t
+ucc_coll_group_member_triggered_post(ucc_ee_h ee, ucc_ev_t *ev, //NOLINT
+                                     ucc_coll_task_t *task)     //NOLINT
+{
+    ucc_error("triggered post of collective group member %p is not supported",
+              task);
+    return UCC_ERR_NOT_SUPPORTED;
+}
+
+static ucc_status_t ucc_coll_group_member_finalize(ucc_coll_task_t *task)
+{
+    ucc_coll_group_member_t *m  = ucc_derived_of(task,
+                                                 ucc_coll_group_member_t);
+    ucc_coll_group_op_t     *op = m->op;
+
+    if (m->group) {
+        ucc_list_del(&task->list_elem);
+        m->group->n_members--;
+    }
+    ucc_free(m);
+    if (op && (ucc_atomic_fadd32(&op->n_released, 1) + 1 == op->n_members)) {
+        return ucc_coll_group_op_release(op);
+    }
+    return UCC_OK;
+}
+
+ucc_status_t ucc_coll_group_add_member(ucc_team_t           *team,
+                                       ucc_base_coll_args_t *bargs,
+                                       ucc_coll_task_t     **task_h)
+{
+    ucc_coll_group_member_t *m;
+    ucc_status_t             status;
+
+    m = ucc_malloc(sizeof(*m), "coll_group_member");
+    if (!m) {
+        ucc_error("failed to allocate %zd bytes for coll group member",
+                  sizeof(*m));
+        return UCC_ERR_NO_MEMORY;
+    }
+    status = ucc_coll_task_init(&m->super, bargs, &team->cl_teams[0]->super);
+    if (ucc_unlikely(UCC_OK != status)) {
+        ucc_free(m);
+        return status;
+    }
+    m->super.post           = ucc_coll_group_member_post;
+    m->super.triggered_post = ucc_coll_group_member_triggered_post;
+    m->super.progress       = NULL;
+    m->super.finalize       = ucc_coll_group_member_finalize;
+    m->group                = team->coll_group;
+    m->op                   = NULL;
+    ucc_list_add_tail(&m->group->members, &m->super.list_elem);
+    m->group->n_members++;
+    *task_h = &m->super;
+    return UCC_OK;
+}
+
+ucc_status_t ucc_collective_group_start(ucc_team_h team)
+{
+    ucc_coll_group_t *group;
+
+    if (team->coll_group) {
+        ucc_error("collective group is already started on team %p", team);
+        return UCC_ERR_INVALID_PARAM;
+    }
+    group = ucc_malloc(sizeof(*group), "coll_group");
+    if (!group) {
+        ucc_error("failed to allocate %zd bytes for coll group",
+                  sizeof(*group));
+        return UCC_ERR_NO_MEMORY;
+    }
+    ucc_list_head_init(&group->members);
+    group->n_members = 0;
+    team->coll_group = group;
+    return UCC_OK;
+}
+
+ucc_status_t ucc_collective_group_end(ucc_team_h team)
+{
+    ucc_coll_group_t         *group     = team->coll_group;
+    size_t                    frag_size =
+        team->contexts[0]->coll_group_frag_size;
+    ucc_status_t              status    = UCC_OK;
+    ucc_coll_group_member_t **members, **op_members, *m, *tmp;
+    uint32_t                  n, i, j, k;
+    size_t                    total, len;
+
+    if (!group) {
+        ucc_error("collective group is not started on team %p", team);
+        return UCC_ERR_INVALID_PARAM;
+    }
+    team->coll_group = NULL;
+    n                = group->n_members;
+    members          = NULL;
+    if (n) {
+        members = ucc_malloc(n * sizeof(*members), "coll_group_members");
+        if (!members) {
+            ucc_error("failed to allocate %zd bytes for coll group members",
+                      n * sizeof(*members));
+            team->coll_group = group;
+            return UCC_ERR_NO_MEMORY;
+        }
+    }
+    i = 0;
+    ucc_list_for_each_safe(m, tmp, &group->members, super.list_elem) {
+        ucc_list_del(&m->super.list_elem);
+        m->group     = NULL;
+        members[i++] = m;
+    }
+    ucc_free(group);
+
+    /* Greedy split preserving the order of initialization: the result is the
+       same on all the ranks that initialized the same sequence */
+    for (i = 0; i < n; i++) {
+        if (!members[i]) {
+            continue;
+        }
+        op_members = ucc_malloc((n - i) * sizeof(*op_members),
+                                "coll_group_op_members");
+        if (!op_members) {
+            ucc_error("failed to allocate %zd bytes for coll group op",
+                      (n - i) * sizeof(*op_members));
+            status = UCC_ERR_NO_MEMORY;
+            break;
+        }
+        op_members[0] = members[i];
+        total         = ucc_coll_group_member_len(members[i]);
+        k             = 1;
+        for (j = i + 1; j < n && total < frag_size; j++) {
+            if (!members[j] ||
+                !ucc_coll_group_compatible(op_members[0], members[j])) {
+                continue;
+            }
+            len = ucc_coll_group_member_len(members[j]);
+            if (total + len > frag_size) {
+                continue;
+            }
+            op_members[k++] = members[j];
+            members[j]      = NULL;
+            total          += len;
+        }
+        members[i] = NULL;
+        status = ucc_coll_group_op_init(team, op_members, k, total);
+        if (ucc_unlikely(UCC_OK != status)) {
+            break;
+        }
+    }
+    ucc_free(members);
+    return status;
+}
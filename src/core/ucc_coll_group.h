@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCC_COLL_GROUP_H_
+#define UCC_COLL_GROUP_H_
+
+#include "ucc/api/ucc.h"
+#include "utils/ucc_list.h"
+#include "schedule/ucc_schedule.h"
+#include "ucc_team.h"
+#include "ucc_dt.h"
+
+/* Collective group opened on a team by ucc_collective_group_start.
+
+   Fusable collectives initialized while the group is open become its
+   members: ucc_collective_init returns a lightweight member request and
+   does not select an algorithm. ucc_collective_group_end splits the members
+   into fused operations by compatibility (op, dt, mem type) and by
+   UCC_COLL_GROUP_FRAG_SIZE. Fused operation packs the member buffers into a
+   scratch buffer with the executor copy_multi task, runs a single allreduce
+   on it and unpacks the result. It is posted when the last of its members
+   is posted and it reports the completion to every member request. */
+typedef struct ucc_coll_group {
+    ucc_list_link_t members; /*< members in the order of initialization */
+    uint32_t        n_members;
+} ucc_coll_group_t;
+
+static inline int ucc_coll_group_fusable(ucc_team_t            *team,
+                                         const ucc_coll_args_t *args)
+{
+    return team->coll_group &&
+           args->coll_type == UCC_COLL_TYPE_ALLREDUCE &&
+           !UCC_IS_PERSISTENT(*args) &&
+           !(args->mask & UCC_COLL_ARGS_FIELD_ACTIVE_SET) &&
+           UCC_DT_IS_PREDEFINED(args->dst.info.datatype) &&
+           args->dst.info.count > 0 &&
+           (UCC_IS_INPLACE(*args) ||
+            args->src.info.mem_type == args->dst.info.mem_type);
+}
+
+ucc_status_t ucc_coll_group_add_member(ucc_team_t           *team,
+                                       ucc_base_coll_args_t *bargs,
+                                       ucc_coll_task_t     **task_h);
+
+#endif
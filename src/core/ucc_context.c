@@ -12,6 +12,12 @@
 #include "utils/ucc_list.h"
 #include "utils/ucc_string.h"
 #include "ucc_progress_queue.h"
+#include "utils/ucc_time.h"
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+#include <sched.h>
 
 static uint32_t ucc_context_seq_num = 0;
 static ucc_config_field_t ucc_context_config_table[] = {
@@ -44,6 +50,63 @@ static ucc_config_field_t ucc_context_config_table[] = {
      "is configured with OOB (global mode). 0 - disable, 1 - try, 2 - force.",
      ucc_offsetof(ucc_context_config_t, internal_oob), UCC_CONFIG_TYPE_UINT},
 
+    {"WAIT_SPIN_TIME", "inf",
+     "Time ucc_context_wait polls the context before it puts the calling "
+     "thread to sleep until network activity. inf - never sleep, "
+     "wakeup resources are not allocated by transports in this case",
+     ucc_offsetof(ucc_context_config_t, wait_spin_time), UCC_CONFIG_TYPE_TIME},
+
+    {"WAIT_SLEEP_TIME", "1ms",
+     "Maximal time ucc_context_wait sleeps before polling the context again. "
+     "Bounds the latency of the collectives that are progressed without "
+     "network activity, e.g. by executors or other contexts",
+     ucc_offsetof(ucc_context_config_t, wait_sleep_time), UCC_CONFIG_TYPE_TIME},
+
+    {"PROGRESS_THREAD", "n",
+     "Progress the context by an internal thread, so collectives advance "
+     "while the application computes. ucc_context_progress becomes a no-op. "
+     "Internal resources of the context are created in UCC_THREAD_MULTIPLE "
+     "mode, which requires all selected CLs to support it",
+     ucc_offsetof(ucc_context_config_t, progress_thread), UCC_CONFIG_TYPE_BOOL},
+
+    {"PROGRESS_THREAD_CPU", "-1",
+     "CPU the progress thread is bound to. -1 - inherit the affinity of the "
+     "thread that creates the context",
+     ucc_offsetof(ucc_context_config_t, progress_thread_cpu),
+     UCC_CONFIG_TYPE_INT},
+
+    {"PROGRESS_THREAD_IDLE_ROUNDS", "1000",
+     "Number of consecutive progress rounds without completed collectives "
+     "after which the progress thread yields the cpu between rounds. After "
+     "10 times that many rounds it sleeps PROGRESS_THREAD_IDLE_SLEEP between "
+     "rounds. Any completion switches it back to busy polling. "
+     "0 - always busy poll",
+     ucc_offsetof(ucc_context_config_t, progress_thread_idle_rounds),
+     UCC_CONFIG_TYPE_UINT},
+
+    {"PROGRESS_THREAD_IDLE_SLEEP", "50us",
+     "Sleep time of the idle progress thread between progress rounds. "
+     "Bounds the extra latency of a collective posted to an idle context",
+     ucc_offsetof(ucc_context_config_t, progress_thread_idle_sleep),
+     UCC_CONFIG_TYPE_TIME},
+
+    {"STRIPE_THRESH", "256k",
+     "Minimal message size of a collective on a team created from multiple "
+     "contexts, starting from which the collective is split into fragments "
+     "progressed by all the contexts of the team. Smaller collectives use the "
+     "first context only. Applies to the context passed first to "
+     "ucc_team_create_post",
+     ucc_offsetof(ucc_context_config_t, stripe_thresh),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
+    {"COLL_GROUP_FRAG_SIZE", "256k",
+     "Maximal size of a fused operation created from the collectives of a "
+     "group (see ucc_collective_group_start). Members of a group are packed "
+     "into fragments of this size, fragments progress concurrently so packing "
+     "of one fragment overlaps with communication of another",
+     ucc_offsetof(ucc_context_config_t, coll_group_frag_size),
+     UCC_CONFIG_TYPE_MEMUNITS},
+
     {NULL}};
 UCC_CONFIG_REGISTER_TABLE(ucc_context_config_table, "UCC context", NULL,
                           ucc_context_config_t, &ucc_config_global_list);
@@ -551,6 +614,76 @@ poll:
     return UCC_OK;
 }
 
+static int ucc_context_progress_once(ucc_context_t *context);
+
+static void *ucc_context_progress_thread_fn(void *arg)
+{
+    ucc_context_t *ctx         = arg;
+    unsigned       idle_rounds = ctx->progress_thread_idle_rounds;
+    useconds_t     sleep_us    = (useconds_t)(ctx->progress_thread_idle_sleep *
+                                              1e6) + 1;
+    unsigned       n_idle      = 0;
+    cpu_set_t      cpuset;
+    int            n_done;
+
+    if (ctx->progress_thread_cpu >= 0) {
+        CPU_ZERO(&cpuset);
+        CPU_SET(ctx->progress_thread_cpu, &cpuset);
+        if (0 != pthread_setaffinity_np(pthread_self(), sizeof(cpuset),
+                                        &cpuset)) {
+            ucc_warn("failed to bind progress thread of context %p to cpu %d",
+                     ctx, ctx->progress_thread_cpu);
+        }
+    }
+    while (ctx->progress_thread_active) {
+        n_done = ucc_context_progress_once(ctx);
+        if (ucc_unlikely(n_done < 0)) {
+            /* error is also reported via the status of the failed task */
+            ucc_debug("progress thread of context %p: %s", ctx,
+                      ucc_status_string((ucc_status_t)n_done));
+        }
+        if (n_done != 0 || idle_rounds == 0) {
+            n_idle = 0;
+            continue;
+        }
+        /* nothing completed: back off so that the idle context does not
+           hold a core and the worker lock */
+        if (n_idle < 10 * idle_rounds) {
+            n_idle++;
+        }
+        if (n_idle >= 10 * idle_rounds) {
+            usleep(sleep_us);
+        } else if (n_idle >= idle_rounds) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static ucc_status_t ucc_context_progress_thread_start(ucc_context_t *ctx)
+{
+    int rc;
+
+    ctx->progress_thread_active = 1;
+    rc = pthread_create(&ctx->progress_thread, NULL,
+                        ucc_context_progress_thread_fn, ctx);
+    if (rc != 0) {
+        ucc_error("failed to create progress thread: %s", strerror(rc));
+        ctx->progress_thread_active = 0;
+        return UCC_ERR_NO_MESSAGE;
+    }
+    return UCC_OK;
+}
+
+static void ucc_context_progress_thread_stop(ucc_context_t *ctx)
+{
+    if (!ctx->progress_thread_active) {
+        return;
+    }
+    ctx->progress_thread_active = 0;
+    pthread_join(ctx->progress_thread, NULL);
+}
+
 ucc_status_t ucc_context_create(ucc_lib_h lib,
                                 const ucc_context_params_t *params,
                                 const ucc_context_config_h  config,
@@ -581,6 +714,13 @@ ucc_status_t ucc_context_create(ucc_lib_h lib,
     ctx->lib           = lib;
     ctx->ids.pool_size = config->team_ids_pool_size;
     ucc_list_head_init(&ctx->progress_list);
+    ucc_list_head_init(&ctx->event_list);
+    ctx->epfd            = -1;
+    ctx->wait_spin_time  = config->wait_spin_time;
+    ctx->wait_sleep_time = config->wait_sleep_time;
+    ctx->wait_sleep      = isfinite(config->wait_spin_time);
+    ctx->stripe_thresh   = config->stripe_thresh;
+    ctx->coll_group_frag_size = config->coll_group_frag_size;
     ucc_copy_context_params(&ctx->params, params);
     ucc_copy_context_params(&b_params.params, params);
     b_params.context           = ctx;
@@ -588,6 +728,21 @@ ucc_status_t ucc_context_create(ucc_lib_h lib,
     b_params.estimated_num_ppn = config->estimated_num_ppn;
     b_params.prefix            = lib->full_prefix;
     b_params.thread_mode       = lib->attr.thread_mode;
+    if (config->progress_thread) {
+        /* context is accessed concurrently by the progress thread and
+           the user thread(s) regardless of the lib thread mode */
+        for (i = 0; i < lib->n_cl_libs_opened; i++) {
+            if (lib->cl_attrs[i].super.attr.thread_mode <
+                UCC_THREAD_MULTIPLE) {
+                ucc_error("progress thread requires UCC_THREAD_MULTIPLE "
+                          "support from CL %s",
+                          lib->cl_libs[i]->iface->super.name);
+                status = UCC_ERR_NOT_SUPPORTED;
+                goto error_ctx;
+            }
+        }
+        b_params.thread_mode = UCC_THREAD_MULTIPLE;
+    }
     if (params->mask & UCC_CONTEXT_PARAM_FIELD_OOB) {
         ctx->rank = params->oob.oob_ep;
     }
@@ -663,6 +818,9 @@ ucc_status_t ucc_context_create(ucc_lib_h lib,
                         (params->mask & UCC_CONTEXT_PARAM_FIELD_TYPE))
                            ? UCC_THREAD_SINGLE
                            : lib->attr.thread_mode;
+    if (config->progress_thread) {
+        ctx->thread_mode = UCC_THREAD_MULTIPLE;
+    }
     status           = ucc_progress_queue_init(&ctx->pq, ctx->thread_mode,
                                                config->lock_free_progress_q);
     if (UCC_OK != status) {
@@ -766,6 +924,16 @@ ucc_status_t ucc_context_create(ucc_lib_h lib,
         }
     }
 
+    if (config->progress_thread) {
+        ctx->progress_thread_cpu         = config->progress_thread_cpu;
+        ctx->progress_thread_idle_rounds = config->progress_thread_idle_rounds;
+        ctx->progress_thread_idle_sleep  = config->progress_thread_idle_sleep;
+        status = ucc_context_progress_thread_start(ctx);
+        if (UCC_OK != status) {
+            goto error_ctx_create;
+        }
+    }
+
     ucc_info("created ucc context %p for lib %s", ctx, lib->full_prefix);
     *context = ctx;
     return UCC_OK;
@@ -799,6 +967,7 @@ ucc_status_t ucc_context_destroy(ucc_context_t *context)
     int               i;
     ucc_status_t      status;
 
+    ucc_context_progress_thread_stop(context);
     if (context->service_team) {
         while (UCC_INPROGRESS ==
                (status = UCC_TL_CTX_IFACE(context->service_ctx)
@@ -829,6 +998,9 @@ ucc_status_t ucc_context_destroy(ucc_context_t *context)
         tl_lib->iface->context.destroy(&tl_ctx->super);
     }
     ucc_context_topo_cleanup(context->topo);
+    if (context->epfd >= 0) {
+        close(context->epfd);
+    }
     ucc_progress_queue_finalize(context->pq);
     ucc_free(context->addr_storage.storage);
     ucc_free(context->all_tls.names);
@@ -876,21 +1048,146 @@ ucc_status_t ucc_context_progress_deregister(ucc_context_t *ctx,
     return UCC_ERR_NOT_FOUND;
 }
 
-ucc_status_t ucc_context_progress(ucc_context_h context)
+/* Returns number of completed tasks or negative error status */
+static int ucc_context_progress_once(ucc_context_t *context)
 {
-    ucc_status_t                  status;
     ucc_context_progress_entry_t *entry;
     /* progress registered progress fns */
     ucc_list_for_each(entry, &context->progress_list, list_elem) {
         entry->fn(entry->arg);
     }
+    return ucc_progress_queue(context->pq);
+}
+
+static ucc_status_t ucc_context_progress_all(ucc_context_t *context)
+{
+    ucc_status_t status;
+
     /* the fn below returns int - number of completed tasks.
        TODO : do we need to handle it ? Maybe return to user
        as int as well? */
-    status = (ucc_status_t)ucc_progress_queue(context->pq);
+    status = (ucc_status_t)ucc_context_progress_once(context);
     return (status >= 0 ? UCC_OK : status);
 }
 
+ucc_status_t ucc_context_progress(ucc_context_h context)
+{
+    if (context->progress_thread_active) {
+        return UCC_OK;
+    }
+    return ucc_context_progress_all(context);
+}
+
+typedef struct ucc_context_event_entry {
+    ucc_list_link_t      list_elem;
+    int                  fd;
+    ucc_context_arm_fn_t fn;
+    void                *arg;
+} ucc_context_event_entry_t;
+
+ucc_status_t ucc_context_event_register(ucc_context_t *ctx, int fd,
+                                        ucc_context_arm_fn_t fn, void *arm_arg)
+{
+    ucc_context_event_entry_t *entry;
+    struct epoll_event         ev;
+
+    if (ctx->epfd < 0) {
+        ctx->epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (ctx->epfd < 0) {
+            ucc_error("epoll_create1 failed: %m");
+            return UCC_ERR_NO_MESSAGE;
+        }
+    }
+    entry = ucc_malloc(sizeof(*entry), "event_entry");
+    if (!entry) {
+        ucc_error("failed to allocate %zd bytes for event entry",
+                  sizeof(*entry));
+        return UCC_ERR_NO_MEMORY;
+    }
+    ev.events  = EPOLLIN;
+    ev.data.fd = fd;
+    if (0 != epoll_ctl(ctx->epfd, EPOLL_CTL_ADD, fd, &ev)) {
+        ucc_error("failed to add fd %d to epoll set: %m", fd);
+        ucc_free(entry);
+        return UCC_ERR_NO_MESSAGE;
+    }
+    entry->fd  = fd;
+    entry->fn  = fn;
+    entry->arg = arm_arg;
+    ucc_list_add_tail(&ctx->event_list, &entry->list_elem);
+    return UCC_OK;
+}
+
+ucc_status_t ucc_context_event_deregister(ucc_context_t *ctx, int fd)
+{
+    ucc_context_event_entry_t *entry, *tmp;
+
+    ucc_list_for_each_safe(entry, tmp, &ctx->event_list, list_elem) {
+        if (entry->fd == fd) {
+            epoll_ctl(ctx->epfd, EPOLL_CTL_DEL, fd, NULL);
+            ucc_list_del(&entry->list_elem);
+            ucc_free(entry);
+            return UCC_OK;
+        }
+    }
+    return UCC_ERR_NOT_FOUND;
+}
+
+/* Arms all registered event fds and sleeps until any of them fires or
+   wait_sleep_time expires. Returns immediately if some component has pending
+   events. */
+static ucc_status_t ucc_context_sleep(ucc_context_t *ctx)
+{
+    ucc_context_event_entry_t *entry;
+    struct epoll_event         ev;
+    ucc_status_t               status;
+    int                        timeout_ms;
+
+    ucc_list_for_each(entry, &ctx->event_list, list_elem) {
+        status = entry->fn(entry->arg);
+        if (UCC_OK != status) {
+            /* UCC_INPROGRESS: events pending, keep polling */
+            return (status < 0) ? status : UCC_OK;
+        }
+    }
+    /* round up: 0 would turn sleep into busy polling */
+    timeout_ms = (int)(ctx->wait_sleep_time * 1e3) + 1;
+    if (epoll_wait(ctx->epfd, &ev, 1, timeout_ms) < 0 && errno != EINTR) {
+        ucc_error("epoll_wait failed: %m");
+        return UCC_ERR_NO_MESSAGE;
+    }
+    return UCC_OK;
+}
+
+ucc_status_t ucc_context_wait(ucc_context_h context, ucc_coll_req_h request)
+{
+    int          can_sleep = context->wait_sleep &&
+                             !context->progress_thread_active &&
+                             !ucc_list_is_empty(&context->event_list);
+    double       deadline  = 0;
+    ucc_status_t status;
+
+    if (can_sleep) {
+        deadline = ucc_get_time() + context->wait_spin_time;
+    }
+    while (UCC_INPROGRESS == (status = ucc_collective_test(request))) {
+        status = ucc_context_progress(context);
+        if (ucc_unlikely(status < 0)) {
+            return status;
+        }
+        if (!can_sleep || ucc_get_time() < deadline ||
+            UCC_INPROGRESS != ucc_collective_test(request)) {
+            continue;
+        }
+        status = ucc_context_sleep(context);
+        if (ucc_unlikely(status < 0)) {
+            return status;
+        }
+        deadline = ucc_get_time() + context->wait_spin_time;
+    }
+    return status;
+}
+
 static ucc_status_t ucc_context_pack_addr(ucc_context_t             *context,
                                           ucc_context_addr_len_t    *addr_len,
                                           int                       *n_packed,
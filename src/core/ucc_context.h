@@ -11,6 +11,7 @@
 #include "utils/ucc_list.h"
 #include "utils/ucc_proc_info.h"
 #include "components/topo/ucc_topo.h"
+#include <pthread.h>
 
 typedef struct ucc_lib_info          ucc_lib_info_t;
 typedef struct ucc_cl_context        ucc_cl_context_t;
@@ -20,6 +21,7 @@ typedef struct ucc_tl_context_config ucc_tl_context_config_t;
 typedef struct ucc_tl_team           ucc_tl_team_t;
 
 typedef unsigned (*ucc_context_progress_fn_t)(void *progress_arg);
+typedef ucc_status_t (*ucc_context_arm_fn_t)(void *arm_arg);
 typedef struct ucc_context_progress {
     ucc_context_progress_fn_t progress_fn;
     void                     *progress_arg;
@@ -68,6 +70,21 @@ typedef struct ucc_context {
     ucc_context_topo_t      *topo;
     uint64_t                 cl_flags;
     ucc_tl_team_t           *service_team;
+    ucc_list_link_t          event_list;
+    int                      epfd; /*< epoll fd of the registered event fds,
+                                     -1 if none */
+    int                      wait_sleep; /*< ucc_context_wait may sleep */
+    double                   wait_spin_time;
+    double                   wait_sleep_time;
+    pthread_t                progress_thread;
+    volatile int             progress_thread_active; /*< internal thread
+                                                       progresses the context,
+                                                       user calls are no-op */
+    int                      progress_thread_cpu;
+    unsigned                 progress_thread_idle_rounds;
+    double                   progress_thread_idle_sleep;
+    size_t                   stripe_thresh;
+    size_t                   coll_group_frag_size;
 } ucc_context_t;
 
 typedef struct ucc_context_config {
@@ -81,6 +98,14 @@ typedef struct ucc_context_config {
     uint32_t                  estimated_num_ppn;
     uint32_t                  lock_free_progress_q;
     uint32_t                  internal_oob;
+    double                    wait_spin_time;
+    double                    wait_sleep_time;
+    int                       progress_thread;
+    int                       progress_thread_cpu;
+    unsigned                  progress_thread_idle_rounds;
+    double                    progress_thread_idle_sleep;
+    size_t                    stripe_thresh;
+    size_t                    coll_group_frag_size;
 } ucc_context_config_t;
 
 /* Any internal UCC component (TL, CL, etc) may register its own
@@ -97,6 +122,18 @@ ucc_status_t ucc_context_progress_register(ucc_context_t *ctx,
 ucc_status_t ucc_context_progress_deregister(ucc_context_t *ctx,
                                              ucc_context_progress_fn_t fn,
                                              void *progress_arg);
+
+/* Components that can detect network activity (e.g. TL/UCP worker) may
+   register an event fd along with the "arm" callback. ucc_context_wait sleeps
+   on the registered fds once all of them are armed. The arm callback returns
+   UCC_OK if it is safe to sleep on the fd and UCC_INPROGRESS if there are
+   pending events and the context has to be progressed again.
+   Registration is only needed if ctx->wait_sleep is set, components should
+   not allocate wakeup resources otherwise. */
+ucc_status_t ucc_context_event_register(ucc_context_t *ctx, int fd,
+                                        ucc_context_arm_fn_t fn, void *arm_arg);
+
+ucc_status_t ucc_context_event_deregister(ucc_context_t *ctx, int fd);
 /* Performs address exchange between the processes group defined by OOB.
    This function can be used either at context creation time
    (if ctx is global) or at team creation time. The corresponding oob
@@ -66,4 +66,24 @@ static inline size_t ucc_dt_size(ucc_datatype_t dt)
     ucc_assert(0);
     return SIZE_MAX;
 }
+
+/* Size of "count" elements of "dt" located at "buffer" in packed form.
+   For non contiguous generic datatype it is queried from the user via
+   start_pack/packed_size callbacks */
+static inline size_t ucc_dt_packed_size(ucc_datatype_t dt, const void *buffer,
+                                        size_t count)
+{
+    ucc_dt_generic_t *gdt;
+    void             *state;
+    size_t            size;
+
+    if (UCC_DT_IS_PREDEFINED(dt) || UCC_DT_IS_CONTIG(dt)) {
+        return count * ucc_dt_size(dt);
+    }
+    gdt   = ucc_dt_to_generic(dt);
+    state = gdt->ops.start_pack(gdt->context, buffer, count);
+    size  = gdt->ops.packed_size(state);
+    gdt->ops.finish(state);
+    return size;
+}
 #endif
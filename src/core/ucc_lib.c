@@ -15,6 +15,7 @@
 #include "components/tl/ucc_tl.h"
 #include "components/mc/ucc_mc.h"
 #include "components/ec/ucc_ec.h"
+#include "schedule/ucc_schedule.h"
 
 UCS_CONFIG_DEFINE_ARRAY(cl_types, sizeof(ucc_cl_type_t),
                         UCS_CONFIG_TYPE_ENUM(ucc_cl_names));
@@ -350,6 +351,7 @@ ucc_status_t ucc_init_version(unsigned api_major_version,
         goto error;
     }
 
+    ucc_event_manager_global_init();
     *lib_p = lib;
     return UCC_OK;
 error:
@@ -482,6 +484,8 @@ ucc_status_t ucc_finalize(ucc_lib_info_t *lib)
         gl_status = status;
     }
 
+    ucc_event_manager_global_cleanup();
+
     ucc_free(lib->tl_libs);
     ucc_free(lib->cl_libs);
     ucc_free(lib->full_prefix);
@@ -98,12 +98,19 @@ ucc_status_t ucc_team_create_post(ucc_context_h *contexts, uint32_t num_contexts
     uint64_t     team_rank = UINT64_MAX;
     ucc_team_t  *team;
     ucc_status_t status;
+    uint32_t     i, j;
 
     if (num_contexts < 1) {
         return UCC_ERR_INVALID_PARAM;
-    } else if (num_contexts > 1) {
-        ucc_error("team creation from multiple contexts is not supported yet");
-        return UCC_ERR_NOT_SUPPORTED;
+    }
+    for (i = 0; i < num_contexts; i++) {
+        for (j = i + 1; j < num_contexts; j++) {
+            if (contexts[i] == contexts[j]) {
+                ucc_error("context %p is passed to team create twice",
+                          contexts[i]);
+                return UCC_ERR_INVALID_PARAM;
+            }
+        }
     }
 
     if (params->mask & UCC_TEAM_PARAM_FIELD_TEAM_SIZE) {
@@ -203,10 +210,27 @@ ucc_status_t ucc_team_create_post(ucc_context_h *contexts, uint32_t num_contexts
         (params->id <= UCC_TEAM_ID_MAX)) {
         team->id = ((uint16_t)params->id) | UCC_TEAM_ID_EXTERNAL_BIT;
     }
+    if (num_contexts > 1) {
+        /* The team is created on contexts[0] first, then teams on the other
+           contexts are created one by one, see ucc_team_create_ctx_teams */
+        team->ctx_teams = ucc_calloc(num_contexts - 1, sizeof(ucc_team_t *),
+                                     "ctx_teams");
+        if (!team->ctx_teams) {
+            ucc_error("failed to allocate %zd bytes for ctx teams array",
+                      (num_contexts - 1) * sizeof(ucc_team_t *));
+            status = UCC_ERR_NO_MEMORY;
+            goto err_ctx_teams_alloc;
+        }
+        ucc_copy_team_params(&team->ctx_teams_params, params);
+        UCC_COPY_PARAM_BY_FIELD(&team->ctx_teams_params, params,
+                                UCC_TEAM_PARAM_FIELD_ID, id);
+    }
     status    = ucc_team_create_post_single(contexts[0], team);
     *new_team = team;
     return status;
 
+err_ctx_teams_alloc:
+    ucc_free(team->contexts);
 err_ctx_alloc:
     *new_team = NULL;
     ucc_free(team);
@@ -454,6 +478,10 @@ ucc_status_t ucc_team_create_test_single(ucc_context_t *context,
         /* fall through */
     case UCC_TEAM_CL_CREATE:
         status = ucc_team_create_cls(context, team);
+        break;
+    case UCC_TEAM_CTX_TEAMS:
+        /* teams on other contexts, see ucc_team_create_test */
+        break;
     }
 out:
     team->status = status;
@@ -474,18 +502,53 @@ out:
     return status;
 }
 
+/* Creates the teams on contexts[1..num_contexts-1] sequentially: each of
+   them uses user OOB, which can not be shared by simultaneous team creations */
+static ucc_status_t ucc_team_create_ctx_teams(ucc_team_t *team)
+{
+    ucc_status_t status;
+    uint32_t     i;
+
+    for (i = 1; i < team->num_contexts; i++) {
+        if (!team->ctx_teams[i - 1]) {
+            status = ucc_team_create_post(&team->contexts[i], 1,
+                                          &team->ctx_teams_params,
+                                          &team->ctx_teams[i - 1]);
+            if (UCC_OK != status) {
+                ucc_error("failed to post team create on context %p",
+                          team->contexts[i]);
+                return status;
+            }
+        }
+        status = ucc_team_create_test(team->ctx_teams[i - 1]);
+        if (UCC_OK != status) {
+            return status;
+        }
+    }
+    return UCC_OK;
+}
+
 ucc_status_t ucc_team_create_test(ucc_team_h team)
 {
+    ucc_status_t status;
+
     if (NULL == team) {
         ucc_error("ucc_team_create_test: invalid team handle: NULL");
         return UCC_ERR_INVALID_PARAM;
     }
-    /* we don't support multiple contexts per team yet */
-    ucc_assert(team->num_contexts == 1);
     if (team->status == UCC_OK) {
         return UCC_OK;
     }
-    return ucc_team_create_test_single(team->contexts[0], team);
+    if (team->state != UCC_TEAM_CTX_TEAMS) {
+        status = ucc_team_create_test_single(team->contexts[0], team);
+        if (UCC_OK != status || team->num_contexts == 1) {
+            return status;
+        }
+        team->state = UCC_TEAM_CTX_TEAMS;
+    }
+    status       = ucc_team_create_ctx_teams(team);
+    team->status = status;
+    return status;
 }
 
 static ucc_status_t ucc_team_destroy_single(ucc_team_h team)
@@ -523,6 +586,7 @@ static ucc_status_t ucc_team_destroy_single(ucc_team_h team)
     ucc_free(team->ctx_ranks);
     ucc_team_release_id(team);
     ucc_free(team->cl_teams);
+    ucc_free(team->ctx_teams);
     ucc_free(team->contexts);
     ucc_free(team);
     return UCC_OK;
@@ -530,6 +594,9 @@ static ucc_status_t ucc_team_destroy_single(ucc_team_h team)
 
 ucc_status_t ucc_team_destroy(ucc_team_h team)
 {
+    ucc_status_t status;
+    uint32_t     i;
+
     if (NULL == team) {
         ucc_error("ucc_team_destroy: invalid team handle: NULL");
         return UCC_ERR_INVALID_PARAM;
@@ -540,8 +607,16 @@ ucc_status_t ucc_team_destroy(ucc_team_h team)
         return UCC_ERR_INVALID_PARAM;
     }
 
-    /* we don't support multiple contexts per team yet */
-    ucc_assert(team->num_contexts == 1);
+    for (i = 0; i + 1 < team->num_contexts; i++) {
+        if (!team->ctx_teams[i]) {
+            continue;
+        }
+        status = ucc_team_destroy(team->ctx_teams[i]);
+        if (UCC_OK != status) {
+            return status;
+        }
+        team->ctx_teams[i] = NULL;
+    }
     return ucc_team_destroy_single(team);
 }
 
@@ -23,6 +23,7 @@ typedef enum {
     UCC_TEAM_SERVICE_TEAM,
     UCC_TEAM_ALLOC_ID,
     UCC_TEAM_CL_CREATE,
+    UCC_TEAM_CTX_TEAMS,
 } ucc_team_state_t;
 
 typedef struct ucc_team {
@@ -48,6 +49,13 @@ typedef struct ucc_team {
     ucc_topo_t             *topo;
     ucc_score_map_t        *score_map; /*< score map of CLs */
     uint32_t                seq_num;
+    struct ucc_team       **ctx_teams; /*< teams on contexts[1..num_contexts-1],
+                                         used to stripe large collectives,
+                                         NULL if team has single context */
+    ucc_team_params_t       ctx_teams_params; /*< user params the ctx_teams
+                                                are created with */
+    struct ucc_coll_group  *coll_group; /*< collective group opened by
+                                          ucc_collective_group_start */
 } ucc_team_t;
 
 /* If the bit is set then team_id is provided by the user */
@@ -7,32 +7,147 @@
 #include "components/base/ucc_base_iface.h"
 #include "coll_score/ucc_coll_score.h"
 #include "core/ucc_context.h"
+#include "utils/ucc_malloc.h"
+#include "utils/ucc_mpool.h"
+#include "utils/arch/cpu.h"
+#include <pthread.h>
 
-ucc_status_t ucc_event_manager_init(ucc_event_manager_t *em)
+/* Pool of listener blocks shared by all event managers. Created on first
+   use, released when the last ucc lib is finalized */
+static ucc_mpool_t     ucc_em_block_mp;
+static volatile int    ucc_em_block_mp_ready = 0;
+static int             ucc_em_block_mp_refs  = 0;
+static pthread_mutex_t ucc_em_block_mp_lock  = PTHREAD_MUTEX_INITIALIZER;
+
+/* Tasks that became ready while another ready task is being posted by
+   the same thread, see ucc_task_post_ready */
+typedef struct ucc_task_ready_queue {
+    ucc_coll_task_t *head;
+    ucc_coll_task_t *tail;
+    int              active;
+} ucc_task_ready_queue_t;
+
+static __thread ucc_task_ready_queue_t ucc_task_ready_q;
+
+static ucc_status_t ucc_em_block_mp_init(void)
+{
+    ucc_status_t status = UCC_OK;
+
+    pthread_mutex_lock(&ucc_em_block_mp_lock);
+    if (!ucc_em_block_mp_ready) {
+        status = ucc_mpool_init(&ucc_em_block_mp, 0,
+                                sizeof(ucc_em_listener_block_t), 0,
+                                UCC_CACHE_LINE_SIZE, 64, UINT_MAX, NULL,
+                                UCC_THREAD_MULTIPLE, "em_listener_blocks");
+        if (UCC_OK == status) {
+            ucc_memory_cpu_store_fence();
+            ucc_em_block_mp_ready = 1;
+        }
+    }
+    pthread_mutex_unlock(&ucc_em_block_mp_lock);
+    return status;
+}
+
+void ucc_event_manager_global_init(void)
+{
+    pthread_mutex_lock(&ucc_em_block_mp_lock);
+    ucc_em_block_mp_refs++;
+    pthread_mutex_unlock(&ucc_em_block_mp_lock);
+}
+
+void ucc_event_manager_global_cleanup(void)
 {
-    int i;
-    for (i = 0; i < MAX_LISTENERS; i++) {
-        em->listeners[i].task = NULL;
+    pthread_mutex_lock(&ucc_em_block_mp_lock);
+    ucc_assert(ucc_em_block_mp_refs > 0);
+    if (--ucc_em_block_mp_refs == 0 && ucc_em_block_mp_ready) {
+        ucc_mpool_cleanup(&ucc_em_block_mp, 1);
+        ucc_em_block_mp_ready = 0;
     }
+    pthread_mutex_unlock(&ucc_em_block_mp_lock);
+}
+
+ucc_status_t ucc_event_manager_init(ucc_event_manager_t *em)
+{
+    em->n_listeners = 0;
+    em->blocks      = NULL;
     return UCC_OK;
 }
 
-void ucc_event_manager_subscribe(ucc_event_manager_t *em, ucc_event_t event,
-                                 ucc_coll_task_t *task,
-                                 ucc_task_event_handler_p handler)
+void ucc_event_manager_cleanup(ucc_event_manager_t *em)
 {
-    int i;
-    for (i = 0; i < MAX_LISTENERS; i++) {
-        if (!em->listeners[i].task) {
-            em->listeners[i].task    = task;
-            em->listeners[i].event   = event;
-            em->listeners[i].handler = handler;
-            break;
+    ucc_em_listener_block_t *block;
+
+    while (em->blocks) {
+        block      = em->blocks;
+        em->blocks = block->next;
+        ucc_mpool_put(block);
+    }
+    em->n_listeners = 0;
+}
+
+ucc_status_t ucc_event_manager_subscribe(ucc_event_manager_t *em,
+                                         ucc_event_t event,
+                                         ucc_coll_task_t *task,
+                                         ucc_task_event_handler_p handler)
+{
+    ucc_em_listener_block_t **block = &em->blocks;
+    ucc_em_listener_t        *l;
+    uint32_t                  idx;
+    ucc_status_t              status;
+
+    if (em->n_listeners < UCC_EM_N_INLINE_LISTENERS) {
+        l = &em->listeners[em->n_listeners];
+    } else {
+        idx = em->n_listeners - UCC_EM_N_INLINE_LISTENERS;
+        while (idx >= UCC_EM_BLOCK_N_LISTENERS) {
+            block = &(*block)->next;
+            idx  -= UCC_EM_BLOCK_N_LISTENERS;
+        }
+        if (!(*block)) {
+            if (ucc_unlikely(!ucc_em_block_mp_ready)) {
+                status = ucc_em_block_mp_init();
+                if (UCC_OK != status) {
+                    ucc_error("failed to init event manager listener pool");
+                    return status;
+                }
+            }
+            *block = ucc_mpool_get(&ucc_em_block_mp);
+            if (ucc_unlikely(!(*block))) {
+                ucc_error("failed to get event manager listener block");
+                return UCC_ERR_NO_MEMORY;
+            }
+            (*block)->next = NULL;
         }
+        l = &(*block)->listeners[idx];
     }
-    ucc_assert(i < MAX_LISTENERS);
+    l->task    = task;
+    l->event   = event;
+    l->handler = handler;
+    em->n_listeners++;
+    return UCC_OK;
 }
 
+/* Executes _body for each listener of _em in subscription order */
+#define UCC_EM_FOR_EACH_LISTENER(_em, _l, _body)                               \
+    do {                                                                       \
+        ucc_em_listener_block_t *_block = (_em)->blocks;                       \
+        uint32_t                 _n     = (_em)->n_listeners;                  \
+        uint32_t                 _i;                                           \
+                                                                               \
+        for (_i = 0; _i < ucc_min(_n, UCC_EM_N_INLINE_LISTENERS); _i++) {      \
+            _l = &(_em)->listeners[_i];                                        \
+            _body;                                                             \
+        }                                                                      \
+        _n -= _i;                                                              \
+        for (; _block; _block = _block->next) {                                \
+            for (_i = 0; _i < ucc_min(_n, UCC_EM_BLOCK_N_LISTENERS); _i++) {   \
+                _l = &_block->listeners[_i];                                   \
+                _body;                                                         \
+            }                                                                  \
+            _n -= _i;                                                          \
+        }                                                                      \
+    } while (0)
+
 ucc_status_t ucc_coll_task_init(ucc_coll_task_t *task,
                                 ucc_base_coll_args_t *bargs,
                                 ucc_base_team_t *team)
@@ -42,6 +157,7 @@ ucc_status_t ucc_coll_task_init(ucc_coll_task_t *task,
     task->team                 = team;
     task->n_deps               = 0;
     task->n_deps_satisfied     = 0;
+    task->ready_next           = NULL;
     task->bargs.args.mask      = 0;
     task->schedule             = NULL;
     task->executor             = NULL;
@@ -76,19 +192,16 @@ static ucc_status_t
 ucc_task_error_handler(ucc_coll_task_t *parent_task,
                        ucc_coll_task_t *task)
 {
-    ucc_event_manager_t *em = &parent_task->em;
-    ucc_coll_task_t     *listener;
-    int                 i;
+    ucc_event_manager_t *em = &task->em;
+    ucc_em_listener_t   *l;
 
     task->super.status = parent_task->super.status;
-    for (i = 0; i < MAX_LISTENERS; i++) {
-        listener = em->listeners[i].task;
-        if (listener &&
-            listener->super.status != parent_task->super.status) {
+    UCC_EM_FOR_EACH_LISTENER(em, l, {
+        if (l->task->super.status != parent_task->super.status) {
             /* status has not been propagated yet */
-            ucc_task_error_handler(task, listener);
+            ucc_task_error_handler(task, l->task);
         }
-    }
+    });
     return UCC_OK;
 }
 
@@ -96,25 +209,21 @@ ucc_status_t ucc_event_manager_notify(ucc_coll_task_t *parent_task,
                                       ucc_event_t event)
 {
     ucc_event_manager_t *em = &parent_task->em;
-    ucc_coll_task_t     *task;
-    ucc_status_t        status;
-    int                 i;
-
-    for (i = 0; i < MAX_LISTENERS; i++) {
-        task = em->listeners[i].task;
-        if (task) {
-            if (ucc_unlikely(event == UCC_EVENT_ERROR)) {
-                ucc_task_error_handler(parent_task, task);
-                continue;
-            }
-            if (em->listeners[i].event == event) {
-                status = em->listeners[i].handler(parent_task, task);
-                if (ucc_unlikely(status != UCC_OK)) {
-                    return status;
-                }
+    ucc_em_listener_t   *l;
+    ucc_status_t         status;
+
+    UCC_EM_FOR_EACH_LISTENER(em, l, {
+        if (ucc_unlikely(event == UCC_EVENT_ERROR)) {
+            ucc_task_error_handler(parent_task, l->task);
+            continue;
+        }
+        if (l->event == event) {
+            status = l->handler(parent_task, l->task);
+            if (ucc_unlikely(status != UCC_OK)) {
+                return status;
             }
         }
-    }
+    });
     return UCC_OK;
 }
 
@@ -140,22 +249,63 @@ ucc_status_t ucc_schedule_init(ucc_schedule_t *schedule,
 {
     ucc_status_t status;
 
-    status            = ucc_coll_task_init(&schedule->super, bargs, team);
-    schedule->ctx     = team->context->ucc_context;
-    schedule->n_tasks = 0;
+    status              = ucc_coll_task_init(&schedule->super, bargs, team);
+    schedule->ctx       = team->context->ucc_context;
+    schedule->n_tasks   = 0;
+    schedule->max_tasks = UCC_SCHEDULE_N_INLINE_TASKS;
+    schedule->tasks     = schedule->tasks_inline;
     return status;
 }
 
-void ucc_schedule_add_task(ucc_schedule_t *schedule, ucc_coll_task_t *task)
+static ucc_status_t ucc_schedule_grow(ucc_schedule_t *schedule)
+{
+    uint32_t          max_tasks = schedule->max_tasks * 2;
+    ucc_coll_task_t **tasks;
+
+    if (schedule->tasks == schedule->tasks_inline) {
+        tasks = ucc_malloc(max_tasks * sizeof(*tasks), "schedule_tasks");
+        if (tasks) {
+            memcpy(tasks, schedule->tasks_inline,
+                   schedule->n_tasks * sizeof(*tasks));
+        }
+    } else {
+        tasks = ucc_realloc(schedule->tasks, max_tasks * sizeof(*tasks),
+                            "schedule_tasks");
+    }
+    if (!tasks) {
+        ucc_error("failed to allocate %zd bytes for schedule tasks",
+                  max_tasks * sizeof(*tasks));
+        return UCC_ERR_NO_MEMORY;
+    }
+    schedule->tasks     = tasks;
+    schedule->max_tasks = max_tasks;
+    return UCC_OK;
+}
+
+ucc_status_t ucc_schedule_add_task(ucc_schedule_t *schedule,
+                                   ucc_coll_task_t *task)
 {
-    ucc_event_manager_subscribe(&task->em, UCC_EVENT_COMPLETED_SCHEDULE,
-                                &schedule->super,
-                                ucc_schedule_completed_handler);
+    ucc_status_t status;
+
+    if (schedule->n_tasks == schedule->max_tasks) {
+        status = ucc_schedule_grow(schedule);
+        if (ucc_unlikely(UCC_OK != status)) {
+            return status;
+        }
+    }
+    status = ucc_event_manager_subscribe(&task->em,
+                                         UCC_EVENT_COMPLETED_SCHEDULE,
+                                         &schedule->super,
+                                         ucc_schedule_completed_handler);
+    if (ucc_unlikely(UCC_OK != status)) {
+        return status;
+    }
     task->schedule                       = schedule;
     schedule->tasks[schedule->n_tasks++] = task;
     if (task->flags & UCC_COLL_TASK_FLAG_EXECUTOR) {
         schedule->super.flags |= UCC_COLL_TASK_FLAG_EXECUTOR;
     }
+    return UCC_OK;
 }
 
 ucc_status_t ucc_schedule_start(ucc_coll_task_t *task)
@@ -184,6 +334,7 @@ ucc_status_t ucc_schedule_finalize(ucc_coll_task_t *task)
     int             i;
 
     for (i = 0; i < schedule->n_tasks; i++) {
+        ucc_event_manager_cleanup(&schedule->tasks[i]->em);
         if (schedule->tasks[i]->finalize) {
             status = schedule->tasks[i]->finalize(schedule->tasks[i]);
             if (UCC_OK != status) {
@@ -191,5 +342,61 @@ ucc_status_t ucc_schedule_finalize(ucc_coll_task_t *task)
             }
         }
     }
+    if (schedule->tasks != schedule->tasks_inline) {
+        ucc_free(schedule->tasks);
+        schedule->tasks     = schedule->tasks_inline;
+        schedule->max_tasks = UCC_SCHEDULE_N_INLINE_TASKS;
+    }
+    ucc_event_manager_cleanup(&schedule->super.em);
     return status_overall;
 }
+
+static inline ucc_status_t ucc_task_post_and_notify(ucc_coll_task_t *task)
+{
+    ucc_status_t status;
+
+    status = task->post(task);
+    if (status >= 0) {
+        ucc_event_manager_notify(task, UCC_EVENT_TASK_STARTED);
+    }
+    return status;
+}
+
+ucc_status_t ucc_task_post_ready(ucc_coll_task_t *task)
+{
+    ucc_task_ready_queue_t *q = &ucc_task_ready_q;
+    ucc_status_t            status, st;
+
+    if (q->active) {
+        task->ready_next = NULL;
+        if (q->tail) {
+            q->tail->ready_next = task;
+        } else {
+            q->head = task;
+        }
+        q->tail = task;
+        return UCC_OK;
+    }
+    q->active = 1;
+    status    = ucc_task_post_and_notify(task);
+    while (q->head) {
+        task    = q->head;
+        q->head = task->ready_next;
+        if (!q->head) {
+            q->tail = NULL;
+        }
+        st = ucc_task_post_and_notify(task);
+        if (ucc_unlikely(st < 0)) {
+            ucc_error("failed to post task %p, %s", task,
+                      ucc_status_string(st));
+            task->status       = st;
+            task->super.status = st;
+            ucc_event_manager_notify(task, UCC_EVENT_ERROR);
+            if (status >= 0) {
+                status = st;
+            }
+        }
+    }
+    q->active = 0;
+    return status;
+}
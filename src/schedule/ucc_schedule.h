@@ -14,7 +14,10 @@
 #include "components/base/ucc_base_iface.h"
 #include "components/ec/ucc_ec.h"
 
-#define MAX_LISTENERS 4
+/* Number of listeners stored inline in the event manager, the rest is
+   kept in blocks taken from the global listener pool */
+#define UCC_EM_N_INLINE_LISTENERS 4
+#define UCC_EM_BLOCK_N_LISTENERS  16
 
 typedef enum {
     UCC_EVENT_COMPLETED = 0,
@@ -54,8 +57,17 @@ typedef struct ucc_em_listener {
     ucc_event_t               event;
 } ucc_em_listener_t;
 
+typedef struct ucc_em_listener_block ucc_em_listener_block_t;
+
+typedef struct ucc_em_listener_block {
+    ucc_em_listener_block_t *next;
+    ucc_em_listener_t        listeners[UCC_EM_BLOCK_N_LISTENERS];
+} ucc_em_listener_block_t;
+
 typedef struct ucc_event_manager {
-    ucc_em_listener_t listeners[MAX_LISTENERS];
+    ucc_em_listener_t        listeners[UCC_EM_N_INLINE_LISTENERS];
+    uint32_t                 n_listeners;
+    ucc_em_listener_block_t *blocks;
 } ucc_event_manager_t;
 
 enum {
@@ -98,9 +110,11 @@ typedef struct ucc_coll_task {
         /* used for lf mt progress queue */
         ucc_lf_queue_elem_t          lf_elem;
     };
-    uint8_t  n_deps;
-    uint8_t  n_deps_satisfied;
-    uint8_t  n_deps_base;
+    /* next task in the per-thread queue of tasks ready to be posted */
+    ucc_coll_task_t                   *ready_next;
+    uint32_t n_deps;
+    uint32_t n_deps_satisfied;
+    uint32_t n_deps_base;
     double   start_time; /* timestamp of the start time:
                             either post or triggered_post */
     uint32_t seq_num;
@@ -108,18 +122,35 @@ typedef struct ucc_coll_task {
 
 typedef struct ucc_context ucc_context_t;
 
-#define UCC_SCHEDULE_MAX_TASKS 8
+/* Number of task pointers stored inline in the schedule. Schedules with
+   more tasks grow the tasks array on the heap, it is released in
+   ucc_schedule_finalize */
+#define UCC_SCHEDULE_N_INLINE_TASKS 8
 
 typedef struct ucc_schedule {
-    ucc_coll_task_t  super;
-    uint32_t         n_completed_tasks;
-    uint32_t         n_tasks;
-    ucc_context_t   *ctx;
-    ucc_coll_task_t *tasks[UCC_SCHEDULE_MAX_TASKS];
+    ucc_coll_task_t   super;
+    uint32_t          n_completed_tasks;
+    uint32_t          n_tasks;
+    uint32_t          max_tasks;
+    ucc_context_t    *ctx;
+    ucc_coll_task_t **tasks;
+    ucc_coll_task_t  *tasks_inline[UCC_SCHEDULE_N_INLINE_TASKS];
 } ucc_schedule_t;
 
 ucc_status_t ucc_event_manager_init(ucc_event_manager_t *em);
 
+/* Reference the global pool of listener blocks, called on ucc_init. Pool
+   is destroyed when the last reference is dropped by ucc_finalize */
+void ucc_event_manager_global_init(void);
+
+void ucc_event_manager_global_cleanup(void);
+
+/* Returns listener blocks to the global pool. Called by
+   ucc_schedule_finalize for the schedule and all its tasks, a task used
+   outside of schedule with more than UCC_EM_N_INLINE_LISTENERS listeners
+   must call it before release */
+void ucc_event_manager_cleanup(ucc_event_manager_t *em);
+
 ucc_status_t ucc_coll_task_init(ucc_coll_task_t *task,
                                 ucc_base_coll_args_t *args,
                                 ucc_base_team_t *team);
@@ -127,9 +158,10 @@ ucc_status_t ucc_coll_task_init(ucc_coll_task_t *task,
 ucc_status_t ucc_coll_task_get_executor(ucc_coll_task_t *task,
                                         ucc_ee_executor_t **exec);
 
-void ucc_event_manager_subscribe(ucc_event_manager_t *em, ucc_event_t event,
-                                 ucc_coll_task_t *task,
-                                 ucc_task_event_handler_p handler);
+ucc_status_t ucc_event_manager_subscribe(ucc_event_manager_t *em,
+                                         ucc_event_t event,
+                                         ucc_coll_task_t *task,
+                                         ucc_task_event_handler_p handler);
 
 ucc_status_t ucc_event_manager_notify(ucc_coll_task_t *parent_task,
                                       ucc_event_t event);
@@ -138,7 +170,8 @@ ucc_status_t ucc_schedule_init(ucc_schedule_t *schedule,
                                ucc_base_coll_args_t *bargs,
                                ucc_base_team_t *team);
 
-void ucc_schedule_add_task(ucc_schedule_t *schedule, ucc_coll_task_t *task);
+ucc_status_t ucc_schedule_add_task(ucc_schedule_t *schedule,
+                                   ucc_coll_task_t *task);
 
 ucc_status_t ucc_schedule_start(ucc_coll_task_t *task);
 
@@ -149,6 +182,12 @@ ucc_status_t ucc_schedule_finalize(ucc_coll_task_t *task);
 ucc_status_t ucc_dependency_handler(ucc_coll_task_t *parent, /* NOLINT */
                                     ucc_coll_task_t *task);
 
+/* Posts the task whose dependencies are satisfied. Tasks that become ready
+   while another one is being posted on the same thread (e.g. chain of tasks
+   completing inside post) are queued and posted by the outermost call, so
+   the depth of the schedule does not grow the stack. */
+ucc_status_t ucc_task_post_ready(ucc_coll_task_t *task);
+
 ucc_status_t ucc_triggered_post(ucc_ee_h ee, ucc_ev_t *ev,
                                 ucc_coll_task_t *task);
 
@@ -205,13 +244,18 @@ static inline ucc_status_t ucc_task_complete(ucc_coll_task_t *task)
     return status;
 }
 
-static inline void ucc_task_subscribe_dep(ucc_coll_task_t *target,
-                                          ucc_coll_task_t *subscriber,
-                                          ucc_event_t      event)
+static inline ucc_status_t ucc_task_subscribe_dep(ucc_coll_task_t *target,
+                                                  ucc_coll_task_t *subscriber,
+                                                  ucc_event_t      event)
 {
-    ucc_event_manager_subscribe(&target->em, event, subscriber,
-                                ucc_dependency_handler);
-    subscriber->n_deps++;
+    ucc_status_t status;
+
+    status = ucc_event_manager_subscribe(&target->em, event, subscriber,
+                                         ucc_dependency_handler);
+    if (ucc_likely(UCC_OK == status)) {
+        subscriber->n_deps++;
+    }
+    return status;
 }
 
 #define UCC_TASK_LIB(_task) (((ucc_coll_task_t *)_task)->team->context->lib)
@@ -6,6 +6,8 @@
 #include "ucc_schedule_pipelined.h"
 #include "coll_score/ucc_coll_score.h"
 #include "core/ucc_context.h"
+#include "utils/ucc_malloc.h"
+#include "core/ucc_dt.h"
 
 static ucc_status_t ucc_frag_start_handler(ucc_coll_task_t *parent,
                                            ucc_coll_task_t *task)
@@ -32,7 +34,10 @@ static ucc_status_t ucc_frag_start_handler(ucc_coll_task_t *parent,
                   schedule->next_frag_to_post);
     schedule->n_frags_started++;
     schedule->n_frags_in_pipeline++;
-    return task->post(task);
+    /* frag restarted from completion of another frag is posted by the
+       outermost ready task post to keep the stack bounded for deep
+       pipelines */
+    return ucc_task_post_ready(task);
 }
 
 static ucc_status_t
@@ -100,6 +105,11 @@ ucc_status_t ucc_schedule_pipelined_finalize(ucc_coll_task_t *task)
     for (i = 0; i < schedule_p->n_frags; i++) {
         schedule_p->frags[i]->super.finalize(&frags[i]->super);
     }
+    if (frags != schedule_p->frags_inline) {
+        ucc_free(frags);
+        schedule_p->frags = schedule_p->frags_inline;
+    }
+    ucc_event_manager_cleanup(&schedule_p->super.super.em);
     ucc_recursive_spinlock_destroy(&schedule_p->lock);
     return UCC_OK;
 }
@@ -143,9 +153,8 @@ ucc_status_t ucc_schedule_pipelined_init(
     ucc_status_t     status;
     ucc_schedule_t **frags;
 
-    if (ucc_unlikely(n_frags > UCC_SCHEDULE_PIPELINED_MAX_FRAGS)) {
-        ucc_error("n_frags %d exceeds max limit of %d",
-                  n_frags, UCC_SCHEDULE_PIPELINED_MAX_FRAGS);
+    if (ucc_unlikely(n_frags < 1)) {
+        ucc_error("invalid pipeline depth %d", n_frags);
         return UCC_ERR_INVALID_PARAM;
     }
 
@@ -155,6 +164,18 @@ ucc_status_t ucc_schedule_pipelined_init(
         return status;
     }
 
+    schedule->frags = schedule->frags_inline;
+    if (n_frags > UCC_SCHEDULE_PIPELINED_N_INLINE_FRAGS) {
+        schedule->frags = ucc_malloc(n_frags * sizeof(*schedule->frags),
+                                     "pipelined_frags");
+        if (ucc_unlikely(!schedule->frags)) {
+            ucc_error("failed to allocate %zd bytes for pipelined frags",
+                      n_frags * sizeof(*schedule->frags));
+            schedule->frags = schedule->frags_inline;
+            return UCC_ERR_NO_MEMORY;
+        }
+    }
+
     ucc_recursive_spinlock_init(&schedule->lock, 0);
 
     schedule->super.n_tasks        = n_frags_total;
@@ -163,6 +184,7 @@ ucc_status_t ucc_schedule_pipelined_init(
     schedule->frag_setup           = frag_setup;
     schedule->next_frag_to_post    = 0;
     schedule->n_frags_in_pipeline  = 0;
+    schedule->cache                = NULL;
     schedule->super.super.finalize = ucc_schedule_pipelined_finalize;
     schedule->super.super.post     = ucc_schedule_pipelined_post;
     frags                          = schedule->frags;
@@ -183,44 +205,228 @@ ucc_status_t ucc_schedule_pipelined_init(
         for (j = 0; j < frags[i]->n_tasks; j++) {
             frags[i]->tasks[j]->n_deps_base = frags[i]->tasks[j]->n_deps;
             if (n_frags > 1 && sequential) {
-                ucc_event_manager_subscribe(
+                status = ucc_event_manager_subscribe(
                     &frags[(i > 0) ? (i - 1) : (n_frags - 1)]->tasks[j]->em,
                     UCC_EVENT_TASK_STARTED, frags[i]->tasks[j],
                     ucc_dependency_handler);
+                if (ucc_unlikely(UCC_OK != status)) {
+                    goto err_subscribe;
+                }
                 frags[i]->tasks[j]->n_deps_base++;
             }
         }
-        ucc_event_manager_subscribe(&schedule->super.super.em,
-                                    UCC_EVENT_SCHEDULE_STARTED,
-                                    &frags[i]->super, ucc_frag_start_handler);
-        ucc_event_manager_subscribe(
+        status = ucc_event_manager_subscribe(&schedule->super.super.em,
+                                             UCC_EVENT_SCHEDULE_STARTED,
+                                             &frags[i]->super,
+                                             ucc_frag_start_handler);
+        if (ucc_unlikely(UCC_OK != status)) {
+            goto err_subscribe;
+        }
+        status = ucc_event_manager_subscribe(
             &frags[i]->super.em, UCC_EVENT_COMPLETED_SCHEDULE,
             &schedule->super.super,
             ucc_schedule_pipelined_completed_handler);
+        if (ucc_unlikely(UCC_OK != status)) {
+            goto err_subscribe;
+        }
     }
     return UCC_OK;
+err_subscribe:
+    i = n_frags;
 err:
     for (i = i - 1; i >= 0; i--) {
         frags[i]->super.finalize(&frags[i]->super);
     }
+    ucc_event_manager_cleanup(&schedule->super.super.em);
+    if (frags != schedule->frags_inline) {
+        ucc_free(frags);
+        schedule->frags = schedule->frags_inline;
+    }
     return status;
 }
 
+ucc_status_t ucc_schedule_cache_init(ucc_schedule_cache_t *cache,
+                                     uint32_t              max_entries)
+{
+    cache->max_entries = max_entries;
+    cache->n_entries   = 0;
+    cache->entries     = NULL;
+    if (max_entries > 0) {
+        cache->entries = ucc_malloc(max_entries * sizeof(*cache->entries),
+                                    "schedule_cache");
+        if (!cache->entries) {
+            ucc_error("failed to allocate %zd bytes for schedule cache",
+                      max_entries * sizeof(*cache->entries));
+            return UCC_ERR_NO_MEMORY;
+        }
+    }
+    ucc_spinlock_init(&cache->lock, 0);
+    return UCC_OK;
+}
+
+void ucc_schedule_cache_cleanup(ucc_schedule_cache_t *cache)
+{
+    ucc_schedule_pipelined_t *schedule_p;
+    uint32_t                  i;
+
+    for (i = 0; i < cache->n_entries; i++) {
+        schedule_p        = cache->entries[i].schedule;
+        schedule_p->cache = NULL;
+        schedule_p->cache_destroy(&schedule_p->super.super);
+    }
+    cache->n_entries = 0;
+    ucc_free(cache->entries);
+    ucc_spinlock_destroy(&cache->lock);
+}
+
+ucc_status_t ucc_schedule_cache_key_init(ucc_schedule_cache_key_t *key,
+                                         int                       alg_id,
+                                         ucc_base_coll_args_t     *coll_args)
+{
+    ucc_coll_args_t *args = &coll_args->args;
+
+    if (UCC_IS_PERSISTENT(*args) || UCC_COLL_ARGS_ACTIVE_SET(args) ||
+        !UCC_DT_IS_PREDEFINED(args->dst.info.datatype) ||
+        (!UCC_IS_INPLACE(*args) &&
+         !UCC_DT_IS_PREDEFINED(args->src.info.datatype))) {
+        return UCC_ERR_NOT_SUPPORTED;
+    }
+    /* zero padding, keys are compared with memcmp */
+    memset(key, 0, sizeof(*key));
+    key->alg_id       = alg_id;
+    key->coll_type    = args->coll_type;
+    key->flags        = (args->mask & UCC_COLL_ARGS_FIELD_FLAGS) ?
+                        args->flags : 0;
+    key->dst_count    = args->dst.info.count;
+    key->dst_dt       = args->dst.info.datatype;
+    key->dst_mem_type = args->dst.info.mem_type;
+    if (!UCC_IS_INPLACE(*args)) {
+        key->src_count    = args->src.info.count;
+        key->src_dt       = args->src.info.datatype;
+        key->src_mem_type = args->src.info.mem_type;
+    }
+    if (args->coll_type & (UCC_COLL_TYPE_ALLREDUCE | UCC_COLL_TYPE_REDUCE |
+                           UCC_COLL_TYPE_REDUCE_SCATTER)) {
+        key->op = args->op;
+    }
+    if (args->coll_type & (UCC_COLL_TYPE_BCAST | UCC_COLL_TYPE_REDUCE |
+                           UCC_COLL_TYPE_GATHER | UCC_COLL_TYPE_SCATTER |
+                           UCC_COLL_TYPE_FANIN | UCC_COLL_TYPE_FANOUT)) {
+        key->root = args->root;
+    }
+    return UCC_OK;
+}
+
+static void ucc_schedule_pipelined_reuse(ucc_schedule_pipelined_t *schedule_p,
+                                         ucc_base_coll_args_t *coll_args)
+{
+    ucc_coll_task_t *task = &schedule_p->super.super;
+    ucc_schedule_t  *frag;
+    int              i, j;
+
+    /* same as ucc_coll_task_init, but the listeners subscribed while
+       building the schedule are kept */
+    task->flags               &= UCC_COLL_TASK_FLAG_EXECUTOR;
+    task->ee                   = NULL;
+    task->executor             = NULL;
+    task->schedule             = NULL;
+    task->n_deps               = 0;
+    task->n_deps_satisfied     = 0;
+    task->triggered_post_setup = NULL;
+    task->super.status         = UCC_OPERATION_INITIALIZED;
+    task->em.n_listeners       = schedule_p->cache_n_listeners;
+    memcpy(&task->bargs, coll_args, sizeof(*coll_args));
+    ucc_lf_queue_init_elem(&task->lf_elem);
+    /* executor of the previous collective is cached in frags and tasks by
+       ucc_coll_task_get_executor */
+    for (i = 0; i < schedule_p->n_frags; i++) {
+        frag                 = schedule_p->frags[i];
+        frag->super.executor = NULL;
+        for (j = 0; j < frag->n_tasks; j++) {
+            frag->tasks[j]->executor = NULL;
+        }
+    }
+}
+
+ucc_schedule_pipelined_t *
+ucc_schedule_cache_get(ucc_schedule_cache_t *cache,
+                       ucc_schedule_cache_key_t *key,
+                       ucc_base_coll_args_t *coll_args)
+{
+    ucc_schedule_pipelined_t *schedule_p = NULL;
+    uint32_t                  i;
+
+    /* max_entries does not change after init, n_entries is updated by
+       cache_finalize of the schedules and is read under the lock only */
+    if (!cache->max_entries) {
+        return NULL;
+    }
+    ucc_spin_lock(&cache->lock);
+    for (i = 0; i < cache->n_entries; i++) {
+        if (!memcmp(&cache->entries[i].key, key, sizeof(*key))) {
+            schedule_p        = cache->entries[i].schedule;
+            cache->entries[i] = cache->entries[--cache->n_entries];
+            break;
+        }
+    }
+    ucc_spin_unlock(&cache->lock);
+    if (schedule_p) {
+        ucc_schedule_pipelined_reuse(schedule_p, coll_args);
+    }
+    return schedule_p;
+}
+
+static ucc_status_t ucc_schedule_pipelined_cache_finalize(ucc_coll_task_t *task)
+{
+    ucc_schedule_pipelined_t *schedule_p =
+        ucc_derived_of(task, ucc_schedule_pipelined_t);
+    ucc_schedule_cache_t     *cache      = schedule_p->cache;
+    int                       cached     = 0;
+
+    /* schedules completed with error are not reused, as well as the ones
+       whose listeners were released by the parent schedule finalize */
+    if ((task->super.status == UCC_OK ||
+         task->super.status == UCC_OPERATION_INITIALIZED) &&
+        task->em.n_listeners >= schedule_p->cache_n_listeners) {
+        ucc_spin_lock(&cache->lock);
+        if (cache->n_entries < cache->max_entries) {
+            cache->entries[cache->n_entries].key      = schedule_p->cache_key;
+            cache->entries[cache->n_entries].schedule = schedule_p;
+            cache->n_entries++;
+            cached = 1;
+        }
+        ucc_spin_unlock(&cache->lock);
+    }
+    if (cached) {
+        return UCC_OK;
+    }
+    return schedule_p->cache_destroy(task);
+}
+
+void ucc_schedule_pipelined_set_cache(ucc_schedule_pipelined_t *schedule_p,
+                                      ucc_schedule_cache_t     *cache,
+                                      ucc_schedule_cache_key_t *key)
+{
+    ucc_coll_task_t *task = &schedule_p->super.super;
+
+    schedule_p->cache             = cache;
+    schedule_p->cache_key         = *key;
+    schedule_p->cache_destroy     = task->finalize;
+    schedule_p->cache_n_listeners = task->em.n_listeners;
+    task->finalize                = ucc_schedule_pipelined_cache_finalize;
+}
+
 ucc_status_t ucc_dependency_handler(ucc_coll_task_t *parent,
                                     ucc_coll_task_t *task)
 {
-    ucc_status_t status;
+    uint32_t n_deps_satisfied;
 
-    task->n_deps_satisfied++;
-    ucc_trace_req("task %p, n_deps %d, satisfied %d", task, task->n_deps,
-                  task->n_deps_satisfied);
-    if (task->n_deps == task->n_deps_satisfied) {
+    n_deps_satisfied = ucc_atomic_fadd32(&task->n_deps_satisfied, 1) + 1;
+    ucc_trace_req("task %p, n_deps %u, satisfied %u", task, task->n_deps,
+                  n_deps_satisfied);
+    if (task->n_deps == n_deps_satisfied) {
         task->start_time = parent->start_time;
-        status = task->post(task);
-        if (status >= 0) {
-            ucc_event_manager_notify(task, UCC_EVENT_TASK_STARTED);
-        }
-        return status;
+        return ucc_task_post_ready(task);
     }
 
     return UCC_OK;
@@ -6,11 +6,11 @@
 #define UCC_SCHEDULE_PIPELINED_H_
 #include "components/base/ucc_base_iface.h"
 
-#define UCC_SCHEDULE_FRAG_MAX_TASKS 8
-
 typedef struct ucc_schedule_pipelined ucc_schedule_pipelined_t;
 
-#define UCC_SCHEDULE_PIPELINED_MAX_FRAGS 4
+/* Number of frag pointers stored inline, deeper pipelines allocate the
+   frags array on the heap */
+#define UCC_SCHEDULE_PIPELINED_N_INLINE_FRAGS 4
 
 /* frag_init is the callback provided by the user of pipelined
    framework (e.g., TL that needs to build a pipeline) that is reponsible
@@ -28,10 +28,31 @@ typedef ucc_status_t (*ucc_schedule_frag_init_fn_t)(
 typedef ucc_status_t (*ucc_schedule_frag_setup_fn_t)(
     ucc_schedule_pipelined_t *schedule_p, ucc_schedule_t *frag, int frag_num);
 
+typedef struct ucc_schedule_cache ucc_schedule_cache_t;
+
+/* Shape of a collective: pipelined schedules built by the same algorithm
+   for equal keys consist of the same frags and tasks and differ only by
+   buffers, which frag_setup rebinds on every launch of a frag */
+typedef struct ucc_schedule_cache_key {
+    int                alg_id;
+    ucc_coll_type_t    coll_type;
+    uint64_t           flags;
+    ucc_reduction_op_t op;
+    uint64_t           root;
+    size_t             src_count;
+    size_t             dst_count;
+    ucc_datatype_t     src_dt;
+    ucc_datatype_t     dst_dt;
+    ucc_memory_type_t  src_mem_type;
+    ucc_memory_type_t  dst_mem_type;
+} ucc_schedule_cache_key_t;
+
 typedef struct ucc_schedule_pipelined {
     ucc_schedule_t               super;
     /* Array of the frag schedules - 1 schedule per pipeline entry */
-    ucc_schedule_t *             frags[UCC_SCHEDULE_PIPELINED_MAX_FRAGS];
+    ucc_schedule_t **            frags;
+    ucc_schedule_t *
+        frags_inline[UCC_SCHEDULE_PIPELINED_N_INLINE_FRAGS];
     /* n_frags - is the depth of the pipeline, ie how many fragments can
        be outstanding at a time */
     int                          n_frags;
@@ -47,8 +68,31 @@ typedef struct ucc_schedule_pipelined {
     int                          next_frag_to_post;
     ucc_schedule_frag_setup_fn_t frag_setup;
     ucc_recursive_spinlock_t     lock;
+    /* cache the schedule is returned to on finalize, NULL if not cached */
+    ucc_schedule_cache_t *       cache;
+    ucc_schedule_cache_key_t     cache_key;
+    /* original finalize, releases the schedule when it is not cached */
+    ucc_coll_finalize_fn_t       cache_destroy;
+    /* number of listeners of the schedule itself, listeners added by
+       the user of the previous collective are dropped on reuse */
+    uint32_t                     cache_n_listeners;
 } ucc_schedule_pipelined_t;
 
+typedef struct ucc_schedule_cache_entry {
+    ucc_schedule_cache_key_t  key;
+    ucc_schedule_pipelined_t *schedule;
+} ucc_schedule_cache_entry_t;
+
+/* Bounded set of built pipelined schedules which are not in use. A schedule
+   is taken out of the cache by ucc_schedule_cache_get and returned on
+   finalize, so every cached schedule is used by one collective at a time */
+typedef struct ucc_schedule_cache {
+    ucc_schedule_cache_entry_t *entries;
+    uint32_t                    max_entries;
+    uint32_t                    n_entries;
+    ucc_spinlock_t              lock;
+} ucc_schedule_cache_t;
+
 /* Creates a pipelined schedule for the algorithm defined by "frag_init".
 
    frag_init, frag_setup - client callbacks used to init the pipeline.
@@ -64,4 +108,35 @@ ucc_status_t ucc_schedule_pipelined_init(
 ucc_status_t ucc_schedule_pipelined_post(ucc_coll_task_t *task);
 
 ucc_status_t ucc_schedule_pipelined_finalize(ucc_coll_task_t *task);
+
+/* max_entries == 0 disables caching */
+ucc_status_t ucc_schedule_cache_init(ucc_schedule_cache_t *cache,
+                                     uint32_t              max_entries);
+
+/* Releases all cached schedules */
+void ucc_schedule_cache_cleanup(ucc_schedule_cache_t *cache);
+
+/* Fills the key from collective args with single src/dst buffer info.
+   Returns UCC_ERR_NOT_SUPPORTED if the collective can not be cached:
+   persistent (reused by the user anyway), active set or user defined
+   datatype. */
+ucc_status_t ucc_schedule_cache_key_init(ucc_schedule_cache_key_t *key,
+                                         int                       alg_id,
+                                         ucc_base_coll_args_t     *coll_args);
+
+/* Takes the schedule matching the key out of the cache and re-arms it for
+   coll_args: the state of the top level task is reset, buffers of the frags
+   are rebound by frag_setup on post. Returns NULL on miss. */
+ucc_schedule_pipelined_t *
+ucc_schedule_cache_get(ucc_schedule_cache_t *cache,
+                       ucc_schedule_cache_key_t *key,
+                       ucc_base_coll_args_t *coll_args);
+
+/* Makes the fully initialized pipelined schedule cacheable: its finalize
+   returns it to the cache and the original finalize is only called when
+   the cache is full or cleaned up. Must be called after the schedule
+   post/finalize are set. */
+void ucc_schedule_pipelined_set_cache(ucc_schedule_pipelined_t *schedule_p,
+                                      ucc_schedule_cache_t     *cache,
+                                      ucc_schedule_cache_key_t *key);
 #endif
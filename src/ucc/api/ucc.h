@@ -1109,6 +1109,36 @@ ucc_status_t ucc_context_create(ucc_lib_h lib_handle,
 
 ucc_status_t ucc_context_progress(ucc_context_h context);
 
+/**
+ *  @ingroup UCC_CONTEXT
+ *
+ *  @brief The @ref ucc_context_wait routine progresses the context until
+ *  the collective operation is completed.
+ *
+ *  @param [in]  context  Communication context handle to be progressed
+ *  @param [in]  request  Request handle of the collective posted on a team
+ *                        created on the @e context
+ *
+ *  @parblock
+ *
+ *  @b Description
+ *
+ *  The @ref ucc_context_wait routine is a blocking counterpart of
+ *  @ref ucc_context_progress followed by @ref ucc_collective_test.
+ *  It polls the context for the time defined by UCC_WAIT_SPIN_TIME and if the
+ *  collective is still not completed it puts the calling thread to sleep
+ *  until network activity is detected on the context or UCC_WAIT_SLEEP_TIME
+ *  expires, then the cycle repeats. With default configuration the routine
+ *  never sleeps.
+ *
+ *  @endparblock
+ *
+ *  @return Error code as defined by @ref ucc_status_t: the status of the
+ *  completed collective or the error that occurred during progress.
+ */
+
+ucc_status_t ucc_context_wait(ucc_context_h context, ucc_coll_req_h request);
+
 /**
  *  @ingroup UCC_CONTEXT
  *
@@ -1941,6 +1971,59 @@ static inline ucc_status_t ucc_collective_test(ucc_coll_req_h request)
  */
 ucc_status_t ucc_collective_finalize(ucc_coll_req_h request);
 
+/**
+ *  @ingroup UCC_COLLECTIVES
+ *
+ *  @brief The routine to start a group of collective operations.
+ *
+ *  @param [in] team - Team handle
+ *
+ *  @parblock
+ *
+ *  @b Description
+ *
+ *  @ref ucc_collective_group_start opens a collective group on the team.
+ *  Compatible collectives initialized with @ref ucc_collective_init until the
+ *  group is closed by @ref ucc_collective_group_end become members of the
+ *  group and may be fused by the library into a smaller number of
+ *  operations. Currently non-persistent allreduce operations with predefined
+ *  datatypes are fused if they share reduction operation, datatype and memory
+ *  type, other collectives are initialized as usual. Groups can not be
+ *  nested.
+ *
+ *  @endparblock
+ *
+ *  @return Error code as defined by @ref ucc_status_t
+ */
+ucc_status_t ucc_collective_group_start(ucc_team_h team);
+
+/**
+ *  @ingroup UCC_COLLECTIVES
+ *
+ *  @brief The routine to end a group of collective operations.
+ *
+ *  @param [in] team - Team handle
+ *
+ *  @parblock
+ *
+ *  @b Description
+ *
+ *  @ref ucc_collective_group_end closes the collective group opened by
+ *  @ref ucc_collective_group_start and creates the fused operations for its
+ *  members. It must be called by all the team members with the same sequence
+ *  of grouped collectives. Requests of the group members are used as usual:
+ *  each of them must be posted with @ref ucc_collective_post after the group
+ *  is closed, its status is reported by @ref ucc_collective_test and it is
+ *  released with @ref ucc_collective_finalize. A fused operation starts when
+ *  all of its members are posted, so the user must post all the members of
+ *  a group before waiting for completion of any of them.
+ *
+ *  @endparblock
+ *
+ *  @return Error code as defined by @ref ucc_status_t
+ */
+ucc_status_t ucc_collective_group_end(ucc_team_h team);
+
 /**
  * @ingroup UCC_EVENT_DT
  *
@@ -134,6 +134,9 @@ ucc_memory_type_t ucc_coll_args_mem_type(const ucc_coll_args_t *args,
     return UCC_MEMORY_TYPE_UNKNOWN;
 }
 
+#define UCC_COLL_INFO_PACKED_SIZE(_info)                                       \
+    ucc_dt_packed_size((_info).datatype, (_info).buffer, (_info).count)
+
 size_t ucc_coll_args_msgsize(const ucc_coll_args_t *args,
                              ucc_rank_t rank, ucc_rank_t size)
 {
@@ -145,12 +148,12 @@ size_t ucc_coll_args_msgsize(const ucc_coll_args_t *args,
     case UCC_COLL_TYPE_FANOUT:
         return 0;
     case UCC_COLL_TYPE_BCAST:
-        return args->src.info.count * ucc_dt_size(args->src.info.datatype);
+        return UCC_COLL_INFO_PACKED_SIZE(args->src.info);
     case UCC_COLL_TYPE_ALLREDUCE:
     case UCC_COLL_TYPE_ALLTOALL:
     case UCC_COLL_TYPE_ALLGATHER:
     case UCC_COLL_TYPE_REDUCE_SCATTER:
-        return args->dst.info.count * ucc_dt_size(args->dst.info.datatype);
+        return UCC_COLL_INFO_PACKED_SIZE(args->dst.info);
     case UCC_COLL_TYPE_ALLGATHERV:
     case UCC_COLL_TYPE_REDUCE_SCATTERV:
         return ucc_coll_args_get_total_count(args, args->dst.info_v.counts,
@@ -165,20 +168,16 @@ size_t ucc_coll_args_msgsize(const ucc_coll_args_t *args,
         */
         return UCC_MSG_SIZE_ASSYMETRIC;
     case UCC_COLL_TYPE_REDUCE:
-        return (root == rank)
-                   ? args->dst.info.count * ucc_dt_size(args->dst.info.datatype)
-                   : args->src.info.count *
-                         ucc_dt_size(args->src.info.datatype);
+        return (root == rank) ? UCC_COLL_INFO_PACKED_SIZE(args->dst.info)
+                              : UCC_COLL_INFO_PACKED_SIZE(args->src.info);
     case UCC_COLL_TYPE_GATHER:
-        return (root == rank)
-                 ? args->dst.info.count * ucc_dt_size(args->dst.info.datatype)
-                 : args->src.info.count * ucc_dt_size(args->src.info.datatype) *
-                   size;
+        return (root == rank) ? UCC_COLL_INFO_PACKED_SIZE(args->dst.info)
+                              : UCC_COLL_INFO_PACKED_SIZE(args->src.info) *
+                                    size;
     case UCC_COLL_TYPE_SCATTER:
-        return (root == rank)
-                 ? args->src.info.count * ucc_dt_size(args->src.info.datatype)
-                 : args->dst.info.count * ucc_dt_size(args->dst.info.datatype) *
-                   size;
+        return (root == rank) ? UCC_COLL_INFO_PACKED_SIZE(args->src.info)
+                              : UCC_COLL_INFO_PACKED_SIZE(args->dst.info) *
+                                    size;
     default:
         break;
     }
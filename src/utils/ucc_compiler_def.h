@@ -60,6 +60,14 @@ typedef int                        ucc_score_t;
         }                                                                      \
     } while (0)
 
+#define UCC_CHECK_GOTO(_cmd, _label, _status)                                  \
+    do {                                                                       \
+        _status = (_cmd);                                                      \
+        if (ucc_unlikely(_status != UCC_OK)) {                                 \
+            goto _label;                                                       \
+        }                                                                      \
+    } while (0)
+
 static inline ucc_status_t ucs_status_to_ucc_status(ucs_status_t status)
 {
     switch (status) {
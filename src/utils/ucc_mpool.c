@@ -1,6 +1,116 @@
 #include "ucc_mpool.h"
 #include "ucc_malloc.h"
 #include "ucc_log.h"
+#include "ucc_math.h"
+#include <pthread.h>
+#include <limits.h>
+
+__thread int ucc_mpool_thread_slot = 0;
+
+/* Thread slots are assigned on the first magazine access of a thread and
+   returned on thread exit, so that the magazines (and objects cached in
+   them) of exited threads are reused by new ones */
+static pthread_once_t  ucc_mpool_slot_once  = PTHREAD_ONCE_INIT;
+static pthread_key_t   ucc_mpool_slot_key;
+static pthread_mutex_t ucc_mpool_slot_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t        ucc_mpool_slots_used;
+static int             ucc_mpool_slot_key_ok;
+
+static void ucc_mpool_thread_slot_release(void *arg)
+{
+    int slot = (int)(uintptr_t)arg;
+
+    pthread_mutex_lock(&ucc_mpool_slot_mutex);
+    ucc_mpool_slots_used &= ~UCC_BIT(slot - 1);
+    pthread_mutex_unlock(&ucc_mpool_slot_mutex);
+    ucc_mpool_thread_slot = -1;
+}
+
+static void ucc_mpool_slot_key_init(void)
+{
+    ucc_mpool_slot_key_ok = (0 == pthread_key_create(
+                                      &ucc_mpool_slot_key,
+                                      ucc_mpool_thread_slot_release));
+}
+
+int ucc_mpool_thread_slot_init(void)
+{
+    int slot = -1;
+    int i;
+
+    pthread_once(&ucc_mpool_slot_once, ucc_mpool_slot_key_init);
+    if (ucc_mpool_slot_key_ok) {
+        pthread_mutex_lock(&ucc_mpool_slot_mutex);
+        for (i = 0; i < UCC_MPOOL_MAX_THREADS; i++) {
+            if (!(ucc_mpool_slots_used & UCC_BIT(i))) {
+                ucc_mpool_slots_used |= UCC_BIT(i);
+                slot = i + 1;
+                break;
+            }
+        }
+        pthread_mutex_unlock(&ucc_mpool_slot_mutex);
+    }
+    if (slot > 0 &&
+        0 != pthread_setspecific(ucc_mpool_slot_key, (void *)(uintptr_t)slot)) {
+        ucc_mpool_thread_slot_release((void *)(uintptr_t)slot);
+        slot = -1;
+    }
+    ucc_mpool_thread_slot = slot;
+    return slot;
+}
+
+void *ucc_mpool_get_slow(ucc_mpool_t *mp, ucc_mpool_magazine_t *mag)
+{
+    void    *obj;
+    unsigned n;
+
+    if (!mag && ucc_mpool_thread_slot > 0) {
+        mag = ucc_calloc(1, sizeof(*mag), "mpool_magazine");
+        mp->magazines[ucc_mpool_thread_slot - 1] = mag;
+    }
+    ucc_spin_lock(&mp->lock);
+    obj = ucs_mpool_get(&mp->super);
+    if (obj && mag) {
+        /* refill half of the magazine, keep space for puts */
+        for (n = 0; n < mp->magazine_size / 2; n++) {
+            mag->objs[n] = ucs_mpool_get(&mp->super);
+            if (!mag->objs[n]) {
+                break;
+            }
+        }
+        mag->count = n;
+    }
+    ucc_spin_unlock(&mp->lock);
+    return obj;
+}
+
+void ucc_mpool_put_slow(ucc_mpool_t *mp, ucc_mpool_magazine_t *mag,
+                        void *obj)
+{
+    unsigned half = mp->magazine_size / 2;
+    unsigned i;
+
+    if (!mag && ucc_mpool_thread_slot > 0) {
+        mag = ucc_calloc(1, sizeof(*mag), "mpool_magazine");
+        mp->magazines[ucc_mpool_thread_slot - 1] = mag;
+        if (mag) {
+            mag->objs[mag->count++] = obj;
+            return;
+        }
+    }
+    ucc_spin_lock(&mp->lock);
+    ucs_mpool_put(obj);
+    if (mag) {
+        /* flush the older half of the full magazine */
+        for (i = 0; i < half; i++) {
+            ucs_mpool_put(mag->objs[i]);
+        }
+        memmove(mag->objs, &mag->objs[half],
+                (mag->count - half) * sizeof(void *));
+        mag->count -= half;
+    }
+    ucc_spin_unlock(&mp->lock);
+}
 
 static ucc_mpool_ops_t ucc_default_mpool_ops = {
     .chunk_alloc   = ucc_mpool_hugetlb_malloc,
@@ -44,6 +154,7 @@ ucc_status_t ucc_mpool_init(ucc_mpool_t *mp, size_t priv_size, size_t elem_size,
                             const char *name)
 {
     ucs_mpool_ops_t *ucs_ops = ucc_calloc(1, sizeof(*ucs_ops), "mpool_ops");
+    ucc_status_t     status;
 #if UCS_HAVE_MPOOL_PARAMS
     ucs_mpool_params_t params;
 #endif
@@ -79,17 +190,51 @@ ucc_status_t ucc_mpool_init(ucc_mpool_t *mp, size_t priv_size, size_t elem_size,
     params.ops             = ucs_ops;
     params.name            = name;
 
-    return ucs_status_to_ucc_status(ucs_mpool_init(&params, &mp->super));
+    status = ucs_status_to_ucc_status(ucs_mpool_init(&params, &mp->super));
 #else
-    return ucs_status_to_ucc_status(
+    status = ucs_status_to_ucc_status(
         ucs_mpool_init(&mp->super, priv_size, elem_size, align_offset,
                        alignment, elems_per_chunk, max_elems, ucs_ops, name));
 #endif
+    if (UCC_OK != status) {
+        return status;
+    }
+
+    /* magazines would hide free objects of a bounded pool from other
+       threads, such pools use the locked path */
+    mp->magazines     = NULL;
+    mp->magazine_size = ucc_min(UCC_MPOOL_MAGAZINE_SIZE,
+                                ucc_max(UCC_MPOOL_MAGAZINE_MAX_SIZE /
+                                        ucc_max(elem_size, 1), 2));
+    if (UCC_THREAD_SINGLE != tm && UINT_MAX == max_elems) {
+        mp->magazines = ucc_calloc(UCC_MPOOL_MAX_THREADS,
+                                   sizeof(*mp->magazines), "mpool_magazines");
+        if (!mp->magazines) {
+            ucc_debug("failed to allocate mpool %s magazines, using locked "
+                      "path", name);
+        }
+    }
+    return UCC_OK;
 }
 
 void ucc_mpool_cleanup(ucc_mpool_t *mp, int leak_check)
 {
-    void *ops = (void*)mp->super.data->ops;
+    void    *ops = (void*)mp->super.data->ops;
+    unsigned i, j;
+
+    if (mp->magazines) {
+        for (i = 0; i < UCC_MPOOL_MAX_THREADS; i++) {
+            if (!mp->magazines[i]) {
+                continue;
+            }
+            for (j = 0; j < mp->magazines[i]->count; j++) {
+                ucs_mpool_put(mp->magazines[i]->objs[j]);
+            }
+            ucc_free(mp->magazines[i]);
+        }
+        ucc_free(mp->magazines);
+        mp->magazines = NULL;
+    }
 
     ucs_mpool_cleanup(&mp->super, leak_check);
     ucc_free(ops);
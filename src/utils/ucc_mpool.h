@@ -14,6 +14,24 @@
 
 typedef struct ucc_mpool ucc_mpool_t;
 
+/* Multithreaded mpools keep a per-thread magazine: a bounded stack of free
+   objects served without the pool lock. Empty magazine is refilled and
+   full one is flushed by half of its capacity under the lock. Magazines
+   are indexed by a thread slot, threads beyond UCC_MPOOL_MAX_THREADS and
+   pools with limited number of elements use the locked path. */
+#define UCC_MPOOL_MAX_THREADS       64
+#define UCC_MPOOL_MAGAZINE_SIZE     32
+/* magazine of large objects is shortened to cache at most that many bytes */
+#define UCC_MPOOL_MAGAZINE_MAX_SIZE (256 * 1024)
+
+typedef struct ucc_mpool_magazine {
+    unsigned count;
+    void    *objs[UCC_MPOOL_MAGAZINE_SIZE];
+} ucc_mpool_magazine_t;
+
+/* slot + 1 of the calling thread, 0 - not assigned yet, -1 - no free slot */
+extern __thread int ucc_mpool_thread_slot;
+
 typedef struct ucc_mpool_ops {
     ucc_status_t (*chunk_alloc)(ucc_mpool_t *mp, size_t *size_p,
                                 void **chunk_p);
@@ -23,10 +41,13 @@ typedef struct ucc_mpool_ops {
 } ucc_mpool_ops_t;
 
 struct ucc_mpool {
-    ucs_mpool_t       super;
-    ucc_mpool_ops_t * ucc_ops;
-    ucc_thread_mode_t tm;
-    ucc_spinlock_t    lock;
+    ucs_mpool_t            super;
+    ucc_mpool_ops_t *      ucc_ops;
+    ucc_thread_mode_t      tm;
+    ucc_spinlock_t         lock;
+    /* NULL if magazines are not used */
+    ucc_mpool_magazine_t **magazines;
+    unsigned               magazine_size;
 };
 
 ucc_status_t ucc_mpool_init(ucc_mpool_t *mp, size_t priv_size, size_t elem_size,
@@ -42,13 +63,43 @@ ucc_status_t ucc_mpool_hugetlb_malloc(ucc_mpool_t *mp, size_t *size_p,
 
 void ucc_mpool_hugetlb_free(ucc_mpool_t *mp, void *chunk);
 
+int ucc_mpool_thread_slot_init(void);
+
+void *ucc_mpool_get_slow(ucc_mpool_t *mp, ucc_mpool_magazine_t *mag);
+
+void ucc_mpool_put_slow(ucc_mpool_t *mp, ucc_mpool_magazine_t *mag,
+                        void *obj);
+
+/* Magazine of the calling thread, NULL if the thread has no slot or the
+   magazine is not allocated yet */
+static inline ucc_mpool_magazine_t *ucc_mpool_magazine(ucc_mpool_t *mp)
+{
+    int slot = ucc_mpool_thread_slot;
+
+    if (ucc_unlikely(slot <= 0)) {
+        slot = (slot == 0) ? ucc_mpool_thread_slot_init() : -1;
+        if (slot <= 0) {
+            return NULL;
+        }
+    }
+    return mp->magazines[slot - 1];
+}
+
 static inline void *ucc_mpool_get(ucc_mpool_t *mp)
 {
-    void *ret;
+    ucc_mpool_magazine_t *mag;
+    void                 *ret;
 
     if (UCC_THREAD_SINGLE == mp->tm) {
         return ucs_mpool_get(&mp->super);
     }
+    if (mp->magazines) {
+        mag = ucc_mpool_magazine(mp);
+        if (ucc_likely(mag && mag->count)) {
+            return mag->objs[--mag->count];
+        }
+        return ucc_mpool_get_slow(mp, mag);
+    }
     ucc_spin_lock(&mp->lock);
     ret = ucs_mpool_get(&mp->super);
     ucc_spin_unlock(&mp->lock);
@@ -57,13 +108,23 @@ static inline void *ucc_mpool_get(ucc_mpool_t *mp)
 
 static inline void ucc_mpool_put(void *obj)
 {
-    ucs_mpool_elem_t *elem = (ucs_mpool_elem_t *)obj - 1;
-    ucc_mpool_t *     mp   = ucc_derived_of(elem->mpool, ucc_mpool_t);
+    ucs_mpool_elem_t *    elem = (ucs_mpool_elem_t *)obj - 1;
+    ucc_mpool_t *         mp   = ucc_derived_of(elem->mpool, ucc_mpool_t);
+    ucc_mpool_magazine_t *mag;
 
     if (UCC_THREAD_SINGLE == mp->tm) {
         ucs_mpool_put(obj);
         return;
     }
+    if (mp->magazines) {
+        mag = ucc_mpool_magazine(mp);
+        if (ucc_likely(mag && mag->count < mp->magazine_size)) {
+            mag->objs[mag->count++] = obj;
+            return;
+        }
+        ucc_mpool_put_slow(mp, mag, obj);
+        return;
+    }
     ucc_spin_lock(&mp->lock);
     ucs_mpool_put(obj);
     ucc_spin_unlock(&mp->lock);
@@ -205,6 +205,40 @@ INSTANTIATE_TEST_CASE_P(
         ::testing::Values(TEST_INPLACE, TEST_NO_INPLACE)));
 
 
+/* odd, power of 2 and even non power of 2 team sizes: rd falls back to bruck
+   and neighbor to ring for some of them */
+UCC_TEST_F(test_allgather, algs)
+{
+    for (auto alg : {"ring", "rd", "bruck", "neighbor"}) {
+        std::string   tune = std::string("allgather:0-inf:@") + alg;
+        ucc_job_env_t env  = {{"UCC_TL_UCP_TUNE", tune},
+                              {"UCC_TL_UCP_ALLGATHER_BRUCK_RADIX", "3"},
+                              {"UCC_TL_UCP_ALLGATHER_RING_FRAG_SIZE", "1k"}};
+        for (auto n_procs : {7, 8, 6}) {
+            UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+            UccTeam_h     team = job.create_team(n_procs);
+            UccCollCtxVec ctxs;
+
+            SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+            for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+                this->set_inplace(inplace);
+                for (auto count : {1, 3, 1027}) {
+                    data_init(n_procs, UCC_DT_INT32, count, ctxs, true);
+                    UccReq req(team, ctxs);
+
+                    for (auto i = 0; i < 2; i++) {
+                        req.start();
+                        req.wait();
+                        EXPECT_EQ(true, data_validate(ctxs));
+                        reset(ctxs);
+                    }
+                    data_fini(ctxs);
+                }
+            }
+        }
+    }
+}
+
 class test_allgather_1 : public test_allgather,
         public ::testing::WithParamInterface<Param_1> {};
 
@@ -249,3 +283,60 @@ INSTANTIATE_TEST_CASE_P(
 #endif
         ::testing::Values(1,3,8192), // count
         ::testing::Values(TEST_INPLACE, TEST_NO_INPLACE)));
+
+class test_allgather_generic_dt : public ucc::test {};
+
+UCC_TEST_F(test_allgather_generic_dt, strided)
+{
+    /* 30000 elements per rank do not fit into a single bounce fragment,
+       allgather is split into several fragments */
+    const size_t                      count   = 30000;
+    const int                         n_procs = 4;
+    UccTeam_h                         team    =
+        UccJob::getStaticJob()->create_team(n_procs);
+    std::vector<std::vector<int32_t>> sbufs(n_procs), rbufs(n_procs);
+    std::vector<ucc_coll_args_t>      args(n_procs);
+    std::vector<gtest_ucc_coll_ctx_t> ctx(n_procs);
+    UccCollCtxVec                     ctxs(n_procs);
+    UccStridedDt                      sdt;
+
+    for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+        for (int i = 0; i < n_procs; i++) {
+            sbufs[i].assign(2 * count, -1);
+            rbufs[i].assign(2 * count * n_procs, -1);
+            for (size_t j = 0; j < count; j++) {
+                if (inplace == TEST_INPLACE) {
+                    rbufs[i][2 * (i * count + j)] = (int32_t)(i * count + j);
+                } else {
+                    sbufs[i][2 * j] = (int32_t)(i * count + j);
+                }
+            }
+            memset(&args[i], 0, sizeof(args[i]));
+            args[i].coll_type = UCC_COLL_TYPE_ALLGATHER;
+            if (inplace == TEST_INPLACE) {
+                args[i].mask  = UCC_COLL_ARGS_FIELD_FLAGS;
+                args[i].flags = UCC_COLL_ARGS_FLAG_IN_PLACE;
+            }
+            args[i].src.info.buffer   = sbufs[i].data();
+            args[i].src.info.count    = count;
+            args[i].src.info.datatype = sdt.dt;
+            args[i].src.info.mem_type = UCC_MEMORY_TYPE_HOST;
+            args[i].dst.info.buffer   = rbufs[i].data();
+            args[i].dst.info.count    = count * n_procs;
+            args[i].dst.info.datatype = sdt.dt;
+            args[i].dst.info.mem_type = UCC_MEMORY_TYPE_HOST;
+            ctx[i].args               = &args[i];
+            ctxs[i]                   = &ctx[i];
+        }
+        UccReq req(team, ctxs);
+        ASSERT_EQ(UCC_OK, req.status);
+        req.start();
+        ASSERT_EQ(UCC_OK, req.wait());
+        for (int i = 0; i < n_procs; i++) {
+            for (size_t j = 0; j < count * n_procs; j++) {
+                ASSERT_EQ((int32_t)j, rbufs[i][2 * j]);
+                ASSERT_EQ(-1, rbufs[i][2 * j + 1]);
+            }
+        }
+    }
+}
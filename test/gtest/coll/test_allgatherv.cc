@@ -12,6 +12,8 @@ using Param_1 = std::tuple<ucc_datatype_t, ucc_memory_type_t, int, gtest_ucc_inp
 class test_allgatherv : public UccCollArgs, public ucc::test
 {
 public:
+    /* store the blocks in reverse rank order */
+    bool reverse_displs = false;
     void  data_init(int nprocs, ucc_datatype_t dtype, size_t count,
                     UccCollCtxVec &ctxs, bool persistent) {
         ctxs.resize(nprocs);
@@ -29,9 +31,11 @@ public:
             displs = (int*)malloc(sizeof(int) * nprocs);
 
             for (int i = 0; i < nprocs; i++) {
-                counts[i] = (nprocs - i) * count;
-                displs[i] = all_counts;
-                all_counts += counts[i];
+                int j = reverse_displs ? nprocs - 1 - i : i;
+
+                counts[j] = (nprocs - j) * count;
+                displs[j] = all_counts;
+                all_counts += counts[j];
             }
             coll->mask = 0;
             coll->coll_type = UCC_COLL_TYPE_ALLGATHERV;
@@ -133,12 +137,12 @@ public:
         }
 
         for (int i = 0; i < ctxs.size(); i++) {
-            size_t rank_size = 0;
-            uint8_t *rbuf = dsts[i];
+            int *displs = (int *)ctxs[i]->args->dst.info_v.displacements;
             for (int r = 0; r < ctxs.size(); r++) {
-                rbuf += rank_size;
-                rank_size = ucc_dt_size((ctxs[r])->args->src.info.datatype) *
-                        (ctxs[r])->args->src.info.count;
+                size_t   dt_size   =
+                    ucc_dt_size((ctxs[r])->args->src.info.datatype);
+                size_t   rank_size = dt_size * (ctxs[r])->args->src.info.count;
+                uint8_t *rbuf      = dsts[i] + displs[r] * dt_size;
                 for (int j = 0; j < rank_size; j++) {
                     if (r != rbuf[j]) {
                         ret = false;
@@ -221,6 +225,42 @@ INSTANTIATE_TEST_CASE_P(
         ::testing::Values(1,3,8192), // count
         ::testing::Values(TEST_INPLACE, TEST_NO_INPLACE)));  // inplace
 
+UCC_TEST_F(test_allgatherv, algs)
+{
+    for (auto alg : {"ring", "knomial"}) {
+        std::string   tune = std::string("allgatherv:0-inf:@") + alg;
+        ucc_job_env_t env  = {{"UCC_TL_UCP_TUNE", tune},
+                              {"UCC_TL_UCP_ALLGATHERV_KN_RADIX", "3"},
+                              {"UCC_TL_UCP_ALLGATHERV_RING_FRAG_SIZE", "1k"},
+                              {"UCC_TL_UCP_ALLGATHERV_RING_MAX_SKEW", "0"}};
+        for (auto n_procs : {7, 9}) {
+            UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+            UccTeam_h     team = job.create_team(n_procs);
+            UccCollCtxVec ctxs;
+
+            SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+            for (auto reverse : {false, true}) {
+                reverse_displs = reverse;
+                for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+                    this->set_inplace(inplace);
+                    for (auto count : {1, 1027}) {
+                        data_init(n_procs, UCC_DT_INT32, count, ctxs, true);
+                        UccReq req(team, ctxs);
+
+                        for (auto i = 0; i < 2; i++) {
+                            req.start();
+                            req.wait();
+                            EXPECT_EQ(true, data_validate(ctxs));
+                            reset(ctxs);
+                        }
+                        data_fini(ctxs);
+                    }
+                }
+            }
+        }
+    }
+}
+
 class test_allgatherv_1 : public test_allgatherv,
         public ::testing::WithParamInterface<Param_1> {};
 
@@ -8,6 +8,8 @@
 #include "utils/ucc_math.h"
 
 #include <array>
+#include <fstream>
+#include <unistd.h>
 
 template<typename T>
 class test_allreduce : public UccCollArgs, public testing::Test {
@@ -301,6 +303,196 @@ TYPED_TEST(test_allreduce_alg, sra_knomial_pipelined) {
     }
 }
 
+/* Non persistent collectives of the same shape reuse the pipelined schedule
+   from the team cache, buffers are reallocated on every iteration */
+TYPED_TEST(test_allreduce_alg, sra_knomial_schedule_cache) {
+    int           n_procs = 7;
+    ucc_job_env_t env     = {{"UCC_CL_BASIC_TUNE", "inf"},
+                             {"UCC_TL_UCP_TUNE", "allreduce:@sra_knomial:inf"},
+                             {"UCC_TL_UCP_ALLREDUCE_SRA_KN_FRAG_THRESH", "1024"},
+                             {"UCC_TL_UCP_ALLREDUCE_SRA_KN_N_FRAGS", "6"},
+                             {"UCC_TL_UCP_SCHEDULE_CACHE_SIZE", "2"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccTeam_h     team   = job.create_team(n_procs);
+    int           repeat = 3;
+    UccCollCtxVec ctxs;
+
+    for (auto i = 0; i < repeat; i++) {
+        for (auto count : {4096, 65536, 4096}) {
+            for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+                SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+                this->set_inplace(inplace);
+                this->data_init(n_procs, TypeParam::dt, count, ctxs, false);
+                UccReq req(team, ctxs);
+                req.start();
+                req.wait();
+                EXPECT_EQ(true, this->data_validate(ctxs));
+                this->data_fini(ctxs);
+            }
+        }
+    }
+}
+
+static std::vector<std::string> tuner_file_records(const char *fname)
+{
+    std::vector<std::string> records;
+    std::ifstream            f(fname);
+    std::string              line;
+
+    while (std::getline(f, line)) {
+        records.push_back(line);
+    }
+    return records;
+}
+
+/* Online tuner measures every msg size bucket once, even if several teams
+   of the same shape tune it concurrently, stores the winner in the tuning
+   file and the next team with the same key takes it from the file */
+TYPED_TEST(test_allreduce_alg, tuner) {
+    int                      n_procs   = 4;
+    char                     fname[]   = "/tmp/ucc_gtest_tuner_XXXXXX";
+    int                      fd        = mkstemp(fname);
+    std::vector<int>         counts    = {8, 8192};
+    std::vector<std::string> records;
+    UccCollCtxVec            ctxs;
+
+    ASSERT_GE(fd, 0);
+    close(fd);
+    ucc_job_env_t env = {{"UCC_CL_BASIC_TUNE", "inf"},
+                         {"UCC_TL_UCP_TUNER", "y"},
+                         {"UCC_TL_UCP_TUNER_FILE", fname}};
+    {
+        UccJob                 job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+        std::vector<UccTeam_h> teams = {job.create_team(n_procs),
+                                        job.create_team(n_procs)};
+
+        for (auto &team : teams) {
+            for (auto count : counts) {
+                for (auto i = 0; i < 2; i++) {
+                    SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+                    this->data_init(n_procs, TypeParam::dt, count, ctxs,
+                                    false);
+                    UccReq req(team, ctxs);
+                    req.start();
+                    req.wait();
+                    EXPECT_EQ(true, this->data_validate(ctxs));
+                    this->data_fini(ctxs);
+                }
+            }
+        }
+    }
+    /* one record per bucket */
+    records = tuner_file_records(fname);
+    EXPECT_EQ(counts.size(), records.size());
+    if (records.size() > 1) {
+        EXPECT_NE(records[0], records[1]);
+    }
+    {
+        UccJob    job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+        UccTeam_h team = job.create_team(n_procs);
+
+        /* records are applied on team creation: nothing is measured and
+           stored again even though the file is empty now */
+        std::ofstream(fname, std::ios::trunc);
+        for (auto count : counts) {
+            SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+            this->data_init(n_procs, TypeParam::dt, count, ctxs, false);
+            UccReq req(team, ctxs);
+            req.start();
+            req.wait();
+            EXPECT_EQ(true, this->data_validate(ctxs));
+            this->data_fini(ctxs);
+        }
+    }
+    EXPECT_TRUE(tuner_file_records(fname).empty());
+    unlink(fname);
+}
+
+TYPED_TEST(test_allreduce_alg, rd) {
+    int           n_procs = 11;
+    ucc_job_env_t env     = {{"UCC_CL_BASIC_TUNE", "inf"},
+                             {"UCC_TL_UCP_TUNE", "allreduce:@rd:inf"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccTeam_h     team   = job.create_team(n_procs);
+    int           repeat = 3;
+    UccCollCtxVec ctxs;
+
+    /* 65536 elements exceed rd scratch and check knomial fallback */
+    for (auto count : {1, 64, 65536}) {
+        for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+            SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+            this->set_inplace(inplace);
+            this->data_init(n_procs, TypeParam::dt, count, ctxs, true);
+            UccReq req(team, ctxs);
+
+            for (auto i = 0; i < repeat; i++) {
+                req.start();
+                req.wait();
+                EXPECT_EQ(true, this->data_validate(ctxs));
+                this->reset(ctxs);
+            }
+            this->data_fini(ctxs);
+        }
+    }
+}
+
+TYPED_TEST(test_allreduce_alg, dbt) {
+    ucc_job_env_t env    = {{"UCC_CL_BASIC_TUNE", "inf"},
+                            {"UCC_TL_UCP_TUNE", "allreduce:@dbt:inf"},
+                            {"UCC_TL_UCP_ALLREDUCE_DBT_SEG_SIZE", "1k"}};
+    int           repeat = 3;
+    UccCollCtxVec ctxs;
+
+    /* odd team size uses shifted second tree, even - mirrored */
+    for (auto n_procs : {2, 7, 8}) {
+        UccJob    job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+        UccTeam_h team = job.create_team(n_procs);
+
+        for (auto count : {1, 3, 65536}) {
+            for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+                SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+                this->set_inplace(inplace);
+                this->data_init(n_procs, TypeParam::dt, count, ctxs, true);
+                UccReq req(team, ctxs);
+
+                for (auto i = 0; i < repeat; i++) {
+                    req.start();
+                    req.wait();
+                    EXPECT_EQ(true, this->data_validate(ctxs));
+                    this->reset(ctxs);
+                }
+                this->data_fini(ctxs);
+            }
+        }
+    }
+}
+
+TYPED_TEST(test_allreduce_alg, rd_am) {
+    int           n_procs = 6;
+    ucc_job_env_t env     = {{"UCC_CL_BASIC_TUNE", "inf"},
+                             {"UCC_TL_UCP_USE_AM", "y"},
+                             {"UCC_TL_UCP_TUNE", "allreduce:@rd:inf"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccTeam_h     team   = job.create_team(n_procs);
+    int           repeat = 3;
+    UccCollCtxVec ctxs;
+
+    for (auto count : {1, 64}) {
+        SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+        this->set_inplace(TEST_NO_INPLACE);
+        this->data_init(n_procs, TypeParam::dt, count, ctxs, true);
+        UccReq req(team, ctxs);
+
+        for (auto i = 0; i < repeat; i++) {
+            req.start();
+            req.wait();
+            EXPECT_EQ(true, this->data_validate(ctxs));
+            this->reset(ctxs);
+        }
+        this->data_fini(ctxs);
+    }
+}
+
 template <typename T>
 class test_allreduce_avg_order : public test_allreduce<T> {
 };
@@ -284,6 +284,89 @@ INSTANTIATE_TEST_CASE_P(
         ::testing::Values(/*TEST_INPLACE,*/ TEST_NO_INPLACE),
         ::testing::Values(1,3)));
 
+UCC_TEST_F(test_alltoall, am)
+{
+    int           n_procs = 8;
+    ucc_job_env_t env     = {{"UCC_TL_UCP_USE_AM", "y"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccTeam_h     team    = job.create_team(n_procs);
+    int           repeat  = 3;
+    UccCollCtxVec ctxs;
+
+    this->set_inplace(TEST_NO_INPLACE);
+    SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+    /* large count makes ucx use rndv protocol for AM */
+    for (auto count : {1, 1024, 131072}) {
+        data_init(n_procs, UCC_DT_INT32, count, ctxs, true);
+        UccReq req(team, ctxs);
+
+        for (auto i = 0; i < repeat; i++) {
+            req.start();
+            req.wait();
+            EXPECT_EQ(true, data_validate(ctxs));
+            reset(ctxs);
+        }
+        data_fini(ctxs);
+    }
+}
+
+/* onesided alltoall without user registered buffers: blocks are staged in
+   the team heap, persistent runs alternate the heap slots */
+UCC_TEST_F(test_alltoall, onesided_team_heap)
+{
+    int           n_procs = 8;
+    ucc_job_env_t env     = {{"UCC_TL_UCP_TUNE", "alltoall:0-inf:@1"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccTeam_h     team    = job.create_team(n_procs);
+    int           repeat  = 3;
+    UccCollCtxVec ctxs;
+
+    this->set_inplace(TEST_NO_INPLACE);
+    SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+    for (auto count : {1, 1024}) {
+        data_init(n_procs, UCC_DT_INT32, count, ctxs, true);
+        UccReq req(team, ctxs);
+
+        for (auto i = 0; i < repeat; i++) {
+            req.start();
+            req.wait();
+            EXPECT_EQ(true, data_validate(ctxs));
+            reset(ctxs);
+        }
+        data_fini(ctxs);
+    }
+}
+
+/* non power of radix team size: last digit has less than radix-1 peers */
+UCC_TEST_F(test_alltoall, bruck)
+{
+    int n_procs = 7;
+
+    for (auto radix : {"2", "3", "7"}) {
+        ucc_job_env_t env = {{"UCC_TL_UCP_TUNE", "alltoall:0-inf:@bruck"},
+                             {"UCC_TL_UCP_ALLTOALL_BRUCK_RADIX", radix}};
+        UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+        UccTeam_h     team   = job.create_team(n_procs);
+        int           repeat = 2;
+        UccCollCtxVec ctxs;
+
+        this->set_inplace(TEST_NO_INPLACE);
+        SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+        for (auto count : {1, 3, 1024}) {
+            data_init(n_procs, UCC_DT_INT32, count, ctxs, true);
+            UccReq req(team, ctxs);
+
+            for (auto i = 0; i < repeat; i++) {
+                req.start();
+                req.wait();
+                EXPECT_EQ(true, data_validate(ctxs));
+                reset(ctxs);
+            }
+            data_fini(ctxs);
+        }
+    }
+}
+
 class test_alltoall_1 : public test_alltoall,
         public ::testing::WithParamInterface<Param_1> {};
 
@@ -328,3 +411,56 @@ INSTANTIATE_TEST_CASE_P(
 #endif
         ::testing::Values(/*TEST_INPLACE,*/ TEST_NO_INPLACE),
         ::testing::Values(1,3,8192))); // count
+
+class test_alltoall_generic_dt : public ucc::test {};
+
+UCC_TEST_F(test_alltoall_generic_dt, strided)
+{
+    /* 20000 elements per peer do not fit into a single bounce fragment,
+       alltoall is split into several fragments */
+    const size_t                      count   = 20000;
+    const int                         n_procs = 4;
+    UccTeam_h                         team    =
+        UccJob::getStaticJob()->create_team(n_procs);
+    std::vector<std::vector<int32_t>> sbufs(n_procs), rbufs(n_procs);
+    std::vector<ucc_coll_args_t>      args(n_procs);
+    std::vector<gtest_ucc_coll_ctx_t> ctx(n_procs);
+    UccCollCtxVec                     ctxs(n_procs);
+    UccStridedDt                      sdt;
+
+    for (int i = 0; i < n_procs; i++) {
+        sbufs[i].assign(2 * count * n_procs, -1);
+        rbufs[i].assign(2 * count * n_procs, -1);
+        for (int p = 0; p < n_procs; p++) {
+            for (size_t j = 0; j < count; j++) {
+                sbufs[i][2 * (p * count + j)] =
+                    (int32_t)((i * n_procs + p) * count + j);
+            }
+        }
+        memset(&args[i], 0, sizeof(args[i]));
+        args[i].coll_type         = UCC_COLL_TYPE_ALLTOALL;
+        args[i].src.info.buffer   = sbufs[i].data();
+        args[i].src.info.count    = count * n_procs;
+        args[i].src.info.datatype = sdt.dt;
+        args[i].src.info.mem_type = UCC_MEMORY_TYPE_HOST;
+        args[i].dst.info.buffer   = rbufs[i].data();
+        args[i].dst.info.count    = count * n_procs;
+        args[i].dst.info.datatype = sdt.dt;
+        args[i].dst.info.mem_type = UCC_MEMORY_TYPE_HOST;
+        ctx[i].args               = &args[i];
+        ctxs[i]                   = &ctx[i];
+    }
+    UccReq req(team, ctxs);
+    ASSERT_EQ(UCC_OK, req.status);
+    req.start();
+    ASSERT_EQ(UCC_OK, req.wait());
+    for (int i = 0; i < n_procs; i++) {
+        for (int p = 0; p < n_procs; p++) {
+            for (size_t j = 0; j < count; j++) {
+                ASSERT_EQ((int32_t)((p * n_procs + i) * count + j),
+                          rbufs[i][2 * (p * count + j)]);
+                ASSERT_EQ(-1, rbufs[i][2 * (p * count + j) + 1]);
+            }
+        }
+    }
+}
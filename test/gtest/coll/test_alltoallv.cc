@@ -233,6 +233,65 @@ UCC_TEST_P(test_alltoallv_1, single)
     data_fini(ctxs);
 }
 
+class test_alltoallv_alg : public test_alltoallv<uint32_t> {};
+
+UCC_TEST_F(test_alltoallv_alg, onesided)
+{
+    int           n_procs = 8;
+    ucc_job_env_t env     = {{"UCC_CL_BASIC_TUNE", "inf"},
+                             {"UCC_TL_UCP_TUNE", "alltoallv:@onesided:inf"},
+                             {"UCC_TL_UCP_ALLTOALLV_ONESIDED_NUM_GETS", "2"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccTeam_h     team   = job.create_team(n_procs);
+    int           repeat = 3;
+    UccCollCtxVec ctxs;
+
+    set_inplace(TEST_NO_INPLACE);
+    SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+    for (auto count : {1, 4096}) {
+        data_init(n_procs, UCC_DT_INT32, count, ctxs, true);
+        UccReq req(team, ctxs);
+
+        for (auto i = 0; i < repeat; i++) {
+            req.start();
+            req.wait();
+            EXPECT_EQ(true, data_validate(ctxs));
+            reset(ctxs);
+        }
+        data_fini(ctxs);
+    }
+}
+
+/* Buffers are reallocated between the collectives and the caches are small,
+   so that registrations and rkeys are evicted and invalidated */
+UCC_TEST_F(test_alltoallv_alg, onesided_rcache)
+{
+    int           n_procs = 4;
+    ucc_job_env_t env     = {{"UCC_CL_BASIC_TUNE", "inf"},
+                             {"UCC_TL_UCP_TUNE", "alltoallv:@onesided:inf"},
+                             {"UCC_TL_UCP_RCACHE_MAX_REGIONS", "2"},
+                             {"UCC_TL_UCP_RKEY_CACHE_SIZE", "1"}};
+    UccJob        job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+    UccTeam_h     team   = job.create_team(n_procs);
+    int           repeat = 3;
+    UccCollCtxVec ctxs;
+
+    set_inplace(TEST_NO_INPLACE);
+    SET_MEM_TYPE(UCC_MEMORY_TYPE_HOST);
+    for (auto count : {8, 65536, 8, 1024}) {
+        data_init(n_procs, UCC_DT_INT32, count, ctxs, true);
+        UccReq req(team, ctxs);
+
+        for (auto i = 0; i < repeat; i++) {
+            req.start();
+            req.wait();
+            EXPECT_EQ(true, data_validate(ctxs));
+            reset(ctxs);
+        }
+        data_fini(ctxs);
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(
         64, test_alltoallv_0,
         ::testing::Combine(
@@ -348,3 +407,77 @@ INSTANTIATE_TEST_CASE_P(
 #endif
             ::testing::Values(/*TEST_INPLACE,*/ TEST_NO_INPLACE),
             PREDEFINED_DTYPES)); // dtype
+
+class test_alltoallv_generic_dt : public ucc::test {};
+
+UCC_TEST_F(test_alltoallv_generic_dt, strided)
+{
+    /* alltoallv with generic dt is not fragmented: the whole packed message
+       is exchanged at once, counts include zeros */
+    const int                          n_procs = 4;
+    UccTeam_h                          team    =
+        UccJob::getStaticJob()->create_team(n_procs);
+    std::vector<std::vector<int32_t>>  sbufs(n_procs), rbufs(n_procs);
+    std::vector<std::vector<uint32_t>> scounts(n_procs), sdispls(n_procs);
+    std::vector<std::vector<uint32_t>> rcounts(n_procs), rdispls(n_procs);
+    std::vector<ucc_coll_args_t>       args(n_procs);
+    std::vector<gtest_ucc_coll_ctx_t>  ctx(n_procs);
+    UccCollCtxVec                      ctxs(n_procs);
+    UccStridedDt                       sdt;
+    auto count = [](int src, int dst) {
+        return (uint32_t)(((src + 2 * dst) % 3) * 5000);
+    };
+    auto value = [n_procs](int src, int dst, uint32_t j) {
+        return (int32_t)((src * n_procs + dst) * 100000 + j);
+    };
+
+    for (int i = 0; i < n_procs; i++) {
+        uint32_t s_total = 0, r_total = 0;
+
+        scounts[i].resize(n_procs);
+        sdispls[i].resize(n_procs);
+        rcounts[i].resize(n_procs);
+        rdispls[i].resize(n_procs);
+        for (int p = 0; p < n_procs; p++) {
+            scounts[i][p] = count(i, p);
+            sdispls[i][p] = s_total;
+            s_total      += scounts[i][p];
+            rcounts[i][p] = count(p, i);
+            rdispls[i][p] = r_total;
+            r_total      += rcounts[i][p];
+        }
+        sbufs[i].assign(2 * s_total, -1);
+        rbufs[i].assign(2 * r_total, -1);
+        for (int p = 0; p < n_procs; p++) {
+            for (uint32_t j = 0; j < scounts[i][p]; j++) {
+                sbufs[i][2 * (sdispls[i][p] + j)] = value(i, p, j);
+            }
+        }
+        memset(&args[i], 0, sizeof(args[i]));
+        args[i].coll_type                = UCC_COLL_TYPE_ALLTOALLV;
+        args[i].src.info_v.buffer        = sbufs[i].data();
+        args[i].src.info_v.counts        = (ucc_count_t *)scounts[i].data();
+        args[i].src.info_v.displacements = (ucc_aint_t *)sdispls[i].data();
+        args[i].src.info_v.datatype      = sdt.dt;
+        args[i].src.info_v.mem_type      = UCC_MEMORY_TYPE_HOST;
+        args[i].dst.info_v.buffer        = rbufs[i].data();
+        args[i].dst.info_v.counts        = (ucc_count_t *)rcounts[i].data();
+        args[i].dst.info_v.displacements = (ucc_aint_t *)rdispls[i].data();
+        args[i].dst.info_v.datatype      = sdt.dt;
+        args[i].dst.info_v.mem_type      = UCC_MEMORY_TYPE_HOST;
+        ctx[i].args                      = &args[i];
+        ctxs[i]                          = &ctx[i];
+    }
+    UccReq req(team, ctxs);
+    ASSERT_EQ(UCC_OK, req.status);
+    req.start();
+    ASSERT_EQ(UCC_OK, req.wait());
+    for (int i = 0; i < n_procs; i++) {
+        for (int p = 0; p < n_procs; p++) {
+            for (uint32_t j = 0; j < rcounts[i][p]; j++) {
+                ASSERT_EQ(value(p, i, j), rbufs[i][2 * (rdispls[i][p] + j)]);
+                ASSERT_EQ(-1, rbufs[i][2 * (rdispls[i][p] + j) + 1]);
+            }
+        }
+    }
+}
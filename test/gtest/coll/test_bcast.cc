@@ -232,3 +232,60 @@ INSTANTIATE_TEST_CASE_P(
 #endif
         ::testing::Values(1,3,65536), // count
         ::testing::Values(0,1))); // root
+
+class test_bcast_generic_dt : public ucc::test {};
+
+UCC_TEST_F(test_bcast_generic_dt, strided)
+{
+    /* 400KB of packed data: bcast is split into several fragments */
+    const size_t                      count   = 100000;
+    const int                         n_procs = 4;
+    const int                         root    = 1;
+    UccTeam_h                         team    =
+        UccJob::getStaticJob()->create_team(n_procs);
+    std::vector<std::vector<int32_t>> bufs(n_procs);
+    std::vector<ucc_coll_req_h>       reqs(n_procs);
+    UccStridedDt                      sdt;
+    ucc_datatype_t                    dt = sdt.dt;
+    ucc_coll_args_t                   args;
+    bool                              done;
+
+    for (int i = 0; i < n_procs; i++) {
+        bufs[i].assign(2 * count, -1);
+        if (i == root) {
+            for (size_t j = 0; j < count; j++) {
+                bufs[i][2 * j] = (int32_t)j;
+            }
+        }
+        args.mask              = 0;
+        args.coll_type         = UCC_COLL_TYPE_BCAST;
+        args.root              = root;
+        args.src.info.buffer   = bufs[i].data();
+        args.src.info.count    = count;
+        args.src.info.datatype = dt;
+        args.src.info.mem_type = UCC_MEMORY_TYPE_HOST;
+        ASSERT_EQ(UCC_OK,
+                  ucc_collective_init(&args, &reqs[i], team->procs[i].team));
+    }
+    for (auto r : reqs) {
+        ASSERT_EQ(UCC_OK, ucc_collective_post(r));
+    }
+    do {
+        done = true;
+        team->progress();
+        for (auto r : reqs) {
+            ucc_status_t st = ucc_collective_test(r);
+            ASSERT_GE(st, 0);
+            done = done && (st == UCC_OK);
+        }
+    } while (!done);
+    for (auto r : reqs) {
+        EXPECT_EQ(UCC_OK, ucc_collective_finalize(r));
+    }
+    for (int i = 0; i < n_procs; i++) {
+        for (size_t j = 0; j < count; j++) {
+            ASSERT_EQ((int32_t)j, bufs[i][2 * j]);
+            ASSERT_EQ(-1, bufs[i][2 * j + 1]);
+        }
+    }
+}
@@ -276,3 +276,99 @@ INSTANTIATE_TEST_CASE_P(
                        ::testing::Values(1, 3, 8192), // count
                        ::testing::Values(0, 1),       // root
                        ::testing::Values(TEST_INPLACE, TEST_NO_INPLACE)));
+
+class test_gather_alg : public test_gather,
+                        public ::testing::WithParamInterface<std::string> {
+};
+
+UCC_TEST_P(test_gather_alg, seg)
+{
+    std::string   tune = std::string("gather:@") + GetParam() + ":inf";
+    ucc_job_env_t env  = {{"UCC_CL_BASIC_TUNE", "inf"},
+                          {"UCC_TL_UCP_TUNE", tune},
+                          {"UCC_TL_UCP_GATHER_KN_RADIX", "3"},
+                          {"UCC_TL_UCP_GATHER_SEG_SIZE", "1k"},
+                          {"UCC_TL_UCP_GATHER_SEG_WINDOW", "2"}};
+    UccCollCtxVec ctxs;
+
+    for (auto n_procs : {7, 8}) {
+        UccJob    job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+        UccTeam_h team = job.create_team(n_procs);
+
+        for (auto root : {0, 1, n_procs - 1}) {
+            set_root(root);
+            for (auto count : {5, 4099}) {
+                for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+                    set_inplace(inplace);
+                    data_init(n_procs, UCC_DT_INT32, count, ctxs, true);
+                    UccReq req(team, ctxs);
+
+                    for (auto i = 0; i < 2; i++) {
+                        req.start();
+                        req.wait();
+                        EXPECT_EQ(true, data_validate(ctxs));
+                        reset(ctxs);
+                    }
+                    data_fini(ctxs);
+                }
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(, test_gather_alg,
+                        ::testing::Values("seg_knomial", "linear"));
+
+class test_gather_generic_dt : public ucc::test {};
+
+UCC_TEST_F(test_gather_generic_dt, strided)
+{
+    /* 30000 elements per rank do not fit into a single bounce fragment,
+       gather is split into several fragments */
+    const size_t                      count   = 30000;
+    const int                         n_procs = 4;
+    const int                         root    = 1;
+    UccTeam_h                         team    =
+        UccJob::getStaticJob()->create_team(n_procs);
+    std::vector<std::vector<int32_t>> sbufs(n_procs), rbufs(n_procs);
+    std::vector<ucc_coll_args_t>      args(n_procs);
+    std::vector<gtest_ucc_coll_ctx_t> ctx(n_procs);
+    UccCollCtxVec                     ctxs(n_procs);
+    UccStridedDt                      sdt;
+
+    for (int i = 0; i < n_procs; i++) {
+        sbufs[i].assign(2 * count, -1);
+        for (size_t j = 0; j < count; j++) {
+            sbufs[i][2 * j] = (int32_t)(i * count + j);
+        }
+        memset(&args[i], 0, sizeof(args[i]));
+        args[i].coll_type         = UCC_COLL_TYPE_GATHER;
+        args[i].root              = root;
+        args[i].src.info.buffer   = sbufs[i].data();
+        args[i].src.info.count    = count;
+        args[i].src.info.datatype = sdt.dt;
+        args[i].src.info.mem_type = UCC_MEMORY_TYPE_HOST;
+        if (i == root) {
+            rbufs[i].assign(2 * count * n_procs, -1);
+            args[i].dst.info.buffer   = rbufs[i].data();
+            args[i].dst.info.count    = count * n_procs;
+            args[i].dst.info.datatype = sdt.dt;
+            args[i].dst.info.mem_type = UCC_MEMORY_TYPE_HOST;
+        }
+        ctx[i].args = &args[i];
+        ctxs[i]     = &ctx[i];
+    }
+    UccReq req(team, ctxs);
+    ASSERT_EQ(UCC_OK, req.status);
+    req.start();
+    ASSERT_EQ(UCC_OK, req.wait());
+    for (size_t j = 0; j < count * n_procs; j++) {
+        ASSERT_EQ((int32_t)j, rbufs[root][2 * j]);
+        ASSERT_EQ(-1, rbufs[root][2 * j + 1]);
+    }
+    for (int i = 0; i < n_procs; i++) {
+        for (size_t j = 0; j < count; j++) {
+            ASSERT_EQ(-1, sbufs[i][2 * j + 1]);
+        }
+    }
+}
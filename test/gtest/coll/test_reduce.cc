@@ -15,6 +15,11 @@ class test_reduce : public UccCollArgs, public testing::Test {
   private:
     int root = 0;
   public:
+    virtual void TestBody(){};
+    void set_root(int _root)
+    {
+        root = _root;
+    }
     void data_init(int nprocs, ucc_datatype_t dt, size_t count,
                    UccCollCtxVec &ctxs, bool persistent)
     {
@@ -299,3 +304,49 @@ TYPED_TEST(test_reduce_avg_order, avg_post_op)
         }
     }
 }
+
+class test_reduce_alg : public ucc::test,
+                        public ::testing::WithParamInterface<std::string> {
+};
+
+UCC_TEST_P(test_reduce_alg, bw)
+{
+    test_reduce<TypeOpPair<UCC_DT_INT32, sum>> reduce_test;
+    std::string   tune = std::string("reduce:@") + GetParam() + ":inf";
+    ucc_job_env_t env  = {{"UCC_CL_BASIC_TUNE", "inf"},
+                          {"UCC_TL_UCP_TUNE", tune},
+                          {"UCC_TL_UCP_REDUCE_SRG_KN_RADIX", "3"},
+                          {"UCC_TL_UCP_REDUCE_SRG_KN_FRAG_SIZE", "1k"},
+                          {"UCC_TL_UCP_REDUCE_CHAIN_SEG_SIZE", "1k"}};
+    UccCollCtxVec ctxs;
+
+    /* 7 procs with radix 3 has extra rank 1 */
+    for (auto n_procs : {7, 8}) {
+        UccJob    job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+        UccTeam_h team = job.create_team(n_procs);
+
+        reduce_test.set_mem_type(UCC_MEMORY_TYPE_HOST);
+        for (auto root : {0, 1, n_procs - 1}) {
+            reduce_test.set_root(root);
+            for (auto count : {5, 4099}) {
+                for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+                    reduce_test.set_inplace(inplace);
+                    reduce_test.data_init(n_procs, UCC_DT_INT32, count, ctxs,
+                                          true);
+                    UccReq req(team, ctxs);
+
+                    for (auto i = 0; i < 2; i++) {
+                        req.start();
+                        req.wait();
+                        EXPECT_EQ(true, reduce_test.data_validate(ctxs));
+                        reduce_test.reset(ctxs);
+                    }
+                    reduce_test.data_fini(ctxs);
+                }
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(, test_reduce_alg,
+                        ::testing::Values("srg_knomial", "chain"));
@@ -381,3 +381,47 @@ UCC_TEST_P(test_reduce_scatterv_alg, ring)
 }
 INSTANTIATE_TEST_CASE_P(, test_reduce_scatterv_alg,
                         ::testing::Values("bidirectional", "unidirectional"));
+
+class test_reduce_scatterv_kn
+    : public ucc::test,
+      public ::testing::WithParamInterface<std::string> {
+};
+
+UCC_TEST_P(test_reduce_scatterv_kn, knomial)
+{
+    test_reduce_scatterv<TypeOpPair<UCC_DT_INT32, sum>> rsv_test;
+    std::string                                         radix = GetParam();
+    ucc_job_env_t env = {{"UCC_CL_BASIC_TUNE", "inf"},
+                         {"UCC_TL_UCP_TUNE", "reduce_scatterv:@knomial:inf"},
+                         {"UCC_TL_UCP_REDUCE_SCATTERV_KN_RADIX", radix}};
+    int           repeat = 2;
+    UccCollCtxVec ctxs;
+
+    /* 7 procs has extra ranks for any radix, 8 procs is a full tree for
+       radix 2 and an incomplete one for radix 3 */
+    for (auto n_procs : {7, 8}) {
+        UccJob    job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+        UccTeam_h team = job.create_team(n_procs);
+
+        rsv_test.set_mem_type(UCC_MEMORY_TYPE_HOST);
+        /* small count produces zero blocks for some ranks */
+        for (auto count : {13, 65536}) {
+            for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+                rsv_test.set_inplace(inplace);
+                rsv_test.data_init(n_procs, UCC_DT_INT32, count, ctxs, true);
+                UccReq req(team, ctxs);
+
+                for (auto i = 0; i < repeat; i++) {
+                    req.start();
+                    req.wait();
+                    EXPECT_EQ(true, rsv_test.data_validate(ctxs));
+                    rsv_test.reset(ctxs);
+                }
+                rsv_test.data_fini(ctxs);
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(, test_reduce_scatterv_kn,
+                        ::testing::Values("2", "3", "4"));
@@ -0,0 +1,216 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * See file LICENSE for terms.
+ */
+
+#include "common/test_ucc.h"
+#include "utils/ucc_math.h"
+
+using Param_0 = std::tuple<int, ucc_datatype_t, ucc_memory_type_t, int, int,
+                           gtest_ucc_inplace_t>;
+
+class test_scatter : public UccCollArgs, public ucc::test {
+  private:
+    int root;
+
+  public:
+    void data_init(int nprocs, ucc_datatype_t dtype, size_t single_rank_count,
+                   UccCollCtxVec &ctxs, bool persistent)
+    {
+        size_t block_size = ucc_dt_size(dtype) * single_rank_count;
+
+        ctxs.resize(nprocs);
+        for (auto r = 0; r < nprocs; r++) {
+            ucc_coll_args_t *coll =
+                (ucc_coll_args_t *)calloc(1, sizeof(ucc_coll_args_t));
+            ctxs[r] =
+                (gtest_ucc_coll_ctx_t *)calloc(1, sizeof(gtest_ucc_coll_ctx_t));
+            ctxs[r]->args = coll;
+
+            coll->mask              = 0;
+            coll->flags             = 0;
+            coll->coll_type         = UCC_COLL_TYPE_SCATTER;
+            coll->root              = root;
+            coll->dst.info.mem_type = mem_type;
+            coll->dst.info.count    = (ucc_count_t)single_rank_count;
+            coll->dst.info.datatype = dtype;
+            ctxs[r]->rbuf_size      = block_size;
+
+            if (r == root) {
+                ctxs[r]->init_buf = ucc_malloc(block_size * nprocs, "init buf");
+                EXPECT_NE(ctxs[r]->init_buf, nullptr);
+                for (int i = 0; i < block_size * nprocs; i++) {
+                    uint8_t *ptr = (uint8_t *)ctxs[r]->init_buf;
+                    ptr[i]       = ((i / block_size + i) % 256);
+                }
+                coll->src.info.mem_type = mem_type;
+                coll->src.info.count = (ucc_count_t)single_rank_count * nprocs;
+                coll->src.info.datatype = dtype;
+                UCC_CHECK(ucc_mc_alloc(&ctxs[r]->src_mc_header,
+                                       block_size * nprocs, mem_type));
+                coll->src.info.buffer = ctxs[r]->src_mc_header->addr;
+                UCC_CHECK(ucc_mc_memcpy(coll->src.info.buffer,
+                                        ctxs[r]->init_buf, block_size * nprocs,
+                                        mem_type, UCC_MEMORY_TYPE_HOST));
+            }
+            if (r != root || !inplace) {
+                UCC_CHECK(ucc_mc_alloc(&ctxs[r]->dst_mc_header, block_size,
+                                       mem_type));
+                coll->dst.info.buffer = ctxs[r]->dst_mc_header->addr;
+            }
+            if (inplace) {
+                coll->mask |= UCC_COLL_ARGS_FIELD_FLAGS;
+                coll->flags |= UCC_COLL_ARGS_FLAG_IN_PLACE;
+            }
+            if (persistent) {
+                coll->mask |= UCC_COLL_ARGS_FIELD_FLAGS;
+                coll->flags |= UCC_COLL_ARGS_FLAG_PERSISTENT;
+            }
+        }
+    }
+    void data_fini(UccCollCtxVec ctxs)
+    {
+        for (auto r = 0; r < ctxs.size(); r++) {
+            ucc_coll_args_t *coll = ctxs[r]->args;
+            if (r == root) {
+                UCC_CHECK(ucc_mc_free(ctxs[r]->src_mc_header));
+                ucc_free(ctxs[r]->init_buf);
+            }
+            if (r != root || !inplace) {
+                UCC_CHECK(ucc_mc_free(ctxs[r]->dst_mc_header));
+            }
+            free(coll);
+            free(ctxs[r]);
+        }
+        ctxs.clear();
+    }
+    void reset(UccCollCtxVec ctxs)
+    {
+        for (auto r = 0; r < ctxs.size(); r++) {
+            if (r != root || !inplace) {
+                clear_buffer(ctxs[r]->args->dst.info.buffer,
+                             ctxs[r]->rbuf_size, mem_type, 0);
+            }
+        }
+    }
+    bool data_validate(UccCollCtxVec ctxs)
+    {
+        bool     ret        = true;
+        size_t   block_size = ctxs[0]->rbuf_size;
+        uint8_t *expected   = (uint8_t *)ctxs[root]->init_buf;
+        uint8_t *dst;
+
+        for (int r = 0; r < ctxs.size(); r++) {
+            if (r == root && inplace) {
+                continue;
+            }
+            if (UCC_MEMORY_TYPE_HOST != mem_type) {
+                dst = (uint8_t *)ucc_malloc(block_size, "dst buf");
+                EXPECT_NE(dst, nullptr);
+                UCC_CHECK(ucc_mc_memcpy(dst, ctxs[r]->args->dst.info.buffer,
+                                        block_size, UCC_MEMORY_TYPE_HOST,
+                                        mem_type));
+            } else {
+                dst = (uint8_t *)ctxs[r]->args->dst.info.buffer;
+            }
+            for (int i = 0; i < block_size; i++) {
+                if (expected[r * block_size + i] != dst[i]) {
+                    ret = false;
+                    break;
+                }
+            }
+            if (UCC_MEMORY_TYPE_HOST != mem_type) {
+                ucc_free(dst);
+            }
+        }
+        return ret;
+    }
+    void set_root(int _root)
+    {
+        root = _root;
+    }
+};
+
+class test_scatter_0 : public test_scatter,
+                       public ::testing::WithParamInterface<Param_0> {
+};
+
+UCC_TEST_P(test_scatter_0, single)
+{
+    const int                 team_id  = std::get<0>(GetParam());
+    const ucc_datatype_t      dtype    = std::get<1>(GetParam());
+    const ucc_memory_type_t   mem_type = std::get<2>(GetParam());
+    const int                 count    = std::get<3>(GetParam());
+    const int                 root     = std::get<4>(GetParam());
+    const gtest_ucc_inplace_t inplace  = std::get<5>(GetParam());
+    UccTeam_h                 team     = UccJob::getStaticTeams()[team_id];
+    int                       size     = team->procs.size();
+    UccCollCtxVec             ctxs;
+
+    set_inplace(inplace);
+    SET_MEM_TYPE(mem_type);
+    set_root(root);
+
+    data_init(size, dtype, count, ctxs, false);
+    UccReq req(team, ctxs);
+    req.start();
+    req.wait();
+    EXPECT_EQ(true, data_validate(ctxs));
+    data_fini(ctxs);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    , test_scatter_0,
+    ::testing::Combine(::testing::Range(1, UccJob::nStaticTeams), // team_ids
+                       PREDEFINED_DTYPES,
+#ifdef HAVE_CUDA
+                       ::testing::Values(UCC_MEMORY_TYPE_HOST,
+                                         UCC_MEMORY_TYPE_CUDA),
+#else
+                       ::testing::Values(UCC_MEMORY_TYPE_HOST),
+#endif
+                       ::testing::Values(1, 3, 8192), // count
+                       ::testing::Values(0, 1),       // root
+                       ::testing::Values(TEST_INPLACE, TEST_NO_INPLACE)));
+
+class test_scatter_alg : public test_scatter,
+                         public ::testing::WithParamInterface<std::string> {
+};
+
+UCC_TEST_P(test_scatter_alg, seg)
+{
+    std::string   tune = std::string("scatter:@") + GetParam() + ":inf";
+    ucc_job_env_t env  = {{"UCC_CL_BASIC_TUNE", "inf"},
+                          {"UCC_TL_UCP_TUNE", tune},
+                          {"UCC_TL_UCP_SCATTER_KN_RADIX", "3"},
+                          {"UCC_TL_UCP_SCATTER_SEG_SIZE", "1k"},
+                          {"UCC_TL_UCP_SCATTER_SEG_WINDOW", "2"}};
+    UccCollCtxVec ctxs;
+
+    for (auto n_procs : {7, 8}) {
+        UccJob    job(n_procs, UccJob::UCC_JOB_CTX_GLOBAL, env);
+        UccTeam_h team = job.create_team(n_procs);
+
+        for (auto root : {0, 1, n_procs - 1}) {
+            set_root(root);
+            for (auto count : {5, 4099}) {
+                for (auto inplace : {TEST_NO_INPLACE, TEST_INPLACE}) {
+                    set_inplace(inplace);
+                    data_init(n_procs, UCC_DT_INT32, count, ctxs, true);
+                    UccReq req(team, ctxs);
+
+                    for (auto i = 0; i < 2; i++) {
+                        req.start();
+                        req.wait();
+                        EXPECT_EQ(true, data_validate(ctxs));
+                        reset(ctxs);
+                    }
+                    data_fini(ctxs);
+                }
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(, test_scatter_alg,
+                        ::testing::Values("seg_knomial", "linear"));
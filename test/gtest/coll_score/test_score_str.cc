@@ -113,3 +113,37 @@ UCC_TEST_F(test_score_str, check_range_multiple)
                           RLIST({RANGE(99, 12*1024*1024, 20)})));
     ucc_coll_score_free(score);
 }
+
+UCC_TEST_F(test_score_str, check_team_shape)
+{
+    std::string       str = "alltoall:host:10:team_size=2-64#"
+                            "bcast:host:20:[1,4]";
+    ucc_coll_score_t *score;
+
+    EXPECT_EQ(UCC_OK, ucc_coll_score_alloc_from_str(str.c_str(), &score, 16,
+                                                    NULL, NULL, NULL));
+    EXPECT_EQ(10, SCORE(score, ALLTOALL, HOST));
+    EXPECT_EQ(1, ucc_list_is_empty(
+                     &score->scores[ucc_ilog2(UCC_COLL_TYPE_BCAST)]
+                                   [UCC_MEMORY_TYPE_HOST]));
+    ucc_coll_score_free(score);
+
+    /* team shape is unknown without a team: ppn/nnodes tokens are skipped */
+    str = "alltoall:host:10:ppn=1-inf#"
+          "bcast:host:20:nnodes=1-inf:team_size=16";
+    EXPECT_EQ(UCC_OK, ucc_coll_score_alloc_from_str(str.c_str(), &score, 16,
+                                                    NULL, NULL, NULL));
+    EXPECT_EQ(1, ucc_list_is_empty(
+                     &score->scores[ucc_ilog2(UCC_COLL_TYPE_ALLTOALL)]
+                                   [UCC_MEMORY_TYPE_HOST]));
+    EXPECT_EQ(1, ucc_list_is_empty(
+                     &score->scores[ucc_ilog2(UCC_COLL_TYPE_BCAST)]
+                                   [UCC_MEMORY_TYPE_HOST]));
+    ucc_coll_score_free(score);
+
+    str = "alltoall:host:10:team_size=64-2";
+    testing::internal::CaptureStdout();
+    EXPECT_NE(UCC_OK, ucc_coll_score_alloc_from_str(str.c_str(), &score, 16,
+                                                    NULL, NULL, NULL));
+    testing::internal::GetCapturedStdout();
+}
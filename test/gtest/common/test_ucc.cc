@@ -711,3 +711,79 @@ bool tl_self_available()
     ucc_tl_context_put(tl_ctx);
     return true;
 }
+
+struct strided_dt_state {
+    uint8_t *buf;
+    size_t   count;
+};
+
+static void *strided_dt_start(void *context, const void *buffer, size_t count)
+{
+    strided_dt_state *s = new strided_dt_state;
+
+    s->buf   = (uint8_t *)buffer;
+    s->count = count;
+    return s;
+}
+
+static void *strided_dt_start_unpack(void *context, void *buffer, size_t count)
+{
+    return strided_dt_start(context, buffer, count);
+}
+
+static size_t strided_dt_packed_size(void *state)
+{
+    return ((strided_dt_state *)state)->count * sizeof(int32_t);
+}
+
+static inline uint8_t *strided_dt_byte(strided_dt_state *s, size_t offset)
+{
+    return s->buf + (offset / sizeof(int32_t)) * 2 * sizeof(int32_t) +
+           offset % sizeof(int32_t);
+}
+
+static size_t strided_dt_pack(void *state, size_t offset, void *dest,
+                              size_t max_length)
+{
+    strided_dt_state *s = (strided_dt_state *)state;
+
+    for (size_t i = 0; i < max_length; i++) {
+        ((uint8_t *)dest)[i] = *strided_dt_byte(s, offset + i);
+    }
+    return max_length;
+}
+
+static ucc_status_t strided_dt_unpack(void *state, size_t offset,
+                                      const void *src, size_t length)
+{
+    strided_dt_state *s = (strided_dt_state *)state;
+
+    for (size_t i = 0; i < length; i++) {
+        *strided_dt_byte(s, offset + i) = ((const uint8_t *)src)[i];
+    }
+    return UCC_OK;
+}
+
+static void strided_dt_finish(void *state)
+{
+    delete (strided_dt_state *)state;
+}
+
+UccStridedDt::UccStridedDt()
+{
+    ucc_generic_dt_ops_t ops;
+
+    memset(&ops, 0, sizeof(ops));
+    ops.start_pack   = strided_dt_start;
+    ops.start_unpack = strided_dt_start_unpack;
+    ops.packed_size  = strided_dt_packed_size;
+    ops.pack         = strided_dt_pack;
+    ops.unpack       = strided_dt_unpack;
+    ops.finish       = strided_dt_finish;
+    EXPECT_EQ(UCC_OK, ucc_dt_create_generic(&ops, NULL, &dt));
+}
+
+UccStridedDt::~UccStridedDt()
+{
+    ucc_dt_destroy(dt);
+}
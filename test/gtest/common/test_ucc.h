@@ -268,4 +268,16 @@ void clear_buffer(void *_buf, size_t size, ucc_memory_type_t mt, uint8_t value);
 #define UCC_TEST_MEM_SEGMENT_SIZE (1 << 20)
 
 bool tl_self_available();
+
+/* Non contiguous generic datatype: vector of int32 with stride 2. Element i
+   of the buffer is int32 at index 2 * i, odd int32s do not belong to the
+   datatype and must stay untouched by the collective */
+class UccStridedDt {
+public:
+    ucc_datatype_t dt;
+    UccStridedDt();
+    ~UccStridedDt();
+    UccStridedDt(const UccStridedDt&) = delete;
+    UccStridedDt& operator=(const UccStridedDt&) = delete;
+};
 #endif
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * See file LICENSE for terms.
+ */
+#include "common/test_ucc.h"
+#include <algorithm>
+
+class test_coll_group : public ucc::test {
+  public:
+    void wait(UccTeam_h team, std::vector<ucc_coll_req_h> &reqs)
+    {
+        bool done;
+
+        do {
+            done = true;
+            team->progress();
+            for (auto r : reqs) {
+                ucc_status_t st = ucc_collective_test(r);
+                ASSERT_GE(st, 0);
+                if (UCC_INPROGRESS == st) {
+                    done = false;
+                }
+            }
+        } while (!done);
+    }
+};
+
+/* Many small allreduces of different sizes and ops in one group: members
+   are fused by op and UCC_COLL_GROUP_FRAG_SIZE, results must be the same
+   as without the group */
+UCC_TEST_F(test_coll_group, allreduce)
+{
+    const int                                    n_colls = 64;
+    const int                                    n_procs = 4;
+    UccTeam_h                                    team    =
+        UccJob::getStaticJob()->create_team(n_procs);
+    std::vector<std::vector<std::vector<float>>> bufs(n_procs);
+    std::vector<ucc_coll_req_h>                  reqs;
+    ucc_coll_args_t                              args;
+
+    for (int i = 0; i < n_procs; i++) {
+        ASSERT_EQ(UCC_OK, ucc_collective_group_start(team->procs[i].team));
+        bufs[i].resize(n_colls);
+        for (int c = 0; c < n_colls; c++) {
+            /* 1 to 32k elements: members of each op span several frags */
+            bufs[i][c].assign(1 << (c % 16), (float)(i + 1));
+            args.mask              = UCC_COLL_ARGS_FIELD_FLAGS;
+            args.flags             = UCC_COLL_ARGS_FLAG_IN_PLACE;
+            args.coll_type         = UCC_COLL_TYPE_ALLREDUCE;
+            args.op                = (c % 3) ? UCC_OP_SUM : UCC_OP_MAX;
+            args.dst.info.buffer   = bufs[i][c].data();
+            args.dst.info.count    = bufs[i][c].size();
+            args.dst.info.datatype = UCC_DT_FLOAT32;
+            args.dst.info.mem_type = UCC_MEMORY_TYPE_HOST;
+            reqs.push_back(nullptr);
+            ASSERT_EQ(UCC_OK, ucc_collective_init(&args, &reqs.back(),
+                                                  team->procs[i].team));
+        }
+        ASSERT_EQ(UCC_OK, ucc_collective_group_end(team->procs[i].team));
+    }
+    for (auto r : reqs) {
+        ASSERT_EQ(UCC_OK, ucc_collective_post(r));
+    }
+    wait(team, reqs);
+    for (auto r : reqs) {
+        EXPECT_EQ(UCC_OK, ucc_collective_finalize(r));
+    }
+    for (int i = 0; i < n_procs; i++) {
+        for (int c = 0; c < n_colls; c++) {
+            float expected = (c % 3) ? (float)(n_procs * (n_procs + 1) / 2)
+                                     : (float)n_procs;
+            EXPECT_EQ((ptrdiff_t)bufs[i][c].size(),
+                      std::count(bufs[i][c].begin(), bufs[i][c].end(),
+                                 expected));
+        }
+    }
+}
+
+UCC_TEST_F(test_coll_group, invalid_usage)
+{
+    UccTeam_h       team = UccJob::getStaticJob()->create_team(2);
+    ucc_team_h      t    = team->procs[0].team;
+    float           buf  = 1;
+    ucc_coll_req_h  req;
+    ucc_coll_args_t args;
+
+    EXPECT_NE(UCC_OK, ucc_collective_group_end(t));
+    ASSERT_EQ(UCC_OK, ucc_collective_group_start(t));
+    EXPECT_NE(UCC_OK, ucc_collective_group_start(t));
+
+    args.mask              = UCC_COLL_ARGS_FIELD_FLAGS;
+    args.flags             = UCC_COLL_ARGS_FLAG_IN_PLACE;
+    args.coll_type         = UCC_COLL_TYPE_ALLREDUCE;
+    args.op                = UCC_OP_SUM;
+    args.dst.info.buffer   = &buf;
+    args.dst.info.count    = 1;
+    args.dst.info.datatype = UCC_DT_FLOAT32;
+    args.dst.info.mem_type = UCC_MEMORY_TYPE_HOST;
+    ASSERT_EQ(UCC_OK, ucc_collective_init(&args, &req, t));
+    /* member can not be posted before the group is closed */
+    EXPECT_NE(UCC_OK, ucc_collective_post(req));
+    EXPECT_EQ(UCC_OK, ucc_collective_finalize(req));
+    EXPECT_EQ(UCC_OK, ucc_collective_group_end(t));
+}
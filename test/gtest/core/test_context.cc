@@ -7,6 +7,8 @@
 #include <vector>
 #include <algorithm>
 #include <random>
+#include <thread>
+#include <sched.h>
 
 test_context::test_context()
 {
@@ -100,3 +102,61 @@ UCC_TEST_F(test_context, global)
     job16.cleanup();
 
 }
+
+UCC_TEST_F(test_context, wait_sleep)
+{
+    /* Zero spin time: ucc_context_wait arms the worker and sleeps as soon as
+       the collective is not completed after a single progress call */
+    UccJob                    job(4, UccJob::UCC_JOB_CTX_GLOBAL,
+                                  {ucc_env_var_t("UCC_WAIT_SPIN_TIME", "0"),
+                                   ucc_env_var_t("UCC_WAIT_SLEEP_TIME", "10ms")});
+    UccTeam_h                 team = job.create_team(4);
+    std::vector<ucc_status_t> status(4, UCC_INPROGRESS);
+    std::vector<std::thread>  threads;
+    ucc_coll_args_t           coll;
+
+    unsetenv("UCC_WAIT_SPIN_TIME");
+    unsetenv("UCC_WAIT_SLEEP_TIME");
+    coll.mask      = 0;
+    coll.coll_type = UCC_COLL_TYPE_BARRIER;
+    UccReq req(team, &coll);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(UCC_OK, ucc_collective_post(req.reqs[i]));
+    }
+    for (int i = 0; i < 4; i++) {
+        threads.push_back(std::thread([&, i]() {
+            status[i] = ucc_context_wait(team->procs[i].p->ctx_h,
+                                         req.reqs[i]);
+        }));
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(UCC_OK, status[i]);
+    }
+}
+
+UCC_TEST_F(test_context, progress_thread)
+{
+    /* Collective completes without ucc_context_progress calls from user */
+    UccJob          job(4, UccJob::UCC_JOB_CTX_GLOBAL,
+                        {ucc_env_var_t("UCC_PROGRESS_THREAD", "y")});
+    UccTeam_h       team = job.create_team(4);
+    ucc_coll_args_t coll;
+    ucc_status_t    status;
+
+    unsetenv("UCC_PROGRESS_THREAD");
+    coll.mask      = 0;
+    coll.coll_type = UCC_COLL_TYPE_BARRIER;
+    UccReq req(team, &coll);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(UCC_OK, ucc_collective_post(req.reqs[i]));
+    }
+    for (int i = 0; i < 4; i++) {
+        while (UCC_INPROGRESS == (status = ucc_collective_test(req.reqs[i]))) {
+            sched_yield();
+        }
+        EXPECT_EQ(UCC_OK, status);
+    }
+}
@@ -6,6 +6,7 @@
 extern "C" {
 #include <components/mc/ucc_mc.h>
 #include <pthread.h>
+#include <unistd.h>
 }
 #include <common/test.h>
 #include <vector>
@@ -14,12 +15,12 @@ void *mt_ucc_mc_cpu_allocs(void *args)
 {
     // Final size will be:
     // size * (quantifier^(num_of_allocs/2))
-    // and should be larger than mpool buffer size which is 1MB by default,
+    // and should be larger than mpool buffer size which is 8MB by default,
     // to assure testing both fast and slow ucc_mc_alloc path.
     // if num_of_allocs is changed, change quantifier accordingly.
     size_t                                size          = 4;
     int                                   quantifier    = 2;
-    int                                   num_of_allocs = 40;
+    int                                   num_of_allocs = 50;
     std::vector<ucc_mc_buffer_header_t *> headers;
     std::vector<void *>                   pointers;
     headers.resize(num_of_allocs);
@@ -65,7 +66,7 @@ UCC_TEST_F(test_mc, init_is_required)
 
 UCC_TEST_F(test_mc, can_alloc_and_free_host_mem)
 {
-    // mpool will be used only if size is smaller than UCC_MC_CPU_ELEM_SIZE, which by default set to 1MB and is configurable at runtime.
+    // mpool will be used only if size is smaller than UCC_MC_CPU_ELEM_SIZE, which by default set to 8MB and is configurable at runtime.
     size_t                  size = 4096;
     ucc_mc_buffer_header_t *h;
     void *ptr = NULL;
@@ -82,10 +83,63 @@ UCC_TEST_F(test_mc, can_alloc_and_free_host_mem)
     ucc_mc_finalize();
 }
 
+UCC_TEST_F(test_mc, host_mem_pool_reuse)
+{
+    // sizes fall into different size classes, the last one is served
+    // outside of the pool
+    size_t sizes[] = {64, 4096, 100000, 3 * 1024 * 1024, 9 * 1024 * 1024};
+    ucc_mc_buffer_header_t *h1, *h2;
+
+    ASSERT_EQ(UCC_OK, ucc_constructor());
+    ucc_mc_params_t mc_params = {
+        .thread_mode = UCC_THREAD_SINGLE,
+    };
+    ASSERT_EQ(UCC_OK, ucc_mc_init(&mc_params));
+    for (size_t size : sizes) {
+        ASSERT_EQ(UCC_OK, ucc_mc_alloc(&h1, size, UCC_MEMORY_TYPE_HOST));
+        memset(h1->addr, 0xff, size);
+        EXPECT_EQ(UCC_OK, ucc_mc_free(h1));
+        /* freed pool buffer is reused by the next allocation of that class */
+        ASSERT_EQ(UCC_OK, ucc_mc_alloc(&h2, size - 1, UCC_MEMORY_TYPE_HOST));
+        if (h2->from_pool) {
+            EXPECT_EQ(h1, h2);
+        }
+        memset(h2->addr, 0, size - 1);
+        EXPECT_EQ(UCC_OK, ucc_mc_free(h2));
+    }
+    ucc_mc_finalize();
+}
+
+UCC_TEST_F(test_mc, host_mem_pool_pow2)
+{
+    // power of 2 sizes up to the pool element size are served from the
+    // pool, large buffers are page aligned
+    size_t                  sizes[] = {256, 65536, 1024 * 1024,
+                                       8 * 1024 * 1024};
+    size_t                  page    = sysconf(_SC_PAGESIZE);
+    ucc_mc_buffer_header_t *h;
+
+    ASSERT_EQ(UCC_OK, ucc_constructor());
+    ucc_mc_params_t mc_params = {
+        .thread_mode = UCC_THREAD_SINGLE,
+    };
+    ASSERT_EQ(UCC_OK, ucc_mc_init(&mc_params));
+    for (size_t size : sizes) {
+        ASSERT_EQ(UCC_OK, ucc_mc_alloc(&h, size, UCC_MEMORY_TYPE_HOST));
+        EXPECT_TRUE(h->from_pool);
+        if (size >= 65536) {
+            EXPECT_EQ(0, (uintptr_t)h->addr % page);
+        }
+        memset(h->addr, 0xff, size);
+        EXPECT_EQ(UCC_OK, ucc_mc_free(h));
+    }
+    ucc_mc_finalize();
+}
+
 // Disabled because can't reinit mc with different thread mode
 UCC_TEST_F(test_mc, DISABLED_can_alloc_and_free_host_mem_mt)
 {
-    // mpool will be used only if size is smaller than UCC_MC_CPU_ELEM_SIZE, which by default set to 1MB and is configurable at runtime.
+    // mpool will be used only if size is smaller than UCC_MC_CPU_ELEM_SIZE, which by default set to 8MB and is configurable at runtime.
     int                    num_of_threads = 10;
     std::vector<pthread_t> threads;
     threads.resize(num_of_threads);
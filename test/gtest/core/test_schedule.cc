@@ -77,3 +77,108 @@ UCC_TEST_F(test_schedule, different_handlers)
     EXPECT_EQ(true, (std::get<0>(rst[1]) == &tasks[1]) &&
               (std::get<1>(rst[1]) == 2));
 }
+
+class test_schedule_dag : public ucc::test
+{
+public:
+    typedef struct dag_task {
+        ucc_coll_task_t    super;
+        test_schedule_dag *test;
+        int                id;
+    } dag_task_t;
+    ucc_base_context_t      ctx;
+    ucc_base_team_t         team;
+    ucc_schedule_t          schedule;
+    std::vector<dag_task_t> tasks;
+    std::vector<int>        posted;
+
+    /* task completes inside post, so its dependents are released from
+       the completion of the previous one */
+    static ucc_status_t post(ucc_coll_task_t *task)
+    {
+        dag_task_t *t = (dag_task_t *)task;
+
+        t->test->posted.push_back(t->id);
+        task->status = UCC_OK;
+        return ucc_task_complete(task);
+    }
+    void init(int n_tasks)
+    {
+        ctx.ucc_context = NULL;
+        team.context    = &ctx;
+        EXPECT_EQ(UCC_OK, ucc_schedule_init(&schedule, NULL, &team));
+        tasks.resize(n_tasks);
+        for (int i = 0; i < n_tasks; i++) {
+            EXPECT_EQ(UCC_OK, ucc_coll_task_init(&tasks[i].super, NULL, NULL));
+            tasks[i].super.post     = post;
+            tasks[i].super.finalize = NULL;
+            tasks[i].test           = this;
+            tasks[i].id             = i;
+        }
+    }
+    void start()
+    {
+        for (auto &t : tasks) {
+            EXPECT_EQ(UCC_OK, ucc_schedule_add_task(&schedule, &t.super));
+        }
+        EXPECT_EQ(UCC_OK, ucc_event_manager_subscribe(
+                              &schedule.super.em, UCC_EVENT_SCHEDULE_STARTED,
+                              &tasks[0].super, ucc_task_start_handler));
+        EXPECT_EQ(UCC_OK, ucc_schedule_start(&schedule.super));
+        EXPECT_EQ(UCC_OK, schedule.super.super.status);
+        EXPECT_EQ(tasks.size(), posted.size());
+    }
+    void fini()
+    {
+        EXPECT_EQ(UCC_OK, ucc_schedule_finalize(&schedule.super));
+    }
+};
+
+/* Chain of tasks: every task depends on the previous one. Posting is done
+   from the ready queue so depth is not limited by the stack */
+UCC_TEST_F(test_schedule_dag, deep)
+{
+    const int n_tasks = 4096;
+
+    init(n_tasks);
+    for (int i = 1; i < n_tasks; i++) {
+        EXPECT_EQ(UCC_OK, ucc_task_subscribe_dep(&tasks[i - 1].super,
+                                                 &tasks[i].super,
+                                                 UCC_EVENT_COMPLETED));
+    }
+    start();
+    ASSERT_EQ(n_tasks, (int)posted.size());
+    for (int i = 0; i < n_tasks; i++) {
+        EXPECT_EQ(i, posted[i]);
+    }
+    fini();
+}
+
+/* Fan out from task 0 to n_tasks - 2 tasks, all of them are joined by
+   the last task. Exceeds inline listeners of task 0 and 8 bit deps
+   counter of the last task */
+UCC_TEST_F(test_schedule_dag, wide)
+{
+    const int n_tasks = 512;
+
+    init(n_tasks);
+    for (int i = 1; i < n_tasks - 1; i++) {
+        EXPECT_EQ(UCC_OK, ucc_task_subscribe_dep(&tasks[0].super,
+                                                 &tasks[i].super,
+                                                 UCC_EVENT_COMPLETED));
+        EXPECT_EQ(UCC_OK, ucc_task_subscribe_dep(&tasks[i].super,
+                                                 &tasks[n_tasks - 1].super,
+                                                 UCC_EVENT_COMPLETED));
+    }
+    EXPECT_EQ(n_tasks - 2, tasks[n_tasks - 1].super.n_deps);
+    start();
+    ASSERT_EQ(n_tasks, (int)posted.size());
+    std::vector<int> sorted(posted);
+    std::sort(sorted.begin(), sorted.end());
+    for (int i = 0; i < n_tasks; i++) {
+        EXPECT_EQ(i, sorted[i]);
+    }
+    EXPECT_EQ(0, posted.front());
+    EXPECT_EQ(n_tasks - 1, posted.back());
+    fini();
+}
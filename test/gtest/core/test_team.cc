@@ -121,3 +121,95 @@ UCC_TEST_F(test_team, team_get_attr)
     /* shuffle vector so that teams are destroyed in different order */
     std::shuffle(teams.begin(), teams.end(), std::default_random_engine());
 }
+
+/* Team spanning 2 contexts per process: large allreduce is striped across
+   the contexts, small one runs on the first context only */
+UCC_TEST_F(test_team, team_create_multiple_contexts)
+{
+    const int                       n_procs  = 4;
+    const size_t                    counts[] = {8, 256 * 1024};
+    UccJob                          job0(n_procs, UccJob::UCC_JOB_CTX_GLOBAL);
+    UccJob                          job1(n_procs, UccJob::UCC_JOB_CTX_GLOBAL);
+    std::vector<ucc_team_h>         teams(n_procs);
+    std::vector<std::vector<float>> bufs(n_procs);
+    std::vector<ucc_coll_req_h>     reqs(n_procs);
+    ucc_team_params_t               params;
+    ucc_coll_args_t                 args;
+    ucc_status_t                    status;
+    bool                            all_done;
+
+    for (int i = 0; i < n_procs; i++) {
+        ucc_context_h ctxs[2] = {job0.procs[i]->ctx_h, job1.procs[i]->ctx_h};
+
+        params.mask          = UCC_TEAM_PARAM_FIELD_EP |
+                               UCC_TEAM_PARAM_FIELD_EP_RANGE |
+                               UCC_TEAM_PARAM_FIELD_EP_MAP;
+        params.ep            = i;
+        params.ep_range      = UCC_COLLECTIVE_EP_RANGE_CONTIG;
+        params.ep_map.type   = UCC_EP_MAP_FULL;
+        params.ep_map.ep_num = n_procs;
+        ASSERT_EQ(UCC_OK, ucc_team_create_post(ctxs, 2, &params, &teams[i]));
+    }
+    do {
+        all_done = true;
+        for (int i = 0; i < n_procs; i++) {
+            ucc_context_progress(job0.procs[i]->ctx_h);
+            ucc_context_progress(job1.procs[i]->ctx_h);
+            status = ucc_team_create_test(teams[i]);
+            ASSERT_GE(status, 0);
+            if (UCC_INPROGRESS == status) {
+                all_done = false;
+            }
+        }
+    } while (!all_done);
+
+    for (auto count : counts) {
+        for (int i = 0; i < n_procs; i++) {
+            bufs[i].assign(count, (float)(i + 1));
+            args.mask              = UCC_COLL_ARGS_FIELD_FLAGS;
+            args.flags             = UCC_COLL_ARGS_FLAG_IN_PLACE;
+            args.coll_type         = UCC_COLL_TYPE_ALLREDUCE;
+            args.op                = UCC_OP_SUM;
+            args.dst.info.buffer   = bufs[i].data();
+            args.dst.info.count    = count;
+            args.dst.info.datatype = UCC_DT_FLOAT32;
+            args.dst.info.mem_type = UCC_MEMORY_TYPE_HOST;
+            ASSERT_EQ(UCC_OK, ucc_collective_init(&args, &reqs[i], teams[i]));
+            ASSERT_EQ(UCC_OK, ucc_collective_post(reqs[i]));
+        }
+        do {
+            all_done = true;
+            for (int i = 0; i < n_procs; i++) {
+                ucc_context_progress(job0.procs[i]->ctx_h);
+                ucc_context_progress(job1.procs[i]->ctx_h);
+                status = ucc_collective_test(reqs[i]);
+                ASSERT_GE(status, 0);
+                if (UCC_INPROGRESS == status) {
+                    all_done = false;
+                }
+            }
+        } while (!all_done);
+        for (int i = 0; i < n_procs; i++) {
+            ucc_collective_finalize(reqs[i]);
+            EXPECT_EQ((ptrdiff_t)count,
+                      std::count(bufs[i].begin(), bufs[i].end(),
+                                 (float)(n_procs * (n_procs + 1) / 2)));
+        }
+    }
+
+    do {
+        all_done = true;
+        for (int i = 0; i < n_procs; i++) {
+            if (!teams[i]) {
+                continue;
+            }
+            status = ucc_team_destroy(teams[i]);
+            ASSERT_GE(status, 0);
+            if (UCC_OK == status) {
+                teams[i] = NULL;
+            } else {
+                all_done = false;
+            }
+        }
+    } while (!all_done);
+}
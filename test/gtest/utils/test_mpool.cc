@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2022, NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * See file LICENSE for terms.
+ */
+
+extern "C" {
+#include "utils/ucc_mpool.h"
+#include "utils/ucc_atomic.h"
+#include "utils/ucc_time.h"
+#include "utils/arch/cpu.h"
+#include <limits.h>
+#include <pthread.h>
+}
+#include <common/test.h>
+#include <vector>
+#include <string>
+
+#define MPOOL_ELEM_SIZE  64
+#define MPOOL_NUM_ITERS  200000
+#define MPOOL_BATCH_SIZE 48
+/* any finite limit disables the per-thread magazines */
+#define MPOOL_MAX_ELEMS  (1 << 20)
+
+typedef struct ucc_test_mpool {
+    ucc_mpool_t mp;
+    uint32_t    errors;
+    int         iters;
+} ucc_test_mpool_t;
+
+typedef struct ucc_test_mpool_thread {
+    ucc_test_mpool_t *test;
+    uint64_t          id;
+} ucc_test_mpool_thread_t;
+
+/* Each thread takes a batch of objects, stamps them with its id and
+   verifies the stamps before returning the batch: an object handed out
+   to 2 threads at the same time is detected as a stamp mismatch */
+static void *mpool_thread(void *arg)
+{
+    ucc_test_mpool_thread_t *t    = (ucc_test_mpool_thread_t *)arg;
+    ucc_test_mpool_t        *test = t->test;
+    uint64_t                *objs[MPOOL_BATCH_SIZE];
+    int                      i, j, n;
+
+    for (i = 0; i < test->iters; i++) {
+        n = i % MPOOL_BATCH_SIZE + 1;
+        for (j = 0; j < n; j++) {
+            objs[j] = (uint64_t *)ucc_mpool_get(&test->mp);
+            if (!objs[j]) {
+                ucc_atomic_add32(&test->errors, 1);
+                return NULL;
+            }
+            objs[j][0] = t->id;
+            objs[j][MPOOL_ELEM_SIZE / sizeof(uint64_t) - 1] = t->id;
+        }
+        for (j = 0; j < n; j++) {
+            if (objs[j][0] != t->id ||
+                objs[j][MPOOL_ELEM_SIZE / sizeof(uint64_t) - 1] != t->id) {
+                ucc_atomic_add32(&test->errors, 1);
+            }
+            ucc_mpool_put(objs[j]);
+        }
+    }
+    return NULL;
+}
+
+class test_mpool : public ucc::test {
+  public:
+    ucc_test_mpool_t test;
+    /* returns elapsed time in seconds, negative on error */
+    double run(int n_threads, ucc_thread_mode_t tm, int iters,
+               unsigned max_elems = UINT_MAX);
+};
+
+double test_mpool::run(int n_threads, ucc_thread_mode_t tm, int iters,
+                       unsigned max_elems)
+{
+    std::vector<pthread_t>               threads(n_threads);
+    std::vector<ucc_test_mpool_thread_t> args(n_threads);
+    double                               t;
+    int                                  i;
+
+    memset(&test, 0, sizeof(test));
+    test.iters = iters;
+    if (UCC_OK != ucc_mpool_init(&test.mp, 0, MPOOL_ELEM_SIZE, 0,
+                                 UCC_CACHE_LINE_SIZE, 16, max_elems, NULL,
+                                 tm, "test_mpool")) {
+        return -1;
+    }
+    t = ucc_get_time();
+    for (i = 0; i < n_threads; i++) {
+        args[i].test = &test;
+        args[i].id   = i + 1;
+        pthread_create(&threads[i], NULL, &mpool_thread, &args[i]);
+    }
+    for (i = 0; i < n_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    t = ucc_get_time() - t;
+    /* leak check reports objects not returned to the pool, including
+       those left in the magazines */
+    ucc_mpool_cleanup(&test.mp, 1);
+    return test.errors ? -1 : t;
+}
+
+UCC_TEST_F(test_mpool, single_thread)
+{
+    EXPECT_GE(run(1, UCC_THREAD_SINGLE, MPOOL_NUM_ITERS), 0);
+}
+
+UCC_TEST_F(test_mpool, multiple_threads)
+{
+    EXPECT_GE(run(8, UCC_THREAD_MULTIPLE, MPOOL_NUM_ITERS), 0);
+}
+
+UCC_TEST_F(test_mpool, multiple_threads_bounded)
+{
+    EXPECT_GE(run(8, UCC_THREAD_MULTIPLE, MPOOL_NUM_ITERS, MPOOL_MAX_ELEMS), 0);
+}
+
+UCC_TEST_F(test_mpool, cross_thread_put)
+{
+    std::vector<void *> objs(UCC_MPOOL_MAGAZINE_SIZE * 4);
+    pthread_t           thread;
+    size_t              i;
+
+    ASSERT_EQ(UCC_OK, ucc_mpool_init(&test.mp, 0, MPOOL_ELEM_SIZE, 0,
+                                     UCC_CACHE_LINE_SIZE, 16, UINT_MAX, NULL,
+                                     UCC_THREAD_MULTIPLE, "test_mpool"));
+    for (i = 0; i < objs.size(); i++) {
+        objs[i] = ucc_mpool_get(&test.mp);
+        ASSERT_NE((void *)NULL, objs[i]);
+    }
+    /* objects taken by this thread are returned from another one */
+    pthread_create(
+        &thread, NULL,
+        [](void *arg) -> void * {
+            std::vector<void *> *v = (std::vector<void *> *)arg;
+            for (size_t j = 0; j < v->size(); j++) {
+                ucc_mpool_put((*v)[j]);
+            }
+            return NULL;
+        },
+        &objs);
+    pthread_join(thread, NULL);
+    ucc_mpool_cleanup(&test.mp, 1);
+}
+
+/* Throughput of get/put pairs, recorded as test property in Mops. Bounded
+   pool goes through the locked free list, unbounded one through the
+   magazines */
+UCC_TEST_F(test_mpool, throughput)
+{
+    int         n_threads[] = {1, 2, 4, 8};
+    int         iters       = MPOOL_NUM_ITERS / 4;
+    const char *path[]      = {"locked", "magazine"};
+    unsigned    max_elems[] = {MPOOL_MAX_ELEMS, UINT_MAX};
+    double      t;
+
+    for (int p = 0; p < 2; p++) {
+        for (int n : n_threads) {
+            t = run(n, UCC_THREAD_MULTIPLE, iters, max_elems[p]);
+            ASSERT_GT(t, 0);
+            /* average batch is (MPOOL_BATCH_SIZE + 1) / 2 objects */
+            RecordProperty(std::string("mops_") + path[p] + "_" +
+                               std::to_string(n) + "_threads",
+                           std::to_string(n * (double)iters *
+                                          (MPOOL_BATCH_SIZE + 1) / 2 / t /
+                                          1e6));
+        }
+    }
+}
@@ -1,4 +1,6 @@
 #include <iomanip>
+#include <time.h>
+#include <algorithm>
 #include "ucc_pt_benchmark.h"
 #include "components/mc/ucc_mc.h"
 #include "ucc_perftest.h"
@@ -63,7 +65,7 @@ ucc_status_t ucc_pt_benchmark::run_bench() noexcept
     size_t max_count = coll->has_range() ? config.max_count : 1;
     ucc_status_t    st;
     ucc_coll_args_t args;
-    double          time;
+    double          time, cpu_time, cmp_time, cmp_cpu_time;
 
     print_header();
     for (size_t cnt = min_count; cnt <= max_count; cnt *= 2) {
@@ -74,9 +76,27 @@ ucc_status_t ucc_pt_benchmark::run_bench() noexcept
             iter = config.n_iter_large;
             warmup = config.n_warmup_large;
         }
+        if (config.n_group) {
+            UCCCHECK_GOTO(run_group_bench(cnt, warmup, iter), exit_err, st);
+            continue;
+        }
         UCCCHECK_GOTO(coll->init_coll_args(cnt, args), exit_err, st);
-        UCCCHECK_GOTO(run_single_test(args, warmup, iter, time), free_coll, st);
-        print_time(cnt, args, time);
+        UCCCHECK_GOTO(run_single_test(args, warmup, iter, false, 0, time,
+                                      cpu_time), free_coll, st);
+        if (config.overlap) {
+            /* compute for as long as the pure collective takes */
+            UCCCHECK_GOTO(run_single_test(args, warmup, iter, false, time,
+                                          cmp_time, cmp_cpu_time),
+                          free_coll, st);
+            print_overlap(cnt, time, cmp_time);
+        } else if (config.blocking_wait) {
+            UCCCHECK_GOTO(run_single_test(args, warmup, iter, true, 0,
+                                          cmp_time, cmp_cpu_time),
+                          free_coll, st);
+            print_wait_time(cnt, time, cpu_time, cmp_time, cmp_cpu_time);
+        } else {
+            print_time(cnt, args, time);
+        }
         coll->free_coll_args(args);
     }
 
@@ -95,9 +115,20 @@ static inline double get_time_us(void)
     return t.tv_sec * 1e6 + t.tv_usec;
 }
 
+static inline double get_cpu_time_us(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return t.tv_sec * 1e6 + t.tv_nsec * 1e-3;
+}
+
 ucc_status_t ucc_pt_benchmark::run_single_test(ucc_coll_args_t args,
                                                int nwarmup, int niter,
-                                               double &time)
+                                               bool wait,
+                                               double compute_time,
+                                               double &time,
+                                               double &cpu_time)
                                                noexcept
 {
     const bool    triggered = config.triggered;
@@ -109,7 +140,8 @@ ucc_status_t ucc_pt_benchmark::run_single_test(ucc_coll_args_t args,
     ucc_ev_t comp_ev, *post_ev;
 
     UCCCHECK_GOTO(comm->barrier(), exit_err, st);
-    time = 0;
+    time     = 0;
+    cpu_time = 0;
 
     if (triggered) {
         try {
@@ -125,7 +157,8 @@ ucc_status_t ucc_pt_benchmark::run_single_test(ucc_coll_args_t args,
     }
 
     for (int i = 0; i < nwarmup + niter; i++) {
-        double s = get_time_us();
+        double s  = get_time_us();
+        double cs = get_cpu_time_us();
         UCCCHECK_GOTO(ucc_collective_init(&args, &req, team), exit_err, st);
         if (triggered) {
             comp_ev.req = req;
@@ -137,23 +170,35 @@ ucc_status_t ucc_pt_benchmark::run_single_test(ucc_coll_args_t args,
         } else {
             UCCCHECK_GOTO(ucc_collective_post(req), free_req, st);
         }
-        st = ucc_collective_test(req);
-        while (st > 0) {
-            UCCCHECK_GOTO(ucc_context_progress(ctx), free_req, st);
+        if (compute_time > 0) {
+            /* emulates application compute: no progress calls */
+            while (get_time_us() - s < compute_time) {
+            }
+        }
+        if (wait) {
+            st = ucc_context_wait(ctx, req);
+        } else {
             st = ucc_collective_test(req);
+            while (st > 0) {
+                UCCCHECK_GOTO(comm->progress(), free_req, st);
+                st = ucc_collective_test(req);
+            }
         }
         ucc_collective_finalize(req);
-        double f = get_time_us();
+        double f  = get_time_us();
+        double cf = get_cpu_time_us();
         if (st != UCC_OK) {
             goto exit_err;
         }
         if (i >= nwarmup) {
-            time += f - s;
+            time     += f - s;
+            cpu_time += cf - cs;
         }
         UCCCHECK_GOTO(comm->barrier(), exit_err, st);
     }
     if (niter != 0) {
-        time /= niter;
+        time     /= niter;
+        cpu_time /= niter;
     }
     return UCC_OK;
 free_req:
@@ -162,6 +207,103 @@ exit_err:
     return st;
 }
 
+ucc_status_t ucc_pt_benchmark::run_group_bench(size_t count, int nwarmup,
+                                              int niter) noexcept
+{
+    std::vector<ucc_coll_args_t> args(config.n_group);
+    ucc_status_t                 st = UCC_OK;
+    double                       unfused_time, fused_time;
+    int                          n_init;
+
+    for (n_init = 0; n_init < config.n_group; n_init++) {
+        UCCCHECK_GOTO(coll->init_coll_args(count, args[n_init]), free_args,
+                      st);
+    }
+    UCCCHECK_GOTO(run_group_test(args, nwarmup, niter, false, unfused_time),
+                  free_args, st);
+    UCCCHECK_GOTO(run_group_test(args, nwarmup, niter, true, fused_time),
+                  free_args, st);
+    print_group_time(count, unfused_time, fused_time);
+free_args:
+    for (int i = 0; i < n_init; i++) {
+        coll->free_coll_args(args[i]);
+    }
+    return st;
+}
+
+/* Posts all the collectives of "args" and waits for all of them, either one
+   by one or within a collective group that lets the library fuse them */
+ucc_status_t ucc_pt_benchmark::run_group_test(std::vector<ucc_coll_args_t> &args,
+                                              int nwarmup, int niter,
+                                              bool fused, double &time)
+                                              noexcept
+{
+    ucc_team_h                  team = comm->get_team();
+    ucc_status_t                st   = UCC_OK;
+    std::vector<ucc_coll_req_h> reqs;
+    bool                        done;
+
+    UCCCHECK_GOTO(comm->barrier(), exit_err, st);
+    time = 0;
+    reqs.reserve(args.size());
+    for (int i = 0; i < nwarmup + niter; i++) {
+        double s = get_time_us();
+        if (fused) {
+            UCCCHECK_GOTO(ucc_collective_group_start(team), exit_err, st);
+        }
+        for (auto &a : args) {
+            reqs.push_back(nullptr);
+            st = ucc_collective_init(&a, &reqs.back(), team);
+            if (st != UCC_OK) {
+                reqs.pop_back();
+                break;
+            }
+        }
+        if (fused) {
+            ucc_status_t end_st = ucc_collective_group_end(team);
+            if (st == UCC_OK) {
+                st = end_st;
+            }
+        }
+        if (st != UCC_OK) {
+            goto free_reqs;
+        }
+        for (auto r : reqs) {
+            UCCCHECK_GOTO(ucc_collective_post(r), free_reqs, st);
+        }
+        do {
+            done = true;
+            UCCCHECK_GOTO(comm->progress(), free_reqs, st);
+            for (auto r : reqs) {
+                st = ucc_collective_test(r);
+                if (st < 0) {
+                    goto free_reqs;
+                }
+                done = done && (st == UCC_OK);
+            }
+        } while (!done);
+        for (auto r : reqs) {
+            ucc_collective_finalize(r);
+        }
+        reqs.clear();
+        double f = get_time_us();
+        if (i >= nwarmup) {
+            time += f - s;
+        }
+        UCCCHECK_GOTO(comm->barrier(), exit_err, st);
+    }
+    if (niter != 0) {
+        time /= niter;
+    }
+    return UCC_OK;
+free_reqs:
+    for (auto r : reqs) {
+        ucc_collective_finalize(r);
+    }
+exit_err:
+    return st;
+}
+
 void ucc_pt_benchmark::print_header()
 {
     if (comm->get_rank() == 0) {
@@ -202,6 +344,39 @@ void ucc_pt_benchmark::print_header()
                   << "  large" << config.n_iter_large << std::endl;
         std::cout.copyfmt(iostate);
         std::cout << std::endl;
+        if (config.n_group) {
+            std::cout << std::setw(12) << "Count"
+                      << std::setw(12) << "Size"
+                      << std::setw(24) << "Time avg, us"
+                      << std::setw(12) << "Speedup"
+                      << std::endl;
+            std::cout << std::setw(36) << "unfused"
+                      << std::setw(12) << "fused"
+                      << std::endl;
+            return;
+        }
+        if (config.overlap) {
+            std::cout << std::setw(12) << "Count"
+                      << std::setw(12) << "Size"
+                      << std::setw(12) << "Pure, us"
+                      << std::setw(12) << "Total, us"
+                      << std::setw(12) << "Overlap, %"
+                      << std::endl;
+            return;
+        }
+        if (config.blocking_wait) {
+            std::cout << std::setw(12) << "Count"
+                      << std::setw(12) << "Size"
+                      << std::setw(24) << "Time avg, us"
+                      << std::setw(24) << "CPU usage avg, %"
+                      << std::endl;
+            std::cout << std::setw(36) << "poll"
+                      << std::setw(12) << "wait"
+                      << std::setw(12) << "poll"
+                      << std::setw(12) << "wait"
+                      << std::endl;
+            return;
+        }
         std::cout << std::setw(12) << "Count"
                   << std::setw(12) << "Size"
                   << std::setw(24) << "Time, us";
@@ -275,6 +450,105 @@ void ucc_pt_benchmark::print_time(size_t count, ucc_coll_args_t args,
     }
 }
 
+/* Latency of ucc_context_wait against polling and CPU time consumed by
+   each of them, relative to the collective time */
+void ucc_pt_benchmark::print_wait_time(size_t count, double poll_time,
+                                       double poll_cpu, double wait_time,
+                                       double wait_cpu)
+{
+    size_t size  = count * ucc_dt_size(config.dt);
+    int    gsize = comm->get_size();
+    double in[4] = {poll_time, wait_time,
+                    poll_time > 0 ? 100 * poll_cpu / poll_time : 0,
+                    wait_time > 0 ? 100 * wait_cpu / wait_time : 0};
+    double avg[4];
+
+    comm->allreduce(in, avg, 4, UCC_OP_SUM);
+    for (int i = 0; i < 4; i++) {
+        avg[i] /= gsize;
+    }
+
+    if (comm->get_rank() == 0) {
+        std::ios iostate(nullptr);
+        iostate.copyfmt(std::cout);
+        std::cout << std::setprecision(2) << std::fixed;
+        std::cout << std::setw(12) << (coll->has_range() ?
+                                        std::to_string(count):
+                                        "N/A")
+                  << std::setw(12) << (coll->has_range() ?
+                                        std::to_string(size):
+                                        "N/A");
+        for (int i = 0; i < 4; i++) {
+            std::cout << std::setw(12) << avg[i];
+        }
+        std::cout << std::endl;
+        std::cout.copyfmt(iostate);
+    }
+}
+
+/* Total time is collective posted, compute of pure_time without progress
+   calls, completion. Overlap is the part of the collective hidden behind the
+   compute: 100% if total equals compute, 0% if total is compute + pure */
+void ucc_pt_benchmark::print_overlap(size_t count, double pure_time,
+                                     double total_time)
+{
+    size_t size    = count * ucc_dt_size(config.dt);
+    int    gsize   = comm->get_size();
+    double in[2]   = {pure_time, total_time};
+    double avg[2], overlap;
+
+    comm->allreduce(in, avg, 2, UCC_OP_SUM);
+    avg[0] /= gsize;
+    avg[1] /= gsize;
+    overlap = avg[0] > 0 ? 100 * (1 - (avg[1] - avg[0]) / avg[0]) : 0;
+    overlap = std::min(std::max(overlap, 0.0), 100.0);
+
+    if (comm->get_rank() == 0) {
+        std::ios iostate(nullptr);
+        iostate.copyfmt(std::cout);
+        std::cout << std::setprecision(2) << std::fixed;
+        std::cout << std::setw(12) << (coll->has_range() ?
+                                        std::to_string(count):
+                                        "N/A")
+                  << std::setw(12) << (coll->has_range() ?
+                                        std::to_string(size):
+                                        "N/A")
+                  << std::setw(12) << avg[0]
+                  << std::setw(12) << avg[1]
+                  << std::setw(12) << overlap
+                  << std::endl;
+        std::cout.copyfmt(iostate);
+    }
+}
+
+/* Time of the whole group of config.n_group collectives of "count"
+   elements each, posted one by one and fused */
+void ucc_pt_benchmark::print_group_time(size_t count, double unfused_time,
+                                        double fused_time)
+{
+    size_t size  = count * ucc_dt_size(config.dt);
+    int    gsize = comm->get_size();
+    double in[2] = {unfused_time, fused_time};
+    double avg[2];
+
+    comm->allreduce(in, avg, 2, UCC_OP_SUM);
+    avg[0] /= gsize;
+    avg[1] /= gsize;
+
+    if (comm->get_rank() == 0) {
+        std::ios iostate(nullptr);
+        iostate.copyfmt(std::cout);
+        std::cout << std::setprecision(2) << std::fixed;
+        std::cout << std::setw(12) << count
+                  << std::setw(12) << size
+                  << std::setw(12) << avg[0]
+                  << std::setw(12) << avg[1]
+                  << std::setw(12) << (avg[1] > 0 ? avg[0] / avg[1] : 0)
+                  << std::endl;
+        std::cout.copyfmt(iostate);
+    }
+}
+
 ucc_pt_benchmark::~ucc_pt_benchmark()
 {
     delete coll;
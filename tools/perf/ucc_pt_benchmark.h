@@ -11,6 +11,7 @@
 #include "ucc_pt_coll.h"
 #include "ucc_pt_comm.h"
 #include <ucc/api/ucc.h>
+#include <vector>
 
 class ucc_pt_benchmark {
     ucc_pt_benchmark_config config;
@@ -21,12 +22,23 @@ class ucc_pt_benchmark {
     void print_header();
     void print_time(size_t count, ucc_coll_args_t args,
                     double time);
+    void print_wait_time(size_t count, double poll_time, double poll_cpu,
+                         double wait_time, double wait_cpu);
+    void print_overlap(size_t count, double pure_time, double total_time);
+    void print_group_time(size_t count, double unfused_time,
+                          double fused_time);
 public:
     ucc_pt_benchmark(ucc_pt_benchmark_config cfg, ucc_pt_comm *communicator);
     ucc_status_t run_bench() noexcept;
     ucc_status_t run_single_test(ucc_coll_args_t args,
-                                 int nwarmup, int niter,
-                                 double &time) noexcept;
+                                 int nwarmup, int niter, bool wait,
+                                 double compute_time, double &time,
+                                 double &cpu_time) noexcept;
+    ucc_status_t run_group_bench(size_t count, int nwarmup,
+                                 int niter) noexcept;
+    ucc_status_t run_group_test(std::vector<ucc_coll_args_t> &args,
+                                int nwarmup, int niter, bool fused,
+                                double &time) noexcept;
     ~ucc_pt_benchmark();
 };
 
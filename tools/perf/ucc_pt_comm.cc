@@ -83,7 +83,20 @@ ucc_team_h ucc_pt_comm::get_team()
 
 ucc_context_h ucc_pt_comm::get_context()
 {
-    return context;
+    return contexts[0];
+}
+
+ucc_status_t ucc_pt_comm::progress()
+{
+    ucc_status_t st;
+
+    for (auto ctx : contexts) {
+        st = ucc_context_progress(ctx);
+        if (st != UCC_OK) {
+            return st;
+        }
+    }
+    return UCC_OK;
 }
 
 ucc_status_t ucc_pt_comm::init()
@@ -93,6 +106,7 @@ ucc_status_t ucc_pt_comm::init()
     ucc_lib_params_t lib_params;
     ucc_context_params_t ctx_params;
     ucc_team_params_t team_params;
+    ucc_context_h context;
     ucc_status_t st;
     std::string cfg_mod;
 
@@ -126,16 +140,19 @@ ucc_status_t ucc_pt_comm::init()
                       UCC_CONTEXT_PARAM_FIELD_OOB;
     ctx_params.type = UCC_CONTEXT_SHARED;
     ctx_params.oob  = bootstrap->get_context_oob();
-    UCCCHECK_GOTO(ucc_context_create(lib, &ctx_params, ctx_config, &context),
-                  free_ctx_config, st);
+    for (int i = 0; i < cfg.n_contexts; i++) {
+        UCCCHECK_GOTO(ucc_context_create(lib, &ctx_params, ctx_config,
+                                         &context), free_ctx, st);
+        contexts.push_back(context);
+    }
     team_params.mask     = UCC_TEAM_PARAM_FIELD_EP |
                            UCC_TEAM_PARAM_FIELD_EP_RANGE |
                            UCC_TEAM_PARAM_FIELD_OOB;
     team_params.oob      = bootstrap->get_team_oob();
     team_params.ep       = bootstrap->get_rank();
     team_params.ep_range = UCC_COLLECTIVE_EP_RANGE_CONTIG;
-    UCCCHECK_GOTO(ucc_team_create_post(&context, 1, &team_params, &team),
-                  free_ctx, st);
+    UCCCHECK_GOTO(ucc_team_create_post(contexts.data(), contexts.size(),
+                                       &team_params, &team), free_ctx, st);
     do {
         st = ucc_team_create_test(team);
     } while(st == UCC_INPROGRESS);
@@ -144,7 +161,10 @@ ucc_status_t ucc_pt_comm::init()
     ucc_lib_config_release(lib_config);
     return UCC_OK;
 free_ctx:
-    ucc_context_destroy(context);
+    for (auto ctx : contexts) {
+        ucc_context_destroy(ctx);
+    }
+    contexts.clear();
 free_ctx_config:
     ucc_context_config_release(ctx_config);
 free_lib:
@@ -179,7 +199,9 @@ ucc_status_t ucc_pt_comm::finalize()
     if (status != UCC_OK) {
         std::cerr << "ucc team destroy error: " << ucc_status_string(status);
     }
-    ucc_context_destroy(context);
+    for (auto ctx : contexts) {
+        ucc_context_destroy(ctx);
+    }
     ucc_finalize(lib);
     return UCC_OK;
 }
@@ -194,7 +216,7 @@ ucc_status_t ucc_pt_comm::barrier()
     ucc_collective_init(&args, &req, team);
     ucc_collective_post(req);
     do {
-        ucc_context_progress(context);
+        progress();
     } while (ucc_collective_test(req) == UCC_INPROGRESS);
     ucc_collective_finalize(req);
     return UCC_OK;
@@ -220,7 +242,7 @@ ucc_status_t ucc_pt_comm::allreduce(double* in, double* out, size_t size,
     ucc_collective_init(&args, &req, team);
     ucc_collective_post(req);
     do {
-        ucc_context_progress(context);
+        progress();
     } while (ucc_collective_test(req) == UCC_INPROGRESS);
     ucc_collective_finalize(req);
     return UCC_OK;
@@ -8,6 +8,7 @@
 #define UCC_PT_COMM_H
 
 #include <ucc/api/ucc.h>
+#include <vector>
 #include "ucc_pt_config.h"
 #include "ucc_pt_bootstrap.h"
 #include "ucc_pt_bootstrap_mpi.h"
@@ -15,7 +16,7 @@
 class ucc_pt_comm {
     ucc_pt_comm_config cfg;
     ucc_lib_h lib;
-    ucc_context_h context;
+    std::vector<ucc_context_h> contexts;
     ucc_team_h team;
     void *stream;
     ucc_ee_h ee;
@@ -30,6 +31,7 @@ public:
     ucc_context_h get_context();
     ~ucc_pt_comm();
     ucc_status_t init();
+    ucc_status_t progress();
     ucc_status_t barrier();
     ucc_status_t allreduce(double* in, double *out, size_t size,
                            ucc_reduction_op_t op);
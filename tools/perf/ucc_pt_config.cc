@@ -19,7 +19,11 @@ ucc_pt_config::ucc_pt_config() {
     bench.n_warmup_large = 20;
     bench.large_thresh   = 64 * 1024;
     bench.full_print     = false;
+    bench.blocking_wait  = false;
+    bench.overlap        = false;
+    bench.n_group        = 0;
     comm.mt              = bench.mt;
+    comm.n_contexts      = 1;
 }
 
 const std::map<std::string, ucc_reduction_op_t> ucc_pt_op_map = {
@@ -70,7 +74,7 @@ ucc_status_t ucc_pt_config::process_args(int argc, char *argv[])
     int c;
     ucc_status_t st;
 
-    while ((c = getopt(argc, argv, "c:b:e:d:m:n:w:o:ihFT")) != -1) {
+    while ((c = getopt(argc, argv, "c:b:e:d:m:n:w:o:C:G:ihFTWO")) != -1) {
         switch (c) {
             case 'c':
                 if (ucc_pt_coll_map.count(optarg) == 0) {
@@ -132,12 +136,45 @@ ucc_status_t ucc_pt_config::process_args(int argc, char *argv[])
             case 'F':
                 bench.full_print = true;
                 break;
+            case 'C':
+                std::stringstream(optarg) >> comm.n_contexts;
+                if (comm.n_contexts < 1) {
+                    std::cerr << "invalid number of contexts" << std::endl;
+                    return UCC_ERR_INVALID_PARAM;
+                }
+                break;
+            case 'G':
+                std::stringstream(optarg) >> bench.n_group;
+                if (bench.n_group < 1) {
+                    std::cerr << "invalid group size" << std::endl;
+                    return UCC_ERR_INVALID_PARAM;
+                }
+                break;
+            case 'W':
+                bench.blocking_wait = true;
+                break;
+            case 'O':
+                bench.overlap = true;
+                break;
             case 'h':
             default:
                 print_help();
                 std::exit(0);
         }
     }
+    if (bench.blocking_wait && comm.n_contexts > 1) {
+        std::cerr << "blocking wait progresses single context, "
+                     "can not be used with multiple contexts" << std::endl;
+        return UCC_ERR_INVALID_PARAM;
+    }
+    if (bench.n_group &&
+        (bench.coll_type != UCC_COLL_TYPE_ALLREDUCE || bench.triggered ||
+         bench.blocking_wait || bench.overlap)) {
+        std::cerr << "collective group is supported for non triggered "
+                     "allreduce only, can not be combined with -W or -O"
+                  << std::endl;
+        return UCC_ERR_INVALID_PARAM;
+    }
     return UCC_OK;
 }
 
@@ -153,8 +190,18 @@ void ucc_pt_config::print_help()
     std::cout << "  -m <mtype name>: memory type"<<std::endl;
     std::cout << "  -n <number>: number of iterations"<<std::endl;
     std::cout << "  -w <number>: number of warmup iterations"<<std::endl;
+    std::cout << "  -C <number>: number of UCC contexts the team is created "
+                 "from, large collectives are striped across them"<<std::endl;
     std::cout << "  -T: triggered collective"<<std::endl;
     std::cout << "  -F: enable full print"<<std::endl;
+    std::cout << "  -W: compare polling with blocking ucc_context_wait, "
+                 "requires finite UCC_WAIT_SPIN_TIME"<<std::endl;
+    std::cout << "  -O: measure overlap of collective with compute, "
+                 "use UCC_PROGRESS_THREAD=y to progress during compute"
+              <<std::endl;
+    std::cout << "  -G <number>: compare <number> allreduces posted in a "
+                 "collective group (fused) against posted one by one"
+              <<std::endl;
     std::cout << "  -h: show this help message"<<std::endl;
     std::cout << std::endl;
 }
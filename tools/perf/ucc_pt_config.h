@@ -25,6 +25,7 @@ struct ucc_pt_bootstrap_config {
 
 struct ucc_pt_comm_config {
     ucc_memory_type_t mt;
+    int               n_contexts;
 };
 
 struct ucc_pt_benchmark_config {
@@ -42,6 +43,9 @@ struct ucc_pt_benchmark_config {
     int                n_iter_large;
     int                n_warmup_large;
     bool               full_print;
+    bool               blocking_wait;
+    bool               overlap;
+    int                n_group;
 };
 
 struct ucc_pt_config {